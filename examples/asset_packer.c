@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <sys/stat.h>
+
+#include "cengine/archive.h"
+#include "cengine/files.h"
+
+#include "cengine/types/string.h"
+
+#include "cengine/collections/dlist.h"
+
+// packs the files into an archive, so the game can mount it with archive_mount ()
+// and load its fonts, images & animations from memory instead of opening every file
+// directories are added with all of their files, -c compresses the files that get smaller with lz4
+// usage: asset_packer [-c] <output> <files or directories...>
+
+static void add_path (DoubleList *filenames, const char *path) {
+
+	struct stat filestatus;
+	if (!stat (path, &filestatus)) {
+		if (S_ISDIR (filestatus.st_mode)) {
+			DoubleList *files = files_get_from_dir (path);
+			if (files) {
+				for (ListElement *le = dlist_start (files); le; le = le->next)
+					add_path (filenames, ((String *) le->data)->str);
+
+				dlist_delete (files);
+			}
+		}
+
+		else dlist_insert_after (filenames, dlist_end (filenames), str_new (path));
+	}
+
+	else fprintf (stderr, "%s not found!\n", path);
+
+}
+
+int main (int argc, char **argv) {
+
+	bool compress = (argc > 1) && !strcmp (argv[1], "-c");
+	int first = compress ? 2 : 1;
+
+	if (argc - first < 2) {
+		fprintf (stderr, "usage: %s [-c] <output> <files or directories...>\n", argv[0]);
+		return 1;
+	}
+
+	int errors = 1;
+
+	DoubleList *filenames = dlist_init (str_delete, str_comparator);
+	if (filenames) {
+		for (int i = first + 1; i < argc; i++) add_path (filenames, argv[i]);
+
+		errors = archive_pack (argv[first], filenames, compress);
+		if (!errors) printf ("%s: %zu files\n", argv[first], dlist_size (filenames));
+
+		dlist_delete (filenames);
+	}
+
+	return errors;
+
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include "cengine/atlas.h"
+
+// packs the images into an atlas and bakes it, so the game can load it with atlas_load ()
+// instead of loading and packing every image at startup
+// usage: atlas_packer <output path> <page size> <images...>
+
+int main (int argc, char **argv) {
+
+	if (argc < 4) {
+		fprintf (stderr, "usage: %s <output path> <page size> <images...>\n", argv[0]);
+		return 1;
+	}
+
+	IMG_Init (IMG_INIT_PNG);
+
+	int errors = 0;
+
+	Atlas *atlas = atlas_create (argv[1], (u32) strtoul (argv[2], NULL, 10));
+	if (atlas) {
+		for (int i = 3; i < argc; i++)
+			if (!atlas_add_image (atlas, argv[i])) errors = 1;
+
+		if (!errors) {
+			errors = atlas_bake (atlas, argv[1]);
+			if (!errors)
+				printf ("%s: %d images in %d pages of %d\n", argv[1], atlas->n_regions, atlas->n_pages, atlas->page_size);
+		}
+
+		atlas_delete (atlas);
+	}
+
+	else errors = 1;
+
+	IMG_Quit ();
+
+	return errors;
+
+}
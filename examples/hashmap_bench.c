@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "cengine/collections/hashmap.h"
+
+// compares the HashMap against the chained table that Htab used before,
+// the old implementation is copied in here so both can be measured side by side
+
+#define BENCH_N_KEYS					100000
+#define BENCH_LEGACY_BUCKETS			1024
+#define BENCH_STRING_KEY_SIZE			32
+
+#pragma region legacy
+
+typedef struct LegacyNode {
+
+	struct LegacyNode *next;
+	void *key;
+	size_t key_size;
+	void *val;
+
+} LegacyNode;
+
+typedef struct LegacyHtab {
+
+	LegacyNode **table;
+	size_t size;
+	size_t count;
+
+} LegacyHtab;
+
+static size_t legacy_hash (const void *key, size_t key_size, size_t table_size) {
+
+	size_t sum = 0;
+	const unsigned char *k = (const unsigned char *) key;
+	for (size_t i = 0; i < key_size; ++i)
+		sum = (sum + (int) k[i]) % table_size;
+
+	return sum;
+
+}
+
+static LegacyHtab *legacy_create (size_t size) {
+
+	LegacyHtab *ht = (LegacyHtab *) malloc (sizeof (LegacyHtab));
+	ht->size = size;
+	ht->count = 0;
+	ht->table = (LegacyNode **) calloc (size, sizeof (LegacyNode *));
+
+	return ht;
+
+}
+
+static int legacy_insert (LegacyHtab *ht, const void *key, size_t key_size, void *val) {
+
+	size_t index = legacy_hash (key, key_size, ht->size);
+	for (LegacyNode *n = ht->table[index]; n; n = n->next)
+		if (n->key_size == key_size && !memcmp (n->key, key, key_size)) return 1;
+
+	LegacyNode *node = (LegacyNode *) malloc (sizeof (LegacyNode));
+	node->key = malloc (key_size);
+	memcpy (node->key, key, key_size);
+	node->key_size = key_size;
+	node->val = val;
+	node->next = ht->table[index];
+	ht->table[index] = node;
+	ht->count += 1;
+
+	return 0;
+
+}
+
+static void *legacy_get (LegacyHtab *ht, const void *key, size_t key_size) {
+
+	size_t index = legacy_hash (key, key_size, ht->size);
+	for (LegacyNode *n = ht->table[index]; n; n = n->next)
+		if (n->key_size == key_size && !memcmp (n->key, key, key_size)) return n->val;
+
+	return NULL;
+
+}
+
+static void *legacy_remove (LegacyHtab *ht, const void *key, size_t key_size) {
+
+	size_t index = legacy_hash (key, key_size, ht->size);
+	LegacyNode **prev = &ht->table[index];
+	for (LegacyNode *n = *prev; n; prev = &n->next, n = n->next) {
+		if (n->key_size == key_size && !memcmp (n->key, key, key_size)) {
+			void *val = n->val;
+			*prev = n->next;
+			free (n->key);
+			free (n);
+			ht->count -= 1;
+			return val;
+		}
+	}
+
+	return NULL;
+
+}
+
+static void legacy_destroy (LegacyHtab *ht) {
+
+	for (size_t i = 0; i < ht->size; i++) {
+		LegacyNode *n = ht->table[i];
+		while (n) {
+			LegacyNode *next = n->next;
+			free (n->key);
+			free (n);
+			n = next;
+		}
+	}
+
+	free (ht->table);
+	free (ht);
+
+}
+
+static size_t legacy_longest_chain (LegacyHtab *ht) {
+
+	size_t longest = 0;
+	for (size_t i = 0; i < ht->size; i++) {
+		size_t len = 0;
+		for (LegacyNode *n = ht->table[i]; n; n = n->next) len++;
+		if (len > longest) longest = len;
+	}
+
+	return longest;
+
+}
+
+#pragma endregion
+
+#pragma region bench
+
+typedef struct BenchKeys {
+
+	const char *name;
+	unsigned char *data;
+	size_t key_size;
+
+} BenchKeys;
+
+static double bench_now_ms (void) {
+
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+
+}
+
+#define bench_key(keys, i) ((keys)->data + (size_t) (i) * (keys)->key_size)
+
+// the first half of the keys is inserted, the second half is used for misses
+static void bench_legacy (const BenchKeys *keys, size_t n) {
+
+	size_t half = n / 2;
+	uintptr_t sum = 0;
+
+	LegacyHtab *ht = legacy_create (BENCH_LEGACY_BUCKETS);
+
+	double start = bench_now_ms ();
+	for (size_t i = 0; i < half; i++) legacy_insert (ht, bench_key (keys, i), keys->key_size, (void *) (i + 1));
+	double insert = bench_now_ms () - start;
+
+	start = bench_now_ms ();
+	for (size_t i = 0; i < half; i++) sum += (uintptr_t) legacy_get (ht, bench_key (keys, i), keys->key_size);
+	double hit = bench_now_ms () - start;
+
+	start = bench_now_ms ();
+	for (size_t i = half; i < n; i++) sum += (uintptr_t) legacy_get (ht, bench_key (keys, i), keys->key_size);
+	double miss = bench_now_ms () - start;
+
+	size_t longest = legacy_longest_chain (ht);
+
+	start = bench_now_ms ();
+	for (size_t i = 0; i < half; i++) sum += (uintptr_t) legacy_remove (ht, bench_key (keys, i), keys->key_size);
+	double remove = bench_now_ms () - start;
+
+	printf ("  %-8s insert %9.2f ms  hit %9.2f ms  miss %9.2f ms  remove %9.2f ms  longest chain %zu  (%lu)\n",
+		"htab", insert, hit, miss, remove, longest, (unsigned long) sum);
+
+	legacy_destroy (ht);
+
+}
+
+static void bench_hashmap (const BenchKeys *keys, size_t n) {
+
+	size_t half = n / 2;
+	uintptr_t sum = 0;
+
+	// start small so the resizes are part of the measure
+	HashMap *map = hashmap_create (HASHMAP_MIN_CAPACITY, NULL);
+
+	double start = bench_now_ms ();
+	for (size_t i = 0; i < half; i++) hashmap_insert (map, bench_key (keys, i), keys->key_size, (void *) (i + 1), sizeof (void *));
+	double insert = bench_now_ms () - start;
+
+	start = bench_now_ms ();
+	for (size_t i = 0; i < half; i++) sum += (uintptr_t) hashmap_get (map, bench_key (keys, i), keys->key_size);
+	double hit = bench_now_ms () - start;
+
+	start = bench_now_ms ();
+	for (size_t i = half; i < n; i++) sum += (uintptr_t) hashmap_get (map, bench_key (keys, i), keys->key_size);
+	double miss = bench_now_ms () - start;
+
+	start = bench_now_ms ();
+	for (size_t i = 0; i < half; i++) sum += (uintptr_t) hashmap_remove (map, bench_key (keys, i), keys->key_size);
+	double remove = bench_now_ms () - start;
+
+	printf ("  %-8s insert %9.2f ms  hit %9.2f ms  miss %9.2f ms  remove %9.2f ms  capacity %zu  (%lu)\n",
+		"hashmap", insert, hit, miss, remove, hashmap_capacity (map), (unsigned long) sum);
+
+	hashmap_delete (map);
+
+}
+
+#pragma endregion
+
+int main (int argc, char **argv) {
+
+	size_t n = argc > 1 ? (size_t) strtoul (argv[1], NULL, 10) : BENCH_N_KEYS;
+	if (n < 2) n = 2;
+
+	// sequential integer ids, like the ones used for game objects
+	BenchKeys int_keys = { "u32 ids", (unsigned char *) malloc (n * sizeof (uint32_t)), sizeof (uint32_t) };
+	for (size_t i = 0; i < n; i++) {
+		uint32_t id = (uint32_t) i;
+		memcpy (bench_key (&int_keys, i), &id, sizeof (uint32_t));
+	}
+
+	// names, longer than the inline key size
+	BenchKeys string_keys = { "names", (unsigned char *) calloc (n, BENCH_STRING_KEY_SIZE), BENCH_STRING_KEY_SIZE };
+	for (size_t i = 0; i < n; i++)
+		snprintf ((char *) bench_key (&string_keys, i), BENCH_STRING_KEY_SIZE, "assets/sprites/obj_%u", (unsigned int) i);
+
+	BenchKeys *all_keys[2] = { &int_keys, &string_keys };
+	for (unsigned int k = 0; k < 2; k++) {
+		printf ("%s - %zu keys (%zu inserted)\n", all_keys[k]->name, n, n / 2);
+		bench_legacy (all_keys[k], n);
+		bench_hashmap (all_keys[k], n);
+		printf ("\n");
+	}
+
+	free (int_keys.data);
+	free (string_keys.data);
+
+	return 0;
+
+}
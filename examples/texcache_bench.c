@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include "cengine/texcache.h"
+
+// compares decoding the images every time against loading them from a cold and a warm texture cache
+// usage: texcache_bench <cache dir> <images...>
+
+#define BENCH_ROUNDS					10
+
+static uint64_t bench_now (void) {
+
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+
+}
+
+// decodes the images like texture_load () did before the cache
+static int bench_decode (char **images, int n_images, u32 format) {
+
+	int errors = 0;
+
+	for (int i = 0; i < n_images; i++) {
+		SDL_Surface *surface = IMG_Load (images[i]);
+		SDL_Surface *converted = surface ? SDL_ConvertSurfaceFormat (surface, format, 0) : NULL;
+		if (!converted) errors = 1;
+
+		SDL_FreeSurface (surface);
+		SDL_FreeSurface (converted);
+	}
+
+	return errors;
+
+}
+
+static int bench_cache (char **images, int n_images, u32 format, bool copy) {
+
+	int errors = 0;
+
+	for (int i = 0; i < n_images; i++) {
+		SDL_Surface *surface = texcache_load_surface (images[i], format, copy);
+		if (!surface) errors = 1;
+
+		texcache_surface_delete (surface);
+	}
+
+	return errors;
+
+}
+
+static void bench_print (const char *name, uint64_t ns, int rounds, int n_images) {
+
+	printf ("%-24s %10.3f ms / round %10.1f us / image\n", name,
+		ns / 1e6 / rounds, ns / 1e3 / ((double) rounds * n_images));
+
+}
+
+int main (int argc, char **argv) {
+
+	if (argc < 3) {
+		fprintf (stderr, "usage: %s <cache dir> <images...>\n", argv[0]);
+		return 1;
+	}
+
+	IMG_Init (IMG_INIT_PNG | IMG_INIT_JPG);
+
+	int errors = texcache_set_dir (argv[1]);
+	if (!errors) {
+		char **images = argv + 2;
+		int n_images = argc - 2;
+
+		// the format a renderer without a native one would use
+		u32 format = texcache_get_format (NULL);
+
+		uint64_t start = bench_now ();
+		for (int r = 0; r < BENCH_ROUNDS; r++) errors |= bench_decode (images, n_images, format);
+		bench_print ("decode", bench_now () - start, BENCH_ROUNDS, n_images);
+
+		// decodes & stores every image
+		texcache_clear ();
+		start = bench_now ();
+		errors |= bench_cache (images, n_images, format, false);
+		bench_print ("cold cache", bench_now () - start, 1, n_images);
+
+		start = bench_now ();
+		for (int r = 0; r < BENCH_ROUNDS; r++) errors |= bench_cache (images, n_images, format, false);
+		bench_print ("warm cache (mapped)", bench_now () - start, BENCH_ROUNDS, n_images);
+
+		start = bench_now ();
+		for (int r = 0; r < BENCH_ROUNDS; r++) errors |= bench_cache (images, n_images, format, true);
+		bench_print ("warm cache (copied)", bench_now () - start, BENCH_ROUNDS, n_images);
+
+		TexCacheStats stats = texcache_get_stats ();
+		printf ("hits %llu misses %llu invalidated %llu stored %llu\n",
+			(unsigned long long) stats.hits, (unsigned long long) stats.misses,
+			(unsigned long long) stats.invalidated, (unsigned long long) stats.stored);
+
+		texcache_end ();
+	}
+
+	IMG_Quit ();
+
+	return errors;
+
+}
@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <unistd.h>
+#include <pthread.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/client/client.h"
+#include "cengine/client/connection.h"
+#include "cengine/client/packets.h"
+#include "cengine/client/udp.h"
+
+// sends game packets over udp to an echo peer in loopback that drops some of the datagrams it gets,
+// and checks that every reliable packet comes back exactly once & that the loss & rtt stats make sense
+// the peer is a bare udp connection that uses the same sequences & acks as the client
+// usage: udp_echo [-b] [-w] [drop percent] [packets]
+//	-b sends with a batch of 8 datagrams, -w starts the sequences & reliable ids near the 16 bit wrap
+
+#define ECHO_PORT				7301
+
+#define ECHO_RELIABLE_EVERY		8			// one of every 8 packets is sent reliable
+#define ECHO_DATA_SIZE			100
+#define ECHO_WAIT_TIME			5000		// ms, max time to wait for the reliable packets to come back
+
+#define ECHO_LOSS_TOLERANCE		10.0f		// max difference between the drop & the loss measured by the client
+
+static Connection *peer = NULL;
+static unsigned int drop_percent = 20;
+static volatile bool running = true;
+
+static u32 n_reliable_sent = 0;
+static u32 n_reliable_received = 0;
+static u32 n_reliable_duplicates = 0;
+static u32 n_unreliable_received = 0;
+static u8 *reliable_seen = NULL;
+
+static void *echo_peer (void *args) {
+
+	unsigned int seed = 7;
+	bool connected = false;
+	char datagram[UDP_MAX_DATAGRAM_SIZE];
+
+	while (running) {
+		struct sockaddr_storage from;
+		socklen_t from_len = sizeof (from);
+		ssize_t received = recvfrom (peer->socket->sock_fd, datagram, sizeof (datagram), 0,
+			(struct sockaddr *) &from, &from_len);
+
+		if (received >= (ssize_t) sizeof (UdpHeader)) {
+			// answers only to the first one that talks to it
+			if (!connected) {
+				connect (peer->socket->sock_fd, (struct sockaddr *) &from, from_len);
+				connected = true;
+			}
+
+			if ((unsigned int) (rand_r (&seed) % 100) < drop_percent) continue;
+
+			UdpHeader header;
+			memcpy (&header, datagram, sizeof (UdpHeader));
+
+			if (udp_receive (peer, datagram, received)) {
+				const void *pieces[1] = { datagram + sizeof (UdpHeader) };
+				size_t sizes[1] = { received - sizeof (UdpHeader) };
+				udp_send (peer, pieces, sizes, 1, header.flags & UDP_FLAG_RELIABLE, 0, NULL);
+			}
+		}
+
+		if (connected) udp_update (peer);
+	}
+
+	return NULL;
+
+}
+
+static Connection *echo_peer_create (bool wrap) {
+
+	Connection *connection = connection_create_empty ();
+	if (connection) {
+		connection->protocol = PROTOCOL_UDP;
+		connection->udp = udp_state_new ();
+		connection->socket->sock_fd = socket (AF_INET, SOCK_DGRAM, 0);
+
+		struct sockaddr_in address = { 0 };
+		address.sin_family = AF_INET;
+		address.sin_port = htons (ECHO_PORT);
+		address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+
+		if (connection->udp && (connection->socket->sock_fd >= 0)
+			&& !bind (connection->socket->sock_fd, (struct sockaddr *) &address, sizeof (address))) {
+			// recvfrom () must return from time to time to send again the reliable packets
+			struct timeval timeout = { 0, UDP_UPDATE_INTERVAL * 1000 };
+			setsockopt (connection->socket->sock_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (timeout));
+
+			if (wrap) {
+				connection->udp->local_sequence = 0xFFFF - 100;
+				connection->udp->next_reliable_id = 0xFFFF - 10;
+			}
+		}
+
+		else {
+			perror ("Failed to create the echo peer");
+			connection_delete (connection);
+			connection = NULL;
+		}
+	}
+
+	return connection;
+
+}
+
+// the packets come back with the index they were sent with as their request type
+static void echo_packet_handler (void *packet_ptr) {
+
+	Packet *packet = (Packet *) packet_ptr;
+
+	if (packet->req_type < n_reliable_sent * ECHO_RELIABLE_EVERY && !(packet->req_type % ECHO_RELIABLE_EVERY)) {
+		u32 idx = packet->req_type / ECHO_RELIABLE_EVERY;
+		if (__atomic_fetch_add (&reliable_seen[idx], 1, __ATOMIC_RELAXED))
+			__atomic_add_fetch (&n_reliable_duplicates, 1, __ATOMIC_RELAXED);
+
+		else __atomic_add_fetch (&n_reliable_received, 1, __ATOMIC_RELAXED);
+	}
+
+	else __atomic_add_fetch (&n_unreliable_received, 1, __ATOMIC_RELAXED);
+
+}
+
+static u8 echo_send (Client *client, Connection *connection, u32 idx) {
+
+	u8 retval = 1;
+
+	char data[ECHO_DATA_SIZE];
+	memset (data, idx & 0xFF, sizeof (data));
+
+	Packet *packet = packet_generate_request (APP_PACKET, idx, data, sizeof (data));
+	if (packet) {
+		packet_set_network_values (packet, client, connection);
+
+		retval = (idx % ECHO_RELIABLE_EVERY) ?
+			packet_send (packet, 0, NULL, false) : packet_send_reliable (packet, 0, NULL);
+
+		packet_delete (packet);
+	}
+
+	return retval;
+
+}
+
+int main (int argc, char **argv) {
+
+	bool batch = false;
+	bool wrap = false;
+	u32 n_packets = 400;
+
+	int arg = 1;
+	for (; arg < argc && argv[arg][0] == '-'; arg++) {
+		if (!strcmp (argv[arg], "-b")) batch = true;
+		else if (!strcmp (argv[arg], "-w")) wrap = true;
+		else {
+			fprintf (stderr, "usage: %s [-b] [-w] [drop percent] [packets]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (arg < argc) drop_percent = (unsigned int) atoi (argv[arg++]);
+	if (arg < argc) n_packets = (u32) atoi (argv[arg++]);
+	if (drop_percent > 90 || !n_packets) {
+		fprintf (stderr, "the drop must be between 0 & 90 and there must be some packets\n");
+		return 1;
+	}
+
+	n_reliable_sent = (n_packets + ECHO_RELIABLE_EVERY - 1) / ECHO_RELIABLE_EVERY;
+	reliable_seen = (u8 *) calloc (n_reliable_sent, sizeof (u8));
+
+	peer = echo_peer_create (wrap);
+	if (!peer || !reliable_seen) return 1;
+
+	pthread_t peer_thread;
+	pthread_create (&peer_thread, NULL, echo_peer, NULL);
+
+	int errors = 1;
+
+	Client *client = client_create ();
+	Connection *connection = client ?
+		client_connection_create (client, "127.0.0.1", ECHO_PORT, PROTOCOL_UDP, false) : NULL;
+	if (connection) {
+		client->app_packet_handler = echo_packet_handler;
+		if (batch) connection_set_send_batch (connection, 8 * UDP_MAX_DATAGRAM_SIZE, 2000);
+
+		if (wrap) {
+			connection->udp->local_sequence = 0xFFFF - 100;
+			connection->udp->next_reliable_id = 0xFFFF - 10;
+		}
+
+		if (!client_connect_and_start (client, connection)) {
+			u32 send_errors = 0;
+			for (u32 i = 0; i < n_packets; i++) {
+				if (echo_send (client, connection, i)) send_errors++;
+				usleep (1000);
+			}
+
+			if (batch) connection_flush (connection);
+
+			for (u32 waited = 0; waited < ECHO_WAIT_TIME
+				&& __atomic_load_n (&n_reliable_received, __ATOMIC_RELAXED) < n_reliable_sent; waited += 10)
+				usleep (10000);
+
+			// the last acks
+			usleep (200000);
+
+			connection_stats_update (connection);
+			ConnectionStats *stats = connection->stats;
+
+			u64 resolved = stats->n_udp_acked + stats->n_udp_lost;
+			float loss = resolved ? (float) stats->n_udp_lost * 100.0f / (float) resolved : 0.0f;
+
+			printf ("reliable: %u / %u, %u duplicates\n", n_reliable_received, n_reliable_sent, n_reliable_duplicates);
+			printf ("unreliable: %u / %u\n", n_unreliable_received, n_packets - n_reliable_sent);
+			printf ("datagrams: %lu acked, %lu lost, %lu retransmits\n",
+				stats->n_udp_acked, stats->n_udp_lost, stats->n_udp_retransmits);
+			printf ("loss: %.1f%% (smoothed %.1f%%), drop: %u%%, rtt: %.3f ms\n",
+				loss, stats->packet_loss, drop_percent, stats->rtt);
+
+			errors = 0;
+			if (send_errors) {
+				fprintf (stderr, "%u packets could not be sent!\n", send_errors);
+				errors = 1;
+			}
+
+			if (n_reliable_received != n_reliable_sent || n_reliable_duplicates) {
+				fprintf (stderr, "the reliable packets did not arrive exactly once!\n");
+				errors = 1;
+			}
+
+			if (n_unreliable_received > n_packets - n_reliable_sent) {
+				fprintf (stderr, "more unreliable packets arrived than the ones that were sent!\n");
+				errors = 1;
+			}
+
+			if (!stats->n_udp_acked || (loss < drop_percent - ECHO_LOSS_TOLERANCE)
+				|| (loss > drop_percent + ECHO_LOSS_TOLERANCE)) {
+				fprintf (stderr, "the measured loss does not match the drop!\n");
+				errors = 1;
+			}
+
+			if (stats->rtt <= 0.0f || stats->rtt > UDP_RESEND_MIN_TIME) {
+				fprintf (stderr, "the rtt is not what loopback should take!\n");
+				errors = 1;
+			}
+
+			packets_pool_stats_print ();
+
+			// its update thread has to be done with it before it is deleted
+			client_connection_end (client, connection);
+			while (__atomic_load_n (&connection->update_thread_id, __ATOMIC_ACQUIRE)) usleep (1000);
+		}
+
+		else fprintf (stderr, "Failed to connect to the echo peer!\n");
+	}
+
+	running = false;
+	pthread_join (peer_thread, NULL);
+
+	client_teardown (client);
+	connection_delete (peer);
+
+	free (reliable_seen);
+
+	printf ("%s\n", errors ? "FAILED" : "ok");
+
+	return errors;
+
+}
@@ -49,37 +49,81 @@ CENGINE_EXPORT void animation_set_speed (Animation *animation, u32 speed);
 
 CENGINE_EXPORT Animation *animation_get_by_name (DoubleList *animations, const char *name);
 
+#define ANIMATORS_INIT_CAPACITY             64
+
+// the update is split in cpu jobs when there are more animators than this
+#define ANIMATIONS_PARALLEL_THRESHOLD       4096
+#define ANIMATIONS_JOB_STATES               1024
+#define ANIMATIONS_MAX_JOBS                 32
+
 typedef struct Animator {
 
     // 03/02/2020 -- 9:57 -- unique animator id
     u32 id;
 
     u32 go_id;
-    bool start;
-    bool playing;
-    u8 currFrame;
+
+    // 18/10/2026 -- the animator state lives in the packed states array
+    u32 index;
+
     u8 n_animations;
     Animation **animations;
-    Animation *currAnimation;
-    Animation *defaultAnimation;
-    Timer *timer;
 
 } Animator;
 
+// the sprite that an animator displays after an animations update
+typedef struct AnimatorFrame {
+
+    u32 go_id;
+    u8 frame;
+    u32 col, row;
+
+} AnimatorFrame;
+
+// animators are updated from this packed array, in order
+// every state has two frames, the animations thread writes one of them
+// while the published one is read by the main thread
+typedef struct AnimatorState {
+
+    Animator *animator;
+
+    Animation *animation;
+    Animation *default_animation;
+    bool playing;
+    u64 start_ns;                   // when the current animation started
+
+    AnimatorFrame frames[2];
+
+    // the last frame that was applied to the game object graphics
+    bool applied;
+    u32 applied_col, applied_row;
+
+} AnimatorState;
+
 CENGINE_PUBLIC Animator *animator_new (u32 objectID);
 
 CENGINE_PUBLIC void animator_destroy (Animator *animator);
 
 CENGINE_EXPORT void animator_set_default_animation (Animator *animator, Animation *animation);
 
+// sets the animation that will be used, only if the animator is not playing one
 CENGINE_EXPORT void animator_set_current_animation (Animator *animator, Animation *animation);
 
+// plays the animation once from its first frame, then the default animation is used again
 CENGINE_EXPORT void animator_play_animation (Animator *animator, Animation *animation);
 
+// gets the frame published by the last animations update
+// returns 0 on success, 1 on error
+CENGINE_EXPORT u8 animator_get_frame (Animator *animator, AnimatorFrame *frame);
+
 /*** ANIM THREAD ***/
 
 CENGINE_PRIVATE int animations_init (void);
 
 CENGINE_PRIVATE u8 animations_end (void);
 
+// copies the last published frames into the graphics of the game objects that have an animator
+// it must be called from the main thread before rendering
+CENGINE_PRIVATE void animations_apply (void);
+
 #endif
\ No newline at end of file
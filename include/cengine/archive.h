@@ -0,0 +1,123 @@
+#ifndef _CENGINE_ARCHIVE_H_
+#define _CENGINE_ARCHIVE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <pthread.h>
+
+#include <SDL2/SDL.h>
+
+#include "cengine/types/types.h"
+#include "cengine/types/string.h"
+
+#include "cengine/collections/dlist.h"
+
+#include "cengine/config.h"
+
+#define ARCHIVE_MAGIC                   "CPAK"
+#define ARCHIVE_VERSION                 1
+#define ARCHIVE_ALIGNMENT               64          // every blob starts at a multiple of it
+#define ARCHIVE_HASH_SEED               0x43504b31ULL
+
+#define ARCHIVE_MAX_MOUNTED             8
+
+// the blob is lz4 compressed, it is decompressed once, the first time it is used
+#define ARCHIVE_ENTRY_LZ4               0x1
+
+// the archive is a header, the blobs, the names of the entries and the table of contents
+// numbers are stored in the byte order of the machine that packed it
+typedef struct ArchiveHeader {
+
+    char magic[4];
+    u32 version;
+    u32 n_entries;
+    u32 reserved;
+
+    u64 toc_offset;                 // ArchiveEntry array, sorted by hash & then by name
+    u64 names_offset;               // names of the entries, without a '\0' at the end
+    u64 names_size;
+    u64 file_size;
+
+} ArchiveHeader;
+
+typedef struct ArchiveEntry {
+
+    u64 hash;                       // hash of the normalized name
+    u64 offset;
+    u64 size;                       // stored size
+    u64 original_size;              // size after decompressing the blob
+
+    u32 name_offset;
+    u32 name_length;
+
+    u32 flags;
+    u32 reserved;
+
+} ArchiveEntry;
+
+// a packed archive mapped into memory, so reading one of its files is just
+// using a pointer, without any syscall
+typedef struct Archive {
+
+    String *filename;
+
+    void *map;
+    size_t map_size;
+
+    const ArchiveHeader *header;
+    const ArchiveEntry *entries;
+    const char *names;
+
+    void **decompressed;            // lz4 entries, by index
+
+    pthread_mutex_t *mutex;
+
+} Archive;
+
+// maps the archive and checks that its table of contents is valid
+// returns the archive on success, NULL on error
+CENGINE_PUBLIC Archive *archive_open (const char *filename);
+
+// unmaps the archive, every pointer or rwops of its files is no longer valid
+CENGINE_PUBLIC void archive_close (void *archive_ptr);
+
+// returns the entry of the file, the name is normalized like assets_path_normalize ()
+CENGINE_PUBLIC const ArchiveEntry *archive_find (const Archive *archive, const char *name);
+
+// returns a pointer to the contents of the file that is valid until the archive is closed
+// and sets size to its size, NULL if the file is not in the archive
+CENGINE_PUBLIC const void *archive_get_data (Archive *archive, const char *name, size_t *size);
+
+// returns a read only rwops of the file that does not copy it, it must be closed with SDL_RWclose ()
+// NULL if the file is not in the archive
+CENGINE_PUBLIC SDL_RWops *archive_open_rw (Archive *archive, const char *name);
+
+// packs the files (String list) into a new archive, each one is stored with its normalized path
+// compress stores with lz4 the blobs that get at least 1/8 smaller
+// returns 0 on success, 1 on error
+CENGINE_PUBLIC u8 archive_pack (const char *output, DoubleList *filenames, bool compress);
+
+/*** Mounted ***/
+
+// mounts the archive, so files_* & every asset loader look for their files in it
+// before going to the disk, archives mounted later are searched first
+// returns 0 on success, 1 on error
+CENGINE_PUBLIC u8 archive_mount (const char *filename);
+
+// unmounts the archive, nothing should be loading from it
+// returns 0 on success, 1 if it was not mounted
+CENGINE_PUBLIC u8 archive_unmount (const char *filename);
+
+// unmounts every archive, it is called by cengine_end ()
+CENGINE_PRIVATE void archive_unmount_all (void);
+
+// searches the file in the mounted archives
+// returns a pointer to its contents, NULL if it is not in any of them
+CENGINE_PUBLIC const void *archives_get_data (const char *name, size_t *size);
+
+// searches the file in the mounted archives
+// returns a read only rwops of the file, NULL if it is not in any of them
+CENGINE_PUBLIC SDL_RWops *archives_open_rw (const char *name);
+
+#endif
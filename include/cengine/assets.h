@@ -1,10 +1,17 @@
 #ifndef _CENGINE_ASSETS_H_
 #define _CENGINE_ASSETS_H_
 
+#include <stdbool.h>
+#include <stddef.h>
+
 #include "cengine/types/types.h"
 #include "cengine/types/string.h"
 
 #include "cengine/config.h"
+#include "cengine/renderer.h"
+#include "cengine/sprites.h"
+
+#define DEFAULT_ASSETS_CACHE_BUDGET         268435456           // 256 MB of decoded pixels
 
 CENGINE_EXPORT const String *cengine_assets_path;
 
@@ -21,4 +28,73 @@ CENGINE_PUBLIC u8 ui_default_assets_load (void);
 
 CENGINE_PRIVATE u8 assets_end (void);
 
+/*** Cache ***/
+
+typedef enum AssetType {
+
+    ASSET_TYPE_SPRITE               = 0,
+    ASSET_TYPE_SPRITE_SHEET         = 1,
+
+} AssetType;
+
+// a loaded asset shared by everyone that asks for the same file
+typedef struct AssetEntry {
+
+    String *key;                    // type, renderer & normalized path
+    AssetType type;
+
+    Renderer *renderer;
+    void *data;                     // Sprite or SpriteSheet
+
+    u32 refs;
+    bool loading;                   // the first one that asked for it is loading it
+    size_t bytes;                   // the pixels it keeps in memory, 0 for the ones inside an atlas
+
+    // the entries without references, from the least to the most recently used
+    struct AssetEntry *lru_prev, *lru_next;
+
+} AssetEntry;
+
+typedef struct AssetsCacheStats {
+
+    u64 hits;
+    u64 misses;
+    u64 evictions;
+
+    u32 n_entries;
+    u32 n_unreferenced;
+
+    size_t bytes_resident;
+    size_t bytes_unreferenced;      // the ones that can be evicted
+    size_t budget;
+
+} AssetsCacheStats;
+
+// sets how many bytes of decoded pixels the cache can keep, when it goes over them,
+// the least recently used entries without references are evicted
+// the referenced ones are never evicted, so the budget can still be exceeded
+CENGINE_EXPORT void assets_cache_set_budget (size_t bytes);
+
+// returns a normalized version of the path, without repeated separators, "." or ".." components,
+// that should be freed, NULL on error
+CENGINE_PUBLIC char *assets_path_normalize (const char *path);
+
+// returns the sprite of the file, loading it only if no one else has it loaded
+// the sprite is shared, so it must be released with assets_release () instead of destroyed
+CENGINE_PUBLIC Sprite *assets_get_sprite (const char *filename, Renderer *renderer);
+
+// returns the sprite sheet of the file, loading it only if no one else has it loaded
+// the sprite sheet is shared, so it must be released with assets_release () instead of destroyed
+CENGINE_PUBLIC SpriteSheet *assets_get_sprite_sheet (const char *filename, Renderer *renderer);
+
+// gives back a reference to an asset that was returned by the cache,
+// it is kept until the cache needs its space
+// returns 0 on success, 1 if the asset does not belong to the cache
+CENGINE_PUBLIC u8 assets_release (const void *asset);
+
+// evicts every entry without references
+CENGINE_EXPORT void assets_cache_clear (void);
+
+CENGINE_EXPORT AssetsCacheStats assets_cache_get_stats (void);
+
 #endif
\ No newline at end of file
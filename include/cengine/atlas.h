@@ -0,0 +1,118 @@
+#ifndef _CENGINE_ATLAS_H_
+#define _CENGINE_ATLAS_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include <SDL2/SDL.h>
+
+#include "cengine/types/types.h"
+#include "cengine/types/string.h"
+
+#include "cengine/collections/hashmap.h"
+
+#include "cengine/config.h"
+#include "cengine/renderer.h"
+
+#define ATLAS_DEFAULT_PAGE_SIZE         2048
+#define ATLAS_MAX_PAGES                 16
+#define ATLAS_PADDING                   2           // empty pixels around every region so filtering does not bleed
+#define ATLAS_INIT_REGIONS              64
+
+struct _Sprite;
+struct _SpriteSheet;
+
+// the top edge of the used space of a page, from x to x + w
+typedef struct AtlasSkylineNode {
+
+    u32 x, y, w;
+
+} AtlasSkylineNode;
+
+typedef struct AtlasPage {
+
+    SDL_Surface *surface;           // cpu copy where new regions are added
+    SDL_Texture *texture;           // created in the render thread the first time it is drawn
+
+    bool dirty;
+    SDL_Rect dirty_rect;            // what has to be uploaded to the texture
+
+    AtlasSkylineNode *skyline;
+    u32 n_nodes, nodes_size;
+
+} AtlasPage;
+
+// an image inside an atlas page
+typedef struct AtlasRegion {
+
+    String *name;
+
+    u8 page;
+    SDL_Rect rect;
+
+} AtlasRegion;
+
+// packs many images into a few big pages, so sprites that are drawn together
+// share the same texture and the batch can merge them in a single draw call
+struct _Atlas {
+
+    String *name;
+    u32 page_size;
+
+    AtlasPage pages[ATLAS_MAX_PAGES];
+    u8 n_pages;
+
+    HashMap *regions_map;           // region name -> region
+    AtlasRegion **regions;          // in the order they were added
+    u32 n_regions, regions_size;
+
+    pthread_mutex_t *mutex;
+
+};
+
+typedef struct _Atlas Atlas;
+
+// creates a new empty atlas, page_size = 0 uses ATLAS_DEFAULT_PAGE_SIZE
+CENGINE_PUBLIC Atlas *atlas_create (const char *name, u32 page_size);
+
+// the page textures are destroyed, so it must be called before destroying the renderer
+CENGINE_PUBLIC void atlas_delete (void *atlas_ptr);
+
+// copies the surface into the first page where it fits, using a skyline bottom left packer
+// the surface is NOT freed, the region can NOT be removed later
+// returns the region, or the one that already had the name, NULL on error
+CENGINE_PUBLIC const AtlasRegion *atlas_add_surface (Atlas *atlas, const char *name, SDL_Surface *surface);
+
+// loads the image and adds it to the atlas using its filename as the region name
+// returns the region, NULL on error
+CENGINE_PUBLIC const AtlasRegion *atlas_add_image (Atlas *atlas, const char *filename);
+
+// returns the region with the name, NULL if it is not in the atlas
+CENGINE_PUBLIC const AtlasRegion *atlas_get_region (Atlas *atlas, const char *name);
+
+// returns the texture of the page, uploading the regions that were added since the last call
+// it can only be called from the render thread
+CENGINE_PUBLIC SDL_Texture *atlas_get_page_texture (Atlas *atlas, Renderer *renderer, u8 page_idx);
+
+// returns a new sprite that draws the region of the image in the atlas,
+// the image is added to the atlas if it was not there already
+CENGINE_PUBLIC struct _Sprite *atlas_sprite_load (Atlas *atlas, const char *filename);
+
+// returns a new sprite sheet that draws its frames from the region of the image in the atlas,
+// the image is added to the atlas if it was not there already
+CENGINE_PUBLIC struct _SpriteSheet *atlas_sprite_sheet_load (Atlas *atlas, const char *filename);
+
+/*** Offline ***/
+
+// writes every page as <path>_<n>.png & a <path>.json index with the regions of each page,
+// so the atlas can be loaded at startup without packing the images again
+// returns 0 on success, 1 on error
+CENGINE_PUBLIC int atlas_bake (Atlas *atlas, const char *path);
+
+// loads an atlas written by atlas_bake () from its <path>.json index
+// images added later go to new pages, so the baked ones are never packed again
+// returns the atlas, NULL on error
+CENGINE_PUBLIC Atlas *atlas_load (const char *path);
+
+#endif
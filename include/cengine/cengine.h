@@ -2,12 +2,13 @@
 #define _CENGINE_H_
 
 #include <stdbool.h>
+#include <pthread.h>
+
+#include "cengine/types/types.h"
 
 #include "cengine/config.h"
 #include "cengine/renderer.h"
 
-#include "cengine/ui/textbox.h"
-
 #define EXIT_FAILURE    1
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -32,9 +33,79 @@ CENGINE_EXPORT unsigned int fps_limit;
 
 CENGINE_EXPORT unsigned int cengine_get_fps_limit (void);
 
-CENGINE_EXPORT void cengine_set_main_fps_text (TextBox *text);
+// sets how many times per second the state update runs, by default the same as the fps
+// the update always runs with a fixed delta, call it before cengine_start ()
+CENGINE_EXPORT void cengine_set_update_rate (unsigned int updates_per_second);
+
+// returns the fixed time in seconds that every state update advances
+CENGINE_EXPORT double cengine_get_update_delta (void);
+
+/*** frames ***/
+
+#define FRAME_HISTOGRAM_BUCKETS             1000
+#define FRAME_HISTOGRAM_BUCKET_NS           100000          // 0.1 ms, frames up to 100 ms
+
+#define FRAME_SPIN_NS                       1000000         // spin the last ms of a wait instead of sleeping
+#define FRAME_MAX_UPDATE_STEPS              5               // updates to catch up before dropping time
+
+typedef enum CengineLoop {
+
+    CENGINE_LOOP_MAIN       = 0,            // events & render
+    CENGINE_LOOP_UPDATE     = 1,            // state update
+
+} CengineLoop;
+
+// frame times measured during the last second
+typedef struct FrameStats {
+
+    u32 frames;
+    double avg_ms;
+    double p50_ms;
+    double p99_ms;
+    double max_ms;
+
+} FrameStats;
+
+// paces a loop to a fixed rate using the monotonic clock
+// and keeps a histogram of the time between frames
+typedef struct FrameScheduler {
+
+    u64 frame_ns;               // target time between frames
+    u64 next_frame_ns;          // deadline for the current frame
+    u64 last_frame_ns;          // when the last frame began
+
+    u32 histogram[FRAME_HISTOGRAM_BUCKETS + 1];     // the last bucket counts the slower frames
+    u32 n_frames;
+    u64 total_ns;
+    u64 max_ns;
+    u64 window_start_ns;
+
+    FrameStats stats;
+    pthread_mutex_t *mutex;
+
+} FrameScheduler;
+
+// returns the CLOCK_MONOTONIC time in nanoseconds
+CENGINE_PUBLIC u64 frame_clock_now (void);
+
+CENGINE_PUBLIC FrameScheduler *frame_scheduler_create (unsigned int fps);
+
+CENGINE_PUBLIC void frame_scheduler_delete (void *scheduler_ptr);
+
+// call it at the start of every frame
+// returns the nanoseconds since the previous frame began
+CENGINE_PUBLIC u64 frame_scheduler_begin (FrameScheduler *scheduler);
+
+// sleeps and then spins until the current frame deadline
+// if the deadline was missed by more than a frame, the schedule starts again from now
+CENGINE_PUBLIC void frame_scheduler_wait (FrameScheduler *scheduler);
+
+// gets the stats of the last complete second
+CENGINE_PUBLIC void frame_scheduler_get_stats (FrameScheduler *scheduler, FrameStats *stats);
 
-CENGINE_EXPORT void cengine_set_update_fps_text (TextBox *text);
+// gets the frame times of one of cengine's loops measured during the last second
+// returns 0 on success, 1 on error (cengine has not started)
+CENGINE_EXPORT int cengine_get_frame_stats (CengineLoop loop, FrameStats *stats);
 
 /*** other ***/
 
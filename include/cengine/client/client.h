@@ -19,7 +19,10 @@ struct _Client;
 struct _Connection;
 struct _Packet;
 struct _PacketsPerType;
+struct _Stats;
 
+// 18/10/2026 -- the counters are updated in the shards of counters by the connection threads,
+// the fields are only set from them by client_stats_update ()
 struct _ClientStats {
 
     time_t threshold_time;                  // every time we want to reset the client's stats
@@ -32,13 +35,20 @@ struct _ClientStats {
     u64 n_packets_received;                 // total number of packets received from this client (packet header + data)
     u64 n_packets_sent;                     // total number of packets sent to this client (all connections)
 
+    u64 n_receive_allocs;                   // allocations made to receive packets (buffers & retained packets)
+
     struct _PacketsPerType *received_packets;
     struct _PacketsPerType *sent_packets;
 
+    struct _Stats *counters;                // 18/10/2026 - with the packet size & handler latency histograms
+
 };
 
 typedef struct _ClientStats ClientStats;
 
+// sets the fields of the client stats from its counters
+CLIENT_PUBLIC void client_stats_update (struct _Client *client);
+
 CLIENT_PUBLIC void client_stats_print (struct _Client *client);
 
 struct _Client {
@@ -154,11 +164,15 @@ CLIENT_EXPORT unsigned int client_connect_async (Client *client, struct _Connect
 
 #pragma region requests
 
+// see cengine/client/requests.h to have many requests waiting for their responses at the same time
+
 // when a client is already connected to the cerver, a request can be made to the cerver
 // the result will be passed to the client's handlers
 // this is a blocking method, as it will wait until a complete cerver response has been received
 // the response will be handled using the client's packet handler
 // this method only works if your response consists only of one packet
+// 18/10/2026 -- the response is the packet with the request id, so other requests can be made at the same time,
+// it gives up after CLIENT_REQUEST_DEFAULT_TIMEOUT ms
 // neither client nor the connection will be stopped after the request has ended, the request packet won't be deleted
 // retruns 0 when the response has been handled, 1 on error
 CLIENT_EXPORT unsigned int client_request_to_cerver (Client *client, struct _Connection *connection, struct _Packet *request);
@@ -167,12 +181,22 @@ CLIENT_EXPORT unsigned int client_request_to_cerver (Client *client, struct _Con
 // the result will be passed to the client's handlers
 // this method will NOT block, instead EVENT_CONNECTION_DATA will be triggered
 // this method only works if your response consists only of one packet
+// 18/10/2026 -- if the connection has been started, its update thread or the reactor handle the response,
+// if not, a new thread waits for it, it gives up after CLIENT_REQUEST_DEFAULT_TIMEOUT ms
 // neither client nor the connection will be stopped after the request has ended, the request packet won't be deleted
 // returns 0 on success request, 1 on error
 CLIENT_EXPORT unsigned int client_request_to_cerver_async (Client *client, struct _Connection *connection, struct _Packet *request);
 
 #pragma endregion
 
+#pragma region send
+
+// sends the packets that are waiting in the send batch of every client connection
+// call it once per tick after the tick packets have been sent, see connection_set_send_batch ()
+CLIENT_EXPORT void client_flush (Client *client);
+
+#pragma endregion
+
 #pragma region start
 
 // after a client connection successfully connects to a server, 
@@ -207,6 +231,16 @@ CLIENT_EXPORT int client_disconnect (Client *client);
 // the client got disconnected from the cerver, so correctly clear our data
 CLIENT_EXPORT void client_got_disconnected (Client *client);
 
+// 18/10/2026 -- the connection was lost without being closed by the cerver, so it is closed & the event is triggered,
+// CLIENT_EVENT_DISCONNECTED if it timed out or CLIENT_EVENT_CONNECTION_CLOSE if the socket failed,
+// if reconnect is enabled, it is connected again by its update thread, or in a new thread if it has none
+CLIENT_PRIVATE void client_connection_lost (Client *client, struct _Connection *connection, bool timed_out);
+
+// 18/10/2026 -- connects again a lost connection, waiting a jittered exponential backoff between the attempts,
+// it stops if the client stops running or the connection is closed
+// returns 0 on success, 1 if it gave up
+CLIENT_PRIVATE u8 client_connection_reconnect (Client *client, struct _Connection *connection);
+
 #pragma endregion
 
 /*** Files ***/
@@ -19,12 +19,27 @@
 
 #define DEFAULT_CONNECTION_UPDATE_SLEEP             200000
 
+// 18/10/2026 -- connect & reconnect
+#define DEFAULT_CONNECTION_CONNECT_TIMEOUT          5000        // ms that each connect () attempt can take
+#define CONNECTION_BACKOFF_BASE                     500         // ms, the first wait between two attempts, it doubles after each one
+
+// 18/10/2026 -- keepalive
+#define CONNECTION_KEEPALIVE_CHECK_INTERVAL         50          // ms between the checks of the heartbeats & idle timeouts
+#define CONNECTION_RTT_SMOOTHING                    0.125f
+
 struct _Cerver;
 struct _Client;
+struct _Connection;
 struct _Packet;
 struct _PacketsPerType;
 struct _SockReceive;
+struct _UdpState;
+struct _ConnectionRequests;
+struct _FileTransfers;
+struct _Stats;
 
+// 18/10/2026 -- the counters are updated in the shards of counters,
+// the fields are only set from them by connection_stats_update (), except for the udp rtt & packet loss
 struct _ConnectionStats {
     
     time_t connection_threshold_time;       // every time we want to reset the connection's stats
@@ -33,14 +48,58 @@ struct _ConnectionStats {
     u64 total_bytes_sent;                   // total amount of bytes that have been sent to the connection
     u64 n_packets_received;                 // total number of packets received from this connection (packet header + data)
     u64 n_packets_sent;                     // total number of packets sent to this connection
+    u64 n_receive_allocs;                   // allocations made to receive packets (buffers & retained packets)
+
+    // 18/10/2026 -- udp connections, estimated from the acks of the sent datagrams
+    u64 n_udp_acked;                        // sent datagrams that the cerver acked
+    u64 n_udp_lost;                         // sent datagrams that were never acked
+    u64 n_udp_retransmits;                  // times a reliable packet had to be sent again
+    float rtt;                              // smoothed round trip time in ms
+    float packet_loss;                      // smoothed percentage of the sent datagrams that were lost
+
+    // 18/10/2026 -- packets with compressed data, and the size of their data before & after compressing it
+    u64 n_compressed_sent;
+    u64 bytes_uncompressed_sent;
+    u64 bytes_compressed_sent;
+    u64 n_compressed_received;
+    u64 bytes_uncompressed_received;
+    u64 bytes_compressed_received;
 
     struct _PacketsPerType *received_packets;
     struct _PacketsPerType *sent_packets;
 
+    struct _Stats *counters;
+
 };
 
 typedef struct _ConnectionStats ConnectionStats;
 
+// 18/10/2026 -- the connection goes from DISCONNECTED to CONNECTING with connection_start (),
+// & to RECONNECTING when it is lost with reconnect enabled, until it is CONNECTED again or it gives up
+typedef enum ConnectionState {
+
+    CONNECTION_STATE_DISCONNECTED       = 0,
+    CONNECTION_STATE_CONNECTING         = 1,
+    CONNECTION_STATE_CONNECTED          = 2,
+    CONNECTION_STATE_RECONNECTING       = 3,
+
+} ConnectionState;
+
+// application level ping, sent with CLIENT_HEARTBEAT by both sides,
+// the other side answers with the same values & reply set
+typedef struct SHeartbeat {
+
+    u32 sequence;
+    u8 reply;
+    u8 reserved[3];
+
+    u64 timestamp;                          // ms, in the clock of the side that sent the ping
+
+} SHeartbeat;
+
+// sets the fields of the connection stats from its counters
+CLIENT_PUBLIC void connection_stats_update (struct _Connection *connection);
+
 struct _Connection {
 
     String *name;
@@ -59,18 +118,39 @@ struct _Connection {
     u32 max_sleep;
     bool connected;                     // is the socket connected?
 
+    ConnectionState state;                  // 18/10/2026 - only changed by the connect, close & reconnect methods
+    u32 connect_timeout;                    // 18/10/2026 - ms that each connect () attempt can take
+    bool reconnect;                         // 18/10/2026 - connect again with backoff when the connection is lost
+    u32 reconnect_attempts;                 // 0 to keep trying while the client is running
+
+    u32 heartbeat_interval;                 // 18/10/2026 - ms between our heartbeats, 0 to not send them
+    u32 idle_timeout;                       // 18/10/2026 - ms without receiving anything before the connection is lost
+    u64 last_received;                      // CLOCK_MONOTONIC ms of the last bytes that were received
+    u64 last_heartbeat;                     // when our last heartbeat was sent
+    u32 heartbeat_sequence;
+
     // info about the cerver we are connected to
     struct _Cerver *cerver;
 
-    u32 receive_packet_buffer_size;         // 01/01/2020 - read packets into a buffer of this size in client_receive ()
-    struct _SockReceive *sock_receive;      // 01/01/2020 - used for inter-cerver communications
+    u32 receive_packet_buffer_size;         // 01/01/2020 - initial size of the receive buffer used in client_receive ()
+    struct _SockReceive *sock_receive;      // 18/10/2026 - persistent receive buffer, packets are handled in place
+
+    struct _UdpState *udp;                  // 18/10/2026 - sequences & acks of a PROTOCOL_UDP connection
+
+    u8 compression_codecs;                  // 18/10/2026 - codecs offered to the cerver after CERVER_INFO
+    u8 compression;                         // 18/10/2026 - codec chosen by the cerver, PACKET_CODEC_NONE until then
+    u32 compression_threshold;              // 18/10/2026 - packets with less data are not compressed
 
     pthread_t update_thread_id;
     u32 update_sleep;
+    bool started;                           // 18/10/2026 - its packets are received by an update thread or by the reactor
 
     // 10/06/2020 - used for direct requests to cerver
     bool full_packet;
 
+    struct _ConnectionRequests *requests;   // 18/10/2026 - requests that are waiting for their responses
+    struct _FileTransfers *transfers;       // 18/10/2026 - files that are being sent or received
+
     // 01/01/2020 - a place to safely store the request response, like when using client_connection_request_to_cerver ()
     void *received_data;                    
     size_t received_data_size;
@@ -109,9 +189,25 @@ CLIENT_PUBLIC int connection_comparator_by_sock_fd (const void *a, const void *b
 CLIENT_PUBLIC void connection_set_name (Connection *connection, const char *name);
 
 // sets the connection max sleep (wait time) to try to connect to the cerver
+// 18/10/2026 -- it is the biggest wait between two attempts, connection_start () gives up when the backoff gets to it
 CLIENT_PUBLIC void connection_set_max_sleep (Connection *connection, u32 max_sleep);
 
-// read packets into a buffer of this size in client_receive ()
+// 18/10/2026 -- sets how many ms each connect () attempt can take before it is considered failed
+// timeout = 0 uses DEFAULT_CONNECTION_CONNECT_TIMEOUT
+CLIENT_EXPORT void connection_set_connect_timeout (Connection *connection, u32 timeout);
+
+// 18/10/2026 -- when a started connection is lost, it is connected again with a jittered exponential backoff
+// that starts in CONNECTION_BACKOFF_BASE ms & waits up to max_sleep secs, max_attempts = 0 keeps trying
+// CLIENT_EVENT_CONNECTED is triggered when it succeeds, & CLIENT_EVENT_CONNECTION_FAILED if it gives up
+CLIENT_EXPORT void connection_set_reconnect (Connection *connection, bool reconnect, u32 max_attempts);
+
+// 18/10/2026 -- sends a heartbeat every heartbeat_interval ms to measure the rtt (stats->rtt),
+// & considers the connection lost if nothing has been received in idle_timeout ms, so
+// CLIENT_EVENT_DISCONNECTED is triggered (& it is reconnected, if enabled)
+// it only works in started connections, 0 disables any of them (default)
+CLIENT_EXPORT void connection_set_keepalive (Connection *connection, u32 heartbeat_interval, u32 idle_timeout);
+
+// initial size of the persistent buffer that client_receive () reads packets into, it grows to fit bigger packets
 // by default the value RECEIVE_PACKET_BUFFER_SIZE is used
 CLIENT_PUBLIC void connection_set_receive_buffer_size (Connection *connection, u32 size);
 
@@ -119,6 +215,27 @@ CLIENT_PUBLIC void connection_set_receive_buffer_size (Connection *connection, u
 // the dault value is 200000 (DEFAULT_CONNECTION_UPDATE_SLEEP)
 CLIENT_PUBLIC void connection_set_update_sleep (Connection *connection, u32 sleep);
 
+// 18/10/2026 -- coalesces the packets that are sent in the connection, so many small packets
+// go out with a single syscall, sendmsg () in tcp (like writev ()) & sendmmsg () in udp
+// the batch is sent when it has max_bytes, when its first packet has waited max_delay micro secs,
+// or with connection_flush (), with max_delay = 0 it only waits for one of the other two
+// bigger max values send less syscalls, smaller ones add less latency
+// max_bytes = 0 disables batching (default), it should be set before the connection is started
+CLIENT_EXPORT void connection_set_send_batch (Connection *connection, size_t max_bytes, u32 max_delay);
+
+// 18/10/2026 -- offers the codecs (PacketCodec bits) to the cerver after its CERVER_INFO packet,
+// once it chooses one, packets with at least threshold bytes of data are sent compressed with it
+// threshold = 0 uses PACKET_COMPRESSION_THRESHOLD, codecs = 0 disables compression (default)
+CLIENT_EXPORT void connection_set_compression (Connection *connection, u8 codecs, u32 threshold);
+
+// sends the codecs that the connection can use to the cerver, it answers with CERVER_COMPRESSION
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 connection_compression_request (struct _Client *client, Connection *connection);
+
+// sets how long recv () can block in the connection update thread, so it can also send the udp acks,
+// the expired send batches & end the requests that have timed out
+CLIENT_PRIVATE void connection_update_receive_timeout (Connection *connection);
+
 // sets the connection received data
 // 01/01/2020 - a place to safely store the request response, like when using client_connection_request_to_cerver ()
 CLIENT_PUBLIC void connection_set_received_data (Connection *connection, void *data, size_t data_size, Action data_delete);
@@ -149,9 +266,31 @@ CLIENT_PUBLIC u8 connection_generate_auth_packet (Connection *connection);
 CLIENT_PUBLIC Connection *connection_create (const char *ip_address, u16 port, Protocol protocol, bool use_ipv6);
 
 // starts a connection -> connects to the specified ip and port
+// 18/10/2026 -- each attempt can take connect_timeout ms, & they are made with a jittered exponential backoff
 // returns 0 on success, 1 on error
 CLIENT_PUBLIC int connection_start (Connection *connection);
 
+// returns how many ms to wait before the next attempt, after attempt (starting in 0) has failed
+CLIENT_PRIVATE u32 connection_backoff (Connection *connection, u32 attempt);
+
+// creates a new socket for a closed connection & makes a single attempt to connect it,
+// what was left from the previous one (cerver info, auth, compression, queued bytes) is discarded
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 connection_restart (Connection *connection);
+
+// returns the CLOCK_MONOTONIC time in ms
+CLIENT_PRIVATE u64 connection_time (void);
+
+// sends the heartbeat if it is time to do it
+// returns 1 if the connection has been idle for too much, so it should be considered lost, 0 if not
+CLIENT_PRIVATE u8 connection_keepalive (struct _Client *client, Connection *connection);
+
+// returns true if the connection sends heartbeats or has an idle timeout
+CLIENT_PRIVATE bool connection_keepalive_enabled (const Connection *connection);
+
+// handles a CLIENT_HEARTBEAT packet, answers the pings of the cerver & measures the rtt with its replies
+CLIENT_PRIVATE void connection_heartbeat_handler (struct _Packet *packet);
+
 typedef struct ConnectionCustomReceiveData {
 
     struct _Client *client;
@@ -163,7 +302,12 @@ typedef struct ConnectionCustomReceiveData {
 // starts listening and receiving data in the connection sock
 CLIENT_PUBLIC void connection_update (void *ptr);
 
-// closes a connection directly
+// sends every packet that is waiting in the connection send batch
+// returns 0 on success, 1 on error
+CLIENT_EXPORT u8 connection_flush (Connection *connection);
+
+// closes a connection directly, the packets in the send batch are sent before
+// and the requests that are waiting for a response end with CLIENT_REQUEST_FAILED, as the file transfers
 CLIENT_PUBLIC void connection_close (Connection *connection);
 
 #endif
\ No newline at end of file
@@ -29,6 +29,8 @@ typedef enum ClientErrorType {
 	CLIENT_ERROR_GAME_INIT               = 7, // the game failed to init properly
 	CLIENT_ERROR_GAME_START              = 8, // the game failed to start
 
+	CLIENT_ERROR_FILE_TRANSFER           = 9, // a file could not be sent or received
+
 } ClientErrorType;
 
 typedef struct ClientError {
@@ -38,6 +38,10 @@ typedef enum ClientEventType {
 
     CLIENT_EVENT_LOBBY_START,          // the game in the lobby has started
 
+    CLIENT_EVENT_FILE_PROGRESS,        // 18/10/2026 -- a file transfer has advanced, the response is the FileTransfer
+    CLIENT_EVENT_FILE_DONE,            // 18/10/2026 -- a file has been completely sent or received
+    CLIENT_EVENT_FILE_FAILED,          // 18/10/2026 -- a file transfer has failed or the connection has been closed
+
 } ClientEventType;
 
 typedef struct ClientEvent {
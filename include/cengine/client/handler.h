@@ -8,20 +8,23 @@
 
 #define RECEIVE_PACKET_BUFFER_SIZE          8192
 
+// the receive buffer grows to fit bigger packets up to this size
+#define RECEIVE_PACKET_MAX_SIZE             16777216
+
 struct _Client;
 struct _Connection;
 struct _Packet;
 
+// persistent receive buffer of a connection
+// recv () writes after the bytes that are already in it, and complete packets are handled in place,
+// only the bytes of a packet that did not fit before the end of the buffer are moved to its start
 struct _SockReceive {
 
-    struct _Packet *spare_packet;
-    size_t missing_packet;
+    char *buffer;
+    size_t buffer_size;
 
-    void *header;
-    char *header_end;
-    // unsigned int curr_header_pos;
-    unsigned int remaining_header;
-    bool complete_header;
+    size_t start;                   // first byte that has not been handled
+    size_t end;                     // end of the received bytes
 
 };
 
@@ -31,7 +34,13 @@ CLIENT_PRIVATE SockReceive *sock_receive_new (void);
 
 CLIENT_PRIVATE void sock_receive_delete (void *sock_receive_ptr);
 
-// receives incoming data from the socket
+// receives incoming data from the socket into the connection receive buffer
+// handlers get packets that point inside the buffer (the data may not be aligned), use packet_retain () to keep one
+// in udp connections it receives a single datagram and then sends the pending acks & retransmits
 CLIENT_PUBLIC void client_receive (struct _Client *client, struct _Connection *connection);
 
+// receives until recv () would block, used with non blocking edge triggered sockets
+// returns true if the connection is still connected
+CLIENT_PRIVATE bool client_receive_all (struct _Client *client, struct _Connection *connection);
+
 #endif
\ No newline at end of file
@@ -125,9 +125,11 @@ CLIENT_PUBLIC void packets_per_type_print (PacketsPerType *packets_per_type);
 struct _PacketHeader {
 
 	PacketType packet_type;
+	u32 request_id;			// 18/10/2026 -- sent back in the response to a request, 0 if the packet is not part of one
 	size_t packet_size;
 
 	u8 handler_id;
+	u8 flags;				// 18/10/2026 -- PACKET_FLAG_*, it uses what was padding
 	
 	u32 request_type;
 
@@ -150,6 +152,69 @@ CLIENT_PUBLIC u8 packet_header_copy (PacketHeader **dest, PacketHeader *source);
 
 #pragma endregion
 
+#pragma region compression
+
+// 18/10/2026 -- the data after the header is compressed with lz4 (block format), after its u32 original size
+#define PACKET_FLAG_LZ4                     0x01
+
+#define PACKET_FLAGS_COMPRESSED             (PACKET_FLAG_LZ4)
+
+// codecs that can be negotiated in a connection, they are the same bits as the header flags
+typedef enum PacketCodec {
+
+    PACKET_CODEC_NONE       = 0,
+    PACKET_CODEC_LZ4        = PACKET_FLAG_LZ4,
+
+} PacketCodec;
+
+// packets with less data than this are sent without compressing them
+#define PACKET_COMPRESSION_THRESHOLD        512
+
+// sent by the client with CLIENT_COMPRESSION after the cerver info with the codecs it can use,
+// and by the cerver with CERVER_COMPRESSION with the codec it has chosen (none if it does not support them)
+typedef struct SPacketCompression {
+
+    u8 codecs;
+    u8 reserved[3];
+
+    u32 threshold;
+
+} SPacketCompression;
+
+#pragma endregion
+
+#pragma region pool
+
+// packets and their data buffers are kept in free lists when they are deleted, so they can be used again
+// every thread has its own lists, that are refilled from (or emptied into) shared lists in batches
+#define PACKET_POOL_N_CLASSES               6
+#define PACKET_POOL_MIN_BUFFER_SIZE         64          // each buffer class is 4 times bigger than the previous one
+#define PACKET_POOL_N_LISTS                 (1 + PACKET_POOL_N_CLASSES)
+
+#define PACKET_POOL_THREAD_MAX              64          // max objects in each list of a thread
+#define PACKET_POOL_BATCH                   16
+#define PACKET_POOL_SHARED_MAX              1024        // max objects in each shared list
+
+// the first list counts Packet structs, the others the buffers of each size class
+typedef struct PacketPoolStats {
+
+    u64 hits[PACKET_POOL_N_LISTS];
+    u64 misses[PACKET_POOL_N_LISTS];
+
+    u64 n_oversized;                    // buffers bigger than the biggest class, always allocated
+
+} PacketPoolStats;
+
+// gets the pool counters of every thread that has used it
+CLIENT_EXPORT void packets_pool_stats (PacketPoolStats *stats);
+
+CLIENT_EXPORT void packets_pool_stats_print (void);
+
+// frees the objects that are in the shared lists and in the lists of the calling thread
+CLIENT_EXPORT void packets_pool_clear (void);
+
+#pragma endregion
+
 #pragma region packets
 
 typedef enum RequestType {
@@ -165,7 +230,9 @@ typedef enum CerverPacketType {
 	CERVER_TEARDOWN             = 1,
 
 	CERVER_INFO_STATS           = 2,
-	CERVER_GAME_STATS           = 3
+	CERVER_GAME_STATS           = 3,
+
+	CERVER_COMPRESSION          = 4,
 
 } CerverPacketType;
 
@@ -174,6 +241,17 @@ typedef enum ClientPacketType {
 	CLIENT_CLOSE_CONNECTION     = 1,
 	CLIENT_DISCONNET            = 2,
 
+	CLIENT_COMPRESSION          = 3,
+
+	// 18/10/2026 -- file transfers, see client/transfer.h
+	CLIENT_FILE_GET             = 4,
+	CLIENT_FILE_SEND            = 5,
+	CLIENT_FILE_HEADER          = 6,
+	CLIENT_FILE_CHUNK           = 7,
+	CLIENT_FILE_ACK             = 8,
+
+	CLIENT_HEARTBEAT            = 9,		// 18/10/2026 -- SHeartbeat, see connection_set_keepalive ()
+
 } ClientPacketType;
 
 typedef enum AuthPacketType {
@@ -223,7 +301,10 @@ struct _Packet {
 
     // the actual packet to be sent
     PacketHeader *header;
+    bool header_ref;
+    PacketHeader header_storage;        // 18/10/2026 -- used by the header of packets made by the client
     PacketVersion *version;
+    PacketVersion version_storage;
     size_t packet_size;
     void *packet;
     bool packet_ref;
@@ -232,12 +313,17 @@ struct _Packet {
 
 typedef struct _Packet Packet;
 
-// allocates a new empty packet
+// allocates a new empty packet, taking it from the pool if there is one
 CLIENT_PUBLIC Packet *packet_new (void);
 
-// correctly deletes a packet and all of its data
+// correctly deletes a packet and all of its data, the packet & its buffers go back to the pool
 CLIENT_PUBLIC void packet_delete (void *ptr);
 
+// received packets are views into the connection receive buffer that are only valid inside the handler
+// this creates a copy with its own header & data that can be kept after the handler returns
+// returns a newly allocated packet that should be deleted with packet_delete ()
+CLIENT_EXPORT Packet *packet_retain (const Packet *packet);
+
 // creates a new packet with the option to pass values directly
 // data is copied into packet buffer and can be safely freed
 CLIENT_EXPORT Packet *packet_create (PacketType type, void *data, size_t data_size);
@@ -315,6 +401,12 @@ CLIENT_EXPORT u8 packet_send_split (const Packet *packet, int flags, size_t *tot
 CLIENT_EXPORT u8 packet_send_to_split (const Packet *packet, size_t *total_sent,
     struct _Client *client, struct _Connection *connection);
 
+// sends a packet using its network values in the reliable channel
+// in udp connections the packet is sent again until the cerver acks it,
+// in tcp connections it works just as packet_send ()
+// returns 0 on success, 1 on error
+CLIENT_EXPORT u8 packet_send_reliable (const Packet *packet, int flags, size_t *total_sent);
+
 // sends a packet in pieces, taking the header from the packet's field
 // sends each buffer as they are with they respective sizes
 // socket mutex will be locked for the entire operation
@@ -332,6 +424,23 @@ CLIENT_EXPORT u8 packet_send_pieces (
 CLIENT_EXPORT u8 packet_send_to_socket (const Packet *packet, struct _Socket *socket, 
     int flags, size_t *total_sent, bool raw);
 
+// sends the packet with the request id in a copy of its header, in udp connections it uses the reliable channel
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 packet_send_request (const Packet *packet, u32 request_id, int flags, size_t *total_sent);
+
+// 18/10/2026 -- sends the packet followed by size bytes of the file from offset, that are sent with sendfile (),
+// so the packet size in the header that is sent counts them, only tcp connections can send files like this
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 packet_send_file (const Packet *packet, int file_fd, off_t offset, size_t size, size_t *total_sent);
+
+// replaces the compressed data of a received packet with the decompressed data in a pooled buffer
+// the header is updated to match it, and the packet is set to NULL as it has the compressed data
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 packet_decompress (Packet *packet);
+
+// releases the buffer that the data was decompressed into, a packet that was retained has its own copy
+CLIENT_PRIVATE void packet_decompress_end (Packet *packet);
+
 // check if packet has a compatible protocol id and a version
 // returns false on a bad packet
 CLIENT_PUBLIC bool packet_check (Packet *packet);
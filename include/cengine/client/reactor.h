@@ -0,0 +1,96 @@
+#ifndef _CLIENT_REACTOR_H_
+#define _CLIENT_REACTOR_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/client/config.h"
+#include "cengine/client/client.h"
+#include "cengine/client/connection.h"
+
+#define CLIENT_REACTOR_MAX_THREADS              8
+#define CLIENT_REACTOR_MAX_EVENTS               64
+
+// ms between the checks of the connections send batches
+#define CLIENT_REACTOR_BATCH_WAIT               1
+
+struct _Client;
+struct _Connection;
+
+struct _ClientReactorThread;
+
+// a connection that is owned by a reactor thread
+typedef struct ClientReactorEntry {
+
+    struct _Client *client;
+    struct _Connection *connection;
+
+    ConnectionCustomReceiveData *custom_data;
+
+    struct _ClientReactorThread *thread;
+
+    bool batched;                   // its send batch is sent by the thread when it waits too much
+    bool keepalive;                 // 18/10/2026 - the thread sends its heartbeats & checks its idle timeout
+
+    // removed entries are only freed by their thread before it waits again,
+    // so events that were already returned for them are safely skipped
+    bool removed;
+    struct ClientReactorEntry *prev, *next;
+
+} ClientReactorEntry;
+
+struct _ClientReactorThread {
+
+    pthread_t thread_id;
+
+    int epoll_fd;
+    int wake_fd;                    // used to stop the thread while it waits
+
+    u32 n_connections;
+    u32 n_batched;
+    u32 n_keepalive;
+    u64 requests_time;              // last time the requests that timed out were checked
+    u64 keepalive_time;             // 18/10/2026 - last time the connections heartbeats & timeouts were checked
+    ClientReactorEntry *entries;
+    ClientReactorEntry *removed;
+
+};
+
+typedef struct _ClientReactorThread ClientReactorThread;
+
+typedef struct ClientReactor {
+
+    ClientReactorThread threads[CLIENT_REACTOR_MAX_THREADS];
+    u32 n_threads;
+
+    bool running;
+
+} ClientReactor;
+
+// starts the reactor with n_threads epoll threads (1 if 0 is passed)
+// after this, client_connection_start () registers the connections in the reactor
+// instead of creating an update thread for each one of them
+// returns 0 on success, 1 on error
+CLIENT_EXPORT u8 client_reactor_init (unsigned int n_threads);
+
+// stops the reactor threads, the connections that are still registered are not closed
+CLIENT_EXPORT void client_reactor_end (void);
+
+// returns true if the reactor has been started
+CLIENT_EXPORT bool client_reactor_is_running (void);
+
+// wakes up every reactor thread, so they check again how much time they can wait for events
+CLIENT_PRIVATE void client_reactor_wake (void);
+
+// makes the connection socket non blocking and gives it to the reactor thread with less connections
+// received packets are handled with client_receive (), or with the connection custom receive method
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 client_reactor_register (struct _Client *client, struct _Connection *connection);
+
+// removes the connection from its reactor thread, it must be called before closing the socket
+CLIENT_PRIVATE void client_reactor_unregister (struct _Connection *connection);
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef _CLIENT_REQUESTS_H_
+#define _CLIENT_REQUESTS_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/client/config.h"
+
+#define CONNECTION_REQUESTS_BUCKETS             64
+
+// ms between the checks of the requests that have timed out,
+// it is also the max time the connection update waits in recv ()
+#define CLIENT_REQUEST_CHECK_INTERVAL           50
+
+// ms that client_request_to_cerver () & client_request_to_cerver_async () wait for a response
+#define CLIENT_REQUEST_DEFAULT_TIMEOUT          10000
+
+struct _Client;
+struct _Connection;
+struct _Packet;
+
+struct _ConnectionRequests;
+
+typedef enum ClientRequestStatus {
+
+    CLIENT_REQUEST_PENDING          = 0,
+    CLIENT_REQUEST_DONE             = 1,        // the response has been received
+    CLIENT_REQUEST_TIMEOUT          = 2,
+    CLIENT_REQUEST_FAILED           = 3,        // failed to send, bad response or the connection was closed
+    CLIENT_REQUEST_CANCELLED        = 4,
+
+} ClientRequestStatus;
+
+// a request that is waiting for its response
+// the request id is sent in the request packet header, and the cerver sends it back in the response header,
+// so many requests can be waiting at the same time in a connection and their responses can arrive in any order
+struct _ClientRequest {
+
+    u32 request_id;
+
+    struct _Client *client;
+    struct _Connection *connection;
+    struct _ConnectionRequests *requests;
+
+    ClientRequestStatus status;
+    u64 deadline;                           // micro secs, 0 if the request never times out
+
+    // the response is also handled by the client's packet handlers, like with client_request_to_cerver ()
+    bool handle;
+
+    // called by the thread that receives the response, or that finds that the request has ended,
+    // with a reference to this request, the response packet is only valid inside the callback
+    Action callback;
+    void *callback_args;
+
+    // the response, for requests with a callback it is only valid inside the callback,
+    // for the others it is a retained copy that is deleted with the request
+    struct _Packet *response;
+
+    u32 ref_count;                          // the table & the caller
+    pthread_mutex_t *mutex;
+    pthread_cond_t *done;
+
+    struct _ClientRequest *next;            // next request in its table bucket
+
+};
+
+typedef struct _ClientRequest ClientRequest;
+
+// the requests of a connection that are waiting for their responses
+struct _ConnectionRequests {
+
+    pthread_mutex_t *mutex;
+
+    u32 next_id;
+    u32 n_pending;
+    ClientRequest *buckets[CONNECTION_REQUESTS_BUCKETS];
+
+    // only one thread receives at a time when the requests are waited in a connection that has not been started
+    bool receiving;
+
+    // the cerver has sent back a request id, so responses are only matched by their ids,
+    // until then, like before request ids, the next packet that is not a CLIENT_PACKET
+    // is the response to the oldest pending request
+    bool peer_ids;
+
+};
+
+typedef struct _ConnectionRequests ConnectionRequests;
+
+CLIENT_PRIVATE ConnectionRequests *connection_requests_new (void);
+
+// the requests that are still pending end with CLIENT_REQUEST_FAILED
+CLIENT_PRIVATE void connection_requests_delete (void *requests_ptr);
+
+// sends the request with a new request id and returns a request to wait for its response
+// the response is passed to the callback if there is one, if not, it is kept in the request
+// timeout in ms, 0 to wait forever, if the response does not arrive in time the request ends with CLIENT_REQUEST_TIMEOUT
+// responses are received by the connection update thread or by the reactor if the connection has been started,
+// if not, they are received by the threads that call client_request_wait ()
+// the request packet won't be deleted
+// returns a new request that should be deleted with client_request_delete (), NULL on error
+CLIENT_EXPORT ClientRequest *client_request_send (struct _Client *client, struct _Connection *connection,
+    struct _Packet *request, u32 timeout, Action callback, void *callback_args);
+
+// works just as client_request_send (), handle sets if the response also goes to the client's packet handlers
+CLIENT_PRIVATE ClientRequest *client_request_send_internal (struct _Client *client, struct _Connection *connection,
+    struct _Packet *request, u32 timeout, bool handle, Action callback, void *callback_args);
+
+// waits until the request has ended
+// if the connection has not been started, the waiting threads take turns to receive its packets,
+// waiting for them at most until the request deadline
+
+// returns the request final status
+CLIENT_EXPORT ClientRequestStatus client_request_wait (ClientRequest *request);
+
+// returns the current status of the request without waiting
+CLIENT_EXPORT ClientRequestStatus client_request_get_status (ClientRequest *request);
+
+// returns the response of a request that was made without a callback,
+// it belongs to the request & is deleted with it, NULL if the request has not ended with a response
+CLIENT_EXPORT struct _Packet *client_request_get_response (ClientRequest *request);
+
+// ends a pending request with CLIENT_REQUEST_CANCELLED, its response will be handled as any other packet
+CLIENT_EXPORT void client_request_cancel (ClientRequest *request);
+
+// releases the caller's reference to the request, a pending request is not cancelled,
+// so it is safe to call it right after client_request_send () if the request has a callback
+CLIENT_EXPORT void client_request_delete (void *request_ptr);
+
+// takes the pending request that the response is for out of the connection table,
+// for cervers that do not send back request ids, it is the oldest pending request
+// returns NULL if the packet is not the response of a pending request
+CLIENT_PRIVATE ClientRequest *connection_requests_take (struct _Connection *connection, const struct _Packet *packet);
+
+// ends a request that has been taken out of its table, the response is kept or passed to the callback
+CLIENT_PRIVATE void client_request_end (ClientRequest *request, ClientRequestStatus status, const struct _Packet *response);
+
+// takes the requests that have timed out out of the connection table and adds them to the list
+// returns the new start of the list
+CLIENT_PRIVATE ClientRequest *connection_requests_take_expired (struct _Connection *connection, ClientRequest *expired);
+
+// ends every request in the list with CLIENT_REQUEST_TIMEOUT
+CLIENT_PRIVATE void client_requests_end_expired (ClientRequest *expired);
+
+// ends the requests of the connection that have timed out
+CLIENT_PRIVATE void connection_requests_expire (struct _Connection *connection);
+
+// ends every pending request of the connection with CLIENT_REQUEST_FAILED
+CLIENT_PRIVATE void connection_requests_fail (struct _Connection *connection);
+
+// returns the number of pending requests that can time out, in every connection
+CLIENT_PRIVATE u32 client_requests_timed (void);
+
+#endif
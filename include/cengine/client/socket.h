@@ -1,10 +1,23 @@
 #ifndef _CLIENT_SOCKET_H_
 #define _CLIENT_SOCKET_H_
 
+#include <stdlib.h>
+#include <stdbool.h>
+
 #include <pthread.h>
 
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "cengine/types/types.h"
+
 #include "cengine/client/config.h"
 
+#define SOCKET_QUEUE_INIT_SIZE          4096
+
+#define SOCKET_BATCH_MAX_IOV            64          // max pieces sent by each sendmsg ()
+#define SOCKET_BATCH_MAX_DATAGRAMS      64          // max datagrams sent by each sendmmsg ()
+
 struct _Socket {
 
     int sock_fd;
@@ -15,6 +28,32 @@ struct _Socket {
 	pthread_mutex_t *read_mutex;
 	pthread_mutex_t *write_mutex;
 
+	// 18/10/2026 -- set when a reactor owns the non blocking socket,
+	// bytes that can not be sent without blocking are queued and sent by the reactor
+	int reactor_fd;
+	void *reactor_entry;
+	u32 reactor_events;
+
+	char *queue;
+	size_t queue_size;
+	size_t queue_start;
+	size_t queue_end;
+
+	// 18/10/2026 -- packets that are coalesced to be sent with a single syscall
+	// the batch is sent when it gets to batch_max bytes or its first packet has waited batch_delay
+	bool batch_datagrams;				// keep the packets as separate datagrams (udp)
+	size_t batch_max;					// 0 when batching is disabled
+	u64 batch_delay;					// micro secs, 0 to wait for socket_batch_flush ()
+	u64 batch_time;						// when the first packet was added
+
+	char *batch;
+	size_t batch_size;
+	size_t batch_used;
+
+	size_t *batch_ends;					// the end of every datagram inside the batch
+	u32 batch_n_datagrams;
+	u32 batch_max_datagrams;
+
 };
 
 typedef struct _Socket Socket;
@@ -25,4 +64,52 @@ CLIENT_PRIVATE void *socket_create_empty (void);
 
 CLIENT_PRIVATE Socket *socket_create (int fd);
 
-#endif
\ No newline at end of file
+// sends all of the data, the write mutex must be locked by the caller
+// if the socket is owned by a reactor, what can not be sent right away is queued
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 socket_send (Socket *socket, const void *data, size_t data_size, int flags, size_t *actual_sent);
+
+// works like socket_send () but sends every piece with a single sendmsg () (like writev ())
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 socket_sendv (Socket *socket, const struct iovec *iov, u32 n_iov, int flags, size_t *actual_sent);
+
+// 18/10/2026 -- sends size bytes of the file from offset with sendfile (), so they are not copied to user space
+// the write mutex must be locked by the caller, and the packets in the batch must have been sent before
+// if the socket is owned by a reactor, what can not be sent right away is read from the file & queued
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 socket_sendfile (Socket *socket, int file_fd, off_t offset, size_t size, size_t *actual_sent);
+
+// enables batching with the max bytes & max delay (micro secs) of a batch, max_bytes = 0 disables it
+// datagrams keeps every added piece group as its own datagram
+CLIENT_PRIVATE void socket_batch_set (Socket *socket, size_t max_bytes, u64 max_delay, bool datagrams);
+
+// returns true if batching is enabled
+CLIENT_PRIVATE bool socket_batch_enabled (const Socket *socket);
+
+// copies the pieces at the end of the batch (as a single datagram if the socket uses them),
+// and sends the batch if it is full or has waited too much, the write mutex must be locked by the caller
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 socket_batch_add (Socket *socket, const struct iovec *iov, u32 n_iov, size_t *actual_sent);
+
+// sends everything in the batch, with sendmsg () or with sendmmsg () for datagrams
+// the write mutex must be locked by the caller
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 socket_batch_flush (Socket *socket);
+
+// sends the batch only if its first packet has waited the max delay
+// the write mutex must be locked by the caller
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 socket_batch_flush_expired (Socket *socket);
+
+// sends the queued bytes until send () would block, the write mutex must be locked by the caller
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 socket_flush (Socket *socket);
+
+// returns true if there are bytes waiting to be sent
+CLIENT_PRIVATE bool socket_has_queued (const Socket *socket);
+
+// 18/10/2026 -- drops the bytes that are queued or batched, they belong to a socket that has been closed
+// the write mutex must be locked by the caller
+CLIENT_PRIVATE void socket_reset (Socket *socket);
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef _CLIENT_STATS_H_
+#define _CLIENT_STATS_H_
+
+#include <stdbool.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/client/config.h"
+#include "cengine/client/packets.h"
+
+#define STATS_SHARDS                    8           // power of 2, the threads that update the stats are spread over them
+#define STATS_CACHE_LINE                64
+
+#define STATS_HISTOGRAM_BUCKETS         32          // bucket i counts the values in [2^(i - 1), 2^i), the last one the bigger ones
+
+struct _Client;
+struct _Connection;
+
+typedef enum StatsCounter {
+
+    STATS_RECEIVES_DONE                 = 0,        // n calls to recv ()
+    STATS_BYTES_RECEIVED,
+    STATS_BYTES_SENT,
+    STATS_PACKETS_RECEIVED,
+    STATS_PACKETS_SENT,
+    STATS_RECEIVE_ALLOCS,                           // allocations made to receive packets (buffers & retained packets)
+
+    STATS_UDP_ACKED,                                // sent datagrams that the cerver acked
+    STATS_UDP_LOST,                                 // sent datagrams that were never acked
+    STATS_UDP_RETRANSMITS,                          // times a reliable packet had to be sent again
+
+    STATS_COMPRESSED_SENT,
+    STATS_BYTES_UNCOMPRESSED_SENT,
+    STATS_BYTES_COMPRESSED_SENT,
+    STATS_COMPRESSED_RECEIVED,
+    STATS_BYTES_UNCOMPRESSED_RECEIVED,
+    STATS_BYTES_COMPRESSED_RECEIVED,
+
+    STATS_COUNTERS
+
+} StatsCounter;
+
+// the packet types that are counted, they match the PacketsPerType fields
+typedef enum StatsPacketType {
+
+    STATS_PACKET_CERVER                 = 0,
+    STATS_PACKET_CLIENT,
+    STATS_PACKET_ERROR,
+    STATS_PACKET_AUTH,
+    STATS_PACKET_REQUEST,
+    STATS_PACKET_GAME,
+    STATS_PACKET_APP,
+    STATS_PACKET_APP_ERROR,
+    STATS_PACKET_CUSTOM,
+    STATS_PACKET_TEST,
+    STATS_PACKET_UNKNOWN,
+    STATS_PACKET_BAD,
+
+    STATS_PACKET_TYPES
+
+} StatsPacketType;
+
+// the counters that a thread updates, each shard is in its own cache lines
+struct _StatsShard {
+
+    u64 counters[STATS_COUNTERS];
+    u64 received[STATS_PACKET_TYPES];
+    u64 sent[STATS_PACKET_TYPES];
+
+} __attribute__ ((aligned (STATS_CACHE_LINE)));
+
+typedef struct _StatsShard StatsShard;
+
+struct _StatsHistograms {
+
+    u64 sizes[STATS_PACKET_TYPES][STATS_HISTOGRAM_BUCKETS];         // bytes of the handled packets
+    u64 latency[STATS_PACKET_TYPES][STATS_HISTOGRAM_BUCKETS];       // nano secs that their handlers took
+
+} __attribute__ ((aligned (STATS_CACHE_LINE)));
+
+typedef struct _StatsHistograms StatsHistograms;
+
+// counters that many threads can update without locks & without sharing cache lines,
+// every thread adds to its own shard & the shards are added together when they are read
+struct _Stats {
+
+    StatsShard *shards;                     // STATS_SHARDS, allocated together
+    StatsHistograms *histograms;            // STATS_SHARDS, NULL if the stats do not keep them
+
+};
+
+typedef struct _Stats Stats;
+
+// histograms keeps the sizes & handler latency of the packets
+// returns new stats with every counter in 0, NULL on error
+CLIENT_PRIVATE Stats *stats_new (bool histograms);
+
+CLIENT_PRIVATE void stats_delete (void *stats_ptr);
+
+// returns the type in which the packet type is counted
+CLIENT_PRIVATE StatsPacketType stats_packet_type (PacketType packet_type);
+
+CLIENT_PRIVATE void stats_add (Stats *stats, StatsCounter counter, u64 value);
+
+// counts a received packet of the type
+CLIENT_PRIVATE void stats_received (Stats *stats, StatsPacketType type);
+
+// counts a sent packet of the type
+CLIENT_PRIVATE void stats_sent (Stats *stats, StatsPacketType type);
+
+// adds the size & how much time its handler took to the histograms of the type, if the stats keep them
+CLIENT_PRIVATE void stats_handled (Stats *stats, StatsPacketType type, size_t packet_size, u64 handler_ns);
+
+#pragma region snapshot
+
+// the counters of every shard added together
+typedef struct StatsSnapshot {
+
+    u64 counters[STATS_COUNTERS];
+    u64 received[STATS_PACKET_TYPES];
+    u64 sent[STATS_PACKET_TYPES];
+
+    bool has_histograms;
+    u64 sizes[STATS_PACKET_TYPES][STATS_HISTOGRAM_BUCKETS];
+    u64 latency[STATS_PACKET_TYPES][STATS_HISTOGRAM_BUCKETS];
+
+} StatsSnapshot;
+
+// adds the shards together, the counters that are updated while it is taken may or may not be included
+CLIENT_PUBLIC void stats_snapshot (const Stats *stats, StatsSnapshot *snapshot);
+
+// copies the received or sent packets of the snapshot
+CLIENT_PUBLIC void stats_snapshot_packets_per_type (const StatsSnapshot *snapshot, bool sent,
+    PacketsPerType *packets_per_type);
+
+// returns a newly allocated json object with the snapshot counters (and histograms) that should be freed
+CLIENT_PUBLIC char *stats_snapshot_json (const StatsSnapshot *snapshot);
+
+// takes a snapshot of the stats of the client
+CLIENT_EXPORT void client_stats_snapshot (struct _Client *client, StatsSnapshot *snapshot);
+
+// takes a snapshot of the stats of the connection
+CLIENT_EXPORT void connection_stats_snapshot (struct _Connection *connection, StatsSnapshot *snapshot);
+
+// returns a newly allocated json object with the stats of the client & of each of its connections,
+// for monitoring, it should be freed, NULL on error
+CLIENT_EXPORT char *client_stats_json (struct _Client *client);
+
+#pragma endregion
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef _CLIENT_TRANSFER_H_
+#define _CLIENT_TRANSFER_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/client/config.h"
+
+#define FILE_TRANSFER_CHUNK_SIZE            65536
+#define FILE_TRANSFER_MAX_CHUNK_SIZE        4194304
+#define FILE_TRANSFER_WINDOW                8           // chunks that can be sent before they are acked
+
+#define FILE_TRANSFER_NAME_LENGTH           256
+
+// every chunk carries the sha-256 of its bytes, a chunk that does not match is sent again
+#define FILE_TRANSFER_FLAG_CHECKSUMS        0x01
+
+struct _Client;
+struct _Connection;
+struct _Packet;
+
+typedef enum FileTransferType {
+
+    FILE_TRANSFER_GET           = 0,        // the cerver sends us the file
+    FILE_TRANSFER_SEND          = 1,        // we send the file to the cerver
+
+} FileTransferType;
+
+typedef enum FileTransferStatus {
+
+    FILE_TRANSFER_WAITING       = 0,        // waiting for the cerver to accept it
+    FILE_TRANSFER_ACTIVE        = 1,
+    FILE_TRANSFER_DONE          = 2,
+    FILE_TRANSFER_FAILED        = 3,
+
+} FileTransferStatus;
+
+// a file that is being sent or received in chunks of a connection
+struct _FileTransfer {
+
+    u32 transfer_id;
+
+    FileTransferType type;
+    FileTransferStatus status;
+
+    char filename[FILE_TRANSFER_NAME_LENGTH];   // the name of the file in the cerver
+    char *path;                                 // where the file is in our side
+    int fd;
+
+    u32 flags;
+    u32 chunk_size;
+    u32 window;
+
+    u64 file_size;
+    u64 start_offset;                           // where the transfer was resumed from
+    u64 offset;                                 // every byte before it has been received (or acked by the cerver)
+    u64 sent_offset;                            // the next byte that will be sent
+    bool sending;                               // a thread is sending its chunks, the others only move the window
+
+    bool resending;                             // a bad chunk has been asked again, the ones after it are dropped
+    char *chunk;                                // to compute the checksums of the chunks that are sent
+
+    struct _Client *client;
+    struct _Connection *connection;
+
+    u32 refs;                                   // the table & the packet handlers using it, deleted with the last one
+
+    struct _FileTransfer *next;
+
+};
+
+typedef struct _FileTransfer FileTransfer;
+
+// the file transfers of a connection
+struct _FileTransfers {
+
+    pthread_mutex_t *mutex;
+
+    u32 next_id;
+    FileTransfer *transfers;
+
+    u32 chunk_size;
+    u32 window;
+    u32 flags;
+
+};
+
+typedef struct _FileTransfers FileTransfers;
+
+CLIENT_PRIVATE FileTransfers *file_transfers_new (void);
+
+// the transfers that have not ended are closed without triggering any event
+CLIENT_PRIVATE void file_transfers_delete (void *transfers_ptr);
+
+// sets the chunk size & how many chunks can be sent before the cerver acks them in the transfers of the connection,
+// checksums adds the sha-256 of every chunk so the bad ones are sent again, it is only used in new transfers
+// chunk_size = 0 uses FILE_TRANSFER_CHUNK_SIZE, window = 0 uses FILE_TRANSFER_WINDOW
+CLIENT_EXPORT void connection_set_file_transfers (struct _Connection *connection,
+    u32 chunk_size, u32 window, bool checksums);
+
+// requests the file from the cerver, it is saved in path, and if path already has some of its bytes,
+// the transfer is resumed from there
+// returns 0 on success sending the request, 1 on error
+CLIENT_EXPORT u8 file_transfer_get (struct _Client *client, struct _Connection *connection,
+    const char *filename, const char *path);
+
+// sends the file in path to the cerver with filename, if the cerver already has some of its bytes,
+// it answers with where the transfer should be resumed from
+// returns 0 on success sending the request, 1 on error
+CLIENT_EXPORT u8 file_transfer_send (struct _Client *client, struct _Connection *connection,
+    const char *filename, const char *path);
+
+// handles the CLIENT_FILE_HEADER, CLIENT_FILE_CHUNK & CLIENT_FILE_ACK packets
+CLIENT_PRIVATE void file_transfer_packet_handler (struct _Packet *packet);
+
+// ends every transfer of the connection with FILE_TRANSFER_FAILED
+CLIENT_PRIVATE void connection_file_transfers_fail (struct _Connection *connection);
+
+#pragma region serialization
+
+// sent with CLIENT_FILE_GET & CLIENT_FILE_SEND to start a transfer,
+// the cerver answers a get with CLIENT_FILE_HEADER with the size of the file & the offset it starts from,
+// & a send with CLIENT_FILE_ACK with the offset it wants the file from
+typedef struct SFileHeader {
+
+    u32 transfer_id;
+    u32 flags;
+
+    u32 chunk_size;
+    u32 window;
+
+    u64 file_size;
+    u64 offset;
+
+    char filename[FILE_TRANSFER_NAME_LENGTH];
+
+} SFileHeader;
+
+// a CLIENT_FILE_CHUNK packet has this after its header, & then the bytes of the chunk
+typedef struct SFileChunk {
+
+    u32 transfer_id;
+    u32 size;
+
+    u64 offset;
+
+    u8 checksum[32];
+
+} SFileChunk;
+
+typedef enum FileAckStatus {
+
+    FILE_ACK_OK                 = 0,        // every byte before offset has been received
+    FILE_ACK_RESEND             = 1,        // the chunk at offset was bad, send again from there
+    FILE_ACK_FAILED             = 2,        // the transfer can not continue
+
+} FileAckStatus;
+
+// sent by the side that receives the chunks after every chunk,
+// & by the cerver as the answer to a CLIENT_FILE_SEND, or to a CLIENT_FILE_GET that it can not serve
+typedef struct SFileAck {
+
+    u32 transfer_id;
+    u32 status;
+
+    u64 offset;
+
+} SFileAck;
+
+#pragma endregion
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef _CLIENT_UDP_H_
+#define _CLIENT_UDP_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/client/config.h"
+
+// biggest datagram (udp header + packet) that is sent, small enough to not be fragmented
+#define UDP_MAX_DATAGRAM_SIZE           1200
+
+#define UDP_SEQUENCE_BUFFER_SIZE        256
+#define UDP_ACK_BITS                    32
+
+// max reliable packets that can be waiting for an ack at the same time
+#define UDP_RELIABLE_WINDOW             64
+#define UDP_RELIABLE_MAX_SENDS          10
+
+#define UDP_RESEND_MIN_TIME             100         // ms
+#define UDP_ACK_TIMEOUT                 20          // ms, max time a received datagram waits for its ack
+#define UDP_UPDATE_INTERVAL             10          // ms, max time the connection update waits in recv ()
+
+#define UDP_RTT_SMOOTHING               0.1f
+#define UDP_LOSS_SMOOTHING              0.1f
+
+#define UDP_SEQUENCE_NONE               0xFFFFFFFF
+
+#define UDP_FLAG_RELIABLE               0x01
+#define UDP_FLAG_ACK_ONLY               0x02        // only carries acks, it has no sequence or packet
+#define UDP_FLAG_HAS_ACK                0x04        // ack & ack_bits are valid
+
+struct _Connection;
+
+// sent before the packet in every datagram
+// ack is the newest sequence that has been received from the other end,
+// and the n bit of ack_bits is set if ack - 1 - n has been received too,
+// so every ack is repeated in the next 32 datagrams and a lost one does not matter
+typedef struct UdpHeader {
+
+    u16 sequence;
+    u16 ack;
+    u32 ack_bits;
+
+    u16 reliable_id;
+    u8 flags;
+    u8 reserved;
+
+} UdpHeader;
+
+typedef struct UdpSentPacket {
+
+    u32 sequence;                   // UDP_SEQUENCE_NONE if the slot is empty
+    u64 sent_time;
+
+    bool resolved;                  // it has been acked or counted as lost
+    bool reliable;
+    u16 reliable_id;
+
+} UdpSentPacket;
+
+// a copy of a reliable datagram that is sent again until it gets acked
+typedef struct UdpReliablePacket {
+
+    bool used;
+    u16 reliable_id;
+
+    u64 sent_time;
+    u32 n_sends;
+
+    size_t size;
+    char datagram[UDP_MAX_DATAGRAM_SIZE];
+
+} UdpReliablePacket;
+
+// sequencing state of a udp connection, it is protected by the socket's write mutex
+struct _UdpState {
+
+    u16 local_sequence;                                 // sequence of the next datagram
+    UdpSentPacket sent[UDP_SEQUENCE_BUFFER_SIZE];
+
+    bool has_remote;
+    u16 remote_sequence;                                // newest sequence received
+    u32 received[UDP_SEQUENCE_BUFFER_SIZE];
+
+    bool ack_pending;
+    u64 last_send_time;
+
+    u16 next_reliable_id;
+    UdpReliablePacket reliable[UDP_RELIABLE_WINDOW];
+    u32 reliable_received[UDP_SEQUENCE_BUFFER_SIZE];  // used to drop reliable packets that were sent again
+
+};
+
+typedef struct _UdpState UdpState;
+
+CLIENT_PRIVATE UdpState *udp_state_new (void);
+
+CLIENT_PRIVATE void udp_state_delete (void *udp_state_ptr);
+
+// sends the pieces as a single datagram after a new udp header
+// reliable datagrams are sent again until the other end acks them
+// returns 0 on success, 1 on error
+CLIENT_PRIVATE u8 udp_send (struct _Connection *connection,
+    const void **pieces, const size_t *sizes, u32 n_pieces,
+    bool reliable, int flags, size_t *total_sent);
+
+// handles the udp header of a received datagram and updates the connection stats with its acks
+// returns true if the packet after the header has to be handled,
+// false if it was a duplicate, too old or it only had acks
+CLIENT_PRIVATE bool udp_receive (struct _Connection *connection, const char *datagram, size_t datagram_size);
+
+// sends again the reliable datagrams that have not been acked in time,
+// sends the pending acks if nothing else has been sent to carry them, and the expired send batch
+// it is called by the connection update after every recv ()
+CLIENT_PRIVATE void udp_update (struct _Connection *connection);
+
+#endif
@@ -0,0 +1,123 @@
+#ifndef _COLLECTIONS_HASHMAP_H_
+#define _COLLECTIONS_HASHMAP_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HASHMAP_MIN_CAPACITY				8
+#define HASHMAP_INLINE_KEY_SIZE				16
+#define HASHMAP_DEFAULT_SEED				0x9e3779b97f4a7c15ULL
+
+// how many slots of the old table are moved on each insert or remove while resizing
+#define HASHMAP_MIGRATE_STEP				16
+
+// each slot of the table, keys up to HASHMAP_INLINE_KEY_SIZE bytes are stored in here
+// instead of in a separate allocation
+typedef struct HashMapEntry {
+
+	uint64_t hash;
+	uint32_t dist;					// distance from the ideal slot + 1, 0 if the slot is empty
+	uint32_t key_size;				// 0 in a used slot means the entry was moved or removed
+	union {
+		unsigned char bytes[HASHMAP_INLINE_KEY_SIZE];
+		void *ptr;
+	} key;
+	void *value;
+	size_t value_size;
+
+} HashMapEntry;
+
+typedef struct HashMapTable {
+
+	HashMapEntry *entries;
+	size_t capacity;				// always a power of 2
+	size_t mask;
+	size_t count;
+
+} HashMapTable;
+
+// open addressing hash map using robin hood probing with backward shift removal
+// when the table gets too full, a bigger one is allocated and the entries are moved
+// a few at a time on every insert and remove, lookups check both tables meanwhile
+// it is NOT thread safe, use Htab if you need a locked map
+typedef struct HashMap {
+
+	HashMapTable table;				// every new entry goes in here
+	HashMapTable old;				// the table being moved, empty if we are not resizing
+	size_t migrate_pos;
+
+	size_t count;
+	uint64_t seed;
+
+	size_t (*hash)(const void *key, size_t key_size, size_t table_size);
+
+	void *(*key_create)(const void *);
+	void (*key_delete)(void *);
+	int (*key_compare)(const void *one, const void *two);
+
+	void (*delete_value)(void *value);
+
+} HashMap;
+
+// hashes the key bytes, based on wyhash
+extern uint64_t hashmap_hash (const void *key, size_t key_size, uint64_t seed);
+
+// creates a new hash map with space for at least capacity elements before resizing
+// delete_value - custom method to delete your values, NULL for no delete when the map gets destroyed
+extern HashMap *hashmap_create (size_t capacity, void (*delete_value)(void *value));
+
+// destroys the map with all of its keys and values
+extern void hashmap_delete (void *map_ptr);
+
+// sets a custom method to hash the keys, it is called with SIZE_MAX as the table size
+// and its result is mixed again, so it does not need to be well distributed
+// must be set before inserting any elements
+extern void hashmap_set_hash (HashMap *map,
+	size_t (*hash)(const void *key, size_t key_size, size_t table_size));
+
+// sets a method to correctly create (allocate) a new key
+// keys created with this method are never stored inline
+// must be set before inserting any elements
+extern void hashmap_set_key_create (HashMap *map, void *(*key_create)(const void *));
+
+// sets a method to correctly delete (free) your previous allocated key
+// if not set, free will be used as default
+extern void hashmap_set_key_delete (HashMap *map, void (*key_delete)(void *));
+
+// sets a method to compare keys, it must return 0 if they are equal
+// keys with the same hash are the only ones compared
+// if not set, the keys bytes are compared
+extern void hashmap_set_key_comparator (HashMap *map,
+	int (*key_compare)(const void *one, const void *two));
+
+// returns the current number of elements inside the map
+extern size_t hashmap_size (const HashMap *map);
+
+// returns how many slots the current table has
+extern size_t hashmap_capacity (const HashMap *map);
+
+// returns true if there is a value associated with the key
+extern bool hashmap_contains_key (const HashMap *map, const void *key, size_t key_size);
+
+// inserts a new value associated with its key, the key is copied
+// returns 0 on success, 1 on error or if the key is already inside the map
+extern int hashmap_insert (HashMap *map,
+	const void *key, size_t key_size,
+	void *value, size_t value_size);
+
+// returns a ptr to the value associated with the key
+// returns NULL if no value was found
+extern void *hashmap_get (const HashMap *map, const void *key, size_t key_size);
+
+// removes the key from the map and returns its value, the value is NOT deleted
+// returns NULL if no value was found
+extern void *hashmap_remove (HashMap *map, const void *key, size_t key_size);
+
+// calls the method with every element inside the map, in no particular order
+// the map must not be modified inside the method
+extern void hashmap_foreach (const HashMap *map,
+	void (*method)(const void *key, size_t key_size, void *value, size_t value_size, void *args),
+	void *args);
+
+#endif
@@ -7,41 +7,15 @@
 
 #include <pthread.h>
 
-#define HTAB_DEFAULT_INIT_SIZE				32
-
-typedef struct HtabNode {
-
-	struct HtabNode *next;
-	void *key;
-	size_t key_size;
-	void *val;
-	size_t val_size;
-
-} HtabNode;
-
-typedef struct HtabBucket {
-
-	struct HtabNode *start;
-	size_t count;
+#include "cengine/collections/hashmap.h"
 
-} HtabBucket;
+#define HTAB_DEFAULT_INIT_SIZE				32
 
+// thread safe wrapper around a HashMap, kept for compatibility
+// every operation locks the htab mutex
 typedef struct Htab {
 
-	HtabBucket **table;
-
-	size_t size;
-	size_t count;
-
-	size_t (*hash)(const void *key, size_t key_size, size_t table_size);
-
-	// int (*compare)(const void *k1, size_t s1, const void *k2, size_t s2);
-	void *(*key_create)(const void *);
-	void (*key_delete)(void *);
-	int (*key_compare)(const void *one, const void *two);
-
-	// method to delete the data
-	void (*delete_data)(void *data);
+	HashMap *map;
 
 	pthread_mutex_t *mutex;
 
@@ -64,8 +38,9 @@ extern void htab_set_key_comparator (Htab *htab,
 	int (*key_compare)(const void *one, const void *two));
 
 // creates a new htab
-// size - how many buckets do you want - more buckets = less collisions
+// size - how many elements you expect, the htab grows by itself when it gets full
 // hash - custom method to hash the key for insertion, NULL for default
+// it is called with SIZE_MAX as the table size, so it should not reduce the value
 // delete_data - custom method to delete your data, NULL for no delete when htab gets destroyed
 extern Htab *htab_create (size_t size,
 	size_t (*hash)(const void *key, size_t key_size, size_t table_size),
@@ -103,9 +78,9 @@ extern void *htab_remove (Htab *ht, const void *key, size_t key_size);
 // destroys the htb and all of its data
 extern void htab_destroy (Htab *ht);
 
-// prints the htab - buckets - nodes
+// prints the htab elements
 // currently only works if both keys and values are int
 // used for debugging and testing
 extern void htab_print (Htab *htab);
 
-#endif
\ No newline at end of file
+#endif
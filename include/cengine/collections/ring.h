@@ -0,0 +1,76 @@
+#ifndef _COLLECTIONS_RING_H_
+#define _COLLECTIONS_RING_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#define RING_CACHE_LINE_SIZE            64
+
+typedef enum RingPolicy {
+
+	RING_POLICY_BLOCK				= 0,		// wait until the consumer makes space
+	RING_POLICY_DROP_OLDEST			= 1,		// destroy the oldest element to make space
+	RING_POLICY_GROW				= 2,		// keep the extra elements in a locked overflow buffer
+
+} RingPolicy;
+
+// bounded lock free ring buffer, safe for many producers and many consumers
+// elements are copied inside the ring, so pushing does not allocate memory
+// each slot holds a sequence number that tells if it is ready to be written or read
+typedef struct Ring {
+
+	size_t capacity;				// always a power of 2
+	size_t mask;
+	size_t element_size;
+	size_t slot_size;
+	unsigned char *slots;
+
+	RingPolicy policy;
+	// called with a pointer to the copy inside the ring when an element is dropped or deleted
+	void (*destroy)(void *element);
+
+	// the consumers and the producers positions live in different cache lines
+	char pad_head[RING_CACHE_LINE_SIZE];
+	size_t head;
+	char pad_tail[RING_CACHE_LINE_SIZE];
+	size_t tail;
+	char pad_end[RING_CACHE_LINE_SIZE];
+
+	// only used with RING_POLICY_GROW after the ring gets full,
+	// the elements in here are always newer than the ones in the ring
+	pthread_mutex_t *overflow_mutex;
+	unsigned char *overflow;
+	size_t overflow_capacity;
+	size_t overflow_start;
+	size_t overflow_count;
+
+} Ring;
+
+// creates a new ring with space for at least capacity elements of element_size bytes
+// destroy is used to free any resources referenced by an element, it can be NULL
+extern Ring *ring_create (size_t capacity, size_t element_size,
+	RingPolicy policy, void (*destroy)(void *element));
+
+// destroys the remaining elements and deletes the ring
+extern void ring_delete (void *ring_ptr);
+
+// returns how many elements can be stored without using the policy
+extern size_t ring_capacity (const Ring *ring);
+
+// returns how many elements are inside the ring, it may be old when used by many threads
+extern size_t ring_size (Ring *ring);
+
+extern bool ring_is_empty (Ring *ring);
+
+// copies the element into the ring, if the ring is full the policy is used
+// RING_POLICY_BLOCK must not be used if the consumer thread also pushes
+// returns 0 on success, 1 on error
+extern int ring_push (Ring *ring, const void *element);
+
+// copies the oldest element into element and removes it from the ring
+// returns 0 on success, 1 if the ring is empty
+extern int ring_pop (Ring *ring, void *element);
+
+#endif
@@ -6,6 +6,8 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#include <SDL2/SDL.h>
+
 #include "cengine/collections/dlist.h"
 
 #include "cengine/config.h"
@@ -29,7 +31,7 @@ CENGINE_PUBLIC DoubleList *file_get_lines (const char *filename);
 // opens a file and returns it as a FILE
 CENGINE_PUBLIC FILE *file_open_as_file (const char *filename, const char *modes, struct stat *filestatus);
 
-// opens and reads a file into a buffer
+// opens and reads a file into a buffer, from a mounted archive if it is in one
 // sets file size to the amount of bytes read
 CENGINE_PUBLIC char *file_read (const char *filename, int *file_size);
 
@@ -37,6 +39,11 @@ CENGINE_PUBLIC char *file_read (const char *filename, int *file_size);
 // returns fd on success, -1 on error
 CENGINE_PUBLIC int file_open_as_fd (const char *filename, struct stat *filestatus);
 
+// opens a read only rwops of the file, from a mounted archive if it is in one
+// returns NULL on error
+CENGINE_PUBLIC SDL_RWops *file_open_rw (const char *filename);
+
+// parses the json file, from a mounted archive if it is in one, without copying it
 CENGINE_PUBLIC json_value *file_json_parse (const char *filename);
 
 #endif
\ No newline at end of file
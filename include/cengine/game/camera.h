@@ -32,8 +32,8 @@ struct _Camera {
 
     u32 windowWidth, windowHeight;
 
-    // position
-    Transform transform;
+    // position, the camera is not a game object so it does not use a transform
+    Vector2D position;
     CamRect bounds;
 
     // motion
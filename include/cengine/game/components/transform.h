@@ -6,16 +6,23 @@
 
 #include "cengine/config.h"
 
+#include "cengine/game/ecs.h"
+
+// 18/10/2026 -- the position is stored in the game world transform columns,
+// so the transform is only a view of the game object entity, use the methods to move it
 typedef struct Transform {
 
     u32 go_id;
-    Vector2D position;
-    // Layer layer;
+    Entity entity;
 
 } Transform;
 
-CENGINE_PUBLIC Transform *transform_new (u32 objectID);
+// returns the position of the game object, (0, 0) if it does not have a transform
+CENGINE_PUBLIC Vector2D transform_get_position (const Transform *transform);
+
+CENGINE_PUBLIC void transform_set_position (Transform *transform, float x, float y);
 
-CENGINE_PUBLIC void transform_destroy (Transform *transform);
+// moves the game object by the offset
+CENGINE_PUBLIC void transform_translate (Transform *transform, float x, float y);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,205 @@
+#ifndef _CENGINE_GAME_ECS_H_
+#define _CENGINE_GAME_ECS_H_
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/config.h"
+
+#define ECS_MAX_COMPONENTS              63
+#define ECS_MAX_COLUMNS                 8
+#define ECS_MAX_QUERY_COMPONENTS        8
+
+#define ECS_INIT_CAPACITY               64
+#define ECS_ITER_BATCH                  256
+
+#define ECS_NULL_ENTITY                 0
+#define ECS_INVALID_COMPONENT           0xFFFFFFFF
+#define ECS_INVALID_ROW                 0xFFFFFFFF
+
+// an entity is the index of its slot in the world and the generation of that slot
+// the generation changes every time the slot is reused, so old ids stop being valid
+typedef u64 Entity;
+
+#define ecs_entity_index(entity)                ((u32) ((entity) & 0xFFFFFFFF))
+#define ecs_entity_generation(entity)           ((u32) ((entity) >> 32))
+#define ecs_entity_make(index, generation)      (((Entity) (generation) << 32) | (Entity) (index))
+
+typedef u32 EcsComponent;
+
+// packed storage for a component type, using a sparse set
+// every column is its own dense array, so a component can be a single struct column
+// or be split into many columns (SoA) that are walked separately
+// rows are moved when another entity removes the component, so never keep pointers to them
+typedef struct EcsPool {
+
+    u32 n_columns;
+    size_t column_sizes[ECS_MAX_COLUMNS];
+    u8 *columns[ECS_MAX_COLUMNS];
+
+    Entity *entities;               // the entity that owns each row
+    u32 count, capacity;
+
+    u32 *sparse;                    // entity index -> row, ECS_INVALID_ROW if it does not have it
+    u32 sparse_capacity;
+
+    // called with a ptr to the first column of the row before it gets removed
+    void (*destroy)(void *component);
+
+} EcsPool;
+
+struct _EcsWorld;
+
+// a batch of entities that have every component of a query
+// rows[i][j] is the row of the entities[j] inside the pool of the i component
+typedef struct EcsIter {
+
+    struct _EcsWorld *world;
+
+    EcsComponent components[ECS_MAX_QUERY_COMPONENTS];
+    u32 n_components;
+
+    u64 mask;                       // the bits of the query components
+
+    u32 count;
+    Entity entities[ECS_ITER_BATCH];
+    u32 rows[ECS_MAX_QUERY_COMPONENTS][ECS_ITER_BATCH];
+
+    void *args;
+
+} EcsIter;
+
+typedef struct EcsSystem {
+
+    EcsComponent components[ECS_MAX_QUERY_COMPONENTS];
+    u32 n_components;
+
+    void (*method)(EcsIter *it);
+    void *args;
+
+} EcsSystem;
+
+// a destroy or a remove that was made while a query was running
+// the component is ECS_INVALID_COMPONENT for destroys
+typedef struct EcsDeferred {
+
+    Entity entity;
+    EcsComponent component;
+
+} EcsDeferred;
+
+struct _EcsWorld {
+
+    // for each slot, its current generation and the components it has
+    // the last bit of the mask is set while the entity is alive
+    u32 *generations;
+    u64 *masks;
+    u32 n_slots, max_slots;
+
+    // destroyed slots ready to be used again
+    u32 *free_slots;
+    u32 n_free_slots;
+
+    u32 n_alive;
+
+    EcsPool *pools[ECS_MAX_COMPONENTS];
+    u32 n_pools;
+
+    EcsSystem *systems;
+    u32 n_systems, max_systems;
+
+    // while a query is running, destroys & removes only clear the mask bits
+    // and their rows are removed when the last query ends, so the rows being walked never move
+    u32 iterating;
+    EcsDeferred *deferred;
+    u32 n_deferred, max_deferred;
+
+};
+
+typedef struct _EcsWorld EcsWorld;
+
+CENGINE_PUBLIC EcsWorld *ecs_world_create (void);
+
+// destroys every entity with its components
+CENGINE_PUBLIC void ecs_world_delete (void *world_ptr);
+
+// returns how many entities are alive
+CENGINE_PUBLIC u32 ecs_world_entity_count (const EcsWorld *world);
+
+/*** entities ***/
+
+// creates a new entity, reusing a destroyed slot if there is one
+// returns ECS_NULL_ENTITY on error
+CENGINE_PUBLIC Entity ecs_entity_create (EcsWorld *world);
+
+// removes all of the entity components and frees its slot
+CENGINE_PUBLIC void ecs_entity_destroy (EcsWorld *world, Entity entity);
+
+// returns true if the entity has not been destroyed
+CENGINE_PUBLIC bool ecs_entity_is_alive (const EcsWorld *world, Entity entity);
+
+/*** components ***/
+
+// registers a new component type made of n_columns columns with the specified sizes
+// destroy is called when the component is removed, it can be NULL
+// returns the new component, ECS_INVALID_COMPONENT on error
+CENGINE_PUBLIC EcsComponent ecs_component_register (EcsWorld *world,
+    const size_t *column_sizes, u32 n_columns, void (*destroy)(void *component));
+
+// adds the component to the entity with all of its columns set to 0
+// returns 0 on success, 1 on error or if the entity already has it
+CENGINE_PUBLIC u8 ecs_add (EcsWorld *world, Entity entity, EcsComponent component);
+
+// removes the component from the entity, the last row is moved to fill its place
+CENGINE_PUBLIC void ecs_remove (EcsWorld *world, Entity entity, EcsComponent component);
+
+CENGINE_PUBLIC bool ecs_has (const EcsWorld *world, Entity entity, EcsComponent component);
+
+// returns a ptr to the entity value inside the component column, NULL if it does not have it
+// it is only valid until the next add or remove of the same component
+CENGINE_PUBLIC void *ecs_get (const EcsWorld *world, Entity entity, EcsComponent component, u32 column);
+
+// returns how many entities have the component
+CENGINE_PUBLIC u32 ecs_component_count (const EcsWorld *world, EcsComponent component);
+
+// returns the dense array of a component column, it has ecs_component_count () values
+CENGINE_PUBLIC void *ecs_column (const EcsWorld *world, EcsComponent component, u32 column);
+
+// returns the entities that own each row of the component
+CENGINE_PUBLIC const Entity *ecs_component_entities (const EcsWorld *world, EcsComponent component);
+
+/*** queries ***/
+
+// returns the dense array of the column of the i component of the query
+// it has to be read again after adding a component inside the method, as the column can grow
+#define ecs_iter_column(it, i, column) \
+    ((void *) (it)->world->pools[(it)->components[(i)]]->columns[(column)])
+
+// false if the j entity of the batch was destroyed or lost one of the components inside the method
+#define ecs_iter_valid(it, j) \
+    (((it)->world->masks[ecs_entity_index ((it)->entities[(j)])] & (it)->mask) == (it)->mask)
+
+// calls the method with batches of the entities that have all of the components
+// the pool with less entities is walked in order and the others are checked with a mask,
+// so the cost depends on the smallest component and not on the total entities
+// entities can be destroyed & components removed inside the method, they are applied when the query ends,
+// so methods that do it have to skip the entities that are no longer valid with ecs_iter_valid ()
+CENGINE_PUBLIC void ecs_query_each (EcsWorld *world,
+    const EcsComponent *components, u32 n_components,
+    void (*method)(EcsIter *it), void *args);
+
+/*** systems ***/
+
+// registers a method that will be called with the entities that have all of the components
+// every time the systems run
+// returns 0 on success, 1 on error
+CENGINE_PUBLIC u8 ecs_system_register (EcsWorld *world,
+    const EcsComponent *components, u32 n_components,
+    void (*method)(EcsIter *it), void *args);
+
+// runs every registered system in the order they were registered
+CENGINE_PUBLIC void ecs_world_run_systems (EcsWorld *world);
+
+#endif
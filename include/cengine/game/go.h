@@ -9,6 +9,7 @@
 #include "cengine/config.h"
 #include "cengine/renderer.h"
 
+#include "cengine/game/ecs.h"
 #include "cengine/game/components/graphics.h"
 #include "cengine/game/components/transform.h"
 
@@ -19,6 +20,7 @@
 typedef struct GameObject {
     
     i32 id;
+    Entity entity;
 
     String *name;
     String *tag;
@@ -30,7 +32,8 @@ typedef struct GameObject {
 
     DoubleList *children;
 
-    void (*update)(void *data);
+    // 18/10/2026 -- the TRANSFORM_COMP of the game object, a view of its entity transform columns
+    Transform transform;
 
 } GameObject;
 
@@ -39,6 +42,26 @@ extern u32 max_gos;
 extern u32 curr_max_objs;
 extern u32 new_go_id;
 
+// every game object has an entity in this world, systems registered in it
+// run every time the game objects are updated
+extern EcsWorld *game_world;
+
+// built in component with the position stored as two float columns,
+// so systems can walk the x and y values of every entity separately
+extern EcsComponent game_transform_comp;
+
+// built in components with a single column with the Graphics * / Animator * of the game object,
+// they are deleted when the component is removed from the entity
+extern EcsComponent game_graphics_comp;
+extern EcsComponent game_animator_comp;
+
+typedef enum GameTransformColumn {
+
+    GAME_TRANSFORM_X        = 0,
+    GAME_TRANSFORM_Y        = 1
+
+} GameTransformColumn;
+
 // init our game objects array
 CENGINE_PRIVATE u8 game_objects_init_all (void);
 
@@ -69,7 +92,8 @@ CENGINE_PUBLIC GameObject *game_object_get_by_id (u32 id);
 // clean up game objects
 CENGINE_PRIVATE void game_object_destroy_all (void);
 
-// update every game object
+// updates the game objects by running the game world systems,
+// the user components updates are systems of the components that they belong to
 CENGINE_PUBLIC void game_object_update_all (void);
 
 // sets a new name for the GameObject
@@ -136,6 +160,10 @@ typedef struct UserComponent {
     void (*remove)(void *);
     void (*update)(void *);
 
+    // 18/10/2026 -- the game world component with the game objects that have it,
+    // update is called with each one of them every time the systems run
+    EcsComponent ecs_component;
+
 } UserComponent;
 
 // creates a new user component
@@ -146,6 +174,7 @@ CENGINE_EXPORT UserComponent *user_component_new (const char *name,
 CENGINE_EXPORT void user_component_delete (void *ptr);
 
 // registers a new user component, returns 0 on success, 1 on error
+// it fails if the game objects have not been initialized yet
 CENGINE_EXPORT int user_component_register (UserComponent *user_comp);
 
 // returns the component inside the user component for quick access
@@ -0,0 +1,67 @@
+#ifndef _CENGINE_LOADER_H_
+#define _CENGINE_LOADER_H_
+
+#include <stdbool.h>
+
+#include <SDL2/SDL.h>
+
+#include "cengine/types/types.h"
+#include "cengine/types/string.h"
+
+#include "cengine/config.h"
+#include "cengine/graphics.h"
+#include "cengine/renderer.h"
+
+// handle to follow or cancel a load, 0 is never used
+typedef u32 AssetLoadHandle;
+
+typedef enum AssetLoadPriority {
+
+    ASSET_LOAD_PRIORITY_LOW         = 0,        // things that are not visible yet, like the next level
+    ASSET_LOAD_PRIORITY_NORMAL      = 1,
+    ASSET_LOAD_PRIORITY_HIGH        = 2,        // things that are on the screen right now
+
+    ASSET_LOAD_PRIORITIES
+
+} AssetLoadPriority;
+
+typedef enum AssetLoadStatus {
+
+    ASSET_LOAD_NONE                 = 0,        // unknown handle, or the load has already ended
+    ASSET_LOAD_PENDING              = 1,        // waiting for an io worker
+    ASSET_LOAD_DECODING             = 2,        // being read & decoded in an io worker
+    ASSET_LOAD_UPLOADING            = 3,        // decoded, waiting for the render thread to create its texture
+
+} AssetLoadStatus;
+
+// called in the render thread when the load ends, the texture & the image data belong to the callback
+// texture & img_data are NULL if the image could not be loaded
+// it is never called for a load that was cancelled
+typedef void (*AssetLoadCallback)(AssetLoadHandle handle, SDL_Texture *texture, ImageData *img_data, void *args);
+
+// the file is read & decoded in an io worker, and then the render thread creates the texture
+// loads with a higher priority are decoded & uploaded first
+// returns a handle to follow or cancel the load, 0 on error
+CENGINE_PUBLIC AssetLoadHandle asset_load_texture (Renderer *renderer, const char *filename,
+    AssetLoadPriority priority, AssetLoadCallback callback, void *args);
+
+// returns the status of the load
+CENGINE_PUBLIC AssetLoadStatus asset_load_status (AssetLoadHandle handle);
+
+// cancels a load that is no longer needed, its callback will never be called
+// returns 0 on success, 1 if the load had already ended
+CENGINE_PUBLIC u8 asset_load_cancel (AssetLoadHandle handle);
+
+// cancels every load of the renderer
+CENGINE_PRIVATE void asset_load_cancel_all (Renderer *renderer);
+
+// creates the textures of the decoded images of the renderer until the deadline (frame_clock_now () ns),
+// at least one texture is created even if the deadline has already passed
+// it is called by the renderer every frame in the render thread
+// returns how many loads ended
+CENGINE_PRIVATE u32 asset_loader_upload (Renderer *renderer, u64 deadline);
+
+// frees every load that has not ended, call it after the jobs system has ended
+CENGINE_PRIVATE void asset_loader_end (void);
+
+#endif
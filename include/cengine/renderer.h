@@ -12,7 +12,7 @@
 #include "cengine/types/string.h"
 
 #include "cengine/collections/dlist.h"
-#include "cengine/collections/queue.h"
+#include "cengine/collections/ring.h"
 
 #include "cengine/threads/thread.h"
 
@@ -24,14 +24,38 @@
 #include "cengine/ui/ui.h"
 
 #define DEFAULT_BG_LOADING_FACTOR                   1
+#define DEFAULT_BG_LOADING_BUDGET                   2000            // micro secs per frame to create textures
 #define DEFAULT_BG_DESTROYING_FACTOR                1
 
+#define DEFAULT_TEXTURES_QUEUE_CAPACITY             256
+#define DEFAULT_TEXTURES_QUEUE_POLICY               RING_POLICY_GROW
+
+#define DEFAULT_RENDER_BATCH_SIZE                   256
+#define DEFAULT_RENDER_BATCH_LOOKBACK               64
+
 struct _Window;
 struct _UI;
 
 struct _TextureWrapper;
 
+struct _RenderBatch;
+
+struct _Atlas;
+
+// stats about the last rendered frame
+typedef struct RenderFrameStats {
+
+    u32 n_layers;
+    u32 n_cached_layers;
+    u32 n_redrawn_layers;           // cached layers that had something to redraw
+
+    u64 total_pixels;               // window pixels for every layer
+    u64 redrawn_pixels;             // pixels that were actually drawn again
+
+} RenderFrameStats;
+
 // auxiliary structure to map the source surface to a texture
+// it is copied inside the renderer's load queue
 typedef struct SurfaceTexture {
 
     SDL_Surface *surface;
@@ -40,9 +64,8 @@ typedef struct SurfaceTexture {
 
 } SurfaceTexture;
 
-CENGINE_PRIVATE SurfaceTexture *surface_texture_new (SDL_Surface *surface, SDL_Texture **texture, bool update);
-
-CENGINE_PRIVATE void surface_texture_delete (void *st_ptr);
+// frees the surface of a surface texture that will not be loaded
+CENGINE_PRIVATE void surface_texture_clear (void *st_ptr);
 
 /*** Renderer ***/
 
@@ -56,11 +79,26 @@ struct _Renderer {
     SDL_Renderer *renderer;
     Uint32 render_flags;
     u32 render_count;
+    u32 render_batch_count;             // draw calls submitted by the batch in the last frame
+
+    struct _RenderBatch *batch;
+
+    // the clip rect used while redrawing a cached layer, in target coordinates
+    SDL_Rect clip_rect;
+    bool clip;
 
-    Queue *load_textures_queue;
+    RenderFrameStats frame_stats;
+
+    // how far the current frame is between the last two state updates [0, 1]
+    // use it to interpolate the positions of moving objects
+    double alpha;
+
+    // 18/10/2026 -- lock free rings that other threads push into and the render thread consumes
+    Ring *load_textures_queue;
     u32 bg_loading_factor;
+    u32 bg_loading_budget;
 
-    Queue *destroy_textures_queue;
+    Ring *destroy_textures_queue;
     u32 bg_destroying_factor;
 
     SDL_Rect current_viewport;
@@ -70,6 +108,9 @@ struct _Renderer {
 
     struct _UI *ui;
 
+    // 18/10/2026 -- the images loaded as sprites are packed here, so they share a few textures
+    struct _Atlas *atlas;
+
     Action update;
     void *update_args;
 
@@ -98,18 +139,42 @@ CENGINE_PUBLIC Renderer *renderer_create_with_window (const char *name, int disp
 CENGINE_PUBLIC int renderer_window_attach (Renderer *renderer, Uint32 render_flags, int display_idx,
     const char *window_title, WindowSize window_size, Uint32 window_flags);
 
-CENGINE_PRIVATE void renderer_load_queue_push (Renderer *renderer, SurfaceTexture *st);
+// sends a surface to be loaded into the texture by the render thread
+// if update is true, the texture gets updated instead of created
+// the surface is freed by the renderer
+CENGINE_PRIVATE void renderer_load_queue_push (Renderer *renderer, 
+    SDL_Surface *surface, SDL_Texture **texture, bool update);
 
 CENGINE_PRIVATE void renderer_destroy_queue_push (Renderer *renderer, SDL_Texture *texture);
 
+// sets the capacity and what to do when the textures load queue gets full,
+// call it right after creating the renderer, before other threads can load textures
+// returns 0 on success, 1 on error or if the queue already has more textures than the capacity
+CENGINE_EXPORT int renderer_set_load_queue (Renderer *renderer, size_t capacity, RingPolicy policy);
+
+// sets the capacity and what to do when the textures destroy queue gets full,
+// textures can only be destroyed in the render thread, so RING_POLICY_DROP_OLDEST is not allowed
+// call it right after creating the renderer, before other threads can destroy textures
+// returns 0 on success, 1 on error or if the queue already has more textures than the capacity
+CENGINE_EXPORT int renderer_set_destroy_queue (Renderer *renderer, size_t capacity, RingPolicy policy);
+
 // sets how many textures the renderer can create in the background every loop
 // example: if you have a frame rate of 30, the default loading factor is 1,
 // so you will load 30 textures in a second, 1 for each frame
 CENGINE_EXPORT void renderer_set_background_texture_loading_factor (Renderer *renderer, u32 bg_loading_factor);
 
+// sets the micro secs the renderer can spend every loop creating the textures that were loaded in the background,
+// after the ones of the loading factor, it keeps creating textures until the budget is used
+CENGINE_EXPORT void renderer_set_background_texture_loading_budget (Renderer *renderer, u32 bg_loading_budget);
+
 // sets how many textures the renderer can destroy in the background every loop
 CENGINE_EXPORT void renderer_set_background_texture_destroying_factor (Renderer *renderer, u32 bg_destroying_factor);
 
+// sets the atlas where sprite_load () and sprite_sheet_load () pack their images,
+// the renderer takes ownership of it and deletes it before destroying its SDL renderer
+// returns the previous atlas, that now belongs to the caller as its sprites may still be in use
+CENGINE_EXPORT struct _Atlas *renderer_set_atlas (Renderer *renderer, struct _Atlas *atlas);
+
 // sets an action to executed on every renderer update
 // you can use this if you want to perform action son ui elements, like checking for 
 // the current ui element under the mouse using the ui_element_hover in UI
@@ -124,14 +189,37 @@ CENGINE_EXPORT void renderer_set_viewport_to_previous_size (Renderer *renderer);
 // sets the renderer's viewport to be the size of the window
 CENGINE_EXPORT void renderer_set_viewport_to_window_size (Renderer *renderer);
 
+// sets a clip rect in target coordinates that is kept across viewport changes
+// pass NULL to disable clipping
+CENGINE_PUBLIC void renderer_set_clip_rect (Renderer *renderer, const SDL_Rect *rect);
+
+// returns the stats of the last rendered frame
+CENGINE_EXPORT RenderFrameStats renderer_get_frame_stats (Renderer *renderer);
+
+// returns the percentage (0 - 100) of the layers pixels that were redrawn in the last frame
+// non cached layers always count as fully redrawn
+CENGINE_EXPORT float renderer_get_redrawn_percentage (Renderer *renderer);
+
 /*** Layers ***/
 
+#define LAYER_MAX_DIRTY_RECTS                       16
+
 typedef struct Layer {
 
     String *name;
     int pos;
     DoubleList *elements;
 
+    // a cached layer is drawn into its own texture and only the
+    // parts of it that were marked as dirty are drawn again
+    bool cached;
+    SDL_Texture *cache;
+    int cache_width, cache_height;
+
+    bool dirty_all;
+    SDL_Rect dirty_rects[LAYER_MAX_DIRTY_RECTS];
+    u32 n_dirty_rects;
+
 } Layer;
 
 extern DoubleList *gos_layers;              // render layers for the gameobjects
@@ -165,6 +253,106 @@ CENGINE_PUBLIC int layer_remove_element_by_name (DoubleList *layers, const char
 // init the ui elements layers
 CENGINE_PRIVATE DoubleList *ui_layers_init (void);
 
+// enables or disables caching the layer into a render target texture
+// use it for layers with mostly static content, elements are only drawn again
+// when they are marked as dirty by their setters or using ui_element_set_dirty ()
+// active buttons, images with actions, input fields, dropdowns and notification centers
+// handle the mouse or the time while they are drawn, so they are drawn again every frame
+CENGINE_EXPORT void layer_set_cached (Layer *layer, bool cached);
+
+// marks the whole layer to be drawn again in the next frame
+CENGINE_EXPORT void layer_set_dirty (Layer *layer);
+
+// marks a rect (in window coordinates) of the layer to be drawn again in the next frame
+CENGINE_EXPORT void layer_add_dirty_rect (Layer *layer, const SDL_Rect *rect);
+
+// makes sure the layer's cache texture exists and matches the renderer's size
+// returns 0 on success, 1 on error
+CENGINE_PRIVATE u8 layer_cache_prepare (Renderer *renderer, Layer *layer);
+
+/*** Render Batch ***/
+
+// a single quad recorded while the batch is open
+typedef struct RenderCommand {
+
+    int layer;
+    u32 idx;                    // submission order inside the frame
+    u32 group;                  // the draw call this command was merged into
+
+    SDL_Texture *texture;       // NULL for solid colour quads
+    SDL_Rect src_rect;
+    bool full_src;              // use the whole texture as source
+    SDL_Rect dest_rect;
+    SDL_Color colour;
+    SDL_RendererFlip flip;
+
+} RenderCommand;
+
+// a run of commands that share a texture and can be submitted in one call
+typedef struct RenderGroup {
+
+    SDL_Texture *texture;
+    SDL_Rect bounds;
+    u32 n_commands;
+
+} RenderGroup;
+
+struct _RenderBatch {
+
+    bool enabled;
+    bool open;
+
+    int layer;                  // layer assigned to new commands
+
+    RenderCommand *commands;
+    u32 n_commands;
+    u32 max_commands;
+
+    RenderGroup *groups;
+    u32 n_groups;
+    u32 max_groups;
+
+    SDL_Vertex *vertices;
+    int *indices;
+    u32 max_quads;
+
+    u32 lookback;               // how many groups back a command may be merged
+
+};
+
+typedef struct _RenderBatch RenderBatch;
+
+CENGINE_PRIVATE RenderBatch *render_batch_new (void);
+
+CENGINE_PRIVATE void render_batch_delete (void *batch_ptr);
+
+// enables or disables draw call batching for the renderer, enabled by default
+// when disabled, every draw is submitted to SDL right away
+CENGINE_EXPORT void renderer_set_batching (Renderer *renderer, bool enabled);
+
+// sets how many groups back a new command may be merged into,
+// higher values merge more but cost more time at flush
+CENGINE_EXPORT void renderer_set_batch_lookback (Renderer *renderer, u32 lookback);
+
+// sets the layer that will be used to sort the next recorded commands
+CENGINE_PUBLIC void renderer_batch_set_layer (Renderer *renderer, int layer);
+
+// submits all the recorded commands to SDL,
+// call this before changing any renderer state like the viewport or the render target
+CENGINE_PUBLIC void renderer_batch_flush (Renderer *renderer);
+
+// draws a texture (or a portion of it if src_rect is not NULL)
+// the command is recorded in the batch if it is open, else it is drawn right away
+CENGINE_PUBLIC void renderer_batch_texture (Renderer *renderer, SDL_Texture *texture,
+    const SDL_Rect *src_rect, const SDL_Rect *dest_rect, SDL_RendererFlip flip);
+
+// same as renderer_batch_texture () but the texture colour is modulated by colour
+CENGINE_PUBLIC void renderer_batch_texture_colour (Renderer *renderer, SDL_Texture *texture,
+    const SDL_Rect *src_rect, const SDL_Rect *dest_rect, SDL_RendererFlip flip, SDL_Color colour);
+
+// draws a filled rect using the batch if it is open, else it is drawn right away
+CENGINE_PUBLIC void renderer_batch_fill_rect (Renderer *renderer, const SDL_Rect *rect, SDL_Color colour);
+
 /*** Surfaces ***/
 
 // creates a new empty surface
@@ -272,7 +460,8 @@ CENGINE_EXPORT int render_complex_circle (Renderer *renderer,
 
 /*** Render ***/
 
-CENGINE_PRIVATE void render (Renderer *renderer);
+// alpha is how far the frame is between the last two state updates
+CENGINE_PRIVATE void render (Renderer *renderer, double alpha);
 
 /*** Public ***/
 
@@ -10,6 +10,8 @@
 #include "cengine/graphics.h"
 #include "cengine/textures.h"
 
+struct _Atlas;
+
 struct _Sprite {
 
     ImageData *img_data;
@@ -19,6 +21,11 @@ struct _Sprite {
     i32 scale_factor;
     SDL_Rect src_rect, dest_rect;
 
+    // 18/10/2026 -- a sprite inside an atlas does not have its own texture,
+    // it is drawn from the atlas page and its src_rect is where it is inside the page
+    struct _Atlas *atlas;
+    u8 atlas_page;
+
 };
 
 typedef struct _Sprite Sprite;
@@ -27,8 +34,13 @@ CENGINE_PUBLIC Sprite *sprite_new (void);
 
 CENGINE_PUBLIC void sprite_destroy (Sprite *sprite);
 
+// if the renderer has an atlas, the image is packed into it instead of getting its own texture
 CENGINE_PUBLIC Sprite *sprite_load (const char *filename, Renderer *renderer);
 
+// returns the texture the sprite is drawn from, its own or the one of its atlas page
+// it can only be called from the render thread
+CENGINE_PUBLIC SDL_Texture *sprite_get_texture (Sprite *sprite, Renderer *renderer);
+
 typedef struct IndividualSprite {
 
     u32 col, row;
@@ -50,14 +62,30 @@ struct _SpriteSheet {
 
     IndividualSprite ***individual_sprites;
 
+    // 18/10/2026 -- a sprite sheet inside an atlas is drawn from the atlas page,
+    // region is where the whole sheet is inside the page
+    struct _Atlas *atlas;
+    u8 atlas_page;
+    SDL_Rect region;
+
 };
 
 typedef struct _SpriteSheet SpriteSheet;
 
+CENGINE_PUBLIC SpriteSheet *sprite_sheet_new (void);
+
 CENGINE_PUBLIC void sprite_sheet_destroy (SpriteSheet *sprite_sheet);
 
+// if the renderer has an atlas, the image is packed into it instead of getting its own texture
 CENGINE_PUBLIC SpriteSheet *sprite_sheet_load (const char *filename, Renderer *renderer);
 
+// returns the texture the sprite sheet is drawn from, its own or the one of its atlas page
+// it can only be called from the render thread
+CENGINE_PUBLIC SDL_Texture *sprite_sheet_get_texture (SpriteSheet *sprite_sheet, Renderer *renderer);
+
+// selects the frame at col & row to be drawn
+CENGINE_PUBLIC void sprite_sheet_set_frame (SpriteSheet *sprite_sheet, u32 col, u32 row);
+
 CENGINE_PUBLIC void sprite_sheet_set_sprite_size (SpriteSheet *sprite_sheet, u32 w, u32 h);
 
 CENGINE_PUBLIC void sprite_sheet_set_scale_factor (SpriteSheet *sprite_sheet, i32 scale_factor);
@@ -0,0 +1,87 @@
+#ifndef _CENGINE_TEXCACHE_H_
+#define _CENGINE_TEXCACHE_H_
+
+#include <stdbool.h>
+
+#include <SDL2/SDL.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/config.h"
+#include "cengine/renderer.h"
+
+#define TEXCACHE_MAGIC                  "CTEX"
+#define TEXCACHE_VERSION                1
+#define TEXCACHE_ALIGNMENT              64          // where the pixels start in the entry file
+#define TEXCACHE_HASH_SEED              0x43544558ULL
+
+// every entry file is a header, the source path and the decoded pixels
+// numbers are stored in the byte order of the machine that wrote it
+typedef struct TexCacheHeader {
+
+    char magic[4];
+    u32 version;
+
+    u32 format;                     // SDL_PIXELFORMAT_*, the native one of the renderer
+    u32 width;
+    u32 height;
+    u32 pitch;
+
+    // the source that was decoded, the entry is valid while its mtime & size are the same,
+    // or if they changed, while its contents have the same hash
+    i64 source_mtime_sec;
+    i64 source_mtime_nsec;
+    u64 source_size;
+    u64 source_hash;
+
+    u32 path_length;
+    u32 reserved;
+
+    u64 data_offset;
+    u64 data_size;
+
+} TexCacheHeader;
+
+typedef struct TexCacheStats {
+
+    u64 hits;
+    u64 misses;                     // there was no entry
+    u64 invalidated;                // there was an entry but its source had changed
+    u64 rehashed;                   // the source mtime changed but not its contents
+    u64 stored;
+
+} TexCacheStats;
+
+// sets the directory where the decoded images are stored, it is created if needed
+// the cache is disabled until it is set, NULL disables it again
+// returns 0 on success, 1 on error
+CENGINE_PUBLIC u8 texcache_set_dir (const char *dir);
+
+// returns true if a cache directory has been set
+CENGINE_PUBLIC bool texcache_is_enabled (void);
+
+// returns the pixel format the renderer creates textures from without converting them,
+// ARGB8888 if the renderer is NULL
+CENGINE_PUBLIC u32 texcache_get_format (Renderer *renderer);
+
+// returns the decoded image, from its cache entry if it is valid, or decoding it & storing a new entry
+// the surface is converted to the format, usually the one of texcache_get_format ()
+// if copy is false, the pixels of a cached image are still mapped from its entry file,
+// so the surface must be deleted with texcache_surface_delete ()
+// if copy is true, it can be freed with SDL_FreeSurface () & sent to other threads
+// without a cache dir, or if the file is in a mounted archive, the image is just decoded
+// returns NULL on error
+CENGINE_PUBLIC SDL_Surface *texcache_load_surface (const char *filename, u32 format, bool copy);
+
+// deletes a surface returned by texcache_load_surface () and unmaps its pixels
+CENGINE_PUBLIC void texcache_surface_delete (SDL_Surface *surface);
+
+// removes every entry of the cache directory
+CENGINE_PUBLIC void texcache_clear (void);
+
+CENGINE_PUBLIC TexCacheStats texcache_get_stats (void);
+
+// disables the cache, it is called by cengine_end ()
+CENGINE_PRIVATE void texcache_end (void);
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef _CENGINE_THREADS_JOBS_H_
+#define _CENGINE_THREADS_JOBS_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/collections/ring.h"
+
+#include "cengine/config.h"
+
+#define JOBS_MAX_WORKERS                16
+#define JOBS_IO_WORKERS                 4
+
+#define JOBS_DEQUE_CAPACITY             4096
+#define JOBS_QUEUE_CAPACITY             1024
+
+#define JOBS_STEAL_TRIES                4
+
+typedef enum JobAffinity {
+
+    JOB_AFFINITY_ANY            = 0,        // short cpu work, runs in any worker
+    JOB_AFFINITY_MAIN           = 1,        // runs in the main thread, like anything that uses the renderer
+    JOB_AFFINITY_IO             = 2,        // may block, runs in the io workers that never steal cpu jobs
+
+} JobAffinity;
+
+struct _JobCounter;
+
+typedef struct Job {
+
+    void (*work)(void *args);
+    void *args;
+
+    JobAffinity affinity;
+    struct _JobCounter *counter;
+
+    struct Job *next;               // used while the job waits for a dependency
+
+} Job;
+
+// counts the jobs that have not finished yet
+// jobs can be submitted to run after a counter gets to 0
+struct _JobCounter {
+
+    i32 value;
+
+    pthread_mutex_t *mutex;
+    Job *waiting;
+
+};
+
+typedef struct _JobCounter JobCounter;
+
+// work stealing deque (chase-lev), only the owner pushes and takes from the bottom,
+// other workers steal from the top
+typedef struct JobDeque {
+
+    char pad_top[64];
+    i64 top;
+    char pad_bottom[64];
+    i64 bottom;
+    char pad_end[64];
+
+    Job *jobs[JOBS_DEQUE_CAPACITY];
+
+} JobDeque;
+
+typedef struct JobWorker {
+
+    u32 idx;
+    pthread_t thread_id;
+    JobDeque deque;
+
+    // used to pick the victims to steal from
+    u32 random;
+
+} JobWorker;
+
+typedef struct JobSystem {
+
+    JobWorker *workers[JOBS_MAX_WORKERS];
+    u32 n_workers;
+
+    pthread_t io_threads[JOBS_IO_WORKERS];
+    u32 n_io_threads;
+
+    // jobs submitted from threads that are not workers
+    Ring *queue;
+    Ring *main_queue;
+    Ring *io_queue;
+
+    // jobs that have been submitted but not taken yet, used to know when workers can sleep
+    u32 pending;
+    u32 io_pending;
+    u32 sleeping;
+    u32 io_sleeping;
+
+    pthread_mutex_t *mutex;
+    pthread_cond_t *work_cond;
+    pthread_cond_t *io_cond;
+
+    bool running;
+
+    // the last thread that ran the main jobs
+    pthread_t main_thread;
+    bool main_thread_set;
+
+} JobSystem;
+
+// starts the workers, n_workers = 0 uses one less than the number of cpus
+// it is called by the first submit if it has not been called before
+// returns 0 on success, 1 on error
+CENGINE_PUBLIC u8 jobs_init (u32 n_workers);
+
+// stops and joins every worker, the jobs that have not started are dropped
+CENGINE_PUBLIC void jobs_end (void);
+
+// returns true if the calling thread is one of the cpu workers
+CENGINE_PUBLIC bool jobs_is_worker (void);
+
+// submits a job to run as soon as possible
+// if counter is not NULL, it is incremented now and decremented when the job ends
+// returns 0 on success, 1 on error
+CENGINE_PUBLIC u8 job_submit (JobAffinity affinity,
+    void (*work)(void *args), void *args, JobCounter *counter);
+
+// submits a job that will only run after the dependency counter gets to 0
+// returns 0 on success, 1 on error
+CENGINE_PUBLIC u8 job_submit_after (JobCounter *dependency, JobAffinity affinity,
+    void (*work)(void *args), void *args, JobCounter *counter);
+
+// runs every job that was submitted with JOB_AFFINITY_MAIN
+// called by cengine in the main thread once every frame
+CENGINE_PRIVATE void jobs_run_main (void);
+
+/*** counters ***/
+
+CENGINE_PUBLIC JobCounter *job_counter_create (void);
+
+CENGINE_PUBLIC void job_counter_delete (void *counter_ptr);
+
+CENGINE_PUBLIC i32 job_counter_value (JobCounter *counter);
+
+// waits until the counter gets to 0, running other cpu jobs meanwhile
+// in the main thread it also runs the JOB_AFFINITY_MAIN jobs
+CENGINE_PUBLIC void job_counter_wait (JobCounter *counter);
+
+#endif
@@ -130,7 +130,7 @@ CENGINE_EXPORT void ui_button_set_bg_color (Button *button, Renderer *renderer,
 CENGINE_EXPORT void ui_button_remove_background (Button *button);
 
 // sets an sprite for each button state
-// the sprite is loaded and deleted when the button gets deleted
+// the sprite is shared with the assets cache and released when the button gets deleted
 CENGINE_EXPORT void ui_button_set_sprite (Button *button, Renderer *renderer, ButtonState state, const char *filename);
 
 // uses a refrence to the sprite and does not load or destroy it 
@@ -3,6 +3,8 @@
 
 #include <stdbool.h>
 
+#include <pthread.h>
+
 #include <SDL2/SDL.h>
 
 #include "cengine/types/types.h"
@@ -18,6 +20,17 @@
 struct _Renderer;
 struct _UITransform;
 
+#define TEXT_INIT_QUADS             32
+
+// a glyph placed in the text, dest rect is relative to the text position
+typedef struct TextQuad {
+
+    u8 page;
+    SDL_Rect src_rect;
+    SDL_Rect dest_rect;
+
+} TextQuad;
+
 typedef struct Text {
 
     struct _UITransform *transform;
@@ -32,7 +45,13 @@ typedef struct Text {
     bool wrap_text;
     u32 wrap_length;
 
-    SDL_Texture *texture;       // rendered text
+    // 18/10/2026 -- text is drawn from the font source glyph atlas,
+    // the quads buffer is reused between updates, so no texture is created
+    TextQuad *quads;
+    u32 n_quads;
+    u32 max_quads;
+
+    pthread_mutex_t *mutex;     // updates can come from any thread
 
 } Text;
 
@@ -53,7 +72,8 @@ CENGINE_PUBLIC void ui_text_component_update (Text *text, const char *text_str);
 // sets the option to wrap text (create new lines) if to big
 CENGINE_PUBLIC void ui_text_component_set_wrap (Text *text, u32 wrap_lenght);
 
-// creates / updates the text texture
+// lays out the text using the font source glyph atlas,
+// updates the transform size to fit the text
 CENGINE_PUBLIC void ui_text_component_draw (Text *text, struct _Renderer *renderer);
 
 // renders the text component to the screen
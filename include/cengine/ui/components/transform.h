@@ -10,6 +10,7 @@
 #include "cengine/ui/position.h"
 
 struct _Renderer;
+struct _UIElement;
 
 struct _UITransform {
 
@@ -20,6 +21,10 @@ struct _UITransform {
     // 06/02/2020
     int x_offset, y_offset;
 
+    // the element that owns this transform, NULL for components transforms
+    // used to mark the element as dirty when it moves
+    struct _UIElement *ui_element;
+
 };
 
 typedef struct _UITransform UITransform;
@@ -156,6 +156,9 @@ CENGINE_EXPORT String *ui_dropdown_option_selected (Dropdown *dropdown);
 // IMPORTANT: set the colour after you have added all the options to the dropdwon!
 CENGINE_EXPORT void ui_dropdown_option_set_hover_color (Dropdown *dropdown, Renderer *renderer, RGBA_Color color);
 
+// marks the dropdown and the area where its options are drawn as dirty
+CENGINE_PRIVATE void ui_dropdown_set_dirty (Dropdown *dropdown);
+
 // render the dropdown to the screen
 CENGINE_PRIVATE void ui_dropdown_render (Dropdown *dropdown, Renderer *renderer);
 
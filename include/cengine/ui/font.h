@@ -1,6 +1,8 @@
 #ifndef _CENGINE_UI_FONT_H_
 #define _CENGINE_UI_FONT_H_
 
+#include <pthread.h>
+
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
@@ -21,6 +23,11 @@ typedef SDL_Texture FontImage;
 #define TTF_STYLE_OUTLINE	        16
 #define FONT_LOAD_MAX_SURFACES      10
 
+#define FONT_ATLAS_PAGE_SIZE        1024
+#define FONT_ATLAS_MAX_PAGES        8
+#define FONT_ATLAS_GLYPH_PADDING    1
+#define FONT_ATLAS_INIT_GLYPHS      256
+
 typedef enum FilterEnum {
 
 	FILTER_NEAREST,
@@ -28,6 +35,55 @@ typedef enum FilterEnum {
 
 } FilterEnum;
 
+/*** Atlas ***/
+
+// a glyph that was rasterized into one of the atlas pages
+typedef struct FontGlyph {
+
+	u32 code_point;				// as returned by get_code_point_from_UTF8 (), 0 for empty slots
+	u8 page;
+	bool valid;					// false if the glyph could not be rasterized, it is not cached
+
+	SDL_Rect rect;				// position inside the page
+	int offset_x;				// where the rect starts from the pen, < 0 if the glyph goes to the left of it
+	int advance;
+
+} FontGlyph;
+
+typedef struct FontAtlasPage {
+
+	SDL_Surface *surface;		// cpu copy where new glyphs are added
+	SDL_Texture *texture;
+
+	bool dirty;					// new glyphs that need to be uploaded
+	SDL_Rect dirty_rect;
+
+	// shelf packer
+	int pen_x, pen_y;
+	int row_height;
+
+} FontAtlasPage;
+
+// glyph cache for a font source, every glyph is rasterized only once
+// into a shared page, so drawing text does not create any texture
+typedef struct FontAtlas {
+
+	FontAtlasPage pages[FONT_ATLAS_MAX_PAGES];
+	u8 n_pages;
+
+	// open addressing table by code point
+	FontGlyph *glyphs;
+	u32 glyphs_size;
+	u32 n_glyphs;
+
+	pthread_mutex_t *mutex;
+
+} FontAtlas;
+
+CENGINE_PRIVATE FontAtlas *font_atlas_new (void);
+
+CENGINE_PRIVATE void font_atlas_delete (void *atlas_ptr);
+
 typedef struct FontSource {
 
 	TTF_Font *ttf_source;
@@ -41,8 +97,19 @@ typedef struct FontSource {
 
 	unsigned int size;
 
+	FontAtlas *atlas;
+
 } FontSource;
 
+// gets the glyph for the code point, rasterizing it into the atlas if needed
+// returns a copy of the glyph, check glyph.valid
+CENGINE_PUBLIC FontGlyph font_source_get_glyph (FontSource *source, u32 code_point);
+
+// gets the texture of an atlas page, uploading any new glyphs
+// must be called from the renderer's thread
+CENGINE_PRIVATE SDL_Texture *font_source_get_page_texture (FontSource *source, 
+	struct _Renderer *renderer, u8 page);
+
 typedef struct Font {
 
 	String *name;
@@ -83,6 +150,10 @@ CENGINE_EXPORT Font *ui_font_get_by_name (const char *name);
 
 CENGINE_PRIVATE u32 get_code_point_from_UTF8 (const char **c, u8 advancePtr);
 
+// writes the utf8 bytes of a code point returned by get_code_point_from_UTF8 ()
+// returns the number of bytes written (without the NULL terminator)
+CENGINE_PRIVATE int font_code_point_to_UTF8 (u32 code_point, char *buffer);
+
 /*** Main ***/
 
 // called by internal cengine methods
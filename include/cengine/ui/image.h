@@ -81,6 +81,7 @@ CENGINE_EXPORT void ui_image_set_dimensions (Image *image, unsigned int width, u
 CENGINE_EXPORT void ui_image_set_scale (Image *image, int x_scale, int y_scale);
 
 // sets the image's sprite to be rendered and loads its
+// images that use the same file share the sprite using the assets cache
 // returns 0 on success loading sprite, 1 on error
 CENGINE_EXPORT u8 ui_image_set_sprite (Image *image, Renderer *renderer, const char *filename);
 
@@ -0,0 +1,71 @@
+#ifndef _CENGINE_UI_SPATIAL_H_
+#define _CENGINE_UI_SPATIAL_H_
+
+#include <stdbool.h>
+
+#include <SDL2/SDL_rect.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/config.h"
+
+#define UI_SPATIAL_CELL_SIZE                64
+#define UI_SPATIAL_INIT_ENTRIES             64
+
+struct _UIElement;
+
+// an element that can be hit by the mouse, with the screen rect it covered on the last build
+// entries are kept in draw order, so later entries are on top
+typedef struct UISpatialEntry {
+
+	struct _UIElement *ui_element;
+	SDL_Rect rect;
+
+} UISpatialEntry;
+
+// uniform grid of window cells, each cell references the entries that overlap it
+// the grid is only built again after it has been invalidated
+struct _UISpatialGrid {
+
+	int cell_size;
+	int width, height;
+	int cols, rows;
+
+	UISpatialEntry *entries;
+	u32 n_entries, max_entries;
+
+	// entries indexes grouped by cell, cell i uses [cell_start[i], cell_start[i + 1])
+	u32 *cell_entries;
+	u32 n_cell_entries, max_cell_entries;
+	u32 *cell_start;
+	u32 max_cells;
+
+	bool dirty;
+
+};
+
+typedef struct _UISpatialGrid UISpatialGrid;
+
+CENGINE_PRIVATE UISpatialGrid *ui_spatial_grid_new (int cell_size);
+
+CENGINE_PRIVATE void ui_spatial_grid_delete (void *grid_ptr);
+
+// marks the grid to be built again before the next query
+CENGINE_PRIVATE void ui_spatial_grid_invalidate (UISpatialGrid *grid);
+
+// removes all the entries, call it before adding the elements again
+CENGINE_PRIVATE void ui_spatial_grid_clear (UISpatialGrid *grid);
+
+// adds an element with the screen rect it covers
+// elements must be added in draw order
+// returns 0 on success, 1 on error
+CENGINE_PRIVATE u8 ui_spatial_grid_add (UISpatialGrid *grid, struct _UIElement *ui_element, const SDL_Rect *rect);
+
+// sorts the entries into the cells of a window with the specified size
+// returns 0 on success, 1 on error
+CENGINE_PRIVATE u8 ui_spatial_grid_build (UISpatialGrid *grid, int width, int height);
+
+// returns the top most element under the point that accepts the mouse, NULL if none
+CENGINE_PRIVATE struct _UIElement *ui_spatial_grid_query (UISpatialGrid *grid, int x, int y);
+
+#endif
@@ -10,6 +10,7 @@
 #include "cengine/renderer.h"
 #include "cengine/window.h"
 
+#include "cengine/ui/spatial.h"
 #include "cengine/ui/components/transform.h"
 
 struct _Window;
@@ -82,6 +83,25 @@ CENGINE_PUBLIC void ui_element_set_active (UIElement *ui_element, bool active);
 
 CENGINE_PUBLIC void parent_ui_element_get_position (UIElement *parent, int *x, int *y);
 
+// gets the rect that the element covers in window coordinates
+CENGINE_PUBLIC void ui_element_get_screen_rect (UIElement *ui_element, SDL_Rect *rect);
+
+// marks the area the element covers right now to be drawn again,
+// only has effect if the element is in a cached layer
+// call it before and after changing how the element looks
+CENGINE_PUBLIC void ui_element_set_dirty (UIElement *ui_element);
+
+// marks a rect to be drawn again, the rect is in the same coordinates
+// as the element's transform, useful for components that grow outside the element
+CENGINE_PUBLIC void ui_element_set_dirty_rect (UIElement *ui_element, const SDL_Rect *rect);
+
+// call it after changing the element's transform rect directly
+// to update the rects used to check which element is under the mouse
+CENGINE_PUBLIC void ui_element_set_moved (UIElement *ui_element);
+
+// returns true if the element handles the mouse (buttons, images with actions, inputs and dropdowns)
+CENGINE_PRIVATE bool ui_element_accepts_mouse (UIElement *ui_element);
+
 struct _UI {
 
     // 08/02/2020 -- 21:17
@@ -92,6 +112,14 @@ struct _UI {
 
     UIElement *ui_element_hover;
 
+    // 18/10/2026 -- the element under the mouse is resolved once per mouse change
+    // using a grid of the elements rects that is only built again when they move
+    UISpatialGrid *hit_grid;
+    int hover_x, hover_y;
+    bool hover_in_window;
+    bool hover_mouse_down;
+    bool hover_dirty;
+
 };
 
 typedef struct _UI UI;
@@ -103,6 +131,14 @@ CENGINE_PRIVATE UI *ui_create (void);
 
 CENGINE_PRIVATE UIElement *ui_element_hover_get (UI *ui);
 
+// the rects used to check which element is under the mouse will be updated
+// before the next check, call it after moving many elements directly
+CENGINE_PUBLIC void ui_hit_test_invalidate (UI *ui);
+
+// updates the ui element that is below the mouse, only looks for it again
+// when the mouse or the elements have changed since the last check
+CENGINE_PRIVATE void ui_hit_test (UI *ui, struct _Window *window);
+
 // adds a new ui element back to the UI
 // returns 0 on success, 1 on error
 CENGINE_PUBLIC u8 ui_add_element (UI *ui, UIElement *ui_element);
@@ -0,0 +1,21 @@
+#ifndef _UTILS_LZ4_H_
+#define _UTILS_LZ4_H_
+
+#include <stddef.h>
+
+#include "cengine/config.h"
+
+// lz4 block format (no frame), compatible with LZ4_compress_default () & LZ4_decompress_safe ()
+
+// max size that the compressed data of source_size bytes can have
+#define LZ4_COMPRESS_BOUND(source_size)         ((source_size) + ((source_size) / 255) + 16)
+
+// compresses the source into dest, that should have LZ4_COMPRESS_BOUND (source_size) bytes to always succeed
+// returns the size of the compressed data, 0 if it does not fit in dest_capacity
+CENGINE_PUBLIC size_t lz4_compress (const void *source, size_t source_size, void *dest, size_t dest_capacity);
+
+// decompresses the source into dest, it never reads or writes outside of the buffers, even with bad data
+// returns the size of the decompressed data, 0 if the data is not valid or it does not fit in dest_capacity
+CENGINE_PUBLIC size_t lz4_decompress (const void *source, size_t source_size, void *dest, size_t dest_capacity);
+
+#endif
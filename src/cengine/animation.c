@@ -1,6 +1,9 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <string.h>
+
+#include <pthread.h>
 
 #include <SDL2/SDL.h>
 
@@ -13,9 +16,11 @@
 #include "cengine/timer.h"
 #include "cengine/sprites.h"
 #include "cengine/threads/thread.h"
+#include "cengine/threads/jobs.h"
 #include "cengine/animation.h"
 #include "cengine/files.h"
 #include "cengine/game/go.h"
+#include "cengine/game/ecs.h"
 
 #include "cengine/collections/dlist.h"
 
@@ -210,7 +215,34 @@ Animation *animation_get_by_name (DoubleList *animations, const char *name) {
 
 static u32 next_animator_id = 0;
 
-DoubleList *animators = NULL;
+// 18/10/2026 -- animators_mutex protects the states while they are updated or changed,
+// frames_mutex keeps the published frames still while the main thread reads them,
+// when both are needed, animators_mutex is always locked first
+static pthread_mutex_t animators_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t frames_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static AnimatorState *animator_states = NULL;
+static u32 n_animator_states = 0;
+static u32 max_animator_states = 0;
+
+// the index of the frame inside each state that can be read
+static u8 published_frame = 0;
+
+// returns 0 on success, 1 on error
+static u8 animator_states_reserve (void) {
+
+    if (n_animator_states < max_animator_states) return 0;
+
+    u32 new_max = max_animator_states ? max_animator_states * 2 : ANIMATORS_INIT_CAPACITY;
+    AnimatorState *new_states = (AnimatorState *) realloc (animator_states, new_max * sizeof (AnimatorState));
+    if (!new_states) return 1;
+
+    animator_states = new_states;
+    max_animator_states = new_max;
+
+    return 0;
+
+}
 
 Animator *animator_new (u32 objectID) {
 
@@ -220,16 +252,32 @@ Animator *animator_new (u32 objectID) {
         next_animator_id += 1;
 
         new_animator->go_id = objectID;
-        new_animator->start = true;
-        new_animator->playing = false;
-        new_animator->defaultAnimation = NULL;
-        new_animator->currAnimation = NULL;
-        new_animator->currFrame = 0;
         new_animator->n_animations = 0;
         new_animator->animations = NULL;
-        new_animator->timer = timer_new ();
 
-        dlist_insert_after (animators, dlist_end (animators), new_animator);
+        pthread_mutex_lock (&animators_mutex);
+        pthread_mutex_lock (&frames_mutex);
+
+        if (!animator_states_reserve ()) {
+            new_animator->index = n_animator_states;
+
+            AnimatorState *state = &animator_states[n_animator_states];
+            memset (state, 0, sizeof (AnimatorState));
+            state->animator = new_animator;
+            state->start_ns = frame_clock_now ();
+            state->frames[0].go_id = objectID;
+            state->frames[1].go_id = objectID;
+
+            n_animator_states += 1;
+        }
+
+        else {
+            free (new_animator);
+            new_animator = NULL;
+        }
+
+        pthread_mutex_unlock (&frames_mutex);
+        pthread_mutex_unlock (&animators_mutex);
     }
     
     return new_animator;
@@ -247,150 +295,269 @@ void animator_destroy (Animator *animator) {
             free (animator->animations);
         }
 
-        timer_destroy (animator->timer);
-
-        void *data = dlist_remove (animators, animator, NULL);
-        // void *data = dlist_remove_element (animators, dlist_get_element (animators, animator));
-        if (data) free (data);
-        else free (animator);
-    }
-
-}
+        pthread_mutex_lock (&animators_mutex);
+        pthread_mutex_lock (&frames_mutex);
 
-static void animator_destroy_ref (void *data) { 
-    
-    if (data) animator_destroy ((Animator *) data);
-    
-}
+        // move the last state to keep the array packed
+        u32 last = n_animator_states - 1;
+        if (animator->index != last) {
+            animator_states[animator->index] = animator_states[last];
+            animator_states[animator->index].animator->index = animator->index;
+        }
 
-static int animator_comparator_by_id (const void *one, const void *two) {
+        n_animator_states -= 1;
 
-    if (one && two) {
-        Animator *anim_one = (Animator *) one;
-        Animator *anim_two = (Animator *) two;
+        pthread_mutex_unlock (&frames_mutex);
+        pthread_mutex_unlock (&animators_mutex);
 
-        if (anim_one->id < anim_two->id) return -1;
-        else if (anim_one->id == anim_two->id) return 0;
-        else return 1;
+        free (animator);
     }
 
-    return -1;
 }
 
 void animator_set_default_animation (Animator *animator, Animation *animation) {
 
-    if (animator && animation) 
-        animator->defaultAnimation = animation;
+    if (animator && animation) {
+        pthread_mutex_lock (&animators_mutex);
+
+        animator_states[animator->index].default_animation = animation;
+
+        pthread_mutex_unlock (&animators_mutex);
+    }
 
 }
 
+// sets the animation that will be used, only if the animator is not playing one
 void animator_set_current_animation (Animator *animator, Animation *animation) {
 
-    if (animator && animation) 
-        if (!animator->playing) animator->currAnimation = animation; 
+    if (animator && animation) {
+        pthread_mutex_lock (&animators_mutex);
+
+        AnimatorState *state = &animator_states[animator->index];
+        if (!state->playing) state->animation = animation;
+
+        pthread_mutex_unlock (&animators_mutex);
+    }
 
 }
 
+// plays the animation once from its first frame, then the default animation is used again
 void animator_play_animation (Animator *animator, Animation *animation) {
 
     if (animator && animation) {
-        animator_set_current_animation (animator, animation);
-        animator->start = true;
-        animator->playing = true;
-        animator->currFrame = 0;
-        timer_start (animator->timer);
+        pthread_mutex_lock (&animators_mutex);
+
+        AnimatorState *state = &animator_states[animator->index];
+        state->animation = animation;
+        state->playing = true;
+        state->start_ns = frame_clock_now ();
+
+        pthread_mutex_unlock (&animators_mutex);
     } 
 
 }
 
+// gets the frame published by the last animations update
+// returns 0 on success, 1 on error
+u8 animator_get_frame (Animator *animator, AnimatorFrame *frame) {
+
+    u8 retval = 1;
+
+    if (animator && frame) {
+        pthread_mutex_lock (&frames_mutex);
+
+        *frame = animator_states[animator->index].frames[published_frame];
+
+        pthread_mutex_unlock (&frames_mutex);
+
+        retval = 0;
+    }
+
+    return retval;
+
+}
+
 /*** Anim Thread ***/
 
-void *animations_update (void *data) {
+// computes the frame of the animator at the specified time into the frame buffer
+static inline void animator_state_update (AnimatorState *state, u64 now, u8 buffer) {
 
-    thread_set_name ("animation");
+    AnimatorFrame *frame = &state->frames[buffer];
+    frame->go_id = state->animator->go_id;
 
-    u32 time_per_frame = 1000 / fps_limit;
-    u32 frame_start = 0;
-    i32 sleep_time = 0;
-
-    float delta_time = 0;
-    u32 delta_ticks = 0;
-    u32 fps = 0;
-
-    while (running) {
-        frame_start = SDL_GetTicks ();
-
-        if (dlist_size (animators) > 0) {
-             // update all animations
-            Animator *animator = NULL;
-            Graphics *graphics = NULL;
-            for (ListElement *le = dlist_start (animators); le != NULL; le = le->next) {
-                animator = (Animator *) le->data;
-                graphics = (Graphics *) game_object_get_component (game_object_get_by_id (animator->go_id), GRAPHICS_COMP);
-                animator->currFrame = (int) (((animator->timer->ticks / animator->currAnimation->speed) %
-                        animator->currAnimation->n_frames));
-
-                graphics->x_sprite_offset = animator->currAnimation->frames[animator->currFrame]->col;
-                graphics->y_sprite_offset = animator->currAnimation->frames[animator->currFrame]->row;
-
-                if (animator->playing) {
-                    if (animator->currFrame >= (animator->currAnimation->n_frames - 1)) {
-                        animator->playing = false;
-                        animator->currAnimation = animator->defaultAnimation;
-                        animator->currFrame = 0;
-                        timer_start (animator->timer);
-                    }
-                }
-            }
+    Animation *animation = state->animation;
+    if (animation && animation->n_frames && animation->speed) {
+        u64 n = ((now - state->start_ns) / 1000000) / animation->speed;
+
+        if (state->playing && n >= animation->n_frames) {
+            // we are done playing, go back to the default animation
+            state->playing = false;
+            state->animation = animation = state->default_animation;
+            state->start_ns = now;
+            n = 0;
+
+            if (!animation || !animation->n_frames) return;
         }
 
-        // limit the FPS
-        sleep_time = time_per_frame - (SDL_GetTicks () - frame_start);
-        if (sleep_time > 0) SDL_Delay (sleep_time);
+        frame->frame = (u8) (n % animation->n_frames);
+        if (animation->frames[frame->frame]) {
+            frame->col = animation->frames[frame->frame]->col;
+            frame->row = animation->frames[frame->frame]->row;
+        }
+    }
 
-        // update animators timers
-        if (dlist_size (animators) > 0) {
-            Animator *animator = NULL;
-            for (ListElement *le = dlist_start (animators); le; le = le->next) {
-                animator = (Animator *) le->data;
-                animator->timer->ticks = SDL_GetTicks () - animator->timer->startTicks;
-            }
+}
+
+static void animator_states_update (u32 start, u32 end, u64 now, u8 buffer) {
+
+    for (u32 i = start; i < end; i++)
+        animator_state_update (&animator_states[i], now, buffer);
+
+}
+
+typedef struct AnimationRange {
+
+    u32 start, end;
+    u64 now;
+    u8 buffer;
+
+} AnimationRange;
+
+static AnimationRange animation_ranges[ANIMATIONS_MAX_JOBS];
+static JobCounter *animation_jobs = NULL;
+
+static void animation_range_update (void *range_ptr) {
+
+    AnimationRange *range = (AnimationRange *) range_ptr;
+    animator_states_update (range->start, range->end, range->now, range->buffer);
+
+}
+
+// updates every state into the buffer, splitting the work in cpu jobs if there are many of them
+static void animations_update_states (u64 now, u8 buffer) {
+
+    if (n_animator_states >= ANIMATIONS_PARALLEL_THRESHOLD) {
+        if (!animation_jobs) animation_jobs = job_counter_create ();
+    }
+
+    if (animation_jobs && n_animator_states >= ANIMATIONS_PARALLEL_THRESHOLD) {
+        u32 n_parts = n_animator_states / ANIMATIONS_JOB_STATES;
+        if (n_parts > ANIMATIONS_MAX_JOBS) n_parts = ANIMATIONS_MAX_JOBS;
+
+        for (u32 part = 0; part < n_parts; part++) {
+            AnimationRange *range = &animation_ranges[part];
+            range->start = (u32) (((u64) n_animator_states * part) / n_parts);
+            range->end = (u32) (((u64) n_animator_states * (part + 1)) / n_parts);
+            range->now = now;
+            range->buffer = buffer;
         }
 
-        // count fps
-        delta_time = SDL_GetTicks () - frame_start;
-        delta_ticks += delta_time;
-        fps++;
-        if (delta_ticks >= 1000) {
-            // printf ("anim fps: %i\n", fps);
-            delta_ticks = 0;
-            fps = 0;
+        // the animations thread takes the first range and helps with the rest while it waits
+        for (u32 part = 1; part < n_parts; part++) {
+            if (job_submit (JOB_AFFINITY_ANY, animation_range_update, &animation_ranges[part], animation_jobs))
+                animation_range_update (&animation_ranges[part]);
         }
+
+        animation_range_update (&animation_ranges[0]);
+
+        job_counter_wait (animation_jobs);
+    }
+
+    else {
+        animator_states_update (0, n_animator_states, now, buffer);
+    }
+
+}
+
+static bool animations_running = false;
+
+static void *animations_update (void *data) {
+
+    thread_set_name ("animation");
+
+    FrameScheduler *scheduler = frame_scheduler_create (cengine_get_fps_limit ());
+
+    while (__atomic_load_n (&animations_running, __ATOMIC_ACQUIRE)) {
+        frame_scheduler_begin (scheduler);
+
+        // every animator uses the same time for this frame
+        u64 now = frame_clock_now ();
+
+        pthread_mutex_lock (&animators_mutex);
+
+        u8 buffer = !published_frame;
+        animations_update_states (now, buffer);
+
+        pthread_mutex_lock (&frames_mutex);
+        published_frame = buffer;
+        pthread_mutex_unlock (&frames_mutex);
+
+        pthread_mutex_unlock (&animators_mutex);
+
+        frame_scheduler_wait (scheduler);
     }
 
+    frame_scheduler_delete (scheduler);
+
     return NULL;
 
 }
 
-/*** Public ***/
+// copies the frames of the animators in the batch into the graphics of the same game objects
+static void animations_apply_system (EcsIter *it) {
 
-int animations_init (void) {
+    Animator **animators = (Animator **) ecs_iter_column (it, 0, 0);
+    Graphics **graphics = (Graphics **) ecs_iter_column (it, 1, 0);
 
-    int errors = 0;
+    AnimatorState *state = NULL;
+    AnimatorFrame *frame = NULL;
+    for (u32 i = 0; i < it->count; i++) {
+        state = &animator_states[animators[it->rows[0][i]]->index];
+        frame = &state->frames[published_frame];
 
-    animators = dlist_init (animator_destroy_ref, animator_comparator_by_id);
-    if (animators) {
-        pthread_t thread_id = 0;
-        if (thread_create_detachable (&thread_id, animations_update, NULL)) {
-            cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to create animations thread!");
-            errors = 1;
+        // the graphics only need to be updated if the frame changed
+        if (!state->applied || frame->col != state->applied_col || frame->row != state->applied_row) {
+            Graphics *go_graphics = graphics[it->rows[1][i]];
+            go_graphics->x_sprite_offset = frame->col;
+            go_graphics->y_sprite_offset = frame->row;
+
+            state->applied = true;
+            state->applied_col = frame->col;
+            state->applied_row = frame->row;
         }
     }
 
-    else {
-        #ifdef CENGINE_DEBUG
-        cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to create animators list!");
-        #endif
+}
+
+// copies the last published frames into the graphics of the game objects that have an animator
+// it must be called from the main thread before rendering
+void animations_apply (void) {
+
+    if (game_world) {
+        const EcsComponent components[2] = { game_animator_comp, game_graphics_comp };
+
+        pthread_mutex_lock (&frames_mutex);
+
+        ecs_query_each (game_world, components, 2, animations_apply_system, NULL);
+
+        pthread_mutex_unlock (&frames_mutex);
+    }
+
+}
+
+/*** Public ***/
+
+static pthread_t animations_thread = 0;
+
+int animations_init (void) {
+
+    int errors = 0;
+
+    // 18/10/2026 -- the thread is joined in animations_end () before the states are deleted
+    animations_running = true;
+    if (pthread_create (&animations_thread, NULL, animations_update, NULL)) {
+        cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to create animations thread!");
+        animations_running = false;
         errors = 1;
     }
 
@@ -400,7 +567,21 @@ int animations_init (void) {
 
 u8 animations_end (void) {
 
-    dlist_delete (animators);
+    if (animations_running) {
+        __atomic_store_n (&animations_running, false, __ATOMIC_RELEASE);
+        pthread_join (animations_thread, NULL);
+    }
+
+    job_counter_delete (animation_jobs);
+    animation_jobs = NULL;
+
+    // destroy the animators that were not removed with their game objects
+    while (n_animator_states > 0)
+        animator_destroy (animator_states[n_animator_states - 1].animator);
+
+    free (animator_states);
+    animator_states = NULL;
+    max_animator_states = 0;
 
     #ifdef CENGINE_DEBUG
     cengine_log_msg (stdout, LOG_SUCCESS, LOG_NO_TYPE, "Done cleaning cengine animations.");
@@ -408,4 +589,4 @@ u8 animations_end (void) {
 
     return 0;
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,660 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <pthread.h>
+
+#include <SDL2/SDL.h>
+
+#include "cengine/types/types.h"
+#include "cengine/types/string.h"
+
+#include "cengine/collections/dlist.h"
+#include "cengine/collections/hashmap.h"
+
+#include "cengine/archive.h"
+#include "cengine/assets.h"
+
+#include "cengine/utils/log.h"
+#include "cengine/utils/lz4.h"
+#include "cengine/utils/utils.h"
+
+static pthread_mutex_t mounted_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static Archive *mounted[ARCHIVE_MAX_MOUNTED];
+static unsigned int n_mounted = 0;
+
+#pragma region Archive
+
+static Archive *archive_new (void) {
+
+    Archive *archive = (Archive *) malloc (sizeof (Archive));
+    if (archive) {
+        memset (archive, 0, sizeof (Archive));
+
+        archive->filename = NULL;
+
+        archive->map = NULL;
+        archive->map_size = 0;
+
+        archive->header = NULL;
+        archive->entries = NULL;
+        archive->names = NULL;
+
+        archive->decompressed = NULL;
+
+        archive->mutex = NULL;
+    }
+
+    return archive;
+
+}
+
+void archive_close (void *archive_ptr) {
+
+    if (archive_ptr) {
+        Archive *archive = (Archive *) archive_ptr;
+
+        if (archive->decompressed) {
+            for (u32 i = 0; i < archive->header->n_entries; i++)
+                free (archive->decompressed[i]);
+
+            free (archive->decompressed);
+        }
+
+        if (archive->map) munmap (archive->map, archive->map_size);
+
+        if (archive->mutex) {
+            pthread_mutex_destroy (archive->mutex);
+            free (archive->mutex);
+        }
+
+        str_delete (archive->filename);
+
+        free (archive);
+    }
+
+}
+
+// checks that every offset of the table of contents is inside the file,
+// so the entries can be used later without checking them again
+// returns 0 on success, 1 on error
+static u8 archive_validate (const Archive *archive) {
+
+    const ArchiveHeader *header = archive->header;
+    u64 file_size = archive->map_size;
+
+    if (memcmp (header->magic, ARCHIVE_MAGIC, sizeof (header->magic))) return 1;
+    if (header->version != ARCHIVE_VERSION) return 1;
+    if (header->file_size != file_size) return 1;
+
+    if ((header->toc_offset > file_size) || (header->toc_offset % sizeof (u64))) return 1;
+    if ((file_size - header->toc_offset) / sizeof (ArchiveEntry) < header->n_entries) return 1;
+
+    if (header->names_offset > file_size) return 1;
+    if (header->names_size > file_size - header->names_offset) return 1;
+
+    const ArchiveEntry *entries = (const ArchiveEntry *) ((const char *) archive->map + header->toc_offset);
+    for (u32 i = 0; i < header->n_entries; i++) {
+        const ArchiveEntry *entry = &entries[i];
+
+        if ((entry->offset > file_size) || (entry->size > file_size - entry->offset)) return 1;
+
+        if (entry->name_offset > header->names_size) return 1;
+        if (entry->name_length > header->names_size - entry->name_offset) return 1;
+
+        if ((i > 0) && (entry->hash < entries[i - 1].hash)) return 1;
+
+        if (!(entry->flags & ARCHIVE_ENTRY_LZ4) && (entry->original_size != entry->size)) return 1;
+        if (entry->original_size > INT_MAX) return 1;
+    }
+
+    return 0;
+
+}
+
+// maps the archive and checks that its table of contents is valid
+// returns the archive on success, NULL on error
+Archive *archive_open (const char *filename) {
+
+    Archive *archive = NULL;
+
+    if (filename) {
+        int fd = open (filename, O_RDONLY);
+        if (fd >= 0) {
+            struct stat filestatus;
+            if (!fstat (fd, &filestatus) && ((size_t) filestatus.st_size >= sizeof (ArchiveHeader))) {
+                void *map = mmap (NULL, filestatus.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (map != MAP_FAILED) {
+                    // start reading every page now, instead of one page fault at a time
+                    (void) madvise (map, filestatus.st_size, MADV_WILLNEED);
+
+                    archive = archive_new ();
+                    if (archive) {
+                        archive->filename = str_new (filename);
+
+                        archive->map = map;
+                        archive->map_size = filestatus.st_size;
+
+                        archive->header = (const ArchiveHeader *) map;
+
+                        if (!archive_validate (archive)) {
+                            archive->entries = (const ArchiveEntry *) ((const char *) map + archive->header->toc_offset);
+                            archive->names = (const char *) map + archive->header->names_offset;
+
+                            archive->decompressed = (void **) calloc (archive->header->n_entries + 1, sizeof (void *));
+
+                            archive->mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+                            if (archive->mutex) pthread_mutex_init (archive->mutex, NULL);
+
+                            if (!archive->decompressed || !archive->mutex) {
+                                archive_close (archive);
+                                archive = NULL;
+                            }
+                        }
+
+                        else {
+                            cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                                c_string_create ("%s is not a valid archive!", filename));
+                            archive_close (archive);
+                            archive = NULL;
+                        }
+                    }
+
+                    else munmap (map, filestatus.st_size);
+                }
+            }
+
+            close (fd);
+        }
+
+        if (!archive) {
+            cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                c_string_create ("Failed to open archive %s!", filename));
+        }
+    }
+
+    return archive;
+
+}
+
+static inline u64 archive_hash (const char *name, size_t name_length) {
+
+    return hashmap_hash (name, name_length, ARCHIVE_HASH_SEED);
+
+}
+
+// returns the index of the entry, -1 if it is not in the archive
+static long archive_find_index (const Archive *archive, const char *name) {
+
+    long index = -1;
+
+    size_t name_length = strlen (name);
+    u64 hash = archive_hash (name, name_length);
+
+    // first entry with the hash
+    u32 lo = 0, hi = archive->header->n_entries;
+    while (lo < hi) {
+        u32 mid = lo + (hi - lo) / 2;
+        if (archive->entries[mid].hash < hash) lo = mid + 1;
+        else hi = mid;
+    }
+
+    for (u32 i = lo; (i < archive->header->n_entries) && (archive->entries[i].hash == hash); i++) {
+        const ArchiveEntry *entry = &archive->entries[i];
+        if ((entry->name_length == name_length)
+            && !memcmp (archive->names + entry->name_offset, name, name_length)) {
+            index = i;
+            break;
+        }
+    }
+
+    return index;
+
+}
+
+// returns the entry of the file, the name is normalized like assets_path_normalize ()
+const ArchiveEntry *archive_find (const Archive *archive, const char *name) {
+
+    const ArchiveEntry *entry = NULL;
+
+    if (archive && name) {
+        char *normalized = assets_path_normalize (name);
+        if (normalized) {
+            long index = archive_find_index (archive, normalized);
+            if (index >= 0) entry = &archive->entries[index];
+
+            free (normalized);
+        }
+    }
+
+    return entry;
+
+}
+
+// decompresses the entry the first time it is used
+static const void *archive_get_entry_data (Archive *archive, u32 index) {
+
+    const ArchiveEntry *entry = &archive->entries[index];
+    const void *data = (const char *) archive->map + entry->offset;
+
+    if (entry->flags & ARCHIVE_ENTRY_LZ4) {
+        pthread_mutex_lock (archive->mutex);
+
+        if (!archive->decompressed[index]) {
+            void *buffer = malloc (entry->original_size ? entry->original_size : 1);
+            if (buffer) {
+                if (lz4_decompress (data, entry->size, buffer, entry->original_size) == entry->original_size)
+                    archive->decompressed[index] = buffer;
+
+                else {
+                    cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                        c_string_create ("Failed to decompress %.*s from archive %s!",
+                        (int) entry->name_length, archive->names + entry->name_offset,
+                        archive->filename->str));
+                    free (buffer);
+                }
+            }
+        }
+
+        data = archive->decompressed[index];
+
+        pthread_mutex_unlock (archive->mutex);
+    }
+
+    return data;
+
+}
+
+// returns a pointer to the contents of the file that is valid until the archive is closed
+// and sets size to its size, NULL if the file is not in the archive
+const void *archive_get_data (Archive *archive, const char *name, size_t *size) {
+
+    const void *data = NULL;
+
+    if (archive && name) {
+        char *normalized = assets_path_normalize (name);
+        if (normalized) {
+            long index = archive_find_index (archive, normalized);
+            if (index >= 0) {
+                data = archive_get_entry_data (archive, (u32) index);
+                if (data && size) *size = archive->entries[index].original_size;
+            }
+
+            free (normalized);
+        }
+    }
+
+    return data;
+
+}
+
+// returns a read only rwops of the file that does not copy it, it must be closed with SDL_RWclose ()
+// NULL if the file is not in the archive
+SDL_RWops *archive_open_rw (Archive *archive, const char *name) {
+
+    SDL_RWops *rw = NULL;
+
+    size_t size = 0;
+    const void *data = archive_get_data (archive, name, &size);
+    if (data) rw = SDL_RWFromConstMem (data, (int) size);
+
+    return rw;
+
+}
+
+#pragma endregion
+
+#pragma region Pack
+
+typedef struct ArchivePackEntry {
+
+    ArchiveEntry entry;
+    char *name;
+
+} ArchivePackEntry;
+
+static int archive_pack_entry_comparator (const void *a, const void *b) {
+
+    const ArchivePackEntry *entry_a = (const ArchivePackEntry *) a;
+    const ArchivePackEntry *entry_b = (const ArchivePackEntry *) b;
+
+    if (entry_a->entry.hash < entry_b->entry.hash) return -1;
+    if (entry_a->entry.hash > entry_b->entry.hash) return 1;
+
+    return strcmp (entry_a->name, entry_b->name);
+
+}
+
+// reads the file from the disk, even if it is in a mounted archive
+static void *archive_pack_read_file (const char *filename, size_t *size) {
+
+    void *contents = NULL;
+
+    FILE *file = fopen (filename, "rb");
+    if (file) {
+        struct stat filestatus;
+        if (!fstat (fileno (file), &filestatus) && S_ISREG (filestatus.st_mode)) {
+            *size = filestatus.st_size;
+            contents = malloc (*size ? *size : 1);
+            if (contents && *size && (fread (contents, *size, 1, file) != 1)) {
+                free (contents);
+                contents = NULL;
+            }
+        }
+
+        fclose (file);
+    }
+
+    return contents;
+
+}
+
+// writes zeros until the offset is a multiple of the alignment
+// returns 0 on success, 1 on error
+static u8 archive_pack_align (FILE *file, u64 *offset, u64 alignment) {
+
+    static const char zeros[ARCHIVE_ALIGNMENT] = { 0 };
+
+    u64 padding = (alignment - (*offset % alignment)) % alignment;
+    if (padding && (fwrite (zeros, padding, 1, file) != 1)) return 1;
+
+    *offset += padding;
+
+    return 0;
+
+}
+
+// writes the blob of the file at the end of the archive
+// returns 0 on success, 1 on error
+static u8 archive_pack_file (FILE *file, u64 *offset, ArchivePackEntry *pack_entry,
+    const char *filename, bool compress) {
+
+    u8 errors = 1;
+
+    size_t size = 0;
+    void *contents = archive_pack_read_file (filename, &size);
+    if (contents) {
+        const void *blob = contents;
+        size_t blob_size = size;
+
+        void *compressed = NULL;
+        if (compress && size) {
+            compressed = malloc (LZ4_COMPRESS_BOUND (size));
+            if (compressed) {
+                size_t compressed_size = lz4_compress (contents, size, compressed, LZ4_COMPRESS_BOUND (size));
+                if (compressed_size && (compressed_size <= size - (size / 8))) {
+                    blob = compressed;
+                    blob_size = compressed_size;
+                    pack_entry->entry.flags |= ARCHIVE_ENTRY_LZ4;
+                }
+            }
+        }
+
+        if (!archive_pack_align (file, offset, ARCHIVE_ALIGNMENT)) {
+            if (!blob_size || (fwrite (blob, blob_size, 1, file) == 1)) {
+                pack_entry->entry.offset = *offset;
+                pack_entry->entry.size = blob_size;
+                pack_entry->entry.original_size = size;
+
+                *offset += blob_size;
+                errors = 0;
+            }
+        }
+
+        free (compressed);
+        free (contents);
+    }
+
+    else {
+        cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+            c_string_create ("Failed to read %s!", filename));
+    }
+
+    return errors;
+
+}
+
+// writes the names & the table of contents after the blobs
+// returns 0 on success, 1 on error
+static u8 archive_pack_toc (FILE *file, u64 *offset, ArchiveHeader *header,
+    ArchivePackEntry *pack_entries, u32 n_entries) {
+
+    header->names_offset = *offset;
+    for (u32 i = 0; i < n_entries; i++) {
+        size_t name_length = strlen (pack_entries[i].name);
+        if ((header->names_size + name_length) > UINT_MAX) return 1;
+
+        pack_entries[i].entry.name_offset = (u32) header->names_size;
+        pack_entries[i].entry.name_length = (u32) name_length;
+
+        if (fwrite (pack_entries[i].name, name_length, 1, file) != 1) return 1;
+        header->names_size += name_length;
+    }
+
+    *offset += header->names_size;
+
+    if (archive_pack_align (file, offset, sizeof (u64))) return 1;
+
+    header->toc_offset = *offset;
+    for (u32 i = 0; i < n_entries; i++) {
+        if (fwrite (&pack_entries[i].entry, sizeof (ArchiveEntry), 1, file) != 1) return 1;
+        *offset += sizeof (ArchiveEntry);
+    }
+
+    return 0;
+
+}
+
+// packs the files (String list) into a new archive, each one is stored with its normalized path
+// compress stores with lz4 the blobs that get at least 1/8 smaller
+// returns 0 on success, 1 on error
+u8 archive_pack (const char *output, DoubleList *filenames, bool compress) {
+
+    u8 errors = 1;
+
+    if (output && filenames) {
+        u32 n_entries = (u32) filenames->size;
+        ArchivePackEntry *pack_entries = (ArchivePackEntry *) calloc (n_entries + 1, sizeof (ArchivePackEntry));
+        FILE *file = pack_entries ? fopen (output, "wb") : NULL;
+        if (file) {
+            ArchiveHeader header = { 0 };
+            memcpy (header.magic, ARCHIVE_MAGIC, sizeof (header.magic));
+            header.version = ARCHIVE_VERSION;
+            header.n_entries = n_entries;
+
+            // the header is written again at the end with the offsets
+            u64 offset = sizeof (ArchiveHeader);
+            errors = (fwrite (&header, sizeof (ArchiveHeader), 1, file) != 1);
+
+            u32 i = 0;
+            for (ListElement *le = dlist_start (filenames); le && !errors; le = le->next, i++) {
+                String *filename = (String *) le->data;
+
+                pack_entries[i].name = assets_path_normalize (filename->str);
+                if (pack_entries[i].name) {
+                    pack_entries[i].entry.hash = archive_hash (pack_entries[i].name, strlen (pack_entries[i].name));
+                    errors = archive_pack_file (file, &offset, &pack_entries[i], filename->str, compress);
+                }
+
+                else errors = 1;
+            }
+
+            if (!errors) {
+                qsort (pack_entries, n_entries, sizeof (ArchivePackEntry), archive_pack_entry_comparator);
+
+                for (i = 1; i < n_entries; i++) {
+                    if (!archive_pack_entry_comparator (&pack_entries[i - 1], &pack_entries[i])) {
+                        cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                            c_string_create ("%s is more than once in the archive!", pack_entries[i].name));
+                        errors = 1;
+                    }
+                }
+            }
+
+            if (!errors) errors = archive_pack_toc (file, &offset, &header, pack_entries, n_entries);
+
+            if (!errors) {
+                header.file_size = offset;
+                errors = fseek (file, 0, SEEK_SET) || (fwrite (&header, sizeof (ArchiveHeader), 1, file) != 1);
+            }
+
+            if (fclose (file)) errors = 1;
+            if (errors) remove (output);
+        }
+
+        if (errors) {
+            cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                c_string_create ("Failed to pack archive %s!", output));
+        }
+
+        if (pack_entries) {
+            for (u32 i = 0; i < n_entries; i++) free (pack_entries[i].name);
+            free (pack_entries);
+        }
+    }
+
+    return errors;
+
+}
+
+#pragma endregion
+
+#pragma region Mounted
+
+// mounts the archive, so files_* & every asset loader look for their files in it
+// before going to the disk, archives mounted later are searched first
+// returns 0 on success, 1 on error
+u8 archive_mount (const char *filename) {
+
+    u8 errors = 1;
+
+    if (filename) {
+        Archive *archive = archive_open (filename);
+        if (archive) {
+            pthread_mutex_lock (&mounted_mutex);
+
+            if (n_mounted < ARCHIVE_MAX_MOUNTED) {
+                mounted[n_mounted] = archive;
+                n_mounted += 1;
+                errors = 0;
+            }
+
+            pthread_mutex_unlock (&mounted_mutex);
+
+            if (errors) {
+                cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                    c_string_create ("Failed to mount %s, there are already %d archives mounted!",
+                    filename, ARCHIVE_MAX_MOUNTED));
+                archive_close (archive);
+            }
+        }
+    }
+
+    return errors;
+
+}
+
+// unmounts the archive, nothing should be loading from it
+// returns 0 on success, 1 if it was not mounted
+u8 archive_unmount (const char *filename) {
+
+    u8 errors = 1;
+
+    if (filename) {
+        Archive *archive = NULL;
+
+        pthread_mutex_lock (&mounted_mutex);
+
+        for (unsigned int i = 0; i < n_mounted; i++) {
+            if (!strcmp (mounted[i]->filename->str, filename)) {
+                archive = mounted[i];
+                memmove (&mounted[i], &mounted[i + 1], (n_mounted - i - 1) * sizeof (Archive *));
+                n_mounted -= 1;
+                break;
+            }
+        }
+
+        pthread_mutex_unlock (&mounted_mutex);
+
+        if (archive) {
+            archive_close (archive);
+            errors = 0;
+        }
+    }
+
+    return errors;
+
+}
+
+// unmounts every archive, it is called by cengine_end ()
+void archive_unmount_all (void) {
+
+    pthread_mutex_lock (&mounted_mutex);
+
+    for (unsigned int i = 0; i < n_mounted; i++) {
+        archive_close (mounted[i]);
+        mounted[i] = NULL;
+    }
+
+    n_mounted = 0;
+
+    pthread_mutex_unlock (&mounted_mutex);
+
+}
+
+// searches the file in the mounted archives
+// returns a pointer to its contents, NULL if it is not in any of them
+const void *archives_get_data (const char *name, size_t *size) {
+
+    const void *data = NULL;
+
+    if (name) {
+        pthread_mutex_lock (&mounted_mutex);
+
+        if (n_mounted) {
+            char *normalized = assets_path_normalize (name);
+            if (normalized) {
+                for (int i = (int) n_mounted - 1; (i >= 0) && !data; i--) {
+                    long index = archive_find_index (mounted[i], normalized);
+                    if (index >= 0) {
+                        data = archive_get_entry_data (mounted[i], (u32) index);
+                        if (data && size) *size = mounted[i]->entries[index].original_size;
+                    }
+                }
+
+                free (normalized);
+            }
+        }
+
+        pthread_mutex_unlock (&mounted_mutex);
+    }
+
+    return data;
+
+}
+
+// searches the file in the mounted archives
+// returns a read only rwops of the file, NULL if it is not in any of them
+SDL_RWops *archives_open_rw (const char *name) {
+
+    SDL_RWops *rw = NULL;
+
+    size_t size = 0;
+    const void *data = archives_get_data (name, &size);
+    if (data) rw = SDL_RWFromConstMem (data, (int) size);
+
+    return rw;
+
+}
+
+#pragma endregion
@@ -1,9 +1,21 @@
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <pthread.h>
 
 #include "cengine/types/types.h"
 #include "cengine/types/string.h"
 
+#include "cengine/collections/hashmap.h"
+
+#include "cengine/assets.h"
+#include "cengine/renderer.h"
+#include "cengine/sprites.h"
+#include "cengine/textures.h"
+
 #include "cengine/utils/log.h"
+#include "cengine/utils/utils.h"
 
 const String *cengine_assets_path = NULL;
 
@@ -45,12 +57,473 @@ u8 ui_default_assets_load (void) {
 
 }
 
+static void assets_cache_end (void);
+
 u8 assets_end (void) {
 
+    assets_cache_end ();
+
     str_delete ((String *) cengine_assets_path);
 
     str_delete ((String *) ui_default_assets_path);
 
     return 0;
 
-}
\ No newline at end of file
+}
+/*** Cache ***/
+
+#pragma region Cache
+
+// everything in the cache is protected by its mutex
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cache_cond = PTHREAD_COND_INITIALIZER;          // signaled when an entry ends loading
+
+static HashMap *cache_entries = NULL;               // key -> entry, owns the entries
+static HashMap *cache_assets = NULL;                // asset ptr -> entry
+
+static AssetEntry *lru_head = NULL;                 // the least recently used
+static AssetEntry *lru_tail = NULL;
+
+static AssetsCacheStats cache_stats = { .budget = DEFAULT_ASSETS_CACHE_BUDGET };
+
+static AssetEntry *asset_entry_new (const char *key, AssetType type, Renderer *renderer, void *data) {
+
+    AssetEntry *entry = (AssetEntry *) malloc (sizeof (AssetEntry));
+    if (entry) {
+        memset (entry, 0, sizeof (AssetEntry));
+
+        entry->key = str_new (key);
+        entry->type = type;
+
+        entry->renderer = renderer;
+        entry->data = data;
+
+        entry->lru_prev = entry->lru_next = NULL;
+    }
+
+    return entry;
+
+}
+
+// destroys the asset, its texture is destroyed in the render thread
+static void asset_destroy (AssetType type, Renderer *renderer, void *data) {
+
+    if (data) {
+        switch (type) {
+            case ASSET_TYPE_SPRITE: {
+                Sprite *sprite = (Sprite *) data;
+                if (sprite->texture && !sprite->atlas) texture_destroy (renderer, sprite->texture);
+                sprite->texture = NULL;
+                sprite_destroy (sprite);
+            } break;
+
+            case ASSET_TYPE_SPRITE_SHEET: {
+                SpriteSheet *sprite_sheet = (SpriteSheet *) data;
+                if (sprite_sheet->texture && !sprite_sheet->atlas) texture_destroy (renderer, sprite_sheet->texture);
+                sprite_sheet->texture = NULL;
+                sprite_sheet_destroy (sprite_sheet);
+            } break;
+
+            default: break;
+        }
+    }
+
+}
+
+static void asset_entry_delete (void *entry_ptr) {
+
+    if (entry_ptr) {
+        AssetEntry *entry = (AssetEntry *) entry_ptr;
+
+        asset_destroy (entry->type, entry->renderer, entry->data);
+
+        str_delete (entry->key);
+
+        free (entry);
+    }
+
+}
+
+static void assets_lru_remove (AssetEntry *entry) {
+
+    if (entry->lru_prev) entry->lru_prev->lru_next = entry->lru_next;
+    else lru_head = entry->lru_next;
+
+    if (entry->lru_next) entry->lru_next->lru_prev = entry->lru_prev;
+    else lru_tail = entry->lru_prev;
+
+    entry->lru_prev = entry->lru_next = NULL;
+
+    cache_stats.n_unreferenced -= 1;
+    cache_stats.bytes_unreferenced -= entry->bytes;
+
+}
+
+static void assets_lru_push (AssetEntry *entry) {
+
+    entry->lru_prev = lru_tail;
+    entry->lru_next = NULL;
+
+    if (lru_tail) lru_tail->lru_next = entry;
+    else lru_head = entry;
+
+    lru_tail = entry;
+
+    cache_stats.n_unreferenced += 1;
+    cache_stats.bytes_unreferenced += entry->bytes;
+
+}
+
+// a texture that the render thread has not created yet can not be destroyed
+static bool assets_entry_can_evict (AssetEntry *entry) {
+
+    if (entry->type == ASSET_TYPE_SPRITE) {
+        Sprite *sprite = (Sprite *) entry->data;
+        return sprite->atlas || sprite->texture;
+    }
+
+    SpriteSheet *sprite_sheet = (SpriteSheet *) entry->data;
+    return sprite_sheet->atlas || sprite_sheet->texture;
+
+}
+
+// removes the entry from the cache, the cache mutex must be locked
+static void assets_cache_remove (AssetEntry *entry) {
+
+    assets_lru_remove (entry);
+
+    hashmap_remove (cache_assets, &entry->data, sizeof (void *));
+    hashmap_remove (cache_entries, entry->key->str, entry->key->len);
+
+    cache_stats.n_entries -= 1;
+    cache_stats.bytes_resident -= entry->bytes;
+
+}
+
+// evicts the least recently used entries without references until the cache fits in its budget
+// the evicted entries are returned in a list, so they can be deleted without the lock
+static AssetEntry *assets_cache_evict (size_t budget) {
+
+    AssetEntry *evicted = NULL;
+
+    AssetEntry *entry = lru_head;
+    while (entry && (cache_stats.bytes_resident > budget)) {
+        AssetEntry *next = entry->lru_next;
+
+        if (assets_entry_can_evict (entry)) {
+            assets_cache_remove (entry);
+
+            entry->lru_next = evicted;
+            evicted = entry;
+
+            cache_stats.evictions += 1;
+        }
+
+        entry = next;
+    }
+
+    return evicted;
+
+}
+
+static void assets_cache_delete_evicted (AssetEntry *evicted) {
+
+    while (evicted) {
+        AssetEntry *next = evicted->lru_next;
+        asset_entry_delete (evicted);
+        evicted = next;
+    }
+
+}
+
+void assets_cache_set_budget (size_t bytes) {
+
+    pthread_mutex_lock (&cache_mutex);
+
+    cache_stats.budget = bytes;
+    AssetEntry *evicted = assets_cache_evict (cache_stats.budget);
+
+    pthread_mutex_unlock (&cache_mutex);
+
+    assets_cache_delete_evicted (evicted);
+
+}
+
+char *assets_path_normalize (const char *path) {
+
+    char *normalized = NULL;
+
+    if (path) {
+        size_t len = strlen (path);
+        normalized = (char *) malloc (len + 2);
+        if (normalized) {
+            bool absolute = (path[0] == '/');
+            size_t out = 0;
+            size_t root = 0;             // ".." can not go before it
+            if (absolute) normalized[out++] = '/';
+
+            const char *c = path;
+            while (*c) {
+                while (*c == '/') c++;
+                if (!*c) break;
+
+                const char *end = c;
+                while (*end && (*end != '/')) end++;
+                size_t component_len = end - c;
+
+                if ((component_len == 1) && (c[0] == '.')) {
+                    // nothing to add
+                }
+
+                else if ((component_len == 2) && (c[0] == '.') && (c[1] == '.') && (out > root)) {
+                    // remove the last component
+                    while ((out > root) && (normalized[out - 1] == '/')) out--;
+                    while ((out > root) && (normalized[out - 1] != '/')) out--;
+                }
+
+                else {
+                    if ((out > 0) && (normalized[out - 1] != '/')) normalized[out++] = '/';
+                    memcpy (normalized + out, c, component_len);
+                    out += component_len;
+
+                    // a relative path that starts going up keeps those components
+                    if ((component_len == 2) && (c[0] == '.') && (c[1] == '.')) root = out;
+                }
+
+                c = end;
+            }
+
+            if (!out) normalized[out++] = '.';
+            normalized[out] = '\0';
+        }
+    }
+
+    return normalized;
+
+}
+
+static char *assets_cache_key (AssetType type, const char *filename, Renderer *renderer) {
+
+    char *key = NULL;
+
+    char *normalized = assets_path_normalize (filename);
+    if (normalized) {
+        key = c_string_create ("%d:%lu:%s", type, (unsigned long) renderer->id, normalized);
+        free (normalized);
+    }
+
+    return key;
+
+}
+
+static void *assets_load (AssetType type, const char *filename, Renderer *renderer, size_t *bytes) {
+
+    void *asset = NULL;
+
+    if (type == ASSET_TYPE_SPRITE) {
+        Sprite *sprite = sprite_load (filename, renderer);
+        if (sprite) *bytes = sprite->atlas ? 0 : (size_t) sprite->w * sprite->h * 4;
+        asset = sprite;
+    }
+
+    else {
+        SpriteSheet *sprite_sheet = sprite_sheet_load (filename, renderer);
+        if (sprite_sheet) *bytes = sprite_sheet->atlas ? 0 : (size_t) sprite_sheet->w * sprite_sheet->h * 4;
+        asset = sprite_sheet;
+    }
+
+    return asset;
+
+}
+
+// returns the asset with a new reference, loading it if it is not in the cache
+// the load is done without the lock, and the ones that ask for the same file meanwhile wait for it
+static void *assets_get (AssetType type, const char *filename, Renderer *renderer) {
+
+    void *asset = NULL;
+
+    char *key = (filename && renderer) ? assets_cache_key (type, filename, renderer) : NULL;
+    if (key) {
+        size_t key_size = strlen (key);
+
+        AssetEntry *entry = NULL;
+        AssetEntry *failed = NULL;
+        bool load = false;
+
+        pthread_mutex_lock (&cache_mutex);
+
+        if (!cache_entries) {
+            cache_entries = hashmap_create (0, asset_entry_delete);
+            cache_assets = hashmap_create (0, NULL);
+        }
+
+        if (cache_entries && cache_assets) {
+            entry = (AssetEntry *) hashmap_get (cache_entries, key, key_size);
+            if (entry) {
+                if (!entry->refs) assets_lru_remove (entry);
+                entry->refs += 1;
+
+                cache_stats.hits += 1;
+
+                while (entry->loading) pthread_cond_wait (&cache_cond, &cache_mutex);
+
+                // the load failed and the entry is no longer in the cache
+                asset = entry->data;
+                if (!asset) {
+                    entry->refs -= 1;
+                    if (!entry->refs) failed = entry;
+                }
+            }
+
+            else {
+                entry = asset_entry_new (key, type, renderer, NULL);
+                if (entry && !hashmap_insert (cache_entries, key, key_size, entry, sizeof (AssetEntry))) {
+                    entry->loading = true;
+                    entry->refs = 1;
+                    load = true;
+
+                    cache_stats.misses += 1;
+                }
+
+                else {
+                    asset_entry_delete (entry);
+                    entry = NULL;
+                }
+            }
+        }
+
+        pthread_mutex_unlock (&cache_mutex);
+
+        if (load) {
+            size_t bytes = 0;
+            asset = assets_load (type, filename, renderer, &bytes);
+
+            AssetEntry *evicted = NULL;
+            void *lost = NULL;
+
+            pthread_mutex_lock (&cache_mutex);
+
+            entry->loading = false;
+            if (asset && !hashmap_insert (cache_assets, &asset, sizeof (void *), entry, sizeof (AssetEntry))) {
+                entry->data = asset;
+                entry->bytes = bytes;
+
+                cache_stats.n_entries += 1;
+                cache_stats.bytes_resident += bytes;
+
+                evicted = assets_cache_evict (cache_stats.budget);
+            }
+
+            else {
+                // the ones waiting for it get NULL, and the last one deletes the entry
+                hashmap_remove (cache_entries, key, key_size);
+                entry->refs -= 1;
+                if (!entry->refs) failed = entry;
+
+                lost = asset;
+                asset = NULL;
+            }
+
+            pthread_cond_broadcast (&cache_cond);
+
+            pthread_mutex_unlock (&cache_mutex);
+
+            assets_cache_delete_evicted (evicted);
+            if (lost) asset_destroy (type, renderer, lost);
+        }
+
+        asset_entry_delete (failed);
+
+        free (key);
+    }
+
+    return asset;
+
+}
+
+Sprite *assets_get_sprite (const char *filename, Renderer *renderer) {
+
+    return (Sprite *) assets_get (ASSET_TYPE_SPRITE, filename, renderer);
+
+}
+
+SpriteSheet *assets_get_sprite_sheet (const char *filename, Renderer *renderer) {
+
+    return (SpriteSheet *) assets_get (ASSET_TYPE_SPRITE_SHEET, filename, renderer);
+
+}
+
+u8 assets_release (const void *asset) {
+
+    u8 retval = 1;
+
+    if (asset) {
+        AssetEntry *evicted = NULL;
+
+        pthread_mutex_lock (&cache_mutex);
+
+        AssetEntry *entry = cache_assets ? (AssetEntry *) hashmap_get (cache_assets, &asset, sizeof (void *)) : NULL;
+        if (entry && entry->refs) {
+            entry->refs -= 1;
+            if (!entry->refs) {
+                assets_lru_push (entry);
+                evicted = assets_cache_evict (cache_stats.budget);
+            }
+
+            retval = 0;
+        }
+
+        pthread_mutex_unlock (&cache_mutex);
+
+        assets_cache_delete_evicted (evicted);
+    }
+
+    return retval;
+
+}
+
+void assets_cache_clear (void) {
+
+    pthread_mutex_lock (&cache_mutex);
+
+    AssetEntry *evicted = assets_cache_evict (0);
+
+    pthread_mutex_unlock (&cache_mutex);
+
+    assets_cache_delete_evicted (evicted);
+
+}
+
+AssetsCacheStats assets_cache_get_stats (void) {
+
+    pthread_mutex_lock (&cache_mutex);
+
+    AssetsCacheStats stats = cache_stats;
+
+    pthread_mutex_unlock (&cache_mutex);
+
+    return stats;
+
+}
+
+// deletes every entry, even the referenced ones, as the renderers are about to be destroyed
+static void assets_cache_end (void) {
+
+    pthread_mutex_lock (&cache_mutex);
+
+    hashmap_delete (cache_assets);
+    cache_assets = NULL;
+
+    hashmap_delete (cache_entries);
+    cache_entries = NULL;
+
+    lru_head = lru_tail = NULL;
+
+    AssetsCacheStats empty = { .budget = cache_stats.budget };
+    cache_stats = empty;
+
+    pthread_mutex_unlock (&cache_mutex);
+
+}
+
+#pragma endregion
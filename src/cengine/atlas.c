@@ -0,0 +1,754 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include "cengine/types/types.h"
+#include "cengine/types/string.h"
+
+#include "cengine/collections/hashmap.h"
+
+#include "cengine/atlas.h"
+#include "cengine/files.h"
+#include "cengine/graphics.h"
+#include "cengine/renderer.h"
+#include "cengine/sprites.h"
+
+#include "cengine/utils/json.h"
+#include "cengine/utils/log.h"
+#include "cengine/utils/utils.h"
+
+/*** Misc ***/
+
+#pragma region Misc
+
+static inline SDL_Surface *atlas_create_surface (u32 width, u32 height) {
+
+    #if SDL_BYTEORDER == SDL_BIG_ENDIAN
+        return SDL_CreateRGBSurface (SDL_SWSURFACE, width, height, 32,
+            0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF);
+    #else
+        return SDL_CreateRGBSurface (SDL_SWSURFACE, width, height, 32,
+            0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000);
+    #endif
+
+}
+
+static AtlasRegion *atlas_region_new (const char *name, u8 page, SDL_Rect rect) {
+
+    AtlasRegion *region = (AtlasRegion *) malloc (sizeof (AtlasRegion));
+    if (region) {
+        region->name = str_new (name);
+        region->page = page;
+        region->rect = rect;
+    }
+
+    return region;
+
+}
+
+static void atlas_region_delete (void *region_ptr) {
+
+    if (region_ptr) {
+        AtlasRegion *region = (AtlasRegion *) region_ptr;
+
+        str_delete (region->name);
+
+        free (region);
+    }
+
+}
+
+#pragma endregion
+
+/*** Skyline ***/
+
+#pragma region Skyline
+
+// the skyline starts as a single node at the bottom of the page
+static int atlas_page_init (AtlasPage *page, u32 page_size, bool full) {
+
+    page->skyline = (AtlasSkylineNode *) calloc (8, sizeof (AtlasSkylineNode));
+    if (!page->skyline) return 1;
+
+    page->nodes_size = 8;
+    page->n_nodes = 1;
+
+    // a full page has its skyline at the top, so nothing else fits in it
+    page->skyline[0].x = 0;
+    page->skyline[0].y = full ? page_size : 0;
+    page->skyline[0].w = page_size;
+
+    return 0;
+
+}
+
+// returns the y where a rect can be placed with its left side at the node, -1 if it does not fit
+static i64 atlas_skyline_fit (AtlasPage *page, u32 page_size, u32 idx, u32 w, u32 h) {
+
+    u32 x = page->skyline[idx].x;
+    if (x + w > page_size) return -1;
+
+    u32 y = 0;
+    i64 width_left = w;
+    for (u32 i = idx; (width_left > 0) && (i < page->n_nodes); i++) {
+        if (page->skyline[i].y > y) y = page->skyline[i].y;
+        if (y + h > page_size) return -1;
+
+        width_left -= page->skyline[i].w;
+    }
+
+    return y;
+
+}
+
+// finds the place where the rect ends lower in the page, and between the ones that are
+// as low as it, the one that wastes the less width
+// returns the idx of the node, -1 if it does not fit in the page
+static i64 atlas_skyline_find (AtlasPage *page, u32 page_size, u32 w, u32 h, u32 *x, u32 *y) {
+
+    i64 best_idx = -1;
+    u32 best_bottom = (u32) -1;
+    u32 best_width = (u32) -1;
+
+    for (u32 i = 0; i < page->n_nodes; i++) {
+        i64 fit_y = atlas_skyline_fit (page, page_size, i, w, h);
+        if (fit_y >= 0) {
+            u32 bottom = (u32) fit_y + h;
+            if ((bottom < best_bottom) || ((bottom == best_bottom) && (page->skyline[i].w < best_width))) {
+                best_idx = i;
+                best_bottom = bottom;
+                best_width = page->skyline[i].w;
+
+                *x = page->skyline[i].x;
+                *y = (u32) fit_y;
+            }
+        }
+    }
+
+    return best_idx;
+
+}
+
+// raises the skyline where the rect was placed
+// returns 0 on success, 1 on error
+static int atlas_skyline_add (AtlasPage *page, u32 idx, u32 x, u32 y, u32 w, u32 h) {
+
+    if (page->n_nodes + 1 > page->nodes_size) {
+        AtlasSkylineNode *skyline = (AtlasSkylineNode *) realloc (page->skyline,
+            page->nodes_size * 2 * sizeof (AtlasSkylineNode));
+        if (!skyline) return 1;
+
+        page->skyline = skyline;
+        page->nodes_size *= 2;
+    }
+
+    memmove (&page->skyline[idx + 1], &page->skyline[idx], (page->n_nodes - idx) * sizeof (AtlasSkylineNode));
+    page->skyline[idx].x = x;
+    page->skyline[idx].y = y + h;
+    page->skyline[idx].w = w;
+    page->n_nodes += 1;
+
+    // the nodes that are under the new one are shrinked or removed
+    u32 i = idx + 1;
+    while (i < page->n_nodes) {
+        AtlasSkylineNode *prev = &page->skyline[i - 1];
+        AtlasSkylineNode *node = &page->skyline[i];
+
+        if (node->x >= prev->x + prev->w) break;
+
+        u32 shrink = prev->x + prev->w - node->x;
+        if (node->w <= shrink) {
+            memmove (node, node + 1, (page->n_nodes - i - 1) * sizeof (AtlasSkylineNode));
+            page->n_nodes -= 1;
+        }
+
+        else {
+            node->x += shrink;
+            node->w -= shrink;
+            break;
+        }
+    }
+
+    // nodes at the same height become a single one
+    for (i = 0; i + 1 < page->n_nodes; ) {
+        if (page->skyline[i].y == page->skyline[i + 1].y) {
+            page->skyline[i].w += page->skyline[i + 1].w;
+            memmove (&page->skyline[i + 1], &page->skyline[i + 2],
+                (page->n_nodes - i - 2) * sizeof (AtlasSkylineNode));
+            page->n_nodes -= 1;
+        }
+
+        else i++;
+    }
+
+    return 0;
+
+}
+
+// finds a place for a w x h rect, in a new page if it does not fit in the others
+// returns 0 on success, 1 if there is no space left
+static int atlas_pack (Atlas *atlas, u32 w, u32 h, u8 *page_idx, SDL_Rect *rect) {
+
+    // leave some empty space to the right & bottom of every region
+    u32 padded_w = w + ATLAS_PADDING;
+    u32 padded_h = h + ATLAS_PADDING;
+    if ((padded_w > atlas->page_size) || (padded_h > atlas->page_size)) return 1;
+
+    u32 x = 0, y = 0;
+    i64 idx = -1;
+    u8 p = 0;
+    for (; p < atlas->n_pages; p++) {
+        idx = atlas_skyline_find (&atlas->pages[p], atlas->page_size, padded_w, padded_h, &x, &y);
+        if (idx >= 0) break;
+    }
+
+    if (idx < 0) {
+        if (atlas->n_pages >= ATLAS_MAX_PAGES) return 1;
+
+        AtlasPage *page = &atlas->pages[atlas->n_pages];
+        page->surface = atlas_create_surface (atlas->page_size, atlas->page_size);
+        if (!page->surface) return 1;
+
+        if (atlas_page_init (page, atlas->page_size, false)) {
+            SDL_FreeSurface (page->surface);
+            page->surface = NULL;
+            return 1;
+        }
+
+        p = atlas->n_pages;
+        atlas->n_pages += 1;
+
+        idx = atlas_skyline_find (page, atlas->page_size, padded_w, padded_h, &x, &y);
+    }
+
+    if (atlas_skyline_add (&atlas->pages[p], (u32) idx, x, y, padded_w, padded_h)) return 1;
+
+    rect->x = x;
+    rect->y = y;
+    rect->w = w;
+    rect->h = h;
+    *page_idx = p;
+
+    return 0;
+
+}
+
+#pragma endregion
+
+/*** Atlas ***/
+
+#pragma region Atlas
+
+static Atlas *atlas_new (void) {
+
+    Atlas *atlas = (Atlas *) malloc (sizeof (Atlas));
+    if (atlas) {
+        memset (atlas, 0, sizeof (Atlas));
+
+        atlas->name = NULL;
+        atlas->regions_map = NULL;
+        atlas->regions = NULL;
+        atlas->mutex = NULL;
+    }
+
+    return atlas;
+
+}
+
+void atlas_delete (void *atlas_ptr) {
+
+    if (atlas_ptr) {
+        Atlas *atlas = (Atlas *) atlas_ptr;
+
+        str_delete (atlas->name);
+
+        for (u8 i = 0; i < atlas->n_pages; i++) {
+            if (atlas->pages[i].surface) SDL_FreeSurface (atlas->pages[i].surface);
+            if (atlas->pages[i].texture) SDL_DestroyTexture (atlas->pages[i].texture);
+            if (atlas->pages[i].skyline) free (atlas->pages[i].skyline);
+        }
+
+        // the map owns the regions
+        hashmap_delete (atlas->regions_map);
+        if (atlas->regions) free (atlas->regions);
+
+        if (atlas->mutex) {
+            pthread_mutex_destroy (atlas->mutex);
+            free (atlas->mutex);
+        }
+
+        free (atlas);
+    }
+
+}
+
+Atlas *atlas_create (const char *name, u32 page_size) {
+
+    Atlas *atlas = atlas_new ();
+    if (atlas) {
+        atlas->name = name ? str_new (name) : NULL;
+        atlas->page_size = page_size ? page_size : ATLAS_DEFAULT_PAGE_SIZE;
+
+        atlas->regions_map = hashmap_create (ATLAS_INIT_REGIONS, atlas_region_delete);
+        atlas->regions = (AtlasRegion **) calloc (ATLAS_INIT_REGIONS, sizeof (AtlasRegion *));
+        atlas->regions_size = ATLAS_INIT_REGIONS;
+
+        atlas->mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+        if (atlas->mutex) pthread_mutex_init (atlas->mutex, NULL);
+
+        if (!atlas->regions_map || !atlas->regions || !atlas->mutex) {
+            atlas_delete (atlas);
+            atlas = NULL;
+        }
+    }
+
+    return atlas;
+
+}
+
+// adds a new region to the map & to the regions list, the atlas mutex must be locked
+// returns the region, NULL on error
+static AtlasRegion *atlas_region_register (Atlas *atlas, const char *name, u8 page, SDL_Rect rect) {
+
+    if (atlas->n_regions >= atlas->regions_size) {
+        AtlasRegion **regions = (AtlasRegion **) realloc (atlas->regions,
+            atlas->regions_size * 2 * sizeof (AtlasRegion *));
+        if (!regions) return NULL;
+
+        atlas->regions = regions;
+        atlas->regions_size *= 2;
+    }
+
+    AtlasRegion *region = atlas_region_new (name, page, rect);
+    if (region) {
+        if (!hashmap_insert (atlas->regions_map, name, strlen (name), region, sizeof (AtlasRegion))) {
+            atlas->regions[atlas->n_regions] = region;
+            atlas->n_regions += 1;
+        }
+
+        else {
+            atlas_region_delete (region);
+            region = NULL;
+        }
+    }
+
+    return region;
+
+}
+
+const AtlasRegion *atlas_add_surface (Atlas *atlas, const char *name, SDL_Surface *surface) {
+
+    const AtlasRegion *region = NULL;
+
+    if (atlas && name && surface) {
+        pthread_mutex_lock (atlas->mutex);
+
+        region = (const AtlasRegion *) hashmap_get (atlas->regions_map, name, strlen (name));
+        if (!region) {
+            u8 page_idx = 0;
+            SDL_Rect rect = { 0, 0, 0, 0 };
+            if (!atlas_pack (atlas, surface->w, surface->h, &page_idx, &rect)) {
+                AtlasPage *page = &atlas->pages[page_idx];
+
+                // copy the pixels as they are, including alpha
+                SDL_BlendMode blend_mode = SDL_BLENDMODE_NONE;
+                SDL_GetSurfaceBlendMode (surface, &blend_mode);
+                SDL_SetSurfaceBlendMode (surface, SDL_BLENDMODE_NONE);
+                SDL_Rect dest = rect;
+                SDL_BlitSurface (surface, NULL, page->surface, &dest);
+                SDL_SetSurfaceBlendMode (surface, blend_mode);
+
+                if (page->dirty) SDL_UnionRect (&page->dirty_rect, &rect, &page->dirty_rect);
+                else {
+                    page->dirty_rect = rect;
+                    page->dirty = true;
+                }
+
+                region = atlas_region_register (atlas, name, page_idx, rect);
+            }
+
+            else {
+                cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                    c_string_create ("Failed to add %s to atlas, no space left!", name));
+            }
+        }
+
+        pthread_mutex_unlock (atlas->mutex);
+    }
+
+    return region;
+
+}
+
+const AtlasRegion *atlas_add_image (Atlas *atlas, const char *filename) {
+
+    const AtlasRegion *region = NULL;
+
+    if (atlas && filename) {
+        region = atlas_get_region (atlas, filename);
+        if (!region) {
+            SDL_Surface *surface = IMG_Load_RW (file_open_rw (filename), 1);
+            if (surface) {
+                region = atlas_add_surface (atlas, filename, surface);
+                SDL_FreeSurface (surface);
+            }
+
+            else {
+                cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                    c_string_create ("Failed to load asset: %s!", filename));
+            }
+        }
+    }
+
+    return region;
+
+}
+
+const AtlasRegion *atlas_get_region (Atlas *atlas, const char *name) {
+
+    const AtlasRegion *region = NULL;
+
+    if (atlas && name) {
+        pthread_mutex_lock (atlas->mutex);
+        region = (const AtlasRegion *) hashmap_get (atlas->regions_map, name, strlen (name));
+        pthread_mutex_unlock (atlas->mutex);
+    }
+
+    return region;
+
+}
+
+SDL_Texture *atlas_get_page_texture (Atlas *atlas, Renderer *renderer, u8 page_idx) {
+
+    SDL_Texture *texture = NULL;
+
+    if (atlas && renderer) {
+        pthread_mutex_lock (atlas->mutex);
+
+        if (page_idx < atlas->n_pages) {
+            AtlasPage *page = &atlas->pages[page_idx];
+            if (!page->texture) {
+                page->texture = SDL_CreateTextureFromSurface (renderer->renderer, page->surface);
+                if (page->texture) SDL_SetTextureBlendMode (page->texture, SDL_BLENDMODE_BLEND);
+                page->dirty = false;
+            }
+
+            else if (page->dirty) {
+                // only upload the part of the page that changed
+                u8 *pixels = (u8 *) page->surface->pixels
+                    + page->dirty_rect.y * page->surface->pitch
+                    + page->dirty_rect.x * page->surface->format->BytesPerPixel;
+                SDL_UpdateTexture (page->texture, &page->dirty_rect, pixels, page->surface->pitch);
+                page->dirty = false;
+            }
+
+            texture = page->texture;
+        }
+
+        pthread_mutex_unlock (atlas->mutex);
+    }
+
+    return texture;
+
+}
+
+Sprite *atlas_sprite_load (Atlas *atlas, const char *filename) {
+
+    Sprite *sprite = NULL;
+
+    if (atlas && filename) {
+        const AtlasRegion *region = atlas_add_image (atlas, filename);
+        if (region) {
+            sprite = sprite_new ();
+            if (sprite) {
+                sprite->atlas = atlas;
+                sprite->atlas_page = region->page;
+
+                sprite->img_data = image_data_new (region->rect.w, region->rect.h, str_new (filename));
+
+                // dimensions
+                sprite->dest_rect.w = sprite->w = region->rect.w;
+                sprite->dest_rect.h = sprite->h = region->rect.h;
+
+                // the source is where the image is inside the page
+                sprite->src_rect = region->rect;
+            }
+        }
+    }
+
+    return sprite;
+
+}
+
+SpriteSheet *atlas_sprite_sheet_load (Atlas *atlas, const char *filename) {
+
+    SpriteSheet *sprite_sheet = NULL;
+
+    if (atlas && filename) {
+        const AtlasRegion *region = atlas_add_image (atlas, filename);
+        if (region) {
+            sprite_sheet = sprite_sheet_new ();
+            if (sprite_sheet) {
+                sprite_sheet->atlas = atlas;
+                sprite_sheet->atlas_page = region->page;
+                sprite_sheet->region = region->rect;
+
+                sprite_sheet->img_data = image_data_new (region->rect.w, region->rect.h, str_new (filename));
+
+                sprite_sheet->w = region->rect.w;
+                sprite_sheet->h = region->rect.h;
+
+                // frames are selected using sprite_sheet_set_frame ()
+                sprite_sheet->src_rect.x = region->rect.x;
+                sprite_sheet->src_rect.y = region->rect.y;
+            }
+        }
+    }
+
+    return sprite_sheet;
+
+}
+
+#pragma endregion
+
+/*** Offline ***/
+
+#pragma region Offline
+
+static void atlas_json_write_string (FILE *file, const char *string) {
+
+    fputc ('"', file);
+    for (const char *c = string; *c; c++) {
+        if ((*c == '"') || (*c == '\\')) fputc ('\\', file);
+        fputc (*c, file);
+    }
+    fputc ('"', file);
+
+}
+
+// returns the filename of a page of the atlas baked in path
+static char *atlas_page_filename (const char *path, u8 page_idx) {
+
+    return c_string_create ("%s_%d.png", path, page_idx);
+
+}
+
+// only the rows that have regions are saved
+static int atlas_bake_page (AtlasPage *page, const char *filename) {
+
+    int retval = 1;
+
+    u32 used_h = 0;
+    for (u32 i = 0; i < page->n_nodes; i++)
+        if (page->skyline[i].y > used_h) used_h = page->skyline[i].y;
+
+    if (used_h > (u32) page->surface->h) used_h = page->surface->h;
+    if (!used_h) used_h = 1;
+
+    SDL_Surface *used = SDL_CreateRGBSurfaceFrom (page->surface->pixels,
+        page->surface->w, used_h, 32, page->surface->pitch,
+        page->surface->format->Rmask, page->surface->format->Gmask,
+        page->surface->format->Bmask, page->surface->format->Amask);
+    if (used) {
+        retval = IMG_SavePNG (used, filename) ? 1 : 0;
+        SDL_FreeSurface (used);
+    }
+
+    return retval;
+
+}
+
+int atlas_bake (Atlas *atlas, const char *path) {
+
+    int retval = 1;
+
+    if (atlas && path) {
+        char *json_filename = c_string_create ("%s.json", path);
+        FILE *file = json_filename ? fopen (json_filename, "w") : NULL;
+        if (file) {
+            pthread_mutex_lock (atlas->mutex);
+
+            int errors = 0;
+
+            fprintf (file, "{\n\t\"name\": ");
+            atlas_json_write_string (file, atlas->name ? atlas->name->str : "");
+            fprintf (file, ",\n\t\"page_size\": %d,\n\t\"pages\": [", atlas->page_size);
+
+            for (u8 i = 0; i < atlas->n_pages; i++) {
+                char *page_filename = atlas_page_filename (path, i);
+                if (page_filename) {
+                    if (atlas_bake_page (&atlas->pages[i], page_filename)) {
+                        cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                            c_string_create ("Failed to save atlas page %s!", page_filename));
+                        errors = 1;
+                    }
+
+                    // the index has the page filenames relative to itself
+                    const char *base = strrchr (page_filename, '/');
+                    fprintf (file, i ? ", " : " ");
+                    atlas_json_write_string (file, base ? base + 1 : page_filename);
+
+                    free (page_filename);
+                }
+
+                else errors = 1;
+            }
+
+            fprintf (file, " ],\n\t\"regions\": [\n");
+
+            for (u32 i = 0; i < atlas->n_regions; i++) {
+                AtlasRegion *region = atlas->regions[i];
+
+                fprintf (file, "\t\t{ \"name\": ");
+                atlas_json_write_string (file, region->name->str);
+                fprintf (file, ", \"page\": %d, \"x\": %d, \"y\": %d, \"w\": %d, \"h\": %d }%s\n",
+                    region->page, region->rect.x, region->rect.y, region->rect.w, region->rect.h,
+                    (i + 1 < atlas->n_regions) ? "," : "");
+            }
+
+            fprintf (file, "\t]\n}\n");
+
+            pthread_mutex_unlock (atlas->mutex);
+
+            if (fclose (file)) errors = 1;
+
+            retval = errors;
+        }
+
+        else {
+            cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                c_string_create ("Failed to open atlas index %s!", json_filename ? json_filename : path));
+        }
+
+        if (json_filename) free (json_filename);
+    }
+
+    return retval;
+
+}
+
+// returns the value of the key in the object if it has the type, NULL if not
+static json_value *atlas_json_get (json_value *object, const char *key, json_type type) {
+
+    if (object && (object->type == json_object)) {
+        for (unsigned int i = 0; i < object->u.object.length; i++) {
+            if (!strcmp (object->u.object.values[i].name, key)) {
+                json_value *value = object->u.object.values[i].value;
+                return (value->type == type) ? value : NULL;
+            }
+        }
+    }
+
+    return NULL;
+
+}
+
+// loads the baked pages, they are marked as full
+// returns 0 on success, 1 on error
+static int atlas_load_pages (Atlas *atlas, json_value *pages, const char *dir) {
+
+    if (pages->u.array.length > ATLAS_MAX_PAGES) return 1;
+
+    for (unsigned int i = 0; i < pages->u.array.length; i++) {
+        json_value *page_value = pages->u.array.values[i];
+        if (page_value->type != json_string) return 1;
+
+        char *page_filename = c_string_create ("%s%s", dir, page_value->u.string.ptr);
+        if (!page_filename) return 1;
+
+        AtlasPage *page = &atlas->pages[atlas->n_pages];
+        page->surface = IMG_Load_RW (file_open_rw (page_filename), 1);
+        if (!page->surface) {
+            cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                c_string_create ("Failed to load atlas page %s!", page_filename));
+            free (page_filename);
+            return 1;
+        }
+
+        free (page_filename);
+
+        atlas->n_pages += 1;
+        if (atlas_page_init (page, atlas->page_size, true)) return 1;
+    }
+
+    return 0;
+
+}
+
+// returns 0 on success, 1 on error
+static int atlas_load_regions (Atlas *atlas, json_value *regions) {
+
+    for (unsigned int i = 0; i < regions->u.array.length; i++) {
+        json_value *region_value = regions->u.array.values[i];
+
+        json_value *name = atlas_json_get (region_value, "name", json_string);
+        json_value *page = atlas_json_get (region_value, "page", json_integer);
+        json_value *x = atlas_json_get (region_value, "x", json_integer);
+        json_value *y = atlas_json_get (region_value, "y", json_integer);
+        json_value *w = atlas_json_get (region_value, "w", json_integer);
+        json_value *h = atlas_json_get (region_value, "h", json_integer);
+
+        if (!name || !page || !x || !y || !w || !h) return 1;
+        if ((page->u.integer < 0) || (page->u.integer >= atlas->n_pages)) return 1;
+
+        SDL_Rect rect = { (int) x->u.integer, (int) y->u.integer, (int) w->u.integer, (int) h->u.integer };
+        if (!atlas_region_register (atlas, name->u.string.ptr, (u8) page->u.integer, rect)) return 1;
+    }
+
+    return 0;
+
+}
+
+Atlas *atlas_load (const char *path) {
+
+    Atlas *atlas = NULL;
+
+    if (path) {
+        char *json_filename = c_string_create ("%s.json", path);
+        json_value *value = json_filename ? file_json_parse (json_filename) : NULL;
+        if (value) {
+            json_value *name = atlas_json_get (value, "name", json_string);
+            json_value *page_size = atlas_json_get (value, "page_size", json_integer);
+            json_value *pages = atlas_json_get (value, "pages", json_array);
+            json_value *regions = atlas_json_get (value, "regions", json_array);
+
+            if (page_size && pages && regions) {
+                atlas = atlas_create (name ? name->u.string.ptr : NULL, (u32) page_size->u.integer);
+                if (atlas) {
+                    // the pages are next to the index
+                    const char *base = strrchr (path, '/');
+                    char *dir = base ? c_string_create ("%.*s", (int) (base - path + 1), path) : c_string_create ("");
+
+                    if (!dir || atlas_load_pages (atlas, pages, dir) || atlas_load_regions (atlas, regions)) {
+                        cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                            c_string_create ("Failed to load atlas %s!", path));
+                        atlas_delete (atlas);
+                        atlas = NULL;
+                    }
+
+                    if (dir) free (dir);
+                }
+            }
+
+            else {
+                cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                    c_string_create ("Bad atlas index %s!", json_filename));
+            }
+
+            json_value_free (value);
+        }
+
+        if (json_filename) free (json_filename);
+    }
+
+    return atlas;
+
+}
+
+#pragma endregion
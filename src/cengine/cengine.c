@@ -1,6 +1,10 @@
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <time.h>
+#include <errno.h>
+
+#include <pthread.h>
 
 #include <SDL2/SDL.h>
 
@@ -9,21 +13,25 @@
 
 #include "cengine/collections/dlist.h"
 
+#include "cengine/cengine.h"
 #include "cengine/animation.h"
+#include "cengine/archive.h"
 #include "cengine/assets.h"
 #include "cengine/events.h"
 #include "cengine/input.h"
+#include "cengine/loader.h"
 #include "cengine/renderer.h"
+#include "cengine/texcache.h"
 #include "cengine/window.h"
 
 #include "cengine/threads/thread.h"
+#include "cengine/threads/jobs.h"
 
 #include "cengine/game/go.h"
 #include "cengine/game/camera.h"
 #include "cengine/manager/manager.h"
 
 #include "cengine/ui/ui.h"
-#include "cengine/ui/textbox.h"
 
 #include "cengine/utils/log.h"
 #include "cengine/utils/utils.h"
@@ -106,12 +114,199 @@ int cengine_end (void) {
     
     errors |= animations_end ();
 
+    // after everything that could still be waiting for a job
+    jobs_end ();
+
+    // loads that were still waiting for an io worker
+    asset_loader_end ();
+
+    // nothing can be reading from them anymore, fonts read their ttf until they are deleted
+    archive_unmount_all ();
+
+    texcache_end ();
+
     SDL_Quit ();
 
     return errors;
 
 }
 
+/*** frames ***/
+
+// returns the CLOCK_MONOTONIC time in nanoseconds
+u64 frame_clock_now (void) {
+
+    struct timespec now = { 0 };
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return (u64) now.tv_sec * 1000000000 + (u64) now.tv_nsec;
+
+}
+
+static void frame_sleep_ns (u64 ns) {
+
+    struct timespec sleep_time = {
+        .tv_sec = (time_t) (ns / 1000000000),
+        .tv_nsec = (long) (ns % 1000000000)
+    };
+
+    while (nanosleep (&sleep_time, &sleep_time) == -1 && errno == EINTR);
+
+}
+
+FrameScheduler *frame_scheduler_create (unsigned int fps) {
+
+    FrameScheduler *scheduler = (FrameScheduler *) malloc (sizeof (FrameScheduler));
+    if (scheduler) {
+        memset (scheduler, 0, sizeof (FrameScheduler));
+
+        scheduler->frame_ns = 1000000000 / (fps > 0 ? fps : 30);
+
+        scheduler->mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+        if (scheduler->mutex) pthread_mutex_init (scheduler->mutex, NULL);
+
+        else {
+            free (scheduler);
+            scheduler = NULL;
+        }
+    }
+
+    return scheduler;
+
+}
+
+void frame_scheduler_delete (void *scheduler_ptr) {
+
+    if (scheduler_ptr) {
+        FrameScheduler *scheduler = (FrameScheduler *) scheduler_ptr;
+
+        if (scheduler->mutex) {
+            pthread_mutex_destroy (scheduler->mutex);
+            free (scheduler->mutex);
+        }
+
+        free (scheduler_ptr);
+    }
+
+}
+
+// returns the time of the bucket where the percentage of frames is reached
+static double frame_scheduler_percentile (FrameScheduler *scheduler, double percentage) {
+
+    u32 target = (u32) (scheduler->n_frames * percentage);
+    if (target < 1) target = 1;
+
+    // use the end of the bucket, but never more than the slowest frame
+    u64 value = scheduler->max_ns;
+    u32 count = 0;
+    for (u32 i = 0; i < FRAME_HISTOGRAM_BUCKETS; i++) {
+        count += scheduler->histogram[i];
+        if (count >= target) {
+            u64 bucket_end = (u64) (i + 1) * FRAME_HISTOGRAM_BUCKET_NS;
+            if (bucket_end < value) value = bucket_end;
+            break;
+        }
+    }
+
+    return (double) value / 1000000;
+
+}
+
+// publishes the stats of the frames since the window started and starts a new one
+static void frame_scheduler_publish (FrameScheduler *scheduler, u64 now) {
+
+    FrameStats stats = { 0 };
+    if (scheduler->n_frames) {
+        stats.frames = scheduler->n_frames;
+        stats.avg_ms = ((double) scheduler->total_ns / scheduler->n_frames) / 1000000;
+        stats.p50_ms = frame_scheduler_percentile (scheduler, 0.5);
+        stats.p99_ms = frame_scheduler_percentile (scheduler, 0.99);
+        stats.max_ms = (double) scheduler->max_ns / 1000000;
+    }
+
+    pthread_mutex_lock (scheduler->mutex);
+    scheduler->stats = stats;
+    pthread_mutex_unlock (scheduler->mutex);
+
+    memset (scheduler->histogram, 0, sizeof (scheduler->histogram));
+    scheduler->n_frames = 0;
+    scheduler->total_ns = 0;
+    scheduler->max_ns = 0;
+    scheduler->window_start_ns = now;
+
+}
+
+// call it at the start of every frame
+// returns the nanoseconds since the previous frame began
+u64 frame_scheduler_begin (FrameScheduler *scheduler) {
+
+    u64 elapsed = 0;
+
+    if (scheduler) {
+        u64 now = frame_clock_now ();
+
+        if (scheduler->last_frame_ns) {
+            elapsed = now - scheduler->last_frame_ns;
+
+            u64 bucket = elapsed / FRAME_HISTOGRAM_BUCKET_NS;
+            scheduler->histogram[bucket < FRAME_HISTOGRAM_BUCKETS ? bucket : FRAME_HISTOGRAM_BUCKETS] += 1;
+            scheduler->n_frames += 1;
+            scheduler->total_ns += elapsed;
+            if (elapsed > scheduler->max_ns) scheduler->max_ns = elapsed;
+
+            if (now - scheduler->window_start_ns >= 1000000000) 
+                frame_scheduler_publish (scheduler, now);
+        }
+
+        else {
+            scheduler->next_frame_ns = now + scheduler->frame_ns;
+            scheduler->window_start_ns = now;
+        }
+
+        scheduler->last_frame_ns = now;
+    }
+
+    return elapsed;
+
+}
+
+// sleeps and then spins until the current frame deadline
+// if the deadline was missed by more than a frame, the schedule starts again from now
+void frame_scheduler_wait (FrameScheduler *scheduler) {
+
+    if (scheduler) {
+        u64 now = frame_clock_now ();
+
+        if (now < scheduler->next_frame_ns) {
+            // the os may wake us late, so we only sleep until we are close
+            if (scheduler->next_frame_ns - now > FRAME_SPIN_NS)
+                frame_sleep_ns (scheduler->next_frame_ns - now - FRAME_SPIN_NS);
+
+            while (frame_clock_now () < scheduler->next_frame_ns);
+
+            scheduler->next_frame_ns += scheduler->frame_ns;
+        }
+
+        // avoid rushing many frames to catch up
+        else if (now - scheduler->next_frame_ns > scheduler->frame_ns) 
+            scheduler->next_frame_ns = now + scheduler->frame_ns;
+
+        else scheduler->next_frame_ns += scheduler->frame_ns;
+    }
+
+}
+
+// gets the stats of the last complete second
+void frame_scheduler_get_stats (FrameScheduler *scheduler, FrameStats *stats) {
+
+    if (scheduler && stats) {
+        pthread_mutex_lock (scheduler->mutex);
+        *stats = scheduler->stats;
+        pthread_mutex_unlock (scheduler->mutex);
+    }
+
+}
+
 /*** threads ***/
 
 bool running = true;
@@ -120,22 +315,63 @@ unsigned int fps_limit = 30;
 
 unsigned int cengine_get_fps_limit (void) { return fps_limit; }
 
-static unsigned int main_fps = 0;
-static TextBox *main_fps_text = NULL;
+static unsigned int update_rate = 0;
+
+// sets how many times per second the state update runs, by default the same as the fps
+// the update always runs with a fixed delta, call it before cengine_start ()
+void cengine_set_update_rate (unsigned int updates_per_second) {
+
+    update_rate = updates_per_second;
+
+}
+
+static FrameScheduler *main_scheduler = NULL;
+static FrameScheduler *update_scheduler = NULL;
+
+// returns the fixed time in seconds that every state update advances
+double cengine_get_update_delta (void) {
+
+    return update_scheduler ? (double) update_scheduler->frame_ns / 1000000000 : 0;
+
+}
+
+// gets the frame times of one of cengine's loops measured during the last second
+// returns 0 on success, 1 on error (cengine has not started)
+int cengine_get_frame_stats (CengineLoop loop, FrameStats *stats) {
 
-void cengine_set_main_fps_text (TextBox *text) {
+    int retval = 1;
+
+    FrameScheduler *scheduler = loop == CENGINE_LOOP_UPDATE ? update_scheduler : main_scheduler;
+    if (scheduler && stats) {
+        frame_scheduler_get_stats (scheduler, stats);
+        retval = 0;
+    }
 
-    main_fps_text = text;
+    return retval;
 
 }
 
-static unsigned int update_fps = 0;
-static char update_text[16] = { 0 };
-static TextBox *update_fps_text = NULL;
+// the update thread publishes when it last ran and the time it has left over,
+// so the render can get how far we are between two updates
+static pthread_mutex_t update_time_mutex = PTHREAD_MUTEX_INITIALIZER;
+static u64 update_time_ns = 0;
+static u64 update_accumulator_ns = 0;
+
+// returns how far the current time is between the last update and the next one [0, 1]
+static double cengine_get_update_alpha (void) {
+
+    double alpha = 1;
+
+    if (update_scheduler) {
+        pthread_mutex_lock (&update_time_mutex);
+        u64 since = update_time_ns ? frame_clock_now () - update_time_ns + update_accumulator_ns : 0;
+        pthread_mutex_unlock (&update_time_mutex);
 
-void cengine_set_update_fps_text (TextBox *text) {
+        alpha = (double) since / update_scheduler->frame_ns;
+        if (alpha > 1) alpha = 1;
+    }
 
-    update_fps_text = text;
+    return alpha;
 
 }
 
@@ -143,38 +379,28 @@ static void *cengine_update (void *args) {
 
     thread_set_name ("update");
 
-    u32 time_per_frame = 1000 / fps_limit;
-    u32 frame_start = 0;
-    i32 sleep_time = 0;
-
-    float delta_time = 0;
-    u32 delta_ticks = 0;
-    update_fps = 0;
+    u64 accumulator = 0;
+    u64 max_accumulator = update_scheduler->frame_ns * FRAME_MAX_UPDATE_STEPS;
 
     while (running) {
-        frame_start = SDL_GetTicks ();
-
-        if (manager->curr_state->update)
-            manager->curr_state->update ();
-
-        // limit the FPS
-        sleep_time = time_per_frame - (SDL_GetTicks () - frame_start);
-        if (sleep_time > 0) SDL_Delay (sleep_time);
-
-        // count fps
-        delta_time = SDL_GetTicks () - frame_start;
-        delta_ticks += delta_time;
-        if (delta_ticks >= 1000) {
-            // printf ("update fps: %i\n", update_fps);
-            if (update_fps_text) {
-                snprintf (update_text, 16, "update: %d", update_fps);
-            }
-            
-            delta_ticks = 0;
-            update_fps = 0;
+        accumulator += frame_scheduler_begin (update_scheduler);
+
+        // drop the time we can not catch up with, instead of spiraling
+        if (accumulator > max_accumulator) accumulator = max_accumulator;
+
+        while (accumulator >= update_scheduler->frame_ns) {
+            if (manager->curr_state->update)
+                manager->curr_state->update ();
+
+            accumulator -= update_scheduler->frame_ns;
         }
 
-        else update_fps++;
+        pthread_mutex_lock (&update_time_mutex);
+        update_time_ns = update_scheduler->last_frame_ns;
+        update_accumulator_ns = accumulator;
+        pthread_mutex_unlock (&update_time_mutex);
+
+        frame_scheduler_wait (update_scheduler);
     }
 
     return NULL;
@@ -185,62 +411,32 @@ static void cengine_run (void) {
 
     SDL_Event event;
 
-    float time_per_frame = 1000 / fps_limit;
-    u32 frame_start = 0;
-    i32 sleep_time = 0;
-
-    float delta_time = 0;
-    u32 delta_ticks = 0;
-    main_fps = 0;
-
     while (running) {
-        frame_start = SDL_GetTicks ();
+        frame_scheduler_begin (main_scheduler);
 
         input_handle (event);
 
+        double alpha = cengine_get_update_alpha ();
+
+        // jobs that need to use the renderer, like uploading textures
+        jobs_run_main ();
+
+        // use the same animation frames for every window
+        animations_apply ();
+
         // update input and renderer for each window
         Window *win = NULL;
         for (ListElement *le = dlist_start (windows); le; le = le->next) {
             win = (Window *) le->data;
             if (win->input->user_input) win->input->user_input (win);
 
-            win->renderer->ui->ui_element_hover = NULL;
-            render (win->renderer);
+            ui_hit_test (win->renderer->ui, win);
+            render (win->renderer, alpha);
 
             if (win->renderer->update) win->renderer->update (win->renderer->update_args);
         }
 
-        // limit the FPS
-        // u32 ticks = (SDL_GetTicks () - frame_start);
-        // printf ("ticks: %d\n", ticks);
-        sleep_time = time_per_frame - (SDL_GetTicks () - frame_start);
-        // printf ("sleep: %d\n", sleep_time);
-        if (sleep_time > 0) SDL_Delay (sleep_time);
-
-        // count fps
-        delta_time = SDL_GetTicks () - frame_start;
-        delta_ticks += delta_time;
-        if (delta_ticks >= 1000) {
-            // printf ("main fps: %i\n", main_fps);
-            if (main_fps_text) {
-                char *text = c_string_create ("main: %d", main_fps);
-                if (text) {
-                    // FIXME:
-                    // ui_textbox_update_text (main_fps_text, text);
-                    free (text);
-                }   
-            }
-
-            if (update_fps_text) {
-                // FIXME:
-                // ui_textbox_update_text (update_fps_text, renderer, update_text);
-            } 
-            
-            delta_ticks = 0;
-            main_fps = 0;
-        }
-
-        else main_fps++;
+        frame_scheduler_wait (main_scheduler);
     }
 
 }
@@ -249,14 +445,34 @@ int cengine_start (int fps) {
 
     fps_limit = fps > 0 ? fps : 30;
 
-    pthread_t thread_id = 0;
-    if (thread_create_detachable (&thread_id, cengine_update, NULL)) {
-        cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to create update thread!");
+    main_scheduler = frame_scheduler_create (fps_limit);
+    update_scheduler = frame_scheduler_create (update_rate ? update_rate : fps_limit);
+    if (!main_scheduler || !update_scheduler) {
+        cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to create frame schedulers!");
         running = false;
     }
 
+    // 18/10/2026 -- the update thread is joined before the schedulers get deleted
+    pthread_t thread_id = 0;
+    bool update_thread = false;
+    if (running) {
+        if (!pthread_create (&thread_id, NULL, cengine_update, NULL)) update_thread = true;
+
+        else {
+            cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to create update thread!");
+            running = false;
+        }
+    }
+
     cengine_run ();
 
+    if (update_thread) pthread_join (thread_id, NULL);
+
+    frame_scheduler_delete (main_scheduler);
+    main_scheduler = NULL;
+    frame_scheduler_delete (update_scheduler);
+    update_scheduler = NULL;
+
     return 0;
 
 }
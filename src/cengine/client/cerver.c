@@ -278,6 +278,12 @@ static u8 cerver_check_info (Cerver *cerver, Client *client, Connection *connect
 
         cerver_check_info_handle_auth (cerver, client, connection);
 
+        // 18/10/2026 -- the cerver answers with the codec to use
+        if (connection->compression_codecs) {
+            if (connection_compression_request (client, connection))
+                cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to send compression request to cerver!");
+        }
+
         retval = 0;
     }
 
@@ -304,6 +310,24 @@ static void cerver_packet_handle_info (Packet *packet) {
 
 }
 
+// the cerver has chosen one of the codecs that we offered, or none if it can not use them
+static void cerver_packet_handle_compression (Packet *packet) {
+
+    if (packet->data && (packet->data_size >= sizeof (SPacketCompression))) {
+        SPacketCompression scompression = { 0 };
+        memcpy (&scompression, packet->data, sizeof (SPacketCompression));
+
+        u8 codecs = scompression.codecs & packet->connection->compression_codecs;
+        packet->connection->compression = codecs & (~codecs + 1);
+
+        #ifdef CLIENT_DEBUG
+        cengine_log_msg (stdout, LOG_DEBUG, LOG_NO_TYPE, 
+            packet->connection->compression ? "Cerver accepted packet compression." : "Cerver does NOT use packet compression.");
+        #endif
+    }
+
+}
+
 // handles cerver type packets
 void cerver_packet_handler (Packet *packet) {
 
@@ -335,6 +359,10 @@ void cerver_packet_handler (Packet *packet) {
                     // #endif
                     break;
 
+                case CERVER_COMPRESSION:
+                    cerver_packet_handle_compression (packet);
+                    break;
+
                 default: 
                     cengine_log_msg (stderr, LOG_WARNING, LOG_NO_TYPE, "Unknown cerver type packet."); 
                     break;
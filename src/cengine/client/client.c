@@ -3,6 +3,7 @@
 #include <string.h>
 
 #include <time.h>
+#include <unistd.h>
 
 #include "cengine/types/types.h"
 #include "cengine/types/string.h"
@@ -18,8 +19,13 @@
 #include "cengine/client/cerver.h"
 #include "cengine/client/connection.h"
 #include "cengine/client/game.h"
+#include "cengine/client/reactor.h"
+#include "cengine/client/requests.h"
+#include "cengine/client/stats.h"
+#include "cengine/client/transfer.h"
 
 #include "cengine/threads/thread.h"
+#include "cengine/threads/jobs.h"
 
 #include "cengine/utils/log.h"
 #include "cengine/utils/utils.h"
@@ -37,6 +43,7 @@ static ClientStats *client_stats_new (void) {
         memset (client_stats, 0, sizeof (ClientStats));
         client_stats->received_packets = packets_per_type_new ();
         client_stats->sent_packets = packets_per_type_new ();
+        client_stats->counters = stats_new (true);
     } 
 
     return client_stats;
@@ -49,15 +56,43 @@ static inline void client_stats_delete (ClientStats *client_stats) {
         packets_per_type_delete (client_stats->received_packets);
         packets_per_type_delete (client_stats->sent_packets);
 
+        stats_delete (client_stats->counters);
+
         free (client_stats); 
     } 
     
 }
 
+// sets the fields of the client stats from its counters
+void client_stats_update (Client *client) {
+
+    if (client && client->stats) {
+        StatsSnapshot *snapshot = (StatsSnapshot *) malloc (sizeof (StatsSnapshot));
+        if (snapshot) {
+            stats_snapshot (client->stats->counters, snapshot);
+
+            client->stats->n_receives_done = snapshot->counters[STATS_RECEIVES_DONE];
+            client->stats->total_bytes_received = snapshot->counters[STATS_BYTES_RECEIVED];
+            client->stats->total_bytes_sent = snapshot->counters[STATS_BYTES_SENT];
+            client->stats->n_packets_received = snapshot->counters[STATS_PACKETS_RECEIVED];
+            client->stats->n_packets_sent = snapshot->counters[STATS_PACKETS_SENT];
+            client->stats->n_receive_allocs = snapshot->counters[STATS_RECEIVE_ALLOCS];
+
+            stats_snapshot_packets_per_type (snapshot, false, client->stats->received_packets);
+            stats_snapshot_packets_per_type (snapshot, true, client->stats->sent_packets);
+
+            free (snapshot);
+        }
+    }
+
+}
+
 void client_stats_print (Client *client) {
 
     if (client) {
         if (client->stats) {
+            client_stats_update (client);
+
             printf ("\nClient's stats:\n");
             printf ("Threshold time:            %ld\n", client->stats->threshold_time);
 
@@ -69,6 +104,10 @@ void client_stats_print (Client *client) {
             printf ("N packets received:        %ld\n", client->stats->n_packets_received);
             printf ("N packets sent:            %ld\n", client->stats->n_packets_sent);
 
+            printf ("N receive allocs:          %ld\n", client->stats->n_receive_allocs);
+            printf ("Receive allocs per packet: %.3f\n", client->stats->n_packets_received ?
+                (double) client->stats->n_receive_allocs / client->stats->n_packets_received : 0.0);
+
             printf ("\nReceived packets:\n");
             packets_per_type_print (client->stats->received_packets);
 
@@ -442,7 +481,7 @@ unsigned int client_connect_to_cerver (Client *client, Connection *connection) {
 
 }
 
-static void *client_connect_thread (void *client_connection_ptr) {
+static void client_connect_job (void *client_connection_ptr) {
 
     if (client_connection_ptr) {
         ClientConnection *cc = (ClientConnection *) client_connection_ptr;
@@ -452,16 +491,14 @@ static void *client_connect_thread (void *client_connection_ptr) {
         client_connection_aux_delete (cc);
     }
 
-    return NULL;
-
 }
 
 // connects a client to the host with the specified values in the connection
 // it can be a cerver or not
-// this is NOT a blocking method, a new thread will be created to wait for a connection to be established
+// this is NOT a blocking method, an io job will wait for a connection to be established
 // open a success connection, EVENT_CONNECTED will be triggered, otherwise, EVENT_CONNECTION_FAILED will be triggered
 // user must manually handle how he wants to receive / handle incomming packets and also send requests
-// returns 0 on success connection thread creation, 1 on error
+// returns 0 on success connection job submit, 1 on error
 unsigned int client_connect_async (Client *client, Connection *connection) {
 
     unsigned int retval = 1;
@@ -469,15 +506,15 @@ unsigned int client_connect_async (Client *client, Connection *connection) {
     if (client && connection) {
         ClientConnection *cc = client_connection_aux_new (client, connection);
         if (cc) {
-            pthread_t thread_id = 0;
-            if (!thread_create_detachable (&thread_id, client_connect_thread, cc)) {
+            if (!job_submit (JOB_AFFINITY_IO, client_connect_job, cc, NULL)) {
                 retval = 0;         // success
             }
 
             else {
                 #ifdef CLIENT_DEBUG
-                cengine_log_error ("Failed to create client_connect_thread () detachable thread!");
+                cengine_log_error ("Failed to submit client_connect_job ()!");
                 #endif
+                client_connection_aux_delete (cc);
             }
         }
     }
@@ -495,6 +532,8 @@ unsigned int client_connect_async (Client *client, Connection *connection) {
 // this is a blocking method, as it will wait until a complete cerver response has been received
 // the response will be handled using the client's packet handler
 // this method only works if your response consists only of one packet
+// 18/10/2026 -- the response is the packet with the request id, so other requests can be made at the same time,
+// it gives up after CLIENT_REQUEST_DEFAULT_TIMEOUT ms
 // neither client nor the connection will be stopped after the request has ended, the request packet won't be deleted
 // retruns 0 when the response has been handled, 1 on error
 unsigned int client_request_to_cerver (Client *client, Connection *connection, Packet *request) {
@@ -502,17 +541,13 @@ unsigned int client_request_to_cerver (Client *client, Connection *connection, P
     unsigned int retval = 1;
 
     if (client && connection && request) {
-        // send the request to the cerver
-        packet_set_network_values (request, client, connection);
-
-        size_t sent = 0;
-        if (!packet_send (request, 0, &sent, false)) {
-            // printf ("Request to cerver: %ld\n", sent);
+        ClientRequest *pending = client_request_send_internal (client, connection, request,
+            CLIENT_REQUEST_DEFAULT_TIMEOUT, true, NULL, NULL);
+        if (pending) {
+            // receives the response directly if the connection has not been started
+            if (client_request_wait (pending) == CLIENT_REQUEST_DONE) retval = 0;
 
-            // receive the data directly
-            client_connection_get_next_packet (client, connection);
-
-            retval = 0;
+            client_request_delete (pending);
         }
 
         else {
@@ -526,17 +561,13 @@ unsigned int client_request_to_cerver (Client *client, Connection *connection, P
 
 }
 
-static void *client_request_to_cerver_thread (void *cc_ptr) {
-
-    if (cc_ptr) {
-        ClientConnection *cc = (ClientConnection *) cc_ptr;
-
-        cc->connection->full_packet = false;
-        while (!cc->connection->full_packet) {
-            client_receive (cc->client, cc->connection);
-        }
+// waiting receives from the socket until the response arrives,
+// so it has its own thread instead of an io worker, that would be stalled all that time
+static void *client_request_to_cerver_thread (void *request_ptr) {
 
-        client_connection_aux_delete (cc);
+    if (request_ptr) {
+        (void) client_request_wait ((ClientRequest *) request_ptr);
+        client_request_delete (request_ptr);
     }
 
     return NULL;
@@ -547,6 +578,8 @@ static void *client_request_to_cerver_thread (void *cc_ptr) {
 // the result will be placed inside the connection
 // this method will NOT block and the response will be handled using the client's packet handler
 // this method only works if your response consists only of one packet
+// 18/10/2026 -- if the connection has been started, its update thread or the reactor handle the response,
+// if not, a new thread waits for it, it gives up after CLIENT_REQUEST_DEFAULT_TIMEOUT ms
 // neither client nor the connection will be stopped after the request has ended, the request packet won't be deleted
 // returns 0 on success request, 1 on error
 unsigned int client_request_to_cerver_async (Client *client, Connection *connection, Packet *request) {
@@ -554,22 +587,27 @@ unsigned int client_request_to_cerver_async (Client *client, Connection *connect
     unsigned int retval = 1;
 
     if (client && connection && request) {
-        // send the request to the cerver
-        packet_set_network_values (request, client, connection);
-        if (!packet_send (request, 0, NULL, false)) {
-            ClientConnection *cc = client_connection_aux_new (client, connection);
-            if (cc) {
-                // create a new thread to receive & handle the response
-                pthread_t thread_id = 0;
-                if (!thread_create_detachable (&thread_id, client_request_to_cerver_thread, cc)) {
-                    retval = 0;         // success
-                }
+        ClientRequest *pending = client_request_send_internal (client, connection, request,
+            CLIENT_REQUEST_DEFAULT_TIMEOUT, true, NULL, NULL);
+        if (pending) {
+            pthread_t thread_id = 0;
 
-                else {
-                    #ifdef CLIENT_DEBUG
-                    cengine_log_error ("Failed to create client_request_to_cerver_thread () detachable thread!");
-                    #endif
-                }
+            if (connection->started) {
+                client_request_delete (pending);
+                retval = 0;         // success
+            }
+
+            // a thread receives & handles the response
+            else if (!thread_create_detachable (&thread_id, client_request_to_cerver_thread, pending)) {
+                retval = 0;         // success
+            }
+
+            else {
+                #ifdef CLIENT_DEBUG
+                cengine_log_error ("Failed to create client_request_to_cerver_thread ()!");
+                #endif
+                client_request_cancel (pending);
+                client_request_delete (pending);
             }
         }
 
@@ -586,11 +624,29 @@ unsigned int client_request_to_cerver_async (Client *client, Connection *connect
 
 #pragma endregion
 
+#pragma region send
+
+// sends the packets that are waiting in the send batch of every client connection
+// call it once per tick after the tick packets have been sent, see connection_set_send_batch ()
+void client_flush (Client *client) {
+
+    if (client) {
+        for (ListElement *le = dlist_start (client->connections); le; le = le->next) {
+            Connection *connection = (Connection *) le->data;
+            if (connection->connected) (void) connection_flush (connection);
+        }
+    }
+
+}
+
+#pragma endregion
+
 #pragma region start
 
 // after a client connection successfully connects to a server, 
 // it will start the connection's update thread to enable the connection to
 // receive & handle packets in a dedicated thread
+// if the reactor is running, the connection is handled by one of its threads instead
 // returns 0 on success, 1 on error
 int client_connection_start (Client *client, Connection *connection) {
 
@@ -599,21 +655,48 @@ int client_connection_start (Client *client, Connection *connection) {
     if (client && connection) {
         if (connection->connected) {
             if (!client_start (client)) {
-                pthread_t thread_id = 0;
-                if (!thread_create_detachable (
-                    &thread_id,
-                    (void *(*)(void *)) connection_update,
-                    client_connection_aux_new (client, connection)
-                )) {
-                    retval = 0;         // success
+                // udp connections keep their own thread, as it also sends the acks & retransmits
+                if (client_reactor_is_running () && (connection->protocol == PROTOCOL_TCP)) {
+                    connection->started = true;
+                    if (!client_reactor_register (client, connection)) {
+                        retval = 0;         // success
+                    }
+
+                    else {
+                        connection->started = false;
+
+                        char *s = c_string_create ("client_connection_start () - Failed to register client %s connection in the reactor", 
+                            client->name->str);
+                        if (s) {
+                            cengine_log_error (s);
+                            free (s);
+                        }
+                    }
                 }
 
                 else {
-                    char *s = c_string_create ("client_connection_start () - Failed to create update thread for client %s", 
-                        client->name->str);
-                    if (s) {
-                        cengine_log_error (s);
-                        free (s);
+                    connection->started = true;
+                    connection_update_receive_timeout (connection);
+
+                    pthread_t thread_id = 0;
+                    if (!thread_create_detachable (
+                        &thread_id,
+                        (void *(*)(void *)) connection_update,
+                        client_connection_aux_new (client, connection)
+                    )) {
+                        retval = 0;         // success
+                    }
+
+                    else {
+                        connection->started = false;
+                        connection_update_receive_timeout (connection);
+
+                        char *s = c_string_create ("client_connection_start () - Failed to create update thread for client %s", 
+                            client->name->str);
+                        if (s) {
+                            cengine_log_error (s);
+                            free (s);
+                        }
                     }
                 }
             }
@@ -672,17 +755,22 @@ static void client_connection_start_wrapper (void *data_ptr) {
 
 }
 
-// connects a client connection to a server in a new thread to avoid blocking the calling thread,
+// connects a client connection to a server in an io job to avoid blocking the calling thread,
 // and after a success connection, it will start the connection (create update thread for receiving messages)
-// returns 0 on success creating connection thread, 1 on error
+// returns 0 on success submitting the connection job, 1 on error
 u8 client_connect_and_start_async (Client *client, Connection *connection) {
 
-    pthread_t thread_id = 0;
-    return (client && connection) ? thread_create_detachable (
-        &thread_id,
-        (void *(*)(void *)) client_connection_start_wrapper,
-        client_connection_aux_new (client, connection)
-    ) : 1;
+    u8 retval = 1;
+
+    if (client && connection) {
+        ClientConnection *cc = client_connection_aux_new (client, connection);
+        if (cc) {
+            retval = job_submit (JOB_AFFINITY_IO, client_connection_start_wrapper, cc, NULL);
+            if (retval) client_connection_aux_delete (cc);
+        }
+    }
+
+    return retval;
 
 }
 
@@ -726,6 +814,13 @@ int client_connection_end (Client *client, Connection *connection) {
 
             retval = 0;
         }
+
+        // 18/10/2026 -- it stops trying to reconnect
+        else if (__atomic_load_n (&connection->state, __ATOMIC_ACQUIRE) == CONNECTION_STATE_RECONNECTING) {
+            connection_close (connection);
+
+            retval = 0;
+        }
     }
 
     return retval;
@@ -777,20 +872,146 @@ void client_got_disconnected (Client *client) {
 
 #pragma endregion
 
+#pragma region reconnect
+
+static inline bool client_connection_reconnecting (Client *client, Connection *connection) {
+
+    return client->running 
+        && (__atomic_load_n (&connection->state, __ATOMIC_ACQUIRE) == CONNECTION_STATE_RECONNECTING);
+
+}
+
+// 18/10/2026 -- connects again a lost connection, waiting a jittered exponential backoff between the attempts,
+// it stops if the client stops running or the connection is closed
+// returns 0 on success, 1 if it gave up
+u8 client_connection_reconnect (Client *client, Connection *connection) {
+
+    u8 retval = 1;
+
+    if (client && connection) {
+        for (u32 attempt = 0; client_connection_reconnecting (client, connection); attempt++) {
+            if (!connection_restart (connection)) {
+                connection->connected = true;
+                __atomic_store_n (&connection->state, CONNECTION_STATE_CONNECTED, __ATOMIC_RELEASE);
+                time (&connection->connected_timestamp);
+
+                client_event_trigger (CLIENT_EVENT_CONNECTED, client, connection);
+
+                retval = 0;
+                break;
+            }
+
+            if (connection->reconnect_attempts && ((attempt + 1) >= connection->reconnect_attempts)) break;
+
+            // waits in small steps, so it notices if it has to stop
+            u64 end = connection_time () + connection_backoff (connection, attempt);
+            while (client_connection_reconnecting (client, connection) && (connection_time () < end))
+                usleep (CONNECTION_KEEPALIVE_CHECK_INTERVAL * 1000);
+        }
+
+        if (retval) {
+            // it has only failed if nobody stopped it
+            ConnectionState reconnecting = CONNECTION_STATE_RECONNECTING;
+            if (__atomic_compare_exchange_n (&connection->state, &reconnecting, CONNECTION_STATE_DISCONNECTED,
+                false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                client_event_trigger (CLIENT_EVENT_CONNECTION_FAILED, client, connection);
+        }
+    }
+
+    return retval;
+
+}
+
+typedef struct ClientReconnect {
+
+    Client *client;
+    Connection *connection;
+    bool start;                     // the connection was started before it was lost
+
+} ClientReconnect;
+
+// the backoff sleeps between the attempts, and it may keep trying while the client runs,
+// so it has its own thread instead of an io worker, that would be stalled all that time
+static void *client_connection_reconnect_thread (void *reconnect_ptr) {
+
+    if (reconnect_ptr) {
+        ClientReconnect *reconnect = (ClientReconnect *) reconnect_ptr;
+
+        if (!client_connection_reconnect (reconnect->client, reconnect->connection)) {
+            if (reconnect->start && client_connection_start (reconnect->client, reconnect->connection)) {
+                cengine_log_error ("client_connection_reconnect_thread () - Failed to start the connection again!");
+                connection_close (reconnect->connection);
+            }
+        }
+
+        free (reconnect);
+    }
+
+    return NULL;
+
+}
+
+// 18/10/2026 -- the connection was lost without being closed by the cerver, so it is closed & the event is triggered,
+// CLIENT_EVENT_DISCONNECTED if it timed out or CLIENT_EVENT_CONNECTION_CLOSE if the socket failed,
+// if reconnect is enabled, it is connected again by its update thread, or in a new thread if it has none
+void client_connection_lost (Client *client, Connection *connection, bool timed_out) {
+
+    if (client && connection && connection->connected) {
+        bool start = connection->started;
+        bool reconnect = connection->reconnect && client->running;
+
+        #ifdef CLIENT_DEBUG
+        if (timed_out) cengine_log_msg (stderr, LOG_WARNING, LOG_CLIENT, "A connection has timed out!");
+        #endif
+
+        // nobody is there to get a close connection packet
+        connection_close (connection);
+        if (reconnect) __atomic_store_n (&connection->state, CONNECTION_STATE_RECONNECTING, __ATOMIC_RELEASE);
+
+        client_event_trigger (timed_out ? CLIENT_EVENT_DISCONNECTED : CLIENT_EVENT_CONNECTION_CLOSE, client, connection);
+
+        // the update thread reconnects it once its receive loop ends
+        if (reconnect && !connection->update_thread_id) {
+            ClientReconnect *data = (ClientReconnect *) malloc (sizeof (ClientReconnect));
+            if (data) {
+                data->client = client;
+                data->connection = connection;
+                data->start = start;
+
+                pthread_t thread_id = 0;
+                if (thread_create_detachable (&thread_id, client_connection_reconnect_thread, data)) {
+                    free (data);
+                    data = NULL;
+                }
+            }
+
+            if (!data) {
+                cengine_log_error ("client_connection_lost () - Failed to create the reconnect thread!");
+                connection_close (connection);
+            }
+        }
+    }
+
+}
+
+#pragma endregion
+
 #pragma region files
 
 // requests a file from the server
 // filename: the name of the file to request
 // file complete event will be sent when the file is finished
 // appropiate error is set on bad filename or error in file transmission
+// 18/10/2026 -- the file is saved in the working directory with the last part of its name,
+// if it is already there, the transfer resumes from its end, use file_transfer_get () to choose where it goes
 // returns 0 on success sending request, 1 on failed to send request
 u8 client_file_get (Client *client, Connection *connection, const char *filename) {
 
     u8 retval = 1;
 
-    if (client && connection) {
-        // request the file from the cerver
-        // set our file tray for incoming files
+    if (client && connection && filename) {
+        const char *name = strrchr (filename, '/');
+        retval = file_transfer_get (client, connection, filename, name ? name + 1 : filename);
     }
 
     return retval;
@@ -802,16 +1023,15 @@ u8 client_file_get (Client *client, Connection *connection, const char *filename
 // file is opened using the filename
 // when file is completly sent, event is set appropriately
 // appropiate error is sent on cerver error or on bad file transmission
+// 18/10/2026 -- the cerver gets the last part of the name, use file_transfer_send () to choose it
 // returns 0 on success sending request, 1 on failed to send request
 u8 client_file_send (Client *client, Connection *connection, const char *filename) {
 
     u8 retval = 1;
 
-    if (client && connection) {
-        // request the cerver for a file transmission
-        // open the file
-        // send file header
-        // send file in packets
+    if (client && connection && filename) {
+        const char *name = strrchr (filename, '/');
+        retval = file_transfer_send (client, connection, name ? name + 1 : filename, filename);
     }
 
     return retval;
@@ -1,6 +1,14 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <sys/time.h>
 
 #include "cengine/types/types.h"
 #include "cengine/types/string.h"
@@ -12,6 +20,11 @@
 #include "cengine/client/connection.h"
 #include "cengine/client/handler.h"
 #include "cengine/client/packets.h"
+#include "cengine/client/reactor.h"
+#include "cengine/client/requests.h"
+#include "cengine/client/stats.h"
+#include "cengine/client/transfer.h"
+#include "cengine/client/udp.h"
 
 #include "cengine/threads/thread.h"
 
@@ -41,6 +54,8 @@ static inline void connection_stats_delete (ConnectionStats *stats) {
         packets_per_type_delete (stats->received_packets);
         packets_per_type_delete (stats->sent_packets);
 
+        stats_delete (stats->counters);
+
         free (stats); 
     } 
     
@@ -52,12 +67,50 @@ static ConnectionStats *connection_stats_create (void) {
     if (stats) {
         stats->received_packets = packets_per_type_new ();
         stats->sent_packets = packets_per_type_new ();
+        stats->counters = stats_new (false);
     }
 
     return stats;
 
 }
 
+// sets the fields of the connection stats from its counters
+void connection_stats_update (Connection *connection) {
+
+    if (connection && connection->stats) {
+        ConnectionStats *stats = connection->stats;
+
+        StatsSnapshot *snapshot = (StatsSnapshot *) malloc (sizeof (StatsSnapshot));
+        if (snapshot) {
+            stats_snapshot (stats->counters, snapshot);
+
+            stats->n_receives_done = snapshot->counters[STATS_RECEIVES_DONE];
+            stats->total_bytes_received = snapshot->counters[STATS_BYTES_RECEIVED];
+            stats->total_bytes_sent = snapshot->counters[STATS_BYTES_SENT];
+            stats->n_packets_received = snapshot->counters[STATS_PACKETS_RECEIVED];
+            stats->n_packets_sent = snapshot->counters[STATS_PACKETS_SENT];
+            stats->n_receive_allocs = snapshot->counters[STATS_RECEIVE_ALLOCS];
+
+            stats->n_udp_acked = snapshot->counters[STATS_UDP_ACKED];
+            stats->n_udp_lost = snapshot->counters[STATS_UDP_LOST];
+            stats->n_udp_retransmits = snapshot->counters[STATS_UDP_RETRANSMITS];
+
+            stats->n_compressed_sent = snapshot->counters[STATS_COMPRESSED_SENT];
+            stats->bytes_uncompressed_sent = snapshot->counters[STATS_BYTES_UNCOMPRESSED_SENT];
+            stats->bytes_compressed_sent = snapshot->counters[STATS_BYTES_COMPRESSED_SENT];
+            stats->n_compressed_received = snapshot->counters[STATS_COMPRESSED_RECEIVED];
+            stats->bytes_uncompressed_received = snapshot->counters[STATS_BYTES_UNCOMPRESSED_RECEIVED];
+            stats->bytes_compressed_received = snapshot->counters[STATS_BYTES_COMPRESSED_RECEIVED];
+
+            stats_snapshot_packets_per_type (snapshot, false, stats->received_packets);
+            stats_snapshot_packets_per_type (snapshot, true, stats->sent_packets);
+
+            free (snapshot);
+        }
+    }
+
+}
+
 #pragma endregion
 
 Connection *connection_new (void) {
@@ -79,16 +132,37 @@ Connection *connection_new (void) {
         connection->max_sleep = DEFAULT_CONNECTION_MAX_SLEEP;
         connection->connected = false;
 
+        connection->state = CONNECTION_STATE_DISCONNECTED;
+        connection->connect_timeout = DEFAULT_CONNECTION_CONNECT_TIMEOUT;
+        connection->reconnect = false;
+        connection->reconnect_attempts = 0;
+
+        connection->heartbeat_interval = 0;
+        connection->idle_timeout = 0;
+        connection->last_received = 0;
+        connection->last_heartbeat = 0;
+        connection->heartbeat_sequence = 0;
+
         connection->cerver = NULL;
 
         connection->receive_packet_buffer_size = RECEIVE_PACKET_BUFFER_SIZE;
         connection->sock_receive = NULL;
 
+        connection->udp = NULL;
+
+        connection->compression_codecs = PACKET_CODEC_NONE;
+        connection->compression = PACKET_CODEC_NONE;
+        connection->compression_threshold = PACKET_COMPRESSION_THRESHOLD;
+
         connection->update_thread_id = 0;
         connection->update_sleep = DEFAULT_CONNECTION_UPDATE_SLEEP;
+        connection->started = false;
 
         connection->full_packet = false;
 
+        connection->requests = NULL;
+        connection->transfers = NULL;
+
         connection->received_data = NULL;
         connection->received_data_size = 0;
         connection->received_data_delete = NULL;
@@ -125,6 +199,12 @@ void connection_delete (void *connection_ptr) {
         
         sock_receive_delete (connection->sock_receive);
 
+        udp_state_delete (connection->udp);
+
+        connection_requests_delete (connection->requests);
+
+        file_transfers_delete (connection->transfers);
+
         if (connection->received_data && connection->received_data_delete)
             connection->received_data_delete (connection->received_data);
 
@@ -145,6 +225,8 @@ Connection *connection_create_empty (void) {
 
         connection->socket = (Socket *) socket_create_empty ();
         connection->sock_receive = sock_receive_new ();
+        connection->requests = connection_requests_new ();
+        connection->transfers = file_transfers_new ();
         connection->stats = connection_stats_create ();
     }
 
@@ -188,13 +270,47 @@ void connection_set_name (Connection *connection, const char *name) {
 }
 
 // sets the connection max sleep (wait time) to try to connect to the cerver
+// 18/10/2026 -- it is the biggest wait between two attempts, connection_start () gives up when the backoff gets to it
 void connection_set_max_sleep (Connection *connection, u32 max_sleep) {
 
     if (connection) connection->max_sleep = max_sleep;
 
 }
 
-// read packets into a buffer of this size in client_receive ()
+// 18/10/2026 -- sets how many ms each connect () attempt can take before it is considered failed
+// timeout = 0 uses DEFAULT_CONNECTION_CONNECT_TIMEOUT
+void connection_set_connect_timeout (Connection *connection, u32 timeout) {
+
+    if (connection) connection->connect_timeout = timeout ? timeout : DEFAULT_CONNECTION_CONNECT_TIMEOUT;
+
+}
+
+// 18/10/2026 -- when a started connection is lost, it is connected again with a jittered exponential backoff
+// that starts in CONNECTION_BACKOFF_BASE ms & waits up to max_sleep secs, max_attempts = 0 keeps trying
+// CLIENT_EVENT_CONNECTED is triggered when it succeeds, & CLIENT_EVENT_CONNECTION_FAILED if it gives up
+void connection_set_reconnect (Connection *connection, bool reconnect, u32 max_attempts) {
+
+    if (connection) {
+        connection->reconnect = reconnect;
+        connection->reconnect_attempts = max_attempts;
+    }
+
+}
+
+// 18/10/2026 -- sends a heartbeat every heartbeat_interval ms to measure the rtt (stats->rtt),
+// & considers the connection lost if nothing has been received in idle_timeout ms, so
+// CLIENT_EVENT_DISCONNECTED is triggered (& it is reconnected, if enabled)
+// it only works in started connections, 0 disables any of them (default)
+void connection_set_keepalive (Connection *connection, u32 heartbeat_interval, u32 idle_timeout) {
+
+    if (connection) {
+        connection->heartbeat_interval = heartbeat_interval;
+        connection->idle_timeout = idle_timeout;
+    }
+
+}
+
+// initial size of the persistent buffer that client_receive () reads packets into, it grows to fit bigger packets
 // by default the value RECEIVE_PACKET_BUFFER_SIZE is used
 void connection_set_receive_buffer_size (Connection *connection, u32 size) {
 
@@ -210,6 +326,81 @@ void connection_set_update_sleep (Connection *connection, u32 sleep) {
 
 }
 
+// 18/10/2026 -- coalesces the packets that are sent in the connection, so many small packets
+// go out with a single syscall, sendmsg () in tcp (like writev ()) & sendmmsg () in udp
+// the batch is sent when it has max_bytes, when its first packet has waited max_delay micro secs,
+// or with connection_flush (), with max_delay = 0 it only waits for one of the other two
+// max_bytes = 0 disables batching (default), it should be set before the connection is started
+void connection_set_send_batch (Connection *connection, size_t max_bytes, u32 max_delay) {
+
+    if (connection && connection->socket) {
+        socket_batch_set (connection->socket, max_bytes, max_delay, connection->protocol == PROTOCOL_UDP);
+
+        // the update thread has to wake up to send the batches that have waited too much
+        connection_update_receive_timeout (connection);
+    }
+
+}
+
+// 18/10/2026 -- offers the codecs (PacketCodec bits) to the cerver after its CERVER_INFO packet,
+// once it chooses one, packets with at least threshold bytes of data are sent compressed with it
+// threshold = 0 uses PACKET_COMPRESSION_THRESHOLD, codecs = 0 disables compression (default)
+void connection_set_compression (Connection *connection, u8 codecs, u32 threshold) {
+
+    if (connection) {
+        connection->compression_codecs = codecs & PACKET_FLAGS_COMPRESSED;
+        connection->compression_threshold = threshold ? threshold : PACKET_COMPRESSION_THRESHOLD;
+
+        if (!connection->compression_codecs) connection->compression = PACKET_CODEC_NONE;
+    }
+
+}
+
+// sends the codecs that the connection can use to the cerver, it answers with CERVER_COMPRESSION
+// returns 0 on success, 1 on error
+u8 connection_compression_request (Client *client, Connection *connection) {
+
+    u8 retval = 1;
+
+    if (client && connection && connection->compression_codecs) {
+        SPacketCompression scompression = { 0 };
+        scompression.codecs = connection->compression_codecs;
+        scompression.threshold = connection->compression_threshold;
+
+        Packet *packet = packet_generate_request (CLIENT_PACKET, CLIENT_COMPRESSION, 
+            &scompression, sizeof (SPacketCompression));
+        if (packet) {
+            packet_set_network_values (packet, client, connection);
+            retval = packet_send (packet, 0, NULL, false);
+            packet_delete (packet);
+        }
+    }
+
+    return retval;
+
+}
+
+// sets how long recv () can block in the connection update thread, so it can also send the udp acks,
+// the expired send batches & end the requests that have timed out
+void connection_update_receive_timeout (Connection *connection) {
+
+    if (connection && connection->socket && (connection->socket->sock_fd >= 0)) {
+        u32 wait = (connection->protocol == PROTOCOL_UDP) ? UDP_UPDATE_INTERVAL * 1000 : 0;
+
+        // before the connection is started, recv () is only called when a packet is expected
+        if (connection->started && (!wait || (CLIENT_REQUEST_CHECK_INTERVAL * 1000 < wait)))
+            wait = CLIENT_REQUEST_CHECK_INTERVAL * 1000;
+
+        Socket *socket = connection->socket;
+        if (socket->batch_max && socket->batch_delay && (!wait || (socket->batch_delay < wait)))
+            wait = socket->batch_delay;
+
+        struct timeval timeout = { wait / 1000000, wait % 1000000 };
+        (void) setsockopt (socket->sock_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (struct timeval));
+    }
+
+}
+
 // sets the connection received data
 // 01/01/2020 - a place to safely store the request response, like when using client_connection_request_to_cerver ()
 void connection_set_received_data (Connection *connection, void *data, size_t data_size, Action data_delete) {
@@ -310,6 +501,12 @@ static u8 connection_init (Connection *connection) {
                 break;
             case IPPROTO_UDP:
                 connection->socket->sock_fd = socket ((connection->use_ipv6 == 1 ? AF_INET6 : AF_INET), SOCK_DGRAM, 0);
+                if (connection->socket->sock_fd > 0) {
+                    // recv () must return from time to time to send again the reliable packets
+                    connection_update_receive_timeout (connection);
+
+                    connection->udp = udp_state_new ();
+                }
                 break;
 
             default: 
@@ -376,27 +573,171 @@ Connection *connection_create (const char *ip_address, u16 port, Protocol protoc
 
 }
 
+// 18/10/2026 -- the size of the cerver's address, connect () needs the one of its family
+static inline socklen_t connection_address_size (const Connection *connection) {
+
+    return connection->use_ipv6 ? sizeof (struct sockaddr_in6) : sizeof (struct sockaddr_in);
+
+}
+
+// 18/10/2026 -- makes a single connect () without blocking, and waits up to connect_timeout ms for it
+// returns 0 on success, 1 on error
+static u8 connection_connect (Connection *connection) {
+
+    u8 retval = 1;
+
+    int sock_fd = connection->socket->sock_fd;
+    if (sock_set_blocking (sock_fd, false)) {
+        int rc = connect (sock_fd, (const struct sockaddr *) &connection->address, 
+            connection_address_size (connection));
+
+        if (rc && (errno == EINPROGRESS)) {
+            struct pollfd pfd = { .fd = sock_fd, .events = POLLOUT, .revents = 0 };
+            do {
+                rc = poll (&pfd, 1, (int) connection->connect_timeout);
+            } while ((rc < 0) && (errno == EINTR));
+
+            // the result of the connect () is in the socket error
+            int error = 0;
+            socklen_t error_size = sizeof (int);
+            if ((rc > 0) && !getsockopt (sock_fd, SOL_SOCKET, SO_ERROR, &error, &error_size) && !error) rc = 0;
+            else rc = -1;
+        }
+
+        (void) sock_set_blocking (sock_fd, true);
+
+        if (!rc) retval = 0;
+    }
+
+    return retval;
+
+}
+
+// 18/10/2026 -- a tcp socket can not connect again after a failed attempt, so a new one is created
+// returns 0 on success, 1 on error
+static u8 connection_socket_renew (Connection *connection) {
+
+    u8 retval = 1;
+
+    if (connection->protocol == PROTOCOL_TCP) {
+        close (connection->socket->sock_fd);
+        connection->socket->sock_fd = socket ((connection->use_ipv6 ? AF_INET6 : AF_INET), SOCK_STREAM, 0);
+
+        if (connection->socket->sock_fd >= 0) retval = 0;
+    }
+
+    else retval = 0;
+
+    return retval;
+
+}
+
+static __thread unsigned int connection_backoff_seed = 0;
+
+// returns how many ms to wait before the next attempt, after attempt (starting in 0) has failed
+u32 connection_backoff (Connection *connection, u32 attempt) {
+
+    if (!connection_backoff_seed) connection_backoff_seed = (unsigned int) (time (NULL) ^ (long) pthread_self ());
+
+    u64 wait = (u64) CONNECTION_BACKOFF_BASE << (attempt < 16 ? attempt : 16);
+    u64 max_wait = (u64) connection->max_sleep * 1000;
+    if (wait > max_wait) wait = max_wait;
+
+    // half of it is random, so the clients that lost the same cerver do not try again all at the same time
+    return (u32) (wait / 2 + (u64) rand_r (&connection_backoff_seed) % (wait / 2 + 1));
+
+}
+
 // try to connect a client to an address (server) with exponential backoff
-static u8 connection_try (Connection *connection, const struct sockaddr_storage address) {
+// 18/10/2026 -- until the next wait would be longer than the connection max sleep
+static u8 connection_try (Connection *connection) {
 
-    for (u32 numsec = 2; numsec <= connection->max_sleep; numsec <<= 1) {
-        if (!connect (connection->socket->sock_fd, 
-            (const struct sockaddr *) &address, 
-            sizeof (struct sockaddr))) 
-            return 0;
+    u8 retval = 1;
 
-        if (numsec <= connection->max_sleep / 2) sleep (numsec);
-    } 
+    connection->state = CONNECTION_STATE_CONNECTING;
+
+    for (u32 attempt = 0; ; attempt++) {
+        if (!connection_connect (connection)) {
+            retval = 0;
+            break;
+        }
 
-    return 1;
+        if (((u64) CONNECTION_BACKOFF_BASE << attempt) > (u64) connection->max_sleep * 1000) break;
+
+        usleep (connection_backoff (connection, attempt) * 1000);
+
+        if (connection_socket_renew (connection)) break;
+    }
+
+    if (!retval) {
+        connection->state = CONNECTION_STATE_CONNECTED;
+        connection->last_received = connection_time ();
+        connection->last_heartbeat = connection->last_received;
+    }
+
+    else connection->state = CONNECTION_STATE_DISCONNECTED;
+
+    return retval;
 
 }
 
 // starts a connection -> connects to the specified ip and port
+// 18/10/2026 -- each attempt can take connect_timeout ms, & they are made with a jittered exponential backoff
 // returns 0 on success, 1 on error
 int connection_start (Connection *connection) {
 
-    return (connection ? connection_try (connection, connection->address) : 1);
+    return (connection ? connection_try (connection) : 1);
+
+}
+
+// creates a new socket for a closed connection & makes a single attempt to connect it,
+// what was left from the previous one (cerver info, auth, compression, queued bytes) is discarded
+// returns 0 on success, 1 on error
+u8 connection_restart (Connection *connection) {
+
+    u8 retval = 1;
+
+    if (connection && connection->socket && !connection->connected) {
+        if (connection->socket->sock_fd >= 0) {
+            close (connection->socket->sock_fd);
+            connection->socket->sock_fd = -1;
+        }
+
+        pthread_mutex_lock (connection->socket->write_mutex);
+        socket_reset (connection->socket);
+        pthread_mutex_unlock (connection->socket->write_mutex);
+
+        if (connection->sock_receive) {
+            connection->sock_receive->start = 0;
+            connection->sock_receive->end = 0;
+        }
+
+        udp_state_delete (connection->udp);
+        connection->udp = NULL;
+
+        // the cerver sends them again after we connect
+        cerver_delete (connection->cerver);
+        connection->cerver = NULL;
+        connection->authenticated = false;
+        connection->compression = PACKET_CODEC_NONE;
+        connection->full_packet = false;
+
+        if (!connection_init (connection)) {
+            if (!connection_connect (connection)) {
+                connection->last_received = connection_time ();
+                connection->last_heartbeat = connection->last_received;
+
+                retval = 0;
+            }
+
+            else {
+                close (connection->socket->sock_fd);
+                connection->socket->sock_fd = -1;
+            }
+        }
+    }
+
+    return retval;
 
 }
 
@@ -436,34 +777,202 @@ void connection_update (void *ptr) {
         ConnectionCustomReceiveData *custom_data = connection_custom_receive_data_new (cc->client, cc->connection, 
             cc->connection->custom_receive_args);
 
-        cc->connection->sock_receive = sock_receive_new ();
+        // keep any bytes that were already received into the connection buffer
+        if (!cc->connection->sock_receive) cc->connection->sock_receive = sock_receive_new ();
 
-        while (cc->client->running && cc->connection->connected) {
-            if (cc->connection->custom_receive) {
-                // if a custom receive method is set, use that one directly
-                cc->connection->custom_receive (custom_data);
-            } 
+        // 18/10/2026 -- a lost connection is connected again by this thread
+        cc->connection->update_thread_id = pthread_self ();
 
-            else {
-                // use the default receive method that expects cerver type packages
-                client_receive (cc->client, cc->connection);
+        bool running = true;
+        while (running) {
+            while (cc->client->running && cc->connection->connected) {
+                if (cc->connection->custom_receive) {
+                    // if a custom receive method is set, use that one directly
+                    cc->connection->custom_receive (custom_data);
+                } 
+
+                else {
+                    // use the default receive method that expects cerver type packages
+                    client_receive (cc->client, cc->connection);
+                }
+
+                // send the batch if nothing else has done it in time
+                if (cc->connection->connected) {
+                    pthread_mutex_lock (cc->connection->socket->write_mutex);
+                    (void) socket_batch_flush_expired (cc->connection->socket);
+                    pthread_mutex_unlock (cc->connection->socket->write_mutex);
+                }
+
+                connection_requests_expire (cc->connection);
+
+                if (connection_keepalive (cc->client, cc->connection))
+                    client_connection_lost (cc->client, cc->connection, true);
+            }
+
+            running = (__atomic_load_n (&cc->connection->state, __ATOMIC_ACQUIRE) == CONNECTION_STATE_RECONNECTING)
+                && !client_connection_reconnect (cc->client, cc->connection);
+
+            if (running) {
+                cc->connection->started = true;
+                connection_update_receive_timeout (cc->connection);
             }
         }
 
+        cc->connection->update_thread_id = 0;
+
         connection_custom_receive_data_delete (custom_data);
         client_connection_aux_delete (cc);
     }
 
 }
 
-// closes a connection directly
+#pragma region keepalive
+
+static inline u64 connection_time_us (void) {
+
+    struct timespec now = { 0 };
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return (u64) now.tv_sec * 1000000 + (u64) now.tv_nsec / 1000;
+
+}
+
+// returns the CLOCK_MONOTONIC time in ms
+u64 connection_time (void) {
+
+    return connection_time_us () / 1000;
+
+}
+
+// returns true if the connection sends heartbeats or has an idle timeout
+bool connection_keepalive_enabled (const Connection *connection) {
+
+    return connection && (connection->heartbeat_interval || connection->idle_timeout);
+
+}
+
+// returns 0 on success, 1 on error
+static u8 connection_heartbeat_send (Client *client, Connection *connection, const SHeartbeat *heartbeat) {
+
+    u8 retval = 1;
+
+    Packet *packet = packet_generate_request (CLIENT_PACKET, CLIENT_HEARTBEAT, (void *) heartbeat, sizeof (SHeartbeat));
+    if (packet) {
+        packet_set_network_values (packet, client, connection);
+        retval = packet_send (packet, 0, NULL, false);
+        packet_delete (packet);
+
+        // waiting in the batch would be measured as rtt
+        if (!retval && socket_batch_enabled (connection->socket)) retval = connection_flush (connection);
+    }
+
+    return retval;
+
+}
+
+// sends the heartbeat if it is time to do it
+// the idle timeout is not checked in connections with a custom receive method, as they do not tell when they receive
+// returns 1 if the connection has been idle for too much, so it should be considered lost, 0 if not
+u8 connection_keepalive (Client *client, Connection *connection) {
+
+    u8 retval = 0;
+
+    if (client && connection && connection->connected) {
+        u64 now = connection_time ();
+
+        u64 last_received = __atomic_load_n (&connection->last_received, __ATOMIC_RELAXED);
+        if (connection->idle_timeout && !connection->custom_receive 
+            && (now > last_received) && ((now - last_received) >= connection->idle_timeout)) {
+            retval = 1;
+        }
+
+        else if (connection->heartbeat_interval && ((now - connection->last_heartbeat) >= connection->heartbeat_interval)) {
+            connection->last_heartbeat = now;
+
+            SHeartbeat heartbeat = { 0 };
+            heartbeat.sequence = connection->heartbeat_sequence++;
+            heartbeat.timestamp = connection_time_us ();
+
+            if (connection_heartbeat_send (client, connection, &heartbeat)) {
+                #ifdef CLIENT_DEBUG
+                cengine_log_msg (stderr, LOG_WARNING, LOG_CLIENT, "Failed to send a heartbeat!");
+                #endif
+            }
+        }
+    }
+
+    return retval;
+
+}
+
+// handles a CLIENT_HEARTBEAT packet, answers the pings of the cerver & measures the rtt with its replies
+void connection_heartbeat_handler (Packet *packet) {
+
+    if (packet && packet->connection && packet->data && (packet->data_size >= sizeof (SHeartbeat))) {
+        // the data may not be aligned
+        SHeartbeat heartbeat = { 0 };
+        memcpy (&heartbeat, packet->data, sizeof (SHeartbeat));
+
+        if (heartbeat.reply) {
+            // our timestamps are micro secs
+            u64 now = connection_time_us ();
+            if (heartbeat.timestamp <= now) {
+                float rtt = (float) (now - heartbeat.timestamp) / 1000.0f;
+
+                ConnectionStats *stats = packet->connection->stats;
+                if (stats->rtt == 0.0f) stats->rtt = rtt;
+                else stats->rtt += CONNECTION_RTT_SMOOTHING * (rtt - stats->rtt);
+            }
+        }
+
+        else {
+            heartbeat.reply = 1;
+            (void) connection_heartbeat_send (packet->client, packet->connection, &heartbeat);
+        }
+    }
+
+}
+
+#pragma endregion
+
+// sends every packet that is waiting in the connection send batch
+// returns 0 on success, 1 on error
+u8 connection_flush (Connection *connection) {
+
+    u8 retval = 1;
+
+    if (connection && connection->socket) {
+        pthread_mutex_lock (connection->socket->write_mutex);
+        retval = socket_batch_flush (connection->socket);
+        pthread_mutex_unlock (connection->socket->write_mutex);
+    }
+
+    return retval;
+
+}
+
+// closes a connection directly, the packets in the send batch are sent before
+// and the requests that are waiting for a response end with CLIENT_REQUEST_FAILED, as the file transfers
+// 18/10/2026 -- a connection that is waiting to reconnect stops trying
 void connection_close (Connection *connection) {
 
     if (connection) {
+        __atomic_store_n (&connection->state, CONNECTION_STATE_DISCONNECTED, __ATOMIC_RELEASE);
+
         if (connection->connected) {
+            (void) connection_flush (connection);
+
+            // the reactor must stop watching the socket before it is closed
+            client_reactor_unregister (connection);
+
             close (connection->socket->sock_fd);
             connection->socket->sock_fd = -1;
             connection->connected = false;
+            connection->started = false;
+
+            // no response can arrive anymore
+            connection_requests_fail (connection);
+            connection_file_transfers_fail (connection);
         }
     }
 
@@ -216,6 +216,8 @@ u8 client_error_trigger (const ClientErrorType error_type,
             // trigger the action
             if (error->action) {
                 if (error->create_thread) {
+                    // user actions may block for as long as they want, so they get their own thread
+                    // instead of an io worker, that would stall the engine's io jobs
                     pthread_t thread_id = 0;
                     retval = thread_create_detachable (
                         &thread_id,
@@ -327,6 +329,14 @@ void error_packet_handler (Packet *packet) {
 					); 
 					break;
 
+				case CLIENT_ERROR_FILE_TRANSFER: 
+					client_error_trigger (
+						CLIENT_ERROR_FILE_TRANSFER,
+						packet->client, packet->connection,
+						s_error->msg
+					); 
+					break;
+
 				default: 
 					cengine_log_msg (stderr, LOG_WARNING, LOG_NO_TYPE, "Unknown error received from cerver!"); 
 					break;
@@ -226,6 +226,8 @@ void client_event_trigger (const ClientEventType event_type,
             // trigger the action
             if (event->action) {
                 if (event->create_thread) {
+                    // user actions may block for as long as they want, so they get their own thread
+                    // instead of an io worker, that would stall the engine's io jobs
                     pthread_t thread_id = 0;
                     thread_create_detachable (
                         &thread_id,
@@ -1,8 +1,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
 
 #include <errno.h>
+#include <time.h>
 
 #include "cengine/types/types.h"
 
@@ -17,6 +19,10 @@
 #include "cengine/client/connection.h"
 #include "cengine/client/handler.h"
 #include "cengine/client/game.h"
+#include "cengine/client/requests.h"
+#include "cengine/client/stats.h"
+#include "cengine/client/transfer.h"
+#include "cengine/client/udp.h"
 
 #include "cengine/threads/thread.h"
 
@@ -25,17 +31,25 @@
 
 #pragma region auxiliary
 
+// 18/10/2026 -- nano secs, to measure how much time the handlers take
+static u64 handler_time (void) {
+
+    struct timespec now;
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return (u64) now.tv_sec * 1000000000ULL + (u64) now.tv_nsec;
+
+}
+
 SockReceive *sock_receive_new (void) {
 
     SockReceive *sr = (SockReceive *) malloc (sizeof (SockReceive));
     if (sr) {
-        sr->spare_packet = NULL;
-        sr->missing_packet = 0;
+        sr->buffer = NULL;
+        sr->buffer_size = 0;
 
-        sr->header = NULL;
-        sr->header_end = NULL;
-        sr->remaining_header = 0;
-        sr->complete_header = false;
+        sr->start = 0;
+        sr->end = 0;
     } 
 
     return sr;
@@ -45,7 +59,7 @@ SockReceive *sock_receive_new (void) {
 void sock_receive_delete (void *sock_receive_ptr) {
 
     if (sock_receive_ptr) {
-        packet_delete (((SockReceive *) sock_receive_ptr)->spare_packet);
+        free (((SockReceive *) sock_receive_ptr)->buffer);
         free (sock_receive_ptr);
     }
 
@@ -72,6 +86,18 @@ static void client_client_packet_handler (Packet *packet) {
                     client_event_trigger (CLIENT_EVENT_DISCONNECTED, packet->client, NULL);
                     break;
 
+                // 18/10/2026 -- a ping from the cerver or the reply to ours
+                case CLIENT_HEARTBEAT:
+                    connection_heartbeat_handler (packet);
+                    break;
+
+                // 18/10/2026 -- a file that we are sending or receiving
+                case CLIENT_FILE_HEADER:
+                case CLIENT_FILE_CHUNK:
+                case CLIENT_FILE_ACK:
+                    file_transfer_packet_handler (packet);
+                    break;
+
                 default: 
                     cengine_log_msg (stderr, LOG_WARNING, LOG_NO_TYPE, "Unknown client packet type.");
                     break;
@@ -172,11 +198,16 @@ static void client_request_packet_handler (Packet *packet) {
 }
 
 // the client handles a packet based on its type
+// the packet is owned by the caller, handlers must use packet_retain () to keep it
 static void client_packet_handler (void *data) {
 
     if (data) {
         Packet *packet = (Packet *) data;
-        packet->client->stats->n_packets_received += 1;
+
+        // 18/10/2026 -- the counters & the histograms are in the shard of this thread
+        u64 start = handler_time ();
+        stats_add (packet->client->stats->counters, STATS_PACKETS_RECEIVED, 1);
+        stats_add (packet->connection->stats->counters, STATS_PACKETS_RECEIVED, 1);
 
         bool good = true;
         if (packet->client->check_packets) {
@@ -193,12 +224,22 @@ static void client_packet_handler (void *data) {
             }
         }
 
-        if (good) {
+        StatsPacketType stats_type = good ? stats_packet_type (packet->header->packet_type) : STATS_PACKET_BAD;
+        if (stats_type == STATS_PACKET_UNKNOWN) stats_type = STATS_PACKET_BAD;
+
+        stats_received (packet->client->stats->counters, stats_type);
+        stats_received (packet->connection->stats->counters, stats_type);
+
+        // 18/10/2026 -- the response to a request made with client_request_send ()
+        ClientRequest *request = good ? connection_requests_take (packet->connection, packet) : NULL;
+        if (request && !request->handle) {
+            client_request_end (request, CLIENT_REQUEST_DONE, packet);
+        }
+
+        else if (good) {
             switch (packet->header->packet_type) {
                 // handles cerver type packets
                 case CERVER_PACKET:
-                    packet->client->stats->received_packets->n_cerver_packets += 1;
-                    packet->connection->stats->received_packets->n_cerver_packets += 1;
                     cerver_packet_handler (packet); 
                     break;
 
@@ -209,74 +250,58 @@ static void client_packet_handler (void *data) {
 
                 // handles an error from the server
                 case ERROR_PACKET: 
-                    packet->client->stats->received_packets->n_error_packets += 1;
-                    packet->connection->stats->received_packets->n_error_packets += 1;
                     error_packet_handler (packet); 
                     break;
 
                 // handles authentication packets
                 case AUTH_PACKET: 
-                    packet->client->stats->received_packets->n_auth_packets += 1;
-                    packet->connection->stats->received_packets->n_auth_packets += 1;
                     client_auth_packet_handler (packet); 
                     break;
 
                 // handles a request made from the server
                 case REQUEST_PACKET: 
-                    packet->client->stats->received_packets->n_request_packets += 1; 
-                    packet->connection->stats->received_packets->n_request_packets += 1; 
                     client_request_packet_handler (packet);
                     break;
 
                 // handles a game packet sent from the server
                 case GAME_PACKET: 
-                    packet->client->stats->received_packets->n_game_packets += 1;
-                    packet->connection->stats->received_packets->n_game_packets += 1;
                     client_game_packet_handler (packet);
                     break;
 
                 // user set handler to handle app specific errors
                 case APP_ERROR_PACKET: 
-                    packet->client->stats->received_packets->n_app_error_packets += 1;
-                    packet->connection->stats->received_packets->n_app_error_packets += 1;
                     if (packet->client->app_error_packet_handler)
                         packet->client->app_error_packet_handler (packet);
                     break;
 
                 // user set handler to handler app specific packets
                 case APP_PACKET:
-                    packet->client->stats->received_packets->n_app_packets += 1;
-                    packet->connection->stats->received_packets->n_app_packets += 1;
                     if (packet->client->app_packet_handler)
                         packet->client->app_packet_handler (packet);
                     break;
 
                 // custom packet hanlder
                 case CUSTOM_PACKET: 
-                    packet->client->stats->received_packets->n_custom_packets += 1;
-                    packet->connection->stats->received_packets->n_custom_packets += 1;
                     if (packet->client->custom_packet_handler)
                         packet->client->custom_packet_handler (packet);
                     break;
 
                 // handles a test packet form the cerver
                 case TEST_PACKET: 
-                    packet->client->stats->received_packets->n_test_packets += 1;
-                    packet->connection->stats->received_packets->n_test_packets += 1;
                     cengine_log_msg (stdout, LOG_TEST, LOG_NO_TYPE, "Got a test packet from cerver.");
                     break;
 
                 default:
-                    packet->client->stats->received_packets->n_bad_packets += 1;
-                    packet->connection->stats->received_packets->n_bad_packets += 1;
                     #ifdef CLIENT_DEBUG
                     cengine_log_msg (stdout, LOG_WARNING, LOG_NO_TYPE, "Got a packet of unknown type.");
                     #endif
                     break;
             }
+
+            if (request) client_request_end (request, CLIENT_REQUEST_DONE, NULL);
         }
 
-        packet_delete (packet);
+        stats_handled (packet->client->stats->counters, stats_type, packet->header->packet_size, handler_time () - start);
     }
 
 }
@@ -285,213 +310,162 @@ static void client_packet_handler (void *data) {
 
 #pragma region receive
 
-static void client_receive_handle_spare_packet (Client *client, Connection *connection, 
-    size_t buffer_size, char **end, size_t *buffer_pos) {
+// packets are not aligned inside the buffer, so the header values are copied out
+static inline size_t client_receive_packet_size (const char *start) {
 
-    if (connection->sock_receive->header) {
-        // copy the remaining header size
-        memcpy (connection->sock_receive->header_end, (void *) *end, connection->sock_receive->remaining_header);
+    size_t packet_size = 0;
+    memcpy (&packet_size, start + offsetof (PacketHeader, packet_size), sizeof (size_t));
 
-        connection->sock_receive->complete_header = true;
-    }
+    return packet_size;
 
-    else if (connection->sock_receive->spare_packet) {
-        size_t copy_to_spare = 0;
-        if (connection->sock_receive->missing_packet < buffer_size) 
-            copy_to_spare = connection->sock_receive->missing_packet;
-
-        else copy_to_spare = buffer_size;
+}
 
-        // append new data from buffer to the spare packet
-        if (copy_to_spare > 0) {
-            packet_append_data (connection->sock_receive->spare_packet, *end, copy_to_spare);
+// sets up a packet that points to a complete packet inside the receive buffer
+// only the header is copied into the header storage, the data is used in place
+static inline void client_receive_packet_view (Packet *packet, PacketHeader *header,
+    Client *client, Connection *connection, char *start) {
 
-            // check if we can handler the packet 
-            size_t curr_packet_size = connection->sock_receive->spare_packet->data_size + sizeof (PacketHeader);
-            if (connection->sock_receive->spare_packet->header->packet_size == curr_packet_size) {
-                connection->sock_receive->spare_packet->client = client;
-                connection->sock_receive->spare_packet->connection = connection;
+    memcpy (header, start, sizeof (PacketHeader));
 
-                connection->full_packet = true;
-                client_packet_handler (connection->sock_receive->spare_packet);
+    packet->cerver = NULL;
+    packet->client = client;
+    packet->connection = connection;
 
-                connection->sock_receive->spare_packet = NULL;
-                connection->sock_receive->missing_packet = 0;
-            }
+    packet->packet_type = header->packet_type;
+    packet->req_type = header->request_type;
 
-            else connection->sock_receive->missing_packet -= copy_to_spare;
+    packet->data_size = header->packet_size - sizeof (PacketHeader);
+    packet->data = packet->data_size ? start + sizeof (PacketHeader) : NULL;
+    packet->data_ptr = (char *) packet->data;
+    packet->data_end = packet->data_ptr + packet->data_size;
+    packet->data_ref = true;
 
-            // offset for the buffer
-            if (copy_to_spare < buffer_size) *end += copy_to_spare;
-            *buffer_pos += copy_to_spare;
-        }
-    }
+    packet->header = header;
+    packet->header_ref = true;
+    packet->version = NULL;
+    packet->packet_size = header->packet_size;
+    packet->packet = start;
+    packet->packet_ref = true;
 
 }
 
-// splits the entry buffer in packets of the correct size
-static void client_receive_handle_buffer (Client *client, Connection *connection, 
-    char *buffer, size_t buffer_size) {
+// 18/10/2026 -- passes a received packet to the handler, compressed packets are decompressed first
+static void client_receive_handle_packet (Client *client, Connection *connection, Packet *packet) {
 
-    if (buffer && (buffer_size > 0)) {
-        char *end = buffer;
-        size_t buffer_pos = 0;
+    if (packet->header->flags & PACKET_FLAGS_COMPRESSED) {
+        size_t compressed_size = packet->data_size;
+        if (!packet_decompress (packet)) {
+            stats_add (connection->stats->counters, STATS_COMPRESSED_RECEIVED, 1);
+            stats_add (connection->stats->counters, STATS_BYTES_COMPRESSED_RECEIVED, compressed_size);
+            stats_add (connection->stats->counters, STATS_BYTES_UNCOMPRESSED_RECEIVED, packet->data_size);
 
-        SockReceive *sock_receive = connection->sock_receive;
+            client_packet_handler (packet);
 
-        client_receive_handle_spare_packet (
-            client, connection, 
-            buffer_size, &end, 
-            &buffer_pos
-        );
+            packet_decompress_end (packet);
+        }
 
-        PacketHeader *header = NULL;
-        size_t packet_size = 0;
-        // char *packet_data = NULL;
+        else {
+            cengine_log_msg (stderr, LOG_WARNING, LOG_CLIENT, "Failed to decompress a packet!");
 
-        size_t remaining_buffer_size = 0;
-        size_t packet_real_size = 0;
-        size_t to_copy_size = 0;
+            stats_received (client->stats->counters, STATS_PACKET_BAD);
+            stats_received (connection->stats->counters, STATS_PACKET_BAD);
+        }
+    }
 
-        bool spare_header = false;
+    else client_packet_handler (packet);
 
-        while (buffer_pos < buffer_size) {
-            remaining_buffer_size = buffer_size - buffer_pos;
+}
 
-            if (sock_receive->complete_header) {
-                packet_header_copy (&header, (PacketHeader *) sock_receive->header);
-                // header = ((PacketHeader *) sock_receive->header);
-                // packet_header_print (header);
+// makes sure the unfinished packet at the start position fits in the buffer
+// returns 0 on success, 1 on error
+static u8 client_receive_make_space (Client *client, Connection *connection, SockReceive *sr) {
 
-                end += sock_receive->remaining_header;
-                buffer_pos += sock_receive->remaining_header;
-                // printf ("buffer pos after copy to header: %ld\n", buffer_pos);
+    u8 retval = 1;
 
-                // reset sock header values
-                free (sock_receive->header);
-                sock_receive->header = NULL;
-                sock_receive->header_end = NULL;
-                // sock_receive->curr_header_pos = 0;
-                // sock_receive->remaining_header = 0;
-                sock_receive->complete_header = false;
+    size_t remaining = sr->end - sr->start;
+    size_t needed = sizeof (PacketHeader);
+    if (remaining >= sizeof (PacketHeader))
+        needed = client_receive_packet_size (sr->buffer + sr->start);
 
-                spare_header = true;
-            }
+    // the packet wraps, move what we have of it to the start of the buffer
+    if (sr->start && (needed > sr->buffer_size - sr->start)) {
+        memmove (sr->buffer, sr->buffer + sr->start, remaining);
+        sr->start = 0;
+        sr->end = remaining;
+    }
 
-            else if (remaining_buffer_size >= sizeof (PacketHeader)) {
-                header = (PacketHeader *) end;
-                end += sizeof (PacketHeader);
-                buffer_pos += sizeof (PacketHeader);
+    if (needed > sr->buffer_size) {
+        size_t new_size = sr->buffer_size * 2;
+        if (new_size < needed) new_size = needed;
+        if (new_size > RECEIVE_PACKET_MAX_SIZE) new_size = RECEIVE_PACKET_MAX_SIZE;
 
-                // packet_header_print (header);
+        char *buffer = (char *) realloc (sr->buffer, new_size);
+        if (buffer) {
+            sr->buffer = buffer;
+            sr->buffer_size = new_size;
 
-                spare_header = false;
-            }
+            stats_add (client->stats->counters, STATS_RECEIVE_ALLOCS, 1);
+            stats_add (connection->stats->counters, STATS_RECEIVE_ALLOCS, 1);
 
-            if (header) {
-                // check the packet size
-                packet_size = header->packet_size;
-                if ((packet_size > 0) /* && (packet_size < 65536) */) {
-                    // printf ("packet_size: %ld\n", packet_size);
-                    // end += sizeof (PacketHeader);
-                    // buffer_pos += sizeof (PacketHeader);
-                    // printf ("first buffer pos: %ld\n", buffer_pos);
-
-                    Packet *packet = packet_new ();
-                    if (packet) {
-                        packet_header_copy (&packet->header, header);
-                        packet->packet_size = header->packet_size;
-                        // packet->cerver = cerver;
-                        // packet->lobby = lobby;
-                        packet->client = client;
-                        packet->connection = connection;
-
-                        if (spare_header) {
-                            free (header);
-                            header = NULL;
-                        }
-
-                        // check for packet size and only copy what is in the current buffer
-                        packet_real_size = packet->header->packet_size - sizeof (PacketHeader);
-                        to_copy_size = 0;
-                        if ((remaining_buffer_size - sizeof (PacketHeader)) < packet_real_size) {
-                            sock_receive->spare_packet = packet;
-
-                            if (spare_header) to_copy_size = buffer_size - sock_receive->remaining_header;
-                            else to_copy_size = remaining_buffer_size - sizeof (PacketHeader);
-                            
-                            sock_receive->missing_packet = packet_real_size - to_copy_size;
-                        }
-
-                        else {
-                            to_copy_size = packet_real_size;
-                            packet_delete (sock_receive->spare_packet);
-                            sock_receive->spare_packet = NULL;
-                        } 
-
-                        // printf ("to copy size: %ld\n", to_copy_size);
-                        packet_set_data (packet, (void *) end, to_copy_size);
-
-                        end += to_copy_size;
-                        buffer_pos += to_copy_size;
-                        // printf ("second buffer pos: %ld\n", buffer_pos);
-
-                        if (!sock_receive->spare_packet) {
-                            connection->full_packet = true;
-                            client_packet_handler (packet);
-                        }
-                            
-                    }
+            retval = 0;
+        }
+    }
 
-                    else {
-                        cengine_log_msg (stderr, LOG_ERROR, LOG_CLIENT, 
-                            "Failed to create a new packet in cerver_handle_receive_buffer ()");
-                    }
-                }
+    else retval = 0;
 
-                else {
-                    char *status = c_string_create ("Got a packet of invalid size: %ld", packet_size);
-                    if (status) {
-                        cengine_log_msg (stderr, LOG_WARNING, LOG_CLIENT, status); 
-                        free (status);
-                    }
-                    
-                    break;
-                }
-            }
-
-            else {
-                if (sock_receive->spare_packet) packet_append_data (sock_receive->spare_packet, (void *) end, remaining_buffer_size);
+    return retval;
 
-                else {
-                    // handle part of a new header
-                    // #ifdef CERVER_DEBUG
-                    // cengine_log_debug ("Handle part of a new header...");
-                    // #endif
+}
 
-                    // printf ("buffer size: %ld\n", buffer_size);
-                    // printf ("buffer pos: %ld\n", buffer_pos);
-                    // printf ("remaining_buffer_size: %ld\n", remaining_buffer_size);
+// handles every complete packet that is inside the receive buffer
+// packets are handled in place, without copying them
+static void client_receive_handle_buffer (Client *client, Connection *connection, SockReceive *sr) {
+
+    Packet packet;
+    PacketHeader header;
+    size_t packet_size = 0;
+
+    while ((sr->end - sr->start) >= sizeof (PacketHeader)) {
+        packet_size = client_receive_packet_size (sr->buffer + sr->start);
+        if ((packet_size < sizeof (PacketHeader)) || (packet_size > RECEIVE_PACKET_MAX_SIZE)) {
+            char *status = c_string_create ("Got a packet of invalid size: %ld", packet_size);
+            if (status) {
+                cengine_log_msg (stderr, LOG_WARNING, LOG_CLIENT, status); 
+                free (status);
+            }
 
-                    // copy the piece of possible header that was cut of between recv ()
-                    sock_receive->header = malloc (sizeof (PacketHeader));
-                    memcpy (sock_receive->header, (void *) end, remaining_buffer_size);
+            // we can not know where the next packet starts, so discard everything
+            sr->start = sr->end = 0;
+            break;
+        }
 
-                    sock_receive->header_end = (char *) sock_receive->header;
-                    sock_receive->header_end += remaining_buffer_size;
+        // wait for the rest of the packet
+        if ((sr->end - sr->start) < packet_size) break;
 
-                    // sock_receive->curr_header_pos = remaining_buffer_size;
-                    sock_receive->remaining_header = sizeof (PacketHeader) - remaining_buffer_size;
+        client_receive_packet_view (&packet, &header, client, connection, sr->buffer + sr->start);
+        sr->start += packet_size;
 
-                    // printf ("curr header pos: %d\n", sock_receive->curr_header_pos);
-                    // printf ("remaining header: %d\n", sock_receive->remaining_header);
+        connection->full_packet = true;
+        client_receive_handle_packet (client, connection, &packet);
 
-                    buffer_pos += remaining_buffer_size;
-                }
-            }
+        // the handler ended the connection
+        if (!connection->connected) {
+            sr->start = sr->end = 0;
+            break;
         }
     }
 
+    if (sr->start == sr->end) {
+        sr->start = 0;
+        sr->end = 0;
+    }
+
+    else if (client_receive_make_space (client, connection, sr)) {
+        cengine_log_msg (stderr, LOG_ERROR, LOG_CLIENT, 
+            "Failed to grow the connection receive buffer!");
+        sr->start = sr->end = 0;
+    }
+
 }
 
 // handles a failed recive from a connection associatd with a client
@@ -499,7 +473,10 @@ static void client_receive_handle_buffer (Client *client, Connection *connection
 static void client_receive_handle_failed (Client *client, Connection *connection) {
 
     if (client && connection) {
-        if (!client_connection_end (client, connection)) {
+        // 18/10/2026 -- it will be connected again
+        if (connection->reconnect) client_connection_lost (client, connection, false);
+
+        else if (!client_connection_end (client, connection)) {
             // check if the client has any other active connection
             if (client->connections->size <= 0) {
                 client->running = false;
@@ -509,81 +486,190 @@ static void client_receive_handle_failed (Client *client, Connection *connection
 
 }
 
-// receives incoming data from the socket
-void client_receive (Client *client, Connection *connection) {
+// receives a single datagram, that has a udp header followed by a complete packet
+// it is read into the stack, so it does not need the connection buffer
+// returns the value returned by recv ()
+static ssize_t client_receive_udp (Client *client, Connection *connection) {
 
-    if (client && connection) {
-        char *packet_buffer = (char *) calloc (connection->receive_packet_buffer_size, sizeof (char));
-        if (packet_buffer) {
-            ssize_t rc = recv (connection->socket->sock_fd, packet_buffer, connection->receive_packet_buffer_size, 0);
-
-            switch (rc) {
-                case -1: {
-                    if (errno != EWOULDBLOCK) {
-                        #ifdef CLIENT_DEBUG 
-                        char *s = c_string_create ("client_receive () - rc < 0 - sock fd: %d", connection->socket->sock_fd);
-                        if (s) {
-                            cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, s);
-                            free (s);
-                        }
-                        perror ("Error");
-                        #endif
-
-                        client_receive_handle_failed (client, connection);
-                    }
-                } break;
+    char datagram[UDP_MAX_DATAGRAM_SIZE];
+    ssize_t rc = recv (connection->socket->sock_fd, datagram, UDP_MAX_DATAGRAM_SIZE, MSG_TRUNC);
 
-                case 0: {
-                    // man recv -> steam socket perfomed an orderly shutdown
-                    // but in dgram it might mean something?
-                    #ifdef CLIENT_DEBUG
-                    char *s = c_string_create ("client_receive () - rc == 0 - sock fd: %d",
-                        connection->socket->sock_fd);
+    if (rc < 0) {
+        // the receive timeout expired or there is nobody listening in the cerver's port
+        if ((errno != EWOULDBLOCK) && (errno != EAGAIN) && (errno != ECONNREFUSED) && (errno != EINTR)) {
+            #ifdef CLIENT_DEBUG
+            char *s = c_string_create ("client_receive () - udp rc < 0 - sock fd: %d", connection->socket->sock_fd);
+            if (s) {
+                cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, s);
+                free (s);
+            }
+            perror ("Error");
+            #endif
+
+            client_receive_handle_failed (client, connection);
+        }
+    }
+
+    else if (rc > UDP_MAX_DATAGRAM_SIZE) {
+        cengine_log_msg (stderr, LOG_WARNING, LOG_CLIENT, "Got a datagram that is bigger than UDP_MAX_DATAGRAM_SIZE!");
+    }
+
+    else if (rc > 0) {
+        stats_add (client->stats->counters, STATS_RECEIVES_DONE, 1);
+        stats_add (client->stats->counters, STATS_BYTES_RECEIVED, rc);
+
+        stats_add (connection->stats->counters, STATS_RECEIVES_DONE, 1);
+        stats_add (connection->stats->counters, STATS_BYTES_RECEIVED, rc);
+
+        if (connection->idle_timeout) __atomic_store_n (&connection->last_received, connection_time (), __ATOMIC_RELAXED);
+
+        if (udp_receive (connection, datagram, rc)) {
+            size_t packet_size = rc - sizeof (UdpHeader);
+            if ((packet_size >= sizeof (PacketHeader))
+                && (client_receive_packet_size (datagram + sizeof (UdpHeader)) == packet_size)) {
+                Packet packet;
+                PacketHeader header;
+                client_receive_packet_view (&packet, &header, client, connection, datagram + sizeof (UdpHeader));
+
+                connection->full_packet = true;
+                client_receive_handle_packet (client, connection, &packet);
+            }
+
+            else {
+                stats_received (client->stats->counters, STATS_PACKET_BAD);
+                stats_received (connection->stats->counters, STATS_PACKET_BAD);
+            }
+        }
+    }
+
+    // a datagram may have been handled even if the connection ended
+    if (connection->connected) udp_update (connection);
+
+    return rc;
+
+}
+
+// performs one recv () into the connection buffer and handles the complete packets
+// returns the value returned by recv ()
+static ssize_t client_receive_tcp (Client *client, Connection *connection) {
+
+    ssize_t rc = -1;
+
+    if (!connection->sock_receive) connection->sock_receive = sock_receive_new ();
+
+    SockReceive *sr = connection->sock_receive;
+    if (sr && !sr->buffer) {
+        // the buffer is kept for the whole connection
+        sr->buffer_size = connection->receive_packet_buffer_size > sizeof (PacketHeader) ?
+            connection->receive_packet_buffer_size : sizeof (PacketHeader);
+        sr->buffer = (char *) malloc (sr->buffer_size);
+        if (sr->buffer) {
+            stats_add (client->stats->counters, STATS_RECEIVE_ALLOCS, 1);
+            stats_add (connection->stats->counters, STATS_RECEIVE_ALLOCS, 1);
+        }
+
+        else sr->buffer_size = 0;
+    }
+
+    if (sr && sr->buffer) {
+        rc = recv (connection->socket->sock_fd, sr->buffer + sr->end, sr->buffer_size - sr->end, 0);
+
+        switch (rc) {
+            case -1: {
+                if (errno != EWOULDBLOCK) {
+                    #ifdef CLIENT_DEBUG 
+                    char *s = c_string_create ("client_receive () - rc < 0 - sock fd: %d", connection->socket->sock_fd);
                     if (s) {
-                        cengine_log_msg (stdout, LOG_DEBUG, LOG_NO_TYPE, s);
+                        cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, s);
                         free (s);
                     }
-                    // perror ("Error");
+                    perror ("Error");
                     #endif
-                    
-                    client_receive_handle_failed (client, connection);
-                } break;
-
-                default: {
-                    // char *s = c_string_create ("Connection %s rc: %ld",
-                    //     connection->name->str, rc);
-                    // if (s) {
-                    //     cengine_log_msg (stdout, LOG_DEBUG, LOG_CLIENT, s);
-                    //     free (s);
-                    // }
-
-                    client->stats->n_receives_done += 1;
-                    client->stats->total_bytes_received += rc;
-
-                    connection->stats->n_receives_done += 1;
-                    connection->stats->total_bytes_received += rc;
-
-                    // handle the recived packet buffer -> split them in packets of the correct size
-                    client_receive_handle_buffer (
-                        client, 
-                        connection, 
-                        packet_buffer, 
-                        rc
-                    );
-                } break;
-            }
 
-            free (packet_buffer);
+                    client_receive_handle_failed (client, connection);
+                }
+            } break;
+
+            case 0: {
+                // man recv -> steam socket perfomed an orderly shutdown
+                // but in dgram it might mean something?
+                #ifdef CLIENT_DEBUG
+                char *s = c_string_create ("client_receive () - rc == 0 - sock fd: %d",
+                    connection->socket->sock_fd);
+                if (s) {
+                    cengine_log_msg (stdout, LOG_DEBUG, LOG_NO_TYPE, s);
+                    free (s);
+                }
+                // perror ("Error");
+                #endif
+                
+                client_receive_handle_failed (client, connection);
+            } break;
+
+            default: {
+                // char *s = c_string_create ("Connection %s rc: %ld",
+                //     connection->name->str, rc);
+                // if (s) {
+                //     cengine_log_msg (stdout, LOG_DEBUG, LOG_CLIENT, s);
+                //     free (s);
+                // }
+
+                stats_add (client->stats->counters, STATS_RECEIVES_DONE, 1);
+                stats_add (client->stats->counters, STATS_BYTES_RECEIVED, rc);
+
+                stats_add (connection->stats->counters, STATS_RECEIVES_DONE, 1);
+                stats_add (connection->stats->counters, STATS_BYTES_RECEIVED, rc);
+
+                if (connection->idle_timeout) 
+                    __atomic_store_n (&connection->last_received, connection_time (), __ATOMIC_RELAXED);
+
+                // handle the complete packets that are in the buffer
+                sr->end += rc;
+                client_receive_handle_buffer (client, connection, sr);
+            } break;
         }
+    }
 
-        else {
-            #ifdef CLIENT_DEBUG
-            cengine_log_msg (stderr, LOG_ERROR, LOG_CLIENT, 
-                "Failed to allocate a new packet buffer!");
-            #endif
-        }
+    else {
+        #ifdef CLIENT_DEBUG
+        cengine_log_msg (stderr, LOG_ERROR, LOG_CLIENT, 
+            "Failed to allocate a new packet buffer!");
+        #endif
+    }
+
+    return rc;
+
+}
+
+static inline ssize_t client_receive_internal (Client *client, Connection *connection) {
+
+    return (connection->protocol == PROTOCOL_UDP) ?
+        client_receive_udp (client, connection) : client_receive_tcp (client, connection);
+
+}
+
+// receives incoming data from the socket into the connection receive buffer
+// handlers get packets that point inside the buffer (the data may not be aligned), use packet_retain () to keep one
+void client_receive (Client *client, Connection *connection) {
+
+    if (client && connection) (void) client_receive_internal (client, connection);
+
+}
+
+// receives until recv () would block, used with non blocking edge triggered sockets
+// returns true if the connection is still connected
+bool client_receive_all (Client *client, Connection *connection) {
+
+    bool retval = false;
+
+    if (client && connection) {
+        while (connection->connected && (client_receive_internal (client, connection) > 0));
+
+        retval = connection->connected;
     }
 
+    return retval;
+
 }
 
 #pragma endregion
\ No newline at end of file
@@ -7,6 +7,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include "cengine/types/types.h"
 #include "cengine/types/string.h"
@@ -15,6 +16,12 @@
 #include "cengine/client/packets.h"
 #include "cengine/client/cerver.h"
 #include "cengine/client/client.h"
+#include "cengine/client/connection.h"
+#include "cengine/client/handler.h"
+#include "cengine/client/stats.h"
+#include "cengine/client/udp.h"
+
+#include "cengine/utils/lz4.h"
 
 #ifdef PACKETS_DEBUG
 #include "cengine/utils/log.h"
@@ -126,9 +133,11 @@ PacketHeader *packet_header_create (PacketType packet_type, size_t packet_size,
     PacketHeader *header = (PacketHeader *) malloc (sizeof (PacketHeader));
     if (header) {
         header->packet_type = packet_type;
+        header->request_id = 0;
         header->packet_size = packet_size;
 
         header->handler_id = 0;
+        header->flags = 0;
 
         header->request_type = req_type;
     }
@@ -141,6 +150,7 @@ void packet_header_print (PacketHeader *header) {
 
     if (header) {
         printf ("Packet type: %d\n", header->packet_type);
+        printf ("Request id: %d\n", header->request_id);
         printf ("Packet size: %ld\n", header->packet_size);
         printf ("Handler id: %d\n", header->handler_id);
         printf ("Request type: %d\n", header->request_type);
@@ -168,13 +178,374 @@ u8 packet_header_copy (PacketHeader **dest, PacketHeader *source) {
 
 #pragma endregion
 
+#pragma region pool
+
+// every pool buffer has its class before the memory that is used by the packet,
+// 16 bytes are used to keep the alignment of malloc ()
+#define PACKET_BUFFER_PREFIX            16
+#define PACKET_POOL_NO_CLASS            0xFF
+
+typedef struct PacketPoolNode {
+
+    struct PacketPoolNode *next;
+
+} PacketPoolNode;
+
+typedef struct PacketPoolList {
+
+    PacketPoolNode *head;
+    u32 count;
+
+} PacketPoolList;
+
+typedef struct PacketPoolCache {
+
+    PacketPoolList lists[PACKET_POOL_N_LISTS];
+
+    // only written by the owner thread, packets_pool_stats () reads them with atomic loads
+    u64 hits[PACKET_POOL_N_LISTS];
+    u64 misses[PACKET_POOL_N_LISTS];
+    u64 n_oversized;
+
+    struct PacketPoolCache *prev, *next;
+
+} PacketPoolCache;
+
+static PacketPoolList pool_lists[PACKET_POOL_N_LISTS] = { { 0 } };
+static PacketPoolCache *pool_caches = NULL;
+static PacketPoolStats pool_ended_stats = { { 0 } };       // counters of the threads that have ended
+
+// protects the shared lists and the caches list
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_key_t pool_key;
+static pthread_once_t pool_key_once = PTHREAD_ONCE_INIT;
+static __thread PacketPoolCache *pool_cache = NULL;
+
+#define packets_pool_count(counter)     __atomic_store_n (&(counter), (counter) + 1, __ATOMIC_RELAXED)
+
+static inline void packets_pool_list_push (PacketPoolList *list, void *object) {
+
+    PacketPoolNode *node = (PacketPoolNode *) object;
+    node->next = list->head;
+    list->head = node;
+    list->count += 1;
+
+}
+
+static inline void *packets_pool_list_pop (PacketPoolList *list) {
+
+    PacketPoolNode *node = list->head;
+    if (node) {
+        list->head = node->next;
+        list->count -= 1;
+    }
+
+    return node;
+
+}
+
+// moves n objects from the thread list to the shared list, frees the ones that do not fit
+// the pool mutex must be locked by the caller
+static void packets_pool_list_flush (PacketPoolList *local, PacketPoolList *shared, u32 n) {
+
+    void *object = NULL;
+    for (u32 i = 0; i < n && (object = packets_pool_list_pop (local)); i++) {
+        if (shared->count < PACKET_POOL_SHARED_MAX) packets_pool_list_push (shared, object);
+        else free (object);
+    }
+
+}
+
+// called when a thread that has used the pool ends
+static void packets_pool_cache_delete (void *cache_ptr) {
+
+    if (cache_ptr) {
+        PacketPoolCache *cache = (PacketPoolCache *) cache_ptr;
+
+        pthread_mutex_lock (&pool_mutex);
+
+        for (u32 i = 0; i < PACKET_POOL_N_LISTS; i++) {
+            packets_pool_list_flush (&cache->lists[i], &pool_lists[i], cache->lists[i].count);
+
+            pool_ended_stats.hits[i] += cache->hits[i];
+            pool_ended_stats.misses[i] += cache->misses[i];
+        }
+
+        pool_ended_stats.n_oversized += cache->n_oversized;
+
+        if (cache->prev) cache->prev->next = cache->next;
+        else pool_caches = cache->next;
+        if (cache->next) cache->next->prev = cache->prev;
+
+        pthread_mutex_unlock (&pool_mutex);
+
+        if (pool_cache == cache) pool_cache = NULL;
+        free (cache);
+    }
+
+}
+
+static void packets_pool_key_create (void) {
+
+    (void) pthread_key_create (&pool_key, packets_pool_cache_delete);
+
+}
+
+static PacketPoolCache *packets_pool_cache_get (void) {
+
+    if (!pool_cache) {
+        pthread_once (&pool_key_once, packets_pool_key_create);
+
+        PacketPoolCache *cache = (PacketPoolCache *) malloc (sizeof (PacketPoolCache));
+        if (cache) {
+            memset (cache, 0, sizeof (PacketPoolCache));
+
+            pthread_mutex_lock (&pool_mutex);
+            cache->next = pool_caches;
+            if (pool_caches) pool_caches->prev = cache;
+            pool_caches = cache;
+            pthread_mutex_unlock (&pool_mutex);
+
+            (void) pthread_setspecific (pool_key, cache);
+            pool_cache = cache;
+        }
+    }
+
+    return pool_cache;
+
+}
+
+// takes an object from the thread list, that is refilled from the shared list when it is empty
+// returns NULL if the pool does not have any
+static void *packets_pool_get (u32 list) {
+
+    void *object = NULL;
+
+    PacketPoolCache *cache = packets_pool_cache_get ();
+    if (cache) {
+        PacketPoolList *local = &cache->lists[list];
+        if (!local->head) {
+            pthread_mutex_lock (&pool_mutex);
+            for (u32 i = 0; i < PACKET_POOL_BATCH && pool_lists[list].head; i++)
+                packets_pool_list_push (local, packets_pool_list_pop (&pool_lists[list]));
+            pthread_mutex_unlock (&pool_mutex);
+        }
+
+        object = packets_pool_list_pop (local);
+        if (object) packets_pool_count (cache->hits[list]);
+        else packets_pool_count (cache->misses[list]);
+    }
+
+    return object;
+
+}
+
+// gives back an object to the thread list, half of the list goes to the shared one when it is full
+// returns false if the object could not be kept and has to be freed
+static bool packets_pool_put (u32 list, void *object) {
+
+    bool retval = false;
+
+    PacketPoolCache *cache = packets_pool_cache_get ();
+    if (cache) {
+        PacketPoolList *local = &cache->lists[list];
+        packets_pool_list_push (local, object);
+
+        if (local->count > PACKET_POOL_THREAD_MAX) {
+            pthread_mutex_lock (&pool_mutex);
+            packets_pool_list_flush (local, &pool_lists[list], PACKET_POOL_THREAD_MAX / 2);
+            pthread_mutex_unlock (&pool_mutex);
+        }
+
+        retval = true;
+    }
+
+    return retval;
+
+}
+
+// returns how many allocations the calling thread has made because the pool was empty
+static u64 packets_pool_thread_misses (void) {
+
+    u64 misses = 0;
+
+    PacketPoolCache *cache = packets_pool_cache_get ();
+    if (cache) {
+        for (u32 i = 0; i < PACKET_POOL_N_LISTS; i++) misses += cache->misses[i];
+        misses += cache->n_oversized;
+    }
+
+    return misses;
+
+}
+
+static inline size_t packets_pool_class_size (u32 class) {
+
+    return (size_t) PACKET_POOL_MIN_BUFFER_SIZE << (2 * class);
+
+}
+
+// returns the smallest class that fits the size, PACKET_POOL_NO_CLASS if it is too big
+static inline u32 packets_pool_buffer_class (size_t size) {
+
+    u32 class = 0;
+    while ((class < PACKET_POOL_N_CLASSES) && (packets_pool_class_size (class) < size)) class++;
+
+    return class < PACKET_POOL_N_CLASSES ? class : PACKET_POOL_NO_CLASS;
+
+}
+
+static inline u32 packet_buffer_class (const void *buffer) {
+
+    u32 class = 0;
+    memcpy (&class, (const char *) buffer - PACKET_BUFFER_PREFIX, sizeof (u32));
+
+    return class;
+
+}
+
+// every packet data & packet buffer is allocated with this method
+static void *packet_buffer_alloc (size_t size) {
+
+    char *buffer = NULL;
+
+    u32 class = packets_pool_buffer_class (size);
+    if (class != PACKET_POOL_NO_CLASS) {
+        buffer = (char *) packets_pool_get (1 + class);
+        if (!buffer) buffer = (char *) malloc (PACKET_BUFFER_PREFIX + packets_pool_class_size (class));
+    }
+
+    else {
+        buffer = (char *) malloc (PACKET_BUFFER_PREFIX + size);
+
+        PacketPoolCache *cache = packets_pool_cache_get ();
+        if (cache) packets_pool_count (cache->n_oversized);
+    }
+
+    if (buffer) {
+        memcpy (buffer, &class, sizeof (u32));
+        buffer += PACKET_BUFFER_PREFIX;
+    }
+
+    return buffer;
+
+}
+
+static void packet_buffer_free (void *ptr) {
+
+    if (ptr) {
+        u32 class = packet_buffer_class (ptr);
+        char *buffer = (char *) ptr - PACKET_BUFFER_PREFIX;
+
+        if ((class == PACKET_POOL_NO_CLASS) || !packets_pool_put (1 + class, buffer))
+            free (buffer);
+    }
+
+}
+
+// the same buffer is returned if the new size still fits in its class
+static void *packet_buffer_realloc (void *ptr, size_t size, size_t new_size) {
+
+    void *buffer = NULL;
+
+    if (ptr) {
+        u32 class = packet_buffer_class (ptr);
+        if ((class != PACKET_POOL_NO_CLASS) && (new_size <= packets_pool_class_size (class))) {
+            buffer = ptr;
+        }
+
+        // big buffers are never pooled, so they can grow in place
+        else if ((class == PACKET_POOL_NO_CLASS) 
+            && (packets_pool_buffer_class (new_size) == PACKET_POOL_NO_CLASS)) {
+            buffer = realloc ((char *) ptr - PACKET_BUFFER_PREFIX, PACKET_BUFFER_PREFIX + new_size);
+            if (buffer) buffer = (char *) buffer + PACKET_BUFFER_PREFIX;
+        }
+
+        else {
+            buffer = packet_buffer_alloc (new_size);
+            if (buffer) {
+                memcpy (buffer, ptr, size < new_size ? size : new_size);
+                packet_buffer_free (ptr);
+            }
+        }
+    }
+
+    else buffer = packet_buffer_alloc (new_size);
+
+    return buffer;
+
+}
+
+// gets the pool counters of every thread that has used it
+void packets_pool_stats (PacketPoolStats *stats) {
+
+    if (stats) {
+        pthread_mutex_lock (&pool_mutex);
+
+        memcpy (stats, &pool_ended_stats, sizeof (PacketPoolStats));
+        for (PacketPoolCache *cache = pool_caches; cache; cache = cache->next) {
+            for (u32 i = 0; i < PACKET_POOL_N_LISTS; i++) {
+                stats->hits[i] += __atomic_load_n (&cache->hits[i], __ATOMIC_RELAXED);
+                stats->misses[i] += __atomic_load_n (&cache->misses[i], __ATOMIC_RELAXED);
+            }
+
+            stats->n_oversized += __atomic_load_n (&cache->n_oversized, __ATOMIC_RELAXED);
+        }
+
+        pthread_mutex_unlock (&pool_mutex);
+    }
+
+}
+
+void packets_pool_stats_print (void) {
+
+    PacketPoolStats stats;
+    packets_pool_stats (&stats);
+
+    printf ("\nPackets pool:\n");
+    for (u32 i = 0; i < PACKET_POOL_N_LISTS; i++) {
+        u64 total = stats.hits[i] + stats.misses[i];
+
+        if (!i) printf ("Packets:           ");
+        else printf ("Buffers %-9ld: ", packets_pool_class_size (i - 1));
+
+        printf ("%ld hits - %ld misses (%.1f%% hits)\n", stats.hits[i], stats.misses[i],
+            total ? (double) stats.hits[i] * 100 / total : 0.0);
+    }
+
+    printf ("Oversized buffers: %ld\n", stats.n_oversized);
+
+}
+
+// frees the objects that are in the shared lists and in the lists of the calling thread
+void packets_pool_clear (void) {
+
+    void *object = NULL;
+
+    pthread_mutex_lock (&pool_mutex);
+    for (u32 i = 0; i < PACKET_POOL_N_LISTS; i++) {
+        while ((object = packets_pool_list_pop (&pool_lists[i]))) free (object);
+
+        if (pool_cache) {
+            while ((object = packets_pool_list_pop (&pool_cache->lists[i]))) free (object);
+        }
+    }
+    pthread_mutex_unlock (&pool_mutex);
+
+}
+
+#pragma endregion
+
 #pragma region packets
 
 u8 packet_append_data (Packet *packet, void *data, size_t data_size);
 
 Packet *packet_new (void) {
 
-    Packet *packet = (Packet *) malloc (sizeof (Packet));
+    Packet *packet = (Packet *) packets_pool_get (0);
+    if (!packet) packet = (Packet *) malloc (sizeof (Packet));
+
     if (packet) {
         packet->cerver = NULL;
         packet->client = NULL;
@@ -190,7 +561,10 @@ Packet *packet_new (void) {
         packet->data_ref = false;
 
         packet->header = NULL;
+        packet->header_ref = false;
+        memset (&packet->header_storage, 0, sizeof (PacketHeader));
         packet->version = NULL;
+        memset (&packet->version_storage, 0, sizeof (PacketVersion));
         packet->packet_size = 0;
         packet->packet = NULL;
         packet->packet_ref = false;
@@ -223,22 +597,71 @@ void packet_delete (void *ptr) {
         packet->client = NULL;
         packet->connection = NULL;
 
-        if (!packet->data_ref) {
-            if (packet->data) free (packet->data);
-        }
+        if (!packet->data_ref) packet_buffer_free (packet->data);
 
-        packet_header_delete (packet->header);
-        packet_version_delete (packet->version);
+        // the header & version may have been set by hand
+        if (!packet->header_ref && (packet->header != &packet->header_storage))
+            packet_header_delete (packet->header);
 
-        if (!packet->packet_ref) {
-            if (packet->packet) free (packet->packet);
-        }
+        if (packet->version != &packet->version_storage) packet_version_delete (packet->version);
+
+        if (!packet->packet_ref) packet_buffer_free (packet->packet);
 
-        free (packet);
+        if (!packets_pool_put (0, packet)) free (packet);
     }
 
 }
 
+// received packets are views into the connection receive buffer that are only valid inside the handler
+// this creates a copy with its own header & data that can be kept after the handler returns
+// returns a newly allocated packet that should be deleted with packet_delete ()
+Packet *packet_retain (const Packet *packet) {
+
+    Packet *copy = NULL;
+
+    if (packet) {
+        u64 misses = packets_pool_thread_misses ();
+
+        copy = packet_new ();
+        if (copy) {
+
+            copy->cerver = packet->cerver;
+            copy->client = packet->client;
+            copy->connection = packet->connection;
+
+            copy->packet_type = packet->packet_type;
+            copy->req_type = packet->req_type;
+            copy->packet_size = packet->packet_size;
+
+            if (packet->header) {
+                memcpy (&copy->header_storage, packet->header, sizeof (PacketHeader));
+                copy->header = &copy->header_storage;
+            }
+
+            if (packet->version) {
+                memcpy (&copy->version_storage, packet->version, sizeof (PacketVersion));
+                copy->version = &copy->version_storage;
+            }
+
+            if (packet->data && packet->data_size) {
+                if (!packet_set_data (copy, packet->data, packet->data_size)) {
+                    // keep the read position of the original
+                    copy->data_ptr += packet->data_ptr - (char *) packet->data;
+                }
+            }
+
+            // only what the pool did not have
+            u64 n_allocs = packets_pool_thread_misses () - misses;
+
+            if (copy->client) stats_add (copy->client->stats->counters, STATS_RECEIVE_ALLOCS, n_allocs);
+            if (copy->connection) stats_add (copy->connection->stats->counters, STATS_RECEIVE_ALLOCS, n_allocs);
+        }
+    }
+
+    return copy;
+
+}
+
 // sets the pakcet destinatary is directed to and the protocol to use
 void packet_set_network_values (Packet *packet, Client *client, Connection *connection) {
 
@@ -258,12 +681,11 @@ u8 packet_set_data (Packet *packet, void *data, size_t data_size) {
 
     if (packet && data) {
         // check if there was data in the packet before
-        if (!packet->data_ref) {
-            if (packet->data) free (packet->data);
-        }
+        if (!packet->data_ref) packet_buffer_free (packet->data);
 
+        packet->data_ref = false;
         packet->data_size = data_size;
-        packet->data = malloc (packet->data_size);
+        packet->data = packet_buffer_alloc (packet->data_size);
         if (packet->data) {
             memcpy (packet->data, data, data_size);
             packet->data_end = (char *) packet->data;
@@ -292,7 +714,7 @@ u8 packet_append_data (Packet *packet, void *data, size_t data_size) {
         // append the data to the end if the packet already has data
         if (packet->data) {
             size_t new_size = packet->data_size + data_size;
-            void *new_data = realloc (packet->data, new_size);
+            void *new_data = packet_buffer_realloc (packet->data, packet->data_size, new_size);
             if (new_data) {
                 packet->data_end = (char *) new_data;
                 packet->data_end += packet->data_size;
@@ -322,7 +744,7 @@ u8 packet_append_data (Packet *packet, void *data, size_t data_size) {
         // if the packet is empty, create a new buffer
         else {
             packet->data_size = data_size;
-            packet->data = malloc (packet->data_size);
+            packet->data = packet_buffer_alloc (packet->data_size);
             if (packet->data) {
                 // copy the data to the packet data buffer
                 memcpy (packet->data, data, data_size);
@@ -358,9 +780,7 @@ u8 packet_set_data_ref (Packet *packet, void *data, size_t data_size) {
     u8 retval = 1;
 
     if (packet && data) {
-        if (!packet->data_ref) {
-            if (packet->data) free (packet->data);
-        }
+        if (!packet->data_ref) packet_buffer_free (packet->data);
 
         packet->data = data;
         packet->data_size = data_size;
@@ -381,12 +801,11 @@ u8 packet_set_packet (Packet *packet, void *data, size_t data_size) {
     u8 retval = 1;
 
     if (packet && data) {
-        if (!packet->packet_ref) {
-            if (packet->packet) free (packet->packet);
-        }
+        if (!packet->packet_ref) packet_buffer_free (packet->packet);
 
+        packet->packet_ref = false;
         packet->packet_size = data_size;
-        packet->packet = malloc (packet->packet_size);
+        packet->packet = packet_buffer_alloc (packet->packet_size);
         if (packet->packet) {
             memcpy (packet->packet, data, data_size);
 
@@ -406,9 +825,7 @@ u8 packet_set_packet_ref (Packet *packet, void *data, size_t packet_size) {
     u8 retval = 1;
 
     if (packet && data) {
-        if (!packet->packet_ref) {
-            if (packet->packet) free (packet->packet);
-        }
+        if (!packet->packet_ref) packet_buffer_free (packet->packet);
 
         packet->packet = data;
         packet->packet_size = packet_size;
@@ -430,16 +847,27 @@ u8 packet_generate (Packet *packet) {
 
     if (packet) {
         if (packet->packet) {
-            free (packet->packet);
+            if (!packet->packet_ref) packet_buffer_free (packet->packet);
             packet->packet = NULL;
             packet->packet_size = 0;
+            packet->packet_ref = false;
         }   
 
+        if (!packet->header_ref && (packet->header != &packet->header_storage))
+            packet_header_delete (packet->header);
+
         packet->packet_size = sizeof (PacketHeader) + packet->data_size;
-        packet->header = packet_header_create (packet->packet_type, packet->packet_size, packet->req_type);
+        packet->header_storage.packet_type = packet->packet_type;
+        packet->header_storage.request_id = 0;
+        packet->header_storage.packet_size = packet->packet_size;
+        packet->header_storage.handler_id = 0;
+        packet->header_storage.flags = 0;
+        packet->header_storage.request_type = packet->req_type;
+        packet->header = &packet->header_storage;
+        packet->header_ref = false;
 
         // create the packet buffer to be sent
-        packet->packet = malloc (packet->packet_size);
+        packet->packet = packet_buffer_alloc (packet->packet_size);
         if (packet->packet) {
             char *end = (char *) packet->packet;
             memcpy (end, packet->header, sizeof (PacketHeader));
@@ -484,6 +912,15 @@ Packet *packet_generate_request (PacketType packet_type, u32 req_type,
 
 }
 
+// sends the pieces with a single syscall, or adds them to the connection batch if it is enabled
+// the write mutex must be locked by the caller
+static inline u8 packet_send_iov (Socket *socket, const struct iovec *iov, u32 n_iov, int flags, size_t *total_sent) {
+
+    return socket_batch_enabled (socket) ? 
+        socket_batch_add (socket, iov, n_iov, total_sent) : socket_sendv (socket, iov, n_iov, flags, total_sent);
+
+}
+
 // sends a packet directly using the tcp protocol and the packet sock fd
 // returns 0 on success, 1 on error
 static u8 packet_send_tcp (const Packet *packet, Connection *connection, int flags, size_t *total_sent, bool raw) {
@@ -493,22 +930,15 @@ static u8 packet_send_tcp (const Packet *packet, Connection *connection, int fla
     if (packet && connection) {
         pthread_mutex_lock (connection->socket->write_mutex);
 
-        ssize_t sent = 0;
-        char *p = raw ? (char *) packet->data : (char *) packet->packet;
-        size_t packet_size = raw ? packet->data_size : packet->packet_size;
-
-        while (packet_size > 0) {
-            sent = send (connection->socket->sock_fd, p, packet_size, flags);
-            if (sent < 0) {
-                break;
-            }
+        size_t sent = 0;
+        struct iovec iov = {
+            raw ? packet->data : packet->packet,
+            raw ? packet->data_size : packet->packet_size
+        };
 
-            p += sent;
-            packet_size -= (size_t) sent;
-            retval = 0;
-        }
+        retval = packet_send_iov (connection->socket, &iov, 1, flags, &sent);
 
-        if (total_sent) *total_sent = (size_t) sent;
+        if (total_sent) *total_sent = sent;
 
         pthread_mutex_unlock (connection->socket->write_mutex);
     }
@@ -517,7 +947,7 @@ static u8 packet_send_tcp (const Packet *packet, Connection *connection, int fla
 
 }
 
-// sends a packet to the socket in two parts, first the header & then the data
+// sends the header & then the data of the packet with a single syscall
 // returns 0 on success, 1 on error
 static u8 packet_send_split_tcp (const Packet *packet, Connection *connection, int flags, size_t *total_sent) {
 
@@ -528,43 +958,14 @@ static u8 packet_send_split_tcp (const Packet *packet, Connection *connection, i
 
         size_t actual_sent = 0;
 
-        // first send the header
-        bool fail = false;
-        ssize_t sent = 0;
-        char *p = (char *) packet->header;
-        size_t packet_size = sizeof (PacketHeader);
-
-        while (packet_size > 0) {
-            sent = send (connection->socket->sock_fd, p, packet_size, flags);
-            if (sent < 0) {
-                fail = true;
-                break;
-            }
-
-            p += sent;
-            actual_sent += (size_t) sent;
-            packet_size -= (size_t) sent;
-            fail = false;
-        }
-
-        // now send the data
-        if (!fail) {
-            sent = 0;
-            p = (char *) packet->data;
-            packet_size = packet->data_size;
-
-            while (packet_size > 0) {
-                sent = send (connection->socket->sock_fd, p, packet_size, flags);
-                if (sent < 0) break;
-                p += sent;
-                actual_sent += (size_t) sent;
-                packet_size -= (size_t) sent;
-            }
+        struct iovec iov[2] = {
+            { packet->header, sizeof (PacketHeader) },
+            { packet->data, packet->data ? packet->data_size : 0 }
+        };
 
-            if (total_sent) *total_sent = actual_sent;
+        retval = packet_send_iov (connection->socket, iov, 2, flags, &actual_sent);
 
-            retval = 0;
-        }
+        if (total_sent) *total_sent = actual_sent;
 
         pthread_mutex_unlock (connection->socket->write_mutex);
     }
@@ -573,125 +974,192 @@ static u8 packet_send_split_tcp (const Packet *packet, Connection *connection, i
 
 }
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wunused-function"
-static u8 packet_send_udp (const void *packet, size_t packet_size) {
+// sends the packet as a single datagram, the header & the data are copied after the udp header
+// returns 0 on success, 1 on error
+static u8 packet_send_udp (const Packet *packet, Connection *connection, int flags, size_t *total_sent,
+    bool raw, bool split, bool reliable) {
 
-    // TODO:
+    const void *pieces[2] = { 0 };
+    size_t sizes[2] = { 0 };
+    u32 n_pieces = 0;
 
-    return 0;
+    if (raw) {
+        pieces[n_pieces] = packet->data;
+        sizes[n_pieces++] = packet->data_size;
+    }
+
+    else if (split) {
+        pieces[n_pieces] = packet->header;
+        sizes[n_pieces++] = sizeof (PacketHeader);
+        if (packet->data && packet->data_size) {
+            pieces[n_pieces] = packet->data;
+            sizes[n_pieces++] = packet->data_size;
+        }
+    }
+
+    else {
+        pieces[n_pieces] = packet->packet;
+        sizes[n_pieces++] = packet->packet_size;
+    }
+
+    return udp_send (connection, pieces, sizes, n_pieces, reliable, flags, total_sent);
 
 }
-#pragma GCC diagnostic pop
 
 static void packet_send_update_stats (PacketType packet_type, size_t sent,
     Client *client, Connection *connection) {
 
+    // 18/10/2026 -- packets sent without a type are not counted in any type
+    StatsPacketType type = stats_packet_type (packet_type);
+
     if (client) {
-        client->stats->n_packets_sent += 1;
-        client->stats->total_bytes_sent += sent;
+        stats_add (client->stats->counters, STATS_PACKETS_SENT, 1);
+        stats_add (client->stats->counters, STATS_BYTES_SENT, sent);
+        if (packet_type != DONT_CHECK_TYPE) stats_sent (client->stats->counters, type);
     }
 
-    connection->stats->n_packets_sent += 1;
-    connection->stats->total_bytes_sent += sent; 
+    stats_add (connection->stats->counters, STATS_PACKETS_SENT, 1);
+    stats_add (connection->stats->counters, STATS_BYTES_SENT, sent);
+    if (packet_type != DONT_CHECK_TYPE) stats_sent (connection->stats->counters, type);
 
-    switch (packet_type) {
-        case CERVER_PACKET: break;
+}
 
-        case CLIENT_PACKET: break;
+// gets a copy of the packet header & where its data is, even if the packet was set by hand
+static void packet_get_parts (const Packet *packet, PacketHeader *header, const void **data, size_t *data_size) {
 
-        case ERROR_PACKET: 
-            if (client) client->stats->sent_packets->n_error_packets += 1;
-            connection->stats->sent_packets->n_error_packets += 1;
-            break;
+    *data = packet->data;
+    *data_size = packet->data ? packet->data_size : 0;
 
-        case AUTH_PACKET: 
-            if (client) client->stats->sent_packets->n_auth_packets += 1;
-            connection->stats->sent_packets->n_auth_packets += 1;
-            break;
+    if (packet->header) {
+        memcpy (header, packet->header, sizeof (PacketHeader));
+    }
+
+    // the packet was set by hand, its header is at the start
+    else if (packet->packet && (packet->packet_size >= sizeof (PacketHeader))) {
+        memcpy (header, packet->packet, sizeof (PacketHeader));
+        *data = (char *) packet->packet + sizeof (PacketHeader);
+        *data_size = packet->packet_size - sizeof (PacketHeader);
+    }
 
-        case REQUEST_PACKET: 
-            if (client) client->stats->sent_packets->n_request_packets += 1;
-            connection->stats->sent_packets->n_request_packets += 1;
-            break;
+    else {
+        memset (header, 0, sizeof (PacketHeader));
+        header->packet_type = packet->packet_type;
+        header->request_type = packet->req_type;
+    }
 
-        case GAME_PACKET:
-            if (client) client->stats->sent_packets->n_game_packets += 1;
-            connection->stats->sent_packets->n_game_packets += 1;
-            break;
+    header->packet_size = sizeof (PacketHeader) + *data_size;
 
-        case APP_PACKET:
-            if (client) client->stats->sent_packets->n_app_packets += 1;
-            connection->stats->sent_packets->n_app_packets += 1;
-            break;
+}
 
-        case APP_ERROR_PACKET: 
-            if (client) client->stats->sent_packets->n_app_error_packets += 1;
-            connection->stats->sent_packets->n_app_error_packets += 1;
-            break;
+// 18/10/2026 -- compresses the data with the connection codec into a pooled buffer, if it is big enough
+// and it gets smaller, the compressed packet is a copy of the original with its own header
+// returns true if the packet has been compressed, its data has to be released with packet_buffer_free ()
+static bool packet_compress (const Packet *packet, Connection *connection,
+    Packet *compressed, PacketHeader *header) {
 
-        case CUSTOM_PACKET:
-            if (client) client->stats->sent_packets->n_custom_packets += 1;
-            connection->stats->sent_packets->n_custom_packets += 1;
-            break;
+    bool retval = false;
 
-        case TEST_PACKET: 
-            if (client) client->stats->sent_packets->n_test_packets += 1;
-            connection->stats->sent_packets->n_test_packets += 1;
-            break;
+    if (connection->compression == PACKET_CODEC_LZ4) {
+        const void *data = NULL;
+        size_t data_size = 0;
+        packet_get_parts (packet, header, &data, &data_size);
+
+        if (data && (data_size >= connection->compression_threshold) && (data_size <= RECEIVE_PACKET_MAX_SIZE)
+            && !(header->flags & PACKET_FLAGS_COMPRESSED)) {
+            char *buffer = (char *) packet_buffer_alloc (data_size);
+            if (buffer) {
+                // it is only worth it if the result is smaller than the data
+                u32 original_size = (u32) data_size;
+                memcpy (buffer, &original_size, sizeof (u32));
+                size_t size = lz4_compress (data, data_size, buffer + sizeof (u32), data_size - sizeof (u32) - 1);
+
+                if (size) {
+                    *compressed = *packet;
+                    compressed->data = buffer;
+                    compressed->data_size = sizeof (u32) + size;
+
+                    header->flags |= PACKET_FLAG_LZ4;
+                    header->packet_size = sizeof (PacketHeader) + compressed->data_size;
+                    compressed->header = header;
 
-        case DONT_CHECK_TYPE: break;
+                    retval = true;
+                }
 
-        default: 
-            if (client) client->stats->sent_packets->n_unknown_packets += 1;
-            connection->stats->sent_packets->n_unknown_packets += 1;
-            break;
+                else packet_buffer_free (buffer);
+            }
+        }
     }
 
+    return retval;
+
 }
 
 static inline u8 packet_send_internal (const Packet *packet, int flags, size_t *total_sent, 
-    bool raw, bool split,
+    bool raw, bool split, bool reliable,
     Client *client, Connection *connection) {
 
     u8 retval = 1;
 
     if (packet && connection) {
+        size_t sent = 0;
+        u8 errors = 1;
+
+        // 18/10/2026 -- big packets go out with their data compressed, in two parts
+        Packet compressed;
+        PacketHeader compressed_header;
+        const Packet *original = packet;
+        if (!raw && packet_compress (packet, connection, &compressed, &compressed_header)) {
+            packet = &compressed;
+            split = true;
+        }
+
         switch (connection->protocol) {
-            case PROTOCOL_TCP: {
-                size_t sent = 0;
+            case PROTOCOL_TCP:
+                errors = split ? packet_send_split_tcp (packet, connection, flags, &sent)
+                    : packet_send_tcp (packet, connection, flags, &sent, raw);
+                break;
 
-                if (!(split ? packet_send_split_tcp (packet, connection, flags, &sent)
-                    : packet_send_tcp (packet, connection, flags, &sent, raw))) {
-                    if (total_sent) *total_sent = sent;
+            case PROTOCOL_UDP:
+                errors = packet_send_udp (packet, connection, flags, &sent, raw, split, reliable);
+                break;
 
-                    packet_send_update_stats (
-                        packet->packet_type, sent,
-                        client, connection
-                    );
+            default: break;
+        }
 
-                    retval = 0;
-                }
+        if (!errors) {
+            if (total_sent) *total_sent = sent;
 
-                else {
-                    #ifdef PACKETS_DEBUG
-                    printf ("\n");
-                    perror ("Error");
-                    printf ("\n");
-                    #endif
+            packet_send_update_stats (
+                packet->packet_type, sent,
+                client, connection
+            );
 
-                    if (client) client->stats->sent_packets->n_bad_packets += 1;
-                    if (connection) connection->stats->sent_packets->n_bad_packets += 1;
+            if (packet != original) {
+                u32 original_size = 0;
+                memcpy (&original_size, packet->data, sizeof (u32));
 
-                    if (total_sent) *total_sent = 0;
-                }
-            } break;
+                stats_add (connection->stats->counters, STATS_COMPRESSED_SENT, 1);
+                stats_add (connection->stats->counters, STATS_BYTES_UNCOMPRESSED_SENT, original_size);
+                stats_add (connection->stats->counters, STATS_BYTES_COMPRESSED_SENT, packet->data_size);
+            }
 
-            case PROTOCOL_UDP:
-                break;
+            retval = 0;
+        }
 
-            default: break;
+        else {
+            #ifdef PACKETS_DEBUG
+            printf ("\n");
+            perror ("Error");
+            printf ("\n");
+            #endif
+
+            if (client) stats_sent (client->stats->counters, STATS_PACKET_BAD);
+            if (connection) stats_sent (connection->stats->counters, STATS_PACKET_BAD);
+
+            if (total_sent) *total_sent = 0;
         }
+
+        if (packet != original) packet_buffer_free (packet->data);
     }
 
     return retval;
@@ -705,7 +1173,7 @@ u8 packet_send (const Packet *packet, int flags, size_t *total_sent, bool raw) {
 
     return packet_send_internal (
         packet, flags, total_sent, 
-        raw, false,
+        raw, false, false,
         packet->client, packet->connection
     );
 
@@ -721,7 +1189,7 @@ u8 packet_send_to (const Packet *packet, size_t *total_sent, bool raw,
 
     return packet_send_internal (
         packet, 0, total_sent, 
-        raw, false,
+        raw, false, false,
         client, connection
     );
 
@@ -737,7 +1205,7 @@ u8 packet_send_split (const Packet *packet, int flags, size_t *total_sent) {
 
     return packet_send_internal (
         packet, flags, total_sent, 
-        false, true,
+        false, true, false,
         packet->client, packet->connection
     );
 
@@ -751,41 +1219,28 @@ u8 packet_send_to_split (const Packet *packet, size_t *total_sent,
 
     return packet_send_internal (
         packet, 0, total_sent, 
-        false, true,
+        false, true, false,
         client, connection
     );
 
 }
 
-static u8 packet_send_pieces_actual (
-    Socket *socket, 
-    char *data, size_t data_size, 
-    int flags, 
-    size_t *actual_sent
-) {
-
-    u8 retval = 0;
-
-    ssize_t sent = 0;
-    char *p = data;
-    while (data_size > 0) {
-        sent = send (socket->sock_fd, p, data_size, flags);
-        if (sent < 0) {
-            retval = 1;
-            break;
-        }
-
-        p += sent;
-        *actual_sent += (size_t) sent;
-        data_size -= (size_t) sent;
-    }
+// sends a packet using its network values in the reliable channel
+// in udp connections the packet is sent again until the cerver acks it,
+// in tcp connections it works just as packet_send ()
+// returns 0 on success, 1 on error
+u8 packet_send_reliable (const Packet *packet, int flags, size_t *total_sent) {
 
-    return retval;
+    return packet_send_internal (
+        packet, flags, total_sent, 
+        false, false, true,
+        packet->client, packet->connection
+    );
 
 }
 
 // sends a packet in pieces, taking the header from the packet's field
-// sends each buffer as they are with they respective sizes
+// sends each buffer as they are with they respective sizes, all of them with a single syscall
 // socket mutex will be locked for the entire operation
 // returns 0 on success, 1 on error
 u8 packet_send_pieces (
@@ -798,38 +1253,109 @@ u8 packet_send_pieces (
     u8 retval = 1;
 
     if (packet && pieces && sizes) {
-        pthread_mutex_lock (packet->connection->socket->write_mutex);
+        struct iovec iov_storage[SOCKET_BATCH_MAX_IOV];
+        struct iovec *iov = (n_pieces < SOCKET_BATCH_MAX_IOV) ? 
+            iov_storage : (struct iovec *) malloc ((n_pieces + 1) * sizeof (struct iovec));
 
-        size_t actual_sent = 0;
-
-        // first send the header
-        if (!packet_send_pieces_actual (
-            packet->connection->socket,
-            (char *) packet->header, sizeof (PacketHeader),
-            flags,
-            &actual_sent
-        )) {
-            // send the pieces of data
+        if (iov) {
+            iov[0].iov_base = packet->header;
+            iov[0].iov_len = sizeof (PacketHeader);
             for (u32 i = 0; i < n_pieces; i++) {
-                (void) packet_send_pieces_actual (
-                    packet->connection->socket,
-                    (char *) pieces[i], sizes[i],
-                    flags,
-                    &actual_sent
-                );
+                iov[i + 1].iov_base = pieces[i];
+                iov[i + 1].iov_len = sizes[i];
             }
 
-            retval = 0;
+            pthread_mutex_lock (packet->connection->socket->write_mutex);
+
+            size_t actual_sent = 0;
+            retval = packet_send_iov (packet->connection->socket, iov, n_pieces + 1, flags, &actual_sent);
+
+            packet_send_update_stats (
+                packet->packet_type, actual_sent,
+                packet->client, packet->connection
+            );
+
+            if (total_sent) *total_sent = actual_sent;
+
+            pthread_mutex_unlock (packet->connection->socket->write_mutex);
+
+            if (iov != iov_storage) free (iov);
         }
+    }
 
-        packet_send_update_stats (
-            packet->packet_type, actual_sent,
+    return retval;
+
+}
+
+// sends the packet with the request id in a copy of its header, in udp connections it uses the reliable channel
+// returns 0 on success, 1 on error
+u8 packet_send_request (const Packet *packet, u32 request_id, int flags, size_t *total_sent) {
+
+    u8 retval = 1;
+
+    if (packet) {
+        // the header & the data are sent from a copy of the packet, so the original is not modified
+        Packet request = *packet;
+        PacketHeader header;
+        packet_get_parts (packet, &header, (const void **) &request.data, &request.data_size);
+
+        header.request_id = request_id;
+        request.header = &header;
+
+        retval = packet_send_internal (
+            &request, flags, total_sent,
+            false, true, true,
             packet->client, packet->connection
         );
+    }
 
-        if (total_sent) *total_sent = actual_sent;
+    return retval;
+
+}
+
+// 18/10/2026 -- sends the packet followed by size bytes of the file from offset, that are sent with sendfile (),
+// so the packet size in the header that is sent counts them, only tcp connections can send files like this
+// returns 0 on success, 1 on error
+u8 packet_send_file (const Packet *packet, int file_fd, off_t offset, size_t size, size_t *total_sent) {
+
+    u8 retval = 1;
+
+    if (packet && packet->connection && (packet->connection->protocol == PROTOCOL_TCP)) {
+        Connection *connection = packet->connection;
+
+        PacketHeader header;
+        const void *data = NULL;
+        size_t data_size = 0;
+        packet_get_parts (packet, &header, &data, &data_size);
+        header.packet_size += size;
+
+        struct iovec iov[2] = {
+            { &header, sizeof (PacketHeader) },
+            { (void *) data, data_size }
+        };
 
-        pthread_mutex_unlock (packet->connection->socket->write_mutex);
+        size_t sent = 0;
+
+        pthread_mutex_lock (connection->socket->write_mutex);
+
+        // the file bytes can not be added to the batch, so it goes first
+        if (!socket_batch_flush (connection->socket)
+            && !socket_sendv (connection->socket, iov, data_size ? 2 : 1, MSG_MORE, &sent)) {
+            retval = socket_sendfile (connection->socket, file_fd, offset, size, &sent);
+        }
+
+        pthread_mutex_unlock (connection->socket->write_mutex);
+
+        if (!retval) {
+            if (total_sent) *total_sent = sent;
+
+            packet_send_update_stats (
+                packet->packet_type, sent,
+                packet->client, connection
+            );
+        }
+
+        else if (total_sent) *total_sent = 0;
     }
 
     return retval;
@@ -845,32 +1371,85 @@ u8 packet_send_to_socket (const Packet *packet, Socket *socket,
     u8 retval = 0;
 
     if (packet) {
-        ssize_t sent = 0;
+        size_t sent = 0;
         const char *p = raw ? (char *) packet->data : (char *) packet->packet;
         size_t packet_size = raw ? packet->data_size : packet->packet_size;
 
         pthread_mutex_lock (socket->write_mutex);
 
-        while (packet_size > 0) {
-            sent = send (socket->sock_fd, p, packet_size, flags);
-            if (sent < 0) {
-                retval = 1;
-                break;
-            };
+        retval = socket_send (socket, p, packet_size, flags, &sent);
 
-            p += sent;
-            packet_size -= sent;
-        }
+        if (total_sent) *total_sent = sent;
 
-        if (total_sent) *total_sent = (size_t) sent;
+        pthread_mutex_unlock (socket->write_mutex);
+    }
 
-        pthread_mutex_lock (socket->write_mutex);
+    return retval;
+
+}
+
+// replaces the compressed data of a received packet with the decompressed data in a pooled buffer
+// the header is updated to match it, and the packet is set to NULL as it has the compressed data
+// returns 0 on success, 1 on error
+u8 packet_decompress (Packet *packet) {
+
+    u8 retval = 1;
+
+    if (packet && packet->header && (packet->header->flags & PACKET_FLAG_LZ4)
+        && packet->data && (packet->data_size > sizeof (u32))) {
+        u32 original_size = 0;
+        memcpy (&original_size, packet->data, sizeof (u32));
+
+        if (original_size && (original_size <= RECEIVE_PACKET_MAX_SIZE)) {
+            char *buffer = (char *) packet_buffer_alloc (original_size);
+            if (buffer) {
+                size_t size = lz4_decompress ((char *) packet->data + sizeof (u32), packet->data_size - sizeof (u32),
+                    buffer, original_size);
+
+                if (size == original_size) {
+                    if (!packet->data_ref) packet_buffer_free (packet->data);
+
+                    packet->data = buffer;
+                    packet->data_size = original_size;
+                    packet->data_ptr = buffer;
+                    packet->data_end = buffer + original_size;
+                    packet->data_ref = false;
+
+                    packet->header->flags &= ~PACKET_FLAGS_COMPRESSED;
+                    packet->header->packet_size = sizeof (PacketHeader) + original_size;
+
+                    if (!packet->packet_ref) packet_buffer_free (packet->packet);
+                    packet->packet = NULL;
+                    packet->packet_size = packet->header->packet_size;
+                    packet->packet_ref = false;
+
+                    retval = 0;
+                }
+
+                else packet_buffer_free (buffer);
+            }
+        }
     }
 
     return retval;
 
 }
 
+// releases the buffer that the data was decompressed into, a packet that was retained has its own copy
+void packet_decompress_end (Packet *packet) {
+
+    if (packet && !packet->data_ref) {
+        packet_buffer_free (packet->data);
+
+        packet->data = NULL;
+        packet->data_size = 0;
+        packet->data_ptr = NULL;
+        packet->data_end = NULL;
+        packet->data_ref = true;
+    }
+
+}
+
 // check if packet has a compatible protocol id and a version
 // returns false on a bad packet
 bool packet_check (Packet *packet) {
@@ -0,0 +1,566 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+
+#include <unistd.h>
+#include <pthread.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/client/network.h"
+#include "cengine/client/client.h"
+#include "cengine/client/connection.h"
+#include "cengine/client/socket.h"
+#include "cengine/client/handler.h"
+#include "cengine/client/reactor.h"
+#include "cengine/client/requests.h"
+
+#include "cengine/threads/thread.h"
+
+#include "cengine/utils/log.h"
+
+static ClientReactor *reactor = NULL;
+
+// protects the reactor and the entries lists of every thread
+static pthread_mutex_t reactor_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#pragma region entries
+
+static ClientReactorEntry *client_reactor_entry_new (Client *client, Connection *connection) {
+
+    ClientReactorEntry *entry = (ClientReactorEntry *) malloc (sizeof (ClientReactorEntry));
+    if (entry) {
+        entry->client = client;
+        entry->connection = connection;
+
+        entry->custom_data = NULL;
+        if (connection->custom_receive) {
+            entry->custom_data = (ConnectionCustomReceiveData *) malloc (sizeof (ConnectionCustomReceiveData));
+            if (entry->custom_data) {
+                entry->custom_data->client = client;
+                entry->custom_data->connection = connection;
+                entry->custom_data->args = connection->custom_receive_args;
+            }
+        }
+
+        entry->thread = NULL;
+        entry->batched = false;
+        entry->keepalive = false;
+
+        entry->removed = false;
+        entry->prev = NULL;
+        entry->next = NULL;
+    }
+
+    return entry;
+
+}
+
+static void client_reactor_entry_delete (ClientReactorEntry *entry) {
+
+    if (entry) {
+        if (entry->custom_data) free (entry->custom_data);
+        free (entry);
+    }
+
+}
+
+// frees the entries that were removed while the thread was handling events
+static void client_reactor_thread_free_removed (ClientReactorThread *thread) {
+
+    pthread_mutex_lock (&reactor_mutex);
+
+    ClientReactorEntry *entry = thread->removed;
+    thread->removed = NULL;
+
+    pthread_mutex_unlock (&reactor_mutex);
+
+    while (entry) {
+        ClientReactorEntry *next = entry->next;
+        client_reactor_entry_delete (entry);
+        entry = next;
+    }
+
+}
+
+#pragma endregion
+
+#pragma region thread
+
+static void client_reactor_handle_failed (ClientReactorEntry *entry) {
+
+    if (entry->connection->connected) {
+        // 18/10/2026 -- it will be connected again
+        if (entry->connection->reconnect) client_connection_lost (entry->client, entry->connection, false);
+
+        else if (!client_connection_end (entry->client, entry->connection)) {
+            if (entry->client->connections->size <= 0) {
+                entry->client->running = false;
+            }
+        }
+    }
+
+}
+
+static void client_reactor_handle (ClientReactorEntry *entry, u32 events) {
+
+    Connection *connection = entry->connection;
+
+    // send what was queued while the socket was full
+    if (events & EPOLLOUT) {
+        pthread_mutex_lock (connection->socket->write_mutex);
+        u8 errors = socket_flush (connection->socket);
+        pthread_mutex_unlock (connection->socket->write_mutex);
+
+        if (errors) {
+            client_reactor_handle_failed (entry);
+            return;
+        }
+    }
+
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP)) {
+        if (connection->custom_receive) {
+            // custom receive sockets are level triggered, so one call is enough
+            connection->custom_receive (entry->custom_data);
+
+            if (events & (EPOLLERR | EPOLLHUP)) client_reactor_handle_failed (entry);
+        }
+
+        // reads until recv () would block, the socket is edge triggered
+        else (void) client_receive_all (entry->client, connection);
+    }
+
+}
+
+// sends the batches that have waited their max delay
+static void client_reactor_thread_flush_batches (ClientReactorThread *thread) {
+
+    pthread_mutex_lock (&reactor_mutex);
+
+    for (ClientReactorEntry *entry = thread->entries; entry; entry = entry->next) {
+        if (entry->batched) {
+            pthread_mutex_lock (entry->connection->socket->write_mutex);
+            (void) socket_batch_flush_expired (entry->connection->socket);
+            pthread_mutex_unlock (entry->connection->socket->write_mutex);
+        }
+    }
+
+    pthread_mutex_unlock (&reactor_mutex);
+
+}
+
+// returns the CLOCK_MONOTONIC time in ms
+static inline u64 client_reactor_time (void) {
+
+    struct timespec now = { 0 };
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return (u64) now.tv_sec * 1000 + (u64) now.tv_nsec / 1000000;
+
+}
+
+// ends the requests of the thread connections that have timed out
+static void client_reactor_thread_expire_requests (ClientReactorThread *thread) {
+
+    u64 now = client_reactor_time ();
+    if ((now - thread->requests_time) >= CLIENT_REQUEST_CHECK_INTERVAL) {
+        thread->requests_time = now;
+
+        ClientRequest *expired = NULL;
+
+        pthread_mutex_lock (&reactor_mutex);
+
+        for (ClientReactorEntry *entry = thread->entries; entry; entry = entry->next)
+            expired = connection_requests_take_expired (entry->connection, expired);
+
+        pthread_mutex_unlock (&reactor_mutex);
+
+        // the callbacks can end the connections, so they are called without the reactor lock
+        client_requests_end_expired (expired);
+    }
+
+}
+
+// 18/10/2026 -- sends the heartbeats of the thread connections & ends the ones that have been idle for too much
+static void client_reactor_thread_keepalive (ClientReactorThread *thread) {
+
+    u64 now = client_reactor_time ();
+    if ((now - thread->keepalive_time) >= CONNECTION_KEEPALIVE_CHECK_INTERVAL) {
+        thread->keepalive_time = now;
+
+        // ending a connection takes the reactor lock, so they are ended after it is released,
+        // the entries are only freed by this thread, & the ones that are left are found in the next check
+        ClientReactorEntry *lost[CLIENT_REACTOR_MAX_EVENTS];
+        u32 n_lost = 0;
+
+        pthread_mutex_lock (&reactor_mutex);
+
+        for (ClientReactorEntry *entry = thread->entries; entry && (n_lost < CLIENT_REACTOR_MAX_EVENTS); entry = entry->next) {
+            if (entry->keepalive && connection_keepalive (entry->client, entry->connection))
+                lost[n_lost++] = entry;
+        }
+
+        pthread_mutex_unlock (&reactor_mutex);
+
+        for (u32 i = 0; i < n_lost; i++) {
+            if (!__atomic_load_n (&lost[i]->removed, __ATOMIC_ACQUIRE))
+                client_connection_lost (lost[i]->client, lost[i]->connection, true);
+        }
+    }
+
+}
+
+static void *client_reactor_thread (void *thread_ptr) {
+
+    ClientReactorThread *thread = (ClientReactorThread *) thread_ptr;
+
+    thread_set_name ("client-reactor");
+
+    struct epoll_event events[CLIENT_REACTOR_MAX_EVENTS];
+
+    while (__atomic_load_n (&reactor->running, __ATOMIC_ACQUIRE)) {
+        // none of the events we are about to get can reference these
+        client_reactor_thread_free_removed (thread);
+
+        // wake up from time to time if there are batches that may need to be sent,
+        // or requests that may time out
+        bool batches = __atomic_load_n (&thread->n_batched, __ATOMIC_RELAXED) > 0;
+        bool requests = client_requests_timed () > 0;
+        bool keepalive = __atomic_load_n (&thread->n_keepalive, __ATOMIC_RELAXED) > 0;
+
+        int timeout = -1;
+        if (batches) timeout = CLIENT_REACTOR_BATCH_WAIT;
+        else if (requests) timeout = CLIENT_REQUEST_CHECK_INTERVAL;
+
+        if (keepalive && ((timeout < 0) || (timeout > CONNECTION_KEEPALIVE_CHECK_INTERVAL)))
+            timeout = CONNECTION_KEEPALIVE_CHECK_INTERVAL;
+
+        int n_events = epoll_wait (thread->epoll_fd, events, CLIENT_REACTOR_MAX_EVENTS, timeout);
+        if (n_events < 0) {
+            if (errno == EINTR) continue;
+
+            cengine_log_msg (stderr, LOG_ERROR, LOG_CLIENT, "client_reactor_thread () - epoll_wait () has failed!");
+            break;
+        }
+
+        for (int i = 0; i < n_events; i++) {
+            ClientReactorEntry *entry = (ClientReactorEntry *) events[i].data.ptr;
+
+            // the wake fd
+            if (!entry) {
+                u64 value = 0;
+                (void) read (thread->wake_fd, &value, sizeof (u64));
+                continue;
+            }
+
+            if (!__atomic_load_n (&entry->removed, __ATOMIC_ACQUIRE))
+                client_reactor_handle (entry, events[i].events);
+        }
+
+        if (batches) client_reactor_thread_flush_batches (thread);
+
+        if (requests) client_reactor_thread_expire_requests (thread);
+
+        if (keepalive) client_reactor_thread_keepalive (thread);
+    }
+
+    return NULL;
+
+}
+
+#pragma endregion
+
+#pragma region main
+
+static void client_reactor_thread_close (ClientReactorThread *thread) {
+
+    if (thread->epoll_fd >= 0) close (thread->epoll_fd);
+    if (thread->wake_fd >= 0) close (thread->wake_fd);
+
+    thread->epoll_fd = -1;
+    thread->wake_fd = -1;
+
+}
+
+// returns 0 on success, 1 on error
+static u8 client_reactor_thread_init (ClientReactorThread *thread) {
+
+    u8 retval = 1;
+
+    memset (thread, 0, sizeof (ClientReactorThread));
+
+    thread->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    thread->wake_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ((thread->epoll_fd >= 0) && (thread->wake_fd >= 0)) {
+        struct epoll_event event = { 0 };
+        event.events = EPOLLIN;
+        event.data.ptr = NULL;
+
+        if (!epoll_ctl (thread->epoll_fd, EPOLL_CTL_ADD, thread->wake_fd, &event)) {
+            if (!pthread_create (&thread->thread_id, NULL, client_reactor_thread, thread)) {
+                retval = 0;
+            }
+        }
+    }
+
+    if (retval) client_reactor_thread_close (thread);
+
+    return retval;
+
+}
+
+// starts the reactor with n_threads epoll threads (1 if 0 is passed)
+// after this, client_connection_start () registers the connections in the reactor
+// instead of creating an update thread for each one of them
+// returns 0 on success, 1 on error
+u8 client_reactor_init (unsigned int n_threads) {
+
+    u8 retval = 1;
+
+    pthread_mutex_lock (&reactor_mutex);
+
+    if (!reactor) {
+        if (!n_threads) n_threads = 1;
+        if (n_threads > CLIENT_REACTOR_MAX_THREADS) n_threads = CLIENT_REACTOR_MAX_THREADS;
+
+        reactor = (ClientReactor *) malloc (sizeof (ClientReactor));
+        if (reactor) {
+            memset (reactor, 0, sizeof (ClientReactor));
+            reactor->running = true;
+
+            for (unsigned int i = 0; i < n_threads; i++) {
+                if (client_reactor_thread_init (&reactor->threads[reactor->n_threads])) {
+                    cengine_log_msg (stderr, LOG_ERROR, LOG_CLIENT, "Failed to create client reactor thread!");
+                    break;
+                }
+
+                reactor->n_threads += 1;
+            }
+
+            if (reactor->n_threads) retval = 0;
+
+            else {
+                free (reactor);
+                reactor = NULL;
+            }
+        }
+    }
+
+    pthread_mutex_unlock (&reactor_mutex);
+
+    return retval;
+
+}
+
+// wakes up every reactor thread, so they check again how much time they can wait for events
+void client_reactor_wake (void) {
+
+    pthread_mutex_lock (&reactor_mutex);
+
+    if (reactor) {
+        u64 value = 1;
+        for (u32 i = 0; i < reactor->n_threads; i++)
+            (void) write (reactor->threads[i].wake_fd, &value, sizeof (u64));
+    }
+
+    pthread_mutex_unlock (&reactor_mutex);
+
+}
+
+// gives the socket back to its owner as a blocking socket
+static void client_reactor_entry_detach (ClientReactorEntry *entry) {
+
+    Socket *socket = entry->connection->socket;
+
+    pthread_mutex_lock (socket->write_mutex);
+
+    socket->reactor_fd = -1;
+    socket->reactor_entry = NULL;
+    socket->reactor_events = 0;
+
+    if (socket->sock_fd >= 0) sock_set_blocking (socket->sock_fd, true);
+
+    pthread_mutex_unlock (socket->write_mutex);
+
+}
+
+// stops the reactor threads, the connections that are still registered are not closed
+void client_reactor_end (void) {
+
+    pthread_mutex_lock (&reactor_mutex);
+    ClientReactor *r = reactor;
+    if (r) {
+        __atomic_store_n (&r->running, false, __ATOMIC_RELEASE);
+
+        u64 value = 1;
+        for (u32 i = 0; i < r->n_threads; i++)
+            (void) write (r->threads[i].wake_fd, &value, sizeof (u64));
+    }
+    pthread_mutex_unlock (&reactor_mutex);
+
+    if (r) {
+        // handlers can still unregister connections while we wait
+        for (u32 i = 0; i < r->n_threads; i++)
+            pthread_join (r->threads[i].thread_id, NULL);
+
+        pthread_mutex_lock (&reactor_mutex);
+
+        for (u32 i = 0; i < r->n_threads; i++) {
+            ClientReactorThread *thread = &r->threads[i];
+
+            ClientReactorEntry *entry = thread->entries;
+            while (entry) {
+                ClientReactorEntry *next = entry->next;
+                client_reactor_entry_detach (entry);
+                client_reactor_entry_delete (entry);
+                entry = next;
+            }
+
+            entry = thread->removed;
+            while (entry) {
+                ClientReactorEntry *next = entry->next;
+                client_reactor_entry_delete (entry);
+                entry = next;
+            }
+
+            client_reactor_thread_close (thread);
+        }
+
+        free (r);
+        reactor = NULL;
+
+        pthread_mutex_unlock (&reactor_mutex);
+    }
+
+}
+
+// returns true if the reactor has been started
+bool client_reactor_is_running (void) {
+
+    pthread_mutex_lock (&reactor_mutex);
+    bool running = reactor ? reactor->running : false;
+    pthread_mutex_unlock (&reactor_mutex);
+
+    return running;
+
+}
+
+// makes the connection socket non blocking and gives it to the reactor thread with less connections
+// received packets are handled with client_receive (), or with the connection custom receive method
+// returns 0 on success, 1 on error
+u8 client_reactor_register (Client *client, Connection *connection) {
+
+    u8 retval = 1;
+
+    if (client && connection && connection->socket) {
+        pthread_mutex_lock (&reactor_mutex);
+
+        if (reactor && reactor->running) {
+            ClientReactorThread *thread = &reactor->threads[0];
+            for (u32 i = 1; i < reactor->n_threads; i++)
+                if (reactor->threads[i].n_connections < thread->n_connections) thread = &reactor->threads[i];
+
+            ClientReactorEntry *entry = client_reactor_entry_new (client, connection);
+            if (entry) {
+                entry->thread = thread;
+
+                Socket *socket = connection->socket;
+                sock_set_blocking (socket->sock_fd, false);
+
+                pthread_mutex_lock (socket->write_mutex);
+
+                socket->reactor_fd = thread->epoll_fd;
+                socket->reactor_entry = entry;
+                socket->reactor_events = EPOLLIN | EPOLLRDHUP;
+                if (!connection->custom_receive) socket->reactor_events |= EPOLLET;
+
+                struct epoll_event event = { 0 };
+                event.events = socket->reactor_events | (socket_has_queued (socket) ? EPOLLOUT : 0);
+                event.data.ptr = entry;
+
+                if (!epoll_ctl (thread->epoll_fd, EPOLL_CTL_ADD, socket->sock_fd, &event)) {
+                    entry->next = thread->entries;
+                    if (thread->entries) thread->entries->prev = entry;
+                    thread->entries = entry;
+                    thread->n_connections += 1;
+
+                    entry->batched = socket_batch_enabled (socket) && socket->batch_delay;
+                    if (entry->batched) __atomic_add_fetch (&thread->n_batched, 1, __ATOMIC_RELAXED);
+
+                    entry->keepalive = connection_keepalive_enabled (connection);
+                    if (entry->keepalive) __atomic_add_fetch (&thread->n_keepalive, 1, __ATOMIC_RELAXED);
+
+                    retval = 0;
+                }
+
+                else {
+                    socket->reactor_fd = -1;
+                    socket->reactor_entry = NULL;
+                    socket->reactor_events = 0;
+                }
+
+                pthread_mutex_unlock (socket->write_mutex);
+
+                if (retval) {
+                    sock_set_blocking (socket->sock_fd, true);
+                    client_reactor_entry_delete (entry);
+                }
+            }
+        }
+
+        pthread_mutex_unlock (&reactor_mutex);
+    }
+
+    return retval;
+
+}
+
+// removes the connection from its reactor thread, it must be called before closing the socket
+void client_reactor_unregister (Connection *connection) {
+
+    if (connection && connection->socket) {
+        pthread_mutex_lock (&reactor_mutex);
+
+        Socket *socket = connection->socket;
+
+        pthread_mutex_lock (socket->write_mutex);
+
+        ClientReactorEntry *entry = (ClientReactorEntry *) socket->reactor_entry;
+        if (entry) {
+            (void) epoll_ctl (socket->reactor_fd, EPOLL_CTL_DEL, socket->sock_fd, NULL);
+
+            socket->reactor_fd = -1;
+            socket->reactor_entry = NULL;
+            socket->reactor_events = 0;
+        }
+
+        pthread_mutex_unlock (socket->write_mutex);
+
+        if (entry) {
+            ClientReactorThread *thread = entry->thread;
+
+            if (entry->prev) entry->prev->next = entry->next;
+            else thread->entries = entry->next;
+            if (entry->next) entry->next->prev = entry->prev;
+            thread->n_connections -= 1;
+            if (entry->batched) __atomic_sub_fetch (&thread->n_batched, 1, __ATOMIC_RELAXED);
+            if (entry->keepalive) __atomic_sub_fetch (&thread->n_keepalive, 1, __ATOMIC_RELAXED);
+
+            // the thread frees it before waiting for new events
+            __atomic_store_n (&entry->removed, true, __ATOMIC_RELEASE);
+            entry->prev = NULL;
+            entry->next = thread->removed;
+            thread->removed = entry;
+        }
+
+        pthread_mutex_unlock (&reactor_mutex);
+    }
+
+}
+
+#pragma endregion
@@ -0,0 +1,559 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+
+#include <pthread.h>
+#include <poll.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/client/client.h"
+#include "cengine/client/connection.h"
+#include "cengine/client/handler.h"
+#include "cengine/client/packets.h"
+#include "cengine/client/reactor.h"
+#include "cengine/client/requests.h"
+
+#include "cengine/utils/log.h"
+
+// pending requests that can time out in every connection, the reactor threads only check them if there are any
+static u32 requests_timed = 0;
+
+// returns the CLOCK_MONOTONIC time in micro secs
+static inline u64 requests_time (void) {
+
+    struct timespec now = { 0 };
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return (u64) now.tv_sec * 1000000 + (u64) now.tv_nsec / 1000;
+
+}
+
+#pragma region request
+
+static ClientRequest *client_request_new (void) {
+
+    ClientRequest *request = (ClientRequest *) malloc (sizeof (ClientRequest));
+    if (request) {
+        memset (request, 0, sizeof (ClientRequest));
+
+        request->mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+        request->done = (pthread_cond_t *) malloc (sizeof (pthread_cond_t));
+        if (request->mutex && request->done) {
+            pthread_mutex_init (request->mutex, NULL);
+
+            // the waits are measured with the same clock as the deadlines
+            pthread_condattr_t attr;
+            pthread_condattr_init (&attr);
+            pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+            pthread_cond_init (request->done, &attr);
+            pthread_condattr_destroy (&attr);
+        }
+
+        else {
+            if (request->mutex) free (request->mutex);
+            if (request->done) free (request->done);
+            free (request);
+            request = NULL;
+        }
+    }
+
+    return request;
+
+}
+
+// releases the caller's reference to the request, a pending request is not cancelled,
+// so it is safe to call it right after client_request_send () if the request has a callback
+void client_request_delete (void *request_ptr) {
+
+    if (request_ptr) {
+        ClientRequest *request = (ClientRequest *) request_ptr;
+
+        if (!__atomic_sub_fetch (&request->ref_count, 1, __ATOMIC_ACQ_REL)) {
+            if (!request->callback) packet_delete (request->response);
+
+            pthread_mutex_destroy (request->mutex);
+            free (request->mutex);
+
+            pthread_cond_destroy (request->done);
+            free (request->done);
+
+            free (request);
+        }
+    }
+
+}
+
+// returns the current status of the request without waiting
+ClientRequestStatus client_request_get_status (ClientRequest *request) {
+
+    ClientRequestStatus status = CLIENT_REQUEST_FAILED;
+
+    if (request) {
+        pthread_mutex_lock (request->mutex);
+        status = request->status;
+        pthread_mutex_unlock (request->mutex);
+    }
+
+    return status;
+
+}
+
+// returns the response of a request that was made without a callback,
+// it belongs to the request & is deleted with it, NULL if the request has not ended with a response
+Packet *client_request_get_response (ClientRequest *request) {
+
+    Packet *response = NULL;
+
+    if (request && !request->callback) {
+        pthread_mutex_lock (request->mutex);
+        response = request->response;
+        pthread_mutex_unlock (request->mutex);
+    }
+
+    return response;
+
+}
+
+// ends a request that has been taken out of its table, the response is kept or passed to the callback
+void client_request_end (ClientRequest *request, ClientRequestStatus status, const Packet *response) {
+
+    if (request) {
+        pthread_mutex_lock (request->mutex);
+
+        request->status = status;
+        if (response && !request->callback) request->response = packet_retain (response);
+
+        pthread_cond_broadcast (request->done);
+
+        pthread_mutex_unlock (request->mutex);
+
+        if (request->callback) {
+            request->response = (Packet *) response;
+            request->callback (request);
+            request->response = NULL;
+        }
+
+        // the table reference
+        client_request_delete (request);
+    }
+
+}
+
+#pragma endregion
+
+#pragma region table
+
+ConnectionRequests *connection_requests_new (void) {
+
+    ConnectionRequests *requests = (ConnectionRequests *) malloc (sizeof (ConnectionRequests));
+    if (requests) {
+        memset (requests, 0, sizeof (ConnectionRequests));
+
+        requests->next_id = 1;
+
+        requests->mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+        if (requests->mutex) pthread_mutex_init (requests->mutex, NULL);
+
+        else {
+            free (requests);
+            requests = NULL;
+        }
+    }
+
+    return requests;
+
+}
+
+// takes every request out of the table
+// returns a list of the requests, linked with their next field
+static ClientRequest *connection_requests_take_all (ConnectionRequests *requests) {
+
+    ClientRequest *list = NULL;
+
+    pthread_mutex_lock (requests->mutex);
+
+    for (u32 i = 0; i < CONNECTION_REQUESTS_BUCKETS; i++) {
+        ClientRequest *request = requests->buckets[i];
+        while (request) {
+            ClientRequest *next = request->next;
+
+            if (request->deadline) __atomic_sub_fetch (&requests_timed, 1, __ATOMIC_RELAXED);
+
+            request->next = list;
+            list = request;
+
+            request = next;
+        }
+
+        requests->buckets[i] = NULL;
+    }
+
+    requests->n_pending = 0;
+
+    pthread_mutex_unlock (requests->mutex);
+
+    return list;
+
+}
+
+static void client_requests_end_list (ClientRequest *list, ClientRequestStatus status) {
+
+    while (list) {
+        ClientRequest *next = list->next;
+        list->next = NULL;
+
+        client_request_end (list, status, NULL);
+
+        list = next;
+    }
+
+}
+
+// the requests that are still pending end with CLIENT_REQUEST_FAILED
+void connection_requests_delete (void *requests_ptr) {
+
+    if (requests_ptr) {
+        ConnectionRequests *requests = (ConnectionRequests *) requests_ptr;
+
+        client_requests_end_list (connection_requests_take_all (requests), CLIENT_REQUEST_FAILED);
+
+        pthread_mutex_destroy (requests->mutex);
+        free (requests->mutex);
+
+        free (requests);
+    }
+
+}
+
+// gives the request a new id & adds it to the table, the table mutex must be locked by the caller
+static void connection_requests_add (ConnectionRequests *requests, ClientRequest *request) {
+
+    // 0 is used by the packets that are not part of a request
+    if (!requests->next_id) requests->next_id = 1;
+    request->request_id = requests->next_id++;
+
+    u32 bucket = request->request_id % CONNECTION_REQUESTS_BUCKETS;
+    request->next = requests->buckets[bucket];
+    requests->buckets[bucket] = request;
+
+    requests->n_pending += 1;
+
+}
+
+// removes the request with the id from the table, the table mutex must be locked by the caller
+// returns the request, NULL if it is not in the table
+static ClientRequest *connection_requests_remove (ConnectionRequests *requests, u32 request_id) {
+
+    ClientRequest *request = NULL;
+
+    ClientRequest **link = &requests->buckets[request_id % CONNECTION_REQUESTS_BUCKETS];
+    while (*link) {
+        if ((*link)->request_id == request_id) {
+            request = *link;
+            *link = request->next;
+            request->next = NULL;
+
+            requests->n_pending -= 1;
+            if (request->deadline) __atomic_sub_fetch (&requests_timed, 1, __ATOMIC_RELAXED);
+
+            break;
+        }
+
+        link = &(*link)->next;
+    }
+
+    return request;
+
+}
+
+// removes the request that has been pending for the longest time, the table mutex must be locked by the caller
+// returns the request, NULL if there are none
+static ClientRequest *connection_requests_remove_oldest (ConnectionRequests *requests) {
+
+    ClientRequest *oldest = NULL;
+    u32 oldest_age = 0;
+
+    // the ids are given in order, so the oldest one is the furthest behind the next one
+    for (u32 i = 0; i < CONNECTION_REQUESTS_BUCKETS; i++) {
+        for (ClientRequest *request = requests->buckets[i]; request; request = request->next) {
+            u32 age = requests->next_id - request->request_id;
+            if (!oldest || (age > oldest_age)) {
+                oldest = request;
+                oldest_age = age;
+            }
+        }
+    }
+
+    return oldest ? connection_requests_remove (requests, oldest->request_id) : NULL;
+
+}
+
+// takes the request out of its table if it is still there & ends it with the status
+static void client_request_stop (ClientRequest *request, ClientRequestStatus status) {
+
+    pthread_mutex_lock (request->requests->mutex);
+    ClientRequest *removed = connection_requests_remove (request->requests, request->request_id);
+    pthread_mutex_unlock (request->requests->mutex);
+
+    if (removed) client_request_end (removed, status, NULL);
+
+}
+
+// takes the pending request that the response is for out of the connection table,
+// for cervers that do not send back request ids, it is the oldest pending request
+// returns NULL if the packet is not the response of a pending request
+ClientRequest *connection_requests_take (Connection *connection, const Packet *packet) {
+
+    ClientRequest *request = NULL;
+
+    if (connection && connection->requests && packet && packet->header) {
+        ConnectionRequests *requests = connection->requests;
+
+        pthread_mutex_lock (requests->mutex);
+
+        if (packet->header->request_id) {
+            requests->peer_ids = true;
+            request = connection_requests_remove (requests, packet->header->request_id);
+        }
+
+        // heartbeats & the other connection packets are never a response
+        else if (!requests->peer_ids && requests->n_pending && (packet->header->packet_type != CLIENT_PACKET)) {
+            request = connection_requests_remove_oldest (requests);
+        }
+
+        pthread_mutex_unlock (requests->mutex);
+    }
+
+    return request;
+
+}
+
+// takes the requests that have timed out out of the connection table and adds them to the list
+// returns the new start of the list
+ClientRequest *connection_requests_take_expired (Connection *connection, ClientRequest *expired) {
+
+    if (connection && connection->requests) {
+        ConnectionRequests *requests = connection->requests;
+
+        pthread_mutex_lock (requests->mutex);
+
+        if (requests->n_pending) {
+            u64 now = requests_time ();
+
+            for (u32 i = 0; i < CONNECTION_REQUESTS_BUCKETS; i++) {
+                ClientRequest **link = &requests->buckets[i];
+                while (*link) {
+                    ClientRequest *request = *link;
+                    if (request->deadline && (request->deadline <= now)) {
+                        *link = request->next;
+
+                        requests->n_pending -= 1;
+                        __atomic_sub_fetch (&requests_timed, 1, __ATOMIC_RELAXED);
+
+                        request->next = expired;
+                        expired = request;
+                    }
+
+                    else link = &request->next;
+                }
+            }
+        }
+
+        pthread_mutex_unlock (requests->mutex);
+    }
+
+    return expired;
+
+}
+
+// ends every request in the list with CLIENT_REQUEST_TIMEOUT
+void client_requests_end_expired (ClientRequest *expired) {
+
+    client_requests_end_list (expired, CLIENT_REQUEST_TIMEOUT);
+
+}
+
+// ends the requests of the connection that have timed out
+void connection_requests_expire (Connection *connection) {
+
+    client_requests_end_expired (connection_requests_take_expired (connection, NULL));
+
+}
+
+// ends every pending request of the connection with CLIENT_REQUEST_FAILED
+void connection_requests_fail (Connection *connection) {
+
+    if (connection && connection->requests) {
+        client_requests_end_list (connection_requests_take_all (connection->requests), CLIENT_REQUEST_FAILED);
+    }
+
+}
+
+// returns the number of pending requests that can time out, in every connection
+u32 client_requests_timed (void) {
+
+    return __atomic_load_n (&requests_timed, __ATOMIC_RELAXED);
+
+}
+
+#pragma endregion
+
+#pragma region send
+
+// works just as client_request_send (), handle sets if the response also goes to the client's packet handlers
+ClientRequest *client_request_send_internal (Client *client, Connection *connection,
+    Packet *request_packet, u32 timeout, bool handle, Action callback, void *callback_args) {
+
+    ClientRequest *request = NULL;
+
+    if (client && connection && connection->requests && request_packet) {
+        request = client_request_new ();
+        if (request) {
+            request->client = client;
+            request->connection = connection;
+            request->requests = connection->requests;
+
+            request->status = CLIENT_REQUEST_PENDING;
+            request->deadline = timeout ? requests_time () + (u64) timeout * 1000 : 0;
+
+            request->handle = handle;
+            request->callback = callback;
+            request->callback_args = callback_args;
+
+            request->ref_count = 2;
+
+            // the response can arrive before the send returns
+            pthread_mutex_lock (connection->requests->mutex);
+            connection_requests_add (connection->requests, request);
+            u32 timed = request->deadline ? __atomic_add_fetch (&requests_timed, 1, __ATOMIC_RELAXED) : 0;
+            pthread_mutex_unlock (connection->requests->mutex);
+
+            // the reactor threads may be waiting without a timeout
+            if (timed == 1) client_reactor_wake ();
+
+            packet_set_network_values (request_packet, client, connection);
+            if (packet_send_request (request_packet, request->request_id, 0, NULL)) {
+                pthread_mutex_lock (connection->requests->mutex);
+                ClientRequest *removed = connection_requests_remove (connection->requests, request->request_id);
+                pthread_mutex_unlock (connection->requests->mutex);
+
+                // the table reference, unless the connection was closed & it already ended
+                if (removed) client_request_delete (removed);
+
+                client_request_delete (request);
+                request = NULL;
+
+                #ifdef CLIENT_DEBUG
+                cengine_log_error ("client_request_send () - failed to send request packet!");
+                #endif
+            }
+        }
+    }
+
+    return request;
+
+}
+
+// sends the request with a new request id and returns a request to wait for its response
+// the response is passed to the callback if there is one, if not, it is kept in the request
+// timeout in ms, 0 to wait forever, if the response does not arrive in time the request ends with CLIENT_REQUEST_TIMEOUT
+// responses are received by the connection update thread or by the reactor if the connection has been started,
+// if not, they are received by the threads that call client_request_wait ()
+// the request packet won't be deleted
+// returns a new request that should be deleted with client_request_delete (), NULL on error
+ClientRequest *client_request_send (Client *client, Connection *connection,
+    Packet *request, u32 timeout, Action callback, void *callback_args) {
+
+    return client_request_send_internal (client, connection, request, timeout, false, callback, callback_args);
+
+}
+
+#pragma endregion
+
+#pragma region wait
+
+// waits for the request to end, at most until its deadline or the next check
+static void client_request_wait_timed (ClientRequest *request) {
+
+    u64 until = requests_time () + CLIENT_REQUEST_CHECK_INTERVAL * 1000;
+    if (request->deadline && (request->deadline < until)) until = request->deadline;
+
+    struct timespec abstime = { (time_t) (until / 1000000), (long) (until % 1000000) * 1000 };
+
+    pthread_mutex_lock (request->mutex);
+    while (request->status == CLIENT_REQUEST_PENDING) {
+        if (pthread_cond_timedwait (request->done, request->mutex, &abstime) == ETIMEDOUT) break;
+    }
+    pthread_mutex_unlock (request->mutex);
+
+}
+
+// waits until the socket has something to receive, at most until the request deadline or the next check
+// returns true if it can be received without blocking
+static bool client_request_wait_readable (ClientRequest *request) {
+
+    u64 now = requests_time ();
+    u64 until = now + CLIENT_REQUEST_CHECK_INTERVAL * 1000;
+    if (request->deadline && (request->deadline < until)) until = request->deadline;
+
+    struct pollfd pfd = { .fd = request->connection->socket->sock_fd, .events = POLLIN };
+    int timeout = (until > now) ? (int) ((until - now + 999) / 1000) : 0;
+
+    return poll (&pfd, 1, timeout) > 0;
+
+}
+
+// waits until the request has ended
+// if the connection has not been started, the waiting threads take turns to receive its packets,
+// waiting for them at most until the request deadline
+// returns the request final status
+ClientRequestStatus client_request_wait (ClientRequest *request) {
+
+    ClientRequestStatus status = CLIENT_REQUEST_FAILED;
+
+    if (request) {
+        Connection *connection = request->connection;
+        ConnectionRequests *requests = request->requests;
+
+        while ((status = client_request_get_status (request)) == CLIENT_REQUEST_PENDING) {
+            // nobody else receives the connection packets, so one of the waiting threads does it
+            if (!connection->started && connection->connected
+                && !__atomic_exchange_n (&requests->receiving, true, __ATOMIC_ACQUIRE)) {
+                // the recv () only happens once there is something to receive, so the timeout is kept
+                if (client_request_wait_readable (request)) client_receive (request->client, connection);
+                connection_requests_expire (connection);
+
+                __atomic_store_n (&requests->receiving, false, __ATOMIC_RELEASE);
+            }
+
+            else {
+                client_request_wait_timed (request);
+
+                if (request->deadline && (requests_time () >= request->deadline))
+                    client_request_stop (request, CLIENT_REQUEST_TIMEOUT);
+
+                // closed while nobody was receiving, so nothing can end the request
+                else if (!connection->connected)
+                    client_request_stop (request, CLIENT_REQUEST_FAILED);
+            }
+        }
+    }
+
+    return status;
+
+}
+
+// ends a pending request with CLIENT_REQUEST_CANCELLED, its response will be handled as any other packet
+void client_request_cancel (ClientRequest *request) {
+
+    if (request) {
+        if (client_request_get_status (request) == CLIENT_REQUEST_PENDING)
+            client_request_stop (request, CLIENT_REQUEST_CANCELLED);
+    }
+
+}
+
+#pragma endregion
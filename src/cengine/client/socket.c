@@ -1,7 +1,24 @@
+// needed by sendmmsg ()
+#define _GNU_SOURCE
+
 #include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
 
 #include <pthread.h>
 
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <sys/sendfile.h>
+
+#include <unistd.h>
+
+#include "cengine/types/types.h"
+
 #include "cengine/client/socket.h"
 
 static Socket *socket_new (void) {
@@ -15,6 +32,28 @@ static Socket *socket_new (void) {
 
         socket->read_mutex = NULL;
         socket->write_mutex = NULL;
+
+        socket->reactor_fd = -1;
+        socket->reactor_entry = NULL;
+        socket->reactor_events = 0;
+
+        socket->queue = NULL;
+        socket->queue_size = 0;
+        socket->queue_start = 0;
+        socket->queue_end = 0;
+
+        socket->batch_datagrams = false;
+        socket->batch_max = 0;
+        socket->batch_delay = 0;
+        socket->batch_time = 0;
+
+        socket->batch = NULL;
+        socket->batch_size = 0;
+        socket->batch_used = 0;
+
+        socket->batch_ends = NULL;
+        socket->batch_n_datagrams = 0;
+        socket->batch_max_datagrams = 0;
     }
 
     return socket;
@@ -30,6 +69,9 @@ void socket_delete (void *socket_ptr) {
         pthread_mutex_lock (socket->write_mutex);
 
         if (socket->packet_buffer) free (socket->packet_buffer);
+        if (socket->queue) free (socket->queue);
+        if (socket->batch) free (socket->batch);
+        if (socket->batch_ends) free (socket->batch_ends);
 
         pthread_mutex_unlock (socket->read_mutex);
         pthread_mutex_destroy (socket->read_mutex);
@@ -68,4 +110,485 @@ Socket *socket_create (int fd) {
 
     return socket;
 
-}
\ No newline at end of file
+}
+
+#pragma region send
+
+// returns true if there are bytes waiting to be sent
+bool socket_has_queued (const Socket *socket) {
+
+    return socket->queue_end > socket->queue_start;
+
+}
+
+// 18/10/2026 -- drops the bytes that are queued or batched, they belong to a socket that has been closed
+// the write mutex must be locked by the caller
+void socket_reset (Socket *socket) {
+
+    if (socket) {
+        socket->queue_start = 0;
+        socket->queue_end = 0;
+
+        socket->batch_time = 0;
+        socket->batch_used = 0;
+        socket->batch_n_datagrams = 0;
+    }
+
+}
+
+// asks the reactor to tell us when the socket is writable again, or stop doing it
+static void socket_watch_writes (Socket *socket, bool watch) {
+
+    struct epoll_event event = { 0 };
+    event.events = socket->reactor_events | (watch ? EPOLLOUT : 0);
+    event.data.ptr = socket->reactor_entry;
+
+    (void) epoll_ctl (socket->reactor_fd, EPOLL_CTL_MOD, socket->sock_fd, &event);
+
+}
+
+// makes space for data_size more bytes at the end of the queue
+// returns where they go, NULL on error
+static char *socket_queue_reserve (Socket *socket, size_t data_size) {
+
+    // move the queued bytes to the start before growing
+    if (socket->queue_start) {
+        memmove (socket->queue, socket->queue + socket->queue_start, socket->queue_end - socket->queue_start);
+        socket->queue_end -= socket->queue_start;
+        socket->queue_start = 0;
+    }
+
+    size_t needed = socket->queue_end + data_size;
+    if (needed > socket->queue_size) {
+        size_t new_size = socket->queue_size ? socket->queue_size : SOCKET_QUEUE_INIT_SIZE;
+        while (new_size < needed) new_size *= 2;
+
+        char *queue = (char *) realloc (socket->queue, new_size);
+        if (queue) {
+            socket->queue = queue;
+            socket->queue_size = new_size;
+        }
+    }
+
+    return (needed <= socket->queue_size) ? socket->queue + socket->queue_end : NULL;
+
+}
+
+// copies the data at the end of the queue
+// returns 0 on success, 1 on error
+static u8 socket_queue_push (Socket *socket, const char *data, size_t data_size) {
+
+    u8 retval = 1;
+
+    char *end = socket_queue_reserve (socket, data_size);
+    if (end) {
+        memcpy (end, data, data_size);
+        socket->queue_end += data_size;
+
+        retval = 0;
+    }
+
+    return retval;
+
+}
+
+// reads the bytes of the file at the end of the queue
+// returns 0 on success, 1 on error
+static u8 socket_queue_push_file (Socket *socket, int file_fd, off_t offset, size_t size) {
+
+    u8 retval = 1;
+
+    char *end = socket_queue_reserve (socket, size);
+    if (end) {
+        size_t done = 0;
+        while (done < size) {
+            ssize_t rc = pread (file_fd, end + done, size - done, offset + (off_t) done);
+            if (rc > 0) done += (size_t) rc;
+            else if ((rc < 0) && (errno == EINTR)) continue;
+            else break;
+        }
+
+        if (done == size) {
+            socket->queue_end += size;
+            retval = 0;
+        }
+    }
+
+    return retval;
+
+}
+
+// sends the queued bytes until send () would block, the write mutex must be locked by the caller
+// returns 0 on success, 1 on error
+u8 socket_flush (Socket *socket) {
+
+    u8 retval = 0;
+
+    while (socket_has_queued (socket)) {
+        ssize_t sent = send (socket->sock_fd, 
+            socket->queue + socket->queue_start, socket->queue_end - socket->queue_start, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) retval = 1;
+            break;
+        }
+
+        socket->queue_start += (size_t) sent;
+    }
+
+    if (!socket_has_queued (socket)) {
+        socket->queue_start = 0;
+        socket->queue_end = 0;
+
+        if (socket->reactor_fd >= 0) socket_watch_writes (socket, false);
+    }
+
+    return retval;
+
+}
+
+// sends all of the data, the write mutex must be locked by the caller
+// if the socket is owned by a reactor, what can not be sent right away is queued
+// returns 0 on success, 1 on error
+u8 socket_send (Socket *socket, const void *data, size_t data_size, int flags, size_t *actual_sent) {
+
+    struct iovec iov = { (void *) data, data_size };
+
+    return socket_sendv (socket, &iov, 1, flags, actual_sent);
+
+}
+
+// queues the pieces from the first one that has not been sent, skipping its sent bytes
+// returns 0 on success, 1 on error
+static u8 socket_queue_push_iov (Socket *socket, const struct iovec *iov, u32 n_iov, size_t offset) {
+
+    u8 retval = 0;
+
+    for (u32 i = 0; i < n_iov && !retval; i++) {
+        retval = socket_queue_push (socket, (const char *) iov[i].iov_base + offset, iov[i].iov_len - offset);
+        offset = 0;
+    }
+
+    return retval;
+
+}
+
+// works like socket_send () but sends every piece with a single sendmsg () (like writev ())
+// returns 0 on success, 1 on error
+u8 socket_sendv (Socket *socket, const struct iovec *iov, u32 n_iov, int flags, size_t *actual_sent) {
+
+    u8 retval = 0;
+
+    size_t total = 0;
+    for (u32 i = 0; i < n_iov; i++) total += iov[i].iov_len;
+
+    // keep the order of the bytes that are already waiting
+    if (socket_has_queued (socket)) {
+        retval = socket_queue_push_iov (socket, iov, n_iov, 0);
+        if (!retval && actual_sent) *actual_sent += total;
+    }
+
+    else {
+        // the first piece that has not been completely sent, and how much of it has been sent
+        u32 first = 0;
+        size_t offset = 0;
+
+        struct iovec pending[SOCKET_BATCH_MAX_IOV];
+        struct msghdr msg = { 0 };
+
+        while (first < n_iov) {
+            u32 n_pending = 0;
+            for (u32 i = first; (i < n_iov) && (n_pending < SOCKET_BATCH_MAX_IOV); i++) {
+                pending[n_pending].iov_base = (char *) iov[i].iov_base + (i == first ? offset : 0);
+                pending[n_pending].iov_len = iov[i].iov_len - (i == first ? offset : 0);
+                n_pending++;
+            }
+
+            msg.msg_iov = pending;
+            msg.msg_iovlen = n_pending;
+
+            ssize_t sent = sendmsg (socket->sock_fd, &msg, flags | MSG_NOSIGNAL);
+            if (sent < 0) {
+                if ((socket->reactor_fd >= 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+                    retval = socket_queue_push_iov (socket, iov + first, n_iov - first, offset);
+                    if (!retval) {
+                        size_t queued = 0;
+                        for (u32 i = first; i < n_iov; i++) queued += iov[i].iov_len;
+                        queued -= offset;
+
+                        if (actual_sent) *actual_sent += queued;
+                        socket_watch_writes (socket, true);
+                    }
+                }
+
+                else retval = 1;
+
+                break;
+            }
+
+            if (actual_sent) *actual_sent += (size_t) sent;
+
+            // skip the pieces that were completely sent
+            size_t remaining = (size_t) sent;
+            while ((first < n_iov) && (remaining >= iov[first].iov_len - offset)) {
+                remaining -= iov[first].iov_len - offset;
+                offset = 0;
+                first++;
+            }
+
+            offset += remaining;
+        }
+    }
+
+    return retval;
+
+}
+
+// 18/10/2026 -- sends size bytes of the file from offset with sendfile (), so they are not copied to user space
+// the write mutex must be locked by the caller, and the packets in the batch must have been sent before
+// if the socket is owned by a reactor, what can not be sent right away is read from the file & queued
+// returns 0 on success, 1 on error
+u8 socket_sendfile (Socket *socket, int file_fd, off_t offset, size_t size, size_t *actual_sent) {
+
+    u8 retval = 0;
+
+    // keep the order of the bytes that are already waiting
+    if (socket_has_queued (socket)) {
+        retval = socket_queue_push_file (socket, file_fd, offset, size);
+        if (!retval && actual_sent) *actual_sent += size;
+    }
+
+    else {
+        while (size && !retval) {
+            ssize_t sent = sendfile (socket->sock_fd, file_fd, &offset, size);
+            if (sent > 0) {
+                size -= (size_t) sent;
+                if (actual_sent) *actual_sent += (size_t) sent;
+            }
+
+            else if ((sent < 0) && (errno == EINTR)) continue;
+
+            else if ((sent < 0) && (socket->reactor_fd >= 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) {
+                retval = socket_queue_push_file (socket, file_fd, offset, size);
+                if (!retval) {
+                    if (actual_sent) *actual_sent += size;
+                    socket_watch_writes (socket, true);
+                }
+
+                break;
+            }
+
+            // the file is shorter than expected
+            else retval = 1;
+        }
+    }
+
+    return retval;
+
+}
+
+#pragma endregion
+
+#pragma region batch
+
+// returns the CLOCK_MONOTONIC time in micro secs
+static inline u64 socket_time (void) {
+
+    struct timespec now = { 0 };
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return (u64) now.tv_sec * 1000000 + (u64) now.tv_nsec / 1000;
+
+}
+
+// enables batching with the max bytes & max delay (micro secs) of a batch, max_bytes = 0 disables it
+// datagrams keeps every added piece group as its own datagram
+void socket_batch_set (Socket *socket, size_t max_bytes, u64 max_delay, bool datagrams) {
+
+    pthread_mutex_lock (socket->write_mutex);
+
+    // the packets that are waiting are sent with the old values
+    (void) socket_batch_flush (socket);
+
+    socket->batch_datagrams = datagrams;
+    socket->batch_max = max_bytes;
+    socket->batch_delay = max_delay;
+
+    pthread_mutex_unlock (socket->write_mutex);
+
+}
+
+// returns true if batching is enabled
+bool socket_batch_enabled (const Socket *socket) {
+
+    return socket->batch_max > 0;
+
+}
+
+// makes space for size more bytes and one more datagram
+// returns 0 on success, 1 on error
+static u8 socket_batch_grow (Socket *socket, size_t size) {
+
+    u8 retval = 0;
+
+    size_t needed = socket->batch_used + size;
+    if (needed > socket->batch_size) {
+        size_t new_size = socket->batch_size ? socket->batch_size : SOCKET_QUEUE_INIT_SIZE;
+        while (new_size < needed) new_size *= 2;
+
+        char *batch = (char *) realloc (socket->batch, new_size);
+        if (batch) {
+            socket->batch = batch;
+            socket->batch_size = new_size;
+        }
+
+        else retval = 1;
+    }
+
+    if (!retval && socket->batch_datagrams && (socket->batch_n_datagrams >= socket->batch_max_datagrams)) {
+        u32 new_max = socket->batch_max_datagrams ? socket->batch_max_datagrams * 2 : SOCKET_BATCH_MAX_DATAGRAMS;
+
+        size_t *ends = (size_t *) realloc (socket->batch_ends, new_max * sizeof (size_t));
+        if (ends) {
+            socket->batch_ends = ends;
+            socket->batch_max_datagrams = new_max;
+        }
+
+        else retval = 1;
+    }
+
+    return retval;
+
+}
+
+// sends the datagrams of the batch, as many as possible with each sendmmsg ()
+// returns 0 on success, 1 on error
+static u8 socket_batch_flush_datagrams (Socket *socket) {
+
+    u8 retval = 0;
+
+    struct mmsghdr msgs[SOCKET_BATCH_MAX_DATAGRAMS];
+    struct iovec iov[SOCKET_BATCH_MAX_DATAGRAMS];
+
+    u32 first = 0;
+    while (first < socket->batch_n_datagrams) {
+        u32 n = 0;
+        for (u32 i = first; (i < socket->batch_n_datagrams) && (n < SOCKET_BATCH_MAX_DATAGRAMS); i++, n++) {
+            size_t start = i ? socket->batch_ends[i - 1] : 0;
+
+            iov[n].iov_base = socket->batch + start;
+            iov[n].iov_len = socket->batch_ends[i] - start;
+
+            memset (&msgs[n], 0, sizeof (struct mmsghdr));
+            msgs[n].msg_hdr.msg_iov = &iov[n];
+            msgs[n].msg_hdr.msg_iovlen = 1;
+        }
+
+        int sent = sendmmsg (socket->sock_fd, msgs, n, MSG_NOSIGNAL);
+        if (sent > 0) first += (u32) sent;
+
+        // nobody is listening in the other end, the datagram is lost
+        else if ((sent < 0) && (errno == ECONNREFUSED)) first += 1;
+
+        else {
+            retval = 1;
+            break;
+        }
+    }
+
+    return retval;
+
+}
+
+// sends everything in the batch, with sendmsg () or with sendmmsg () for datagrams
+// the write mutex must be locked by the caller
+// returns 0 on success, 1 on error
+u8 socket_batch_flush (Socket *socket) {
+
+    u8 retval = 0;
+
+    if (socket->batch_used) {
+        if (socket->batch_datagrams) {
+            retval = socket_batch_flush_datagrams (socket);
+        }
+
+        else {
+            struct iovec iov = { socket->batch, socket->batch_used };
+            retval = socket_sendv (socket, &iov, 1, 0, NULL);
+        }
+
+        socket->batch_used = 0;
+        socket->batch_n_datagrams = 0;
+    }
+
+    return retval;
+
+}
+
+// sends the batch only if its first packet has waited the max delay
+// the write mutex must be locked by the caller
+// returns 0 on success, 1 on error
+u8 socket_batch_flush_expired (Socket *socket) {
+
+    u8 retval = 0;
+
+    if (socket->batch_used && socket->batch_delay
+        && ((socket_time () - socket->batch_time) >= socket->batch_delay)) {
+        retval = socket_batch_flush (socket);
+    }
+
+    return retval;
+
+}
+
+// copies the pieces at the end of the batch (as a single datagram if the socket uses them),
+// and sends the batch if it is full or has waited too much, the write mutex must be locked by the caller
+// returns 0 on success, 1 on error
+u8 socket_batch_add (Socket *socket, const struct iovec *iov, u32 n_iov, size_t *actual_sent) {
+
+    u8 retval = 1;
+
+    size_t size = 0;
+    for (u32 i = 0; i < n_iov; i++) size += iov[i].iov_len;
+
+    // a stream packet that does not fit goes in the same syscall as the batch, without copying it
+    if (!socket->batch_datagrams && (socket->batch_used + size > socket->batch_max) && (n_iov < SOCKET_BATCH_MAX_IOV)) {
+        struct iovec all[SOCKET_BATCH_MAX_IOV];
+        u32 n_all = 0;
+
+        if (socket->batch_used) {
+            all[n_all].iov_base = socket->batch;
+            all[n_all++].iov_len = socket->batch_used;
+        }
+
+        for (u32 i = 0; i < n_iov; i++) all[n_all++] = iov[i];
+
+        size_t sent = 0;
+        retval = socket_sendv (socket, all, n_all, 0, &sent);
+        if (!retval && actual_sent) *actual_sent += size;
+
+        socket->batch_used = 0;
+    }
+
+    else if (!socket_batch_grow (socket, size)) {
+        if (!socket->batch_used) socket->batch_time = socket_time ();
+
+        for (u32 i = 0; i < n_iov; i++) {
+            memcpy (socket->batch + socket->batch_used, iov[i].iov_base, iov[i].iov_len);
+            socket->batch_used += iov[i].iov_len;
+        }
+
+        if (socket->batch_datagrams)
+            socket->batch_ends[socket->batch_n_datagrams++] = socket->batch_used;
+
+        if (actual_sent) *actual_sent += size;
+
+        retval = 0;
+        if (socket->batch_used >= socket->batch_max) retval = socket_batch_flush (socket);
+        else retval = socket_batch_flush_expired (socket);
+    }
+
+    return retval;
+
+}
+
+#pragma endregion
@@ -0,0 +1,416 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdarg.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/client/client.h"
+#include "cengine/client/connection.h"
+#include "cengine/client/packets.h"
+#include "cengine/client/stats.h"
+
+// the shard that each thread updates, they are given in order as the threads use them
+static u32 stats_next_shard = 0;
+static __thread u32 stats_thread_shard = STATS_SHARDS;
+
+static inline u32 stats_shard (void) {
+
+    if (stats_thread_shard == STATS_SHARDS)
+        stats_thread_shard = __atomic_fetch_add (&stats_next_shard, 1, __ATOMIC_RELAXED) & (STATS_SHARDS - 1);
+
+    return stats_thread_shard;
+
+}
+
+// returns the histogram bucket of the value, the number of bits that it needs
+static inline u32 stats_bucket (u64 value) {
+
+    u32 bucket = value ? 64 - __builtin_clzll (value) : 0;
+
+    return bucket < STATS_HISTOGRAM_BUCKETS ? bucket : STATS_HISTOGRAM_BUCKETS - 1;
+
+}
+
+// histograms keeps the sizes & handler latency of the packets
+// returns new stats with every counter in 0, NULL on error
+Stats *stats_new (bool histograms) {
+
+    Stats *stats = (Stats *) malloc (sizeof (Stats));
+    if (stats) {
+        stats->shards = (StatsShard *) aligned_alloc (STATS_CACHE_LINE, STATS_SHARDS * sizeof (StatsShard));
+        stats->histograms = histograms ?
+            (StatsHistograms *) aligned_alloc (STATS_CACHE_LINE, STATS_SHARDS * sizeof (StatsHistograms)) : NULL;
+
+        if (stats->shards && (!histograms || stats->histograms)) {
+            memset (stats->shards, 0, STATS_SHARDS * sizeof (StatsShard));
+            if (stats->histograms) memset (stats->histograms, 0, STATS_SHARDS * sizeof (StatsHistograms));
+        }
+
+        else {
+            stats_delete (stats);
+            stats = NULL;
+        }
+    }
+
+    return stats;
+
+}
+
+void stats_delete (void *stats_ptr) {
+
+    if (stats_ptr) {
+        Stats *stats = (Stats *) stats_ptr;
+
+        free (stats->shards);
+        free (stats->histograms);
+
+        free (stats);
+    }
+
+}
+
+// returns the type in which the packet type is counted
+StatsPacketType stats_packet_type (PacketType packet_type) {
+
+    StatsPacketType type = STATS_PACKET_UNKNOWN;
+
+    switch (packet_type) {
+        case CERVER_PACKET: type = STATS_PACKET_CERVER; break;
+        case CLIENT_PACKET: type = STATS_PACKET_CLIENT; break;
+        case ERROR_PACKET: type = STATS_PACKET_ERROR; break;
+        case AUTH_PACKET: type = STATS_PACKET_AUTH; break;
+        case REQUEST_PACKET: type = STATS_PACKET_REQUEST; break;
+        case GAME_PACKET: type = STATS_PACKET_GAME; break;
+        case APP_PACKET: type = STATS_PACKET_APP; break;
+        case APP_ERROR_PACKET: type = STATS_PACKET_APP_ERROR; break;
+        case CUSTOM_PACKET: type = STATS_PACKET_CUSTOM; break;
+        case TEST_PACKET: type = STATS_PACKET_TEST; break;
+
+        default: break;
+    }
+
+    return type;
+
+}
+
+// the shard is only shared if there are more threads than shards, so the adds do not contend
+void stats_add (Stats *stats, StatsCounter counter, u64 value) {
+
+    __atomic_fetch_add (&stats->shards[stats_shard ()].counters[counter], value, __ATOMIC_RELAXED);
+
+}
+
+// counts a received packet of the type
+void stats_received (Stats *stats, StatsPacketType type) {
+
+    __atomic_fetch_add (&stats->shards[stats_shard ()].received[type], 1, __ATOMIC_RELAXED);
+
+}
+
+// counts a sent packet of the type
+void stats_sent (Stats *stats, StatsPacketType type) {
+
+    __atomic_fetch_add (&stats->shards[stats_shard ()].sent[type], 1, __ATOMIC_RELAXED);
+
+}
+
+// adds the size & how much time its handler took to the histograms of the type, if the stats keep them
+void stats_handled (Stats *stats, StatsPacketType type, size_t packet_size, u64 handler_ns) {
+
+    if (stats->histograms) {
+        StatsHistograms *histograms = &stats->histograms[stats_shard ()];
+
+        __atomic_fetch_add (&histograms->sizes[type][stats_bucket (packet_size)], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add (&histograms->latency[type][stats_bucket (handler_ns)], 1, __ATOMIC_RELAXED);
+    }
+
+}
+
+#pragma region snapshot
+
+// adds the shards together, the counters that are updated while it is taken may or may not be included
+void stats_snapshot (const Stats *stats, StatsSnapshot *snapshot) {
+
+    memset (snapshot, 0, sizeof (StatsSnapshot));
+
+    if (stats) {
+        for (u32 s = 0; s < STATS_SHARDS; s++) {
+            const StatsShard *shard = &stats->shards[s];
+
+            for (u32 i = 0; i < STATS_COUNTERS; i++)
+                snapshot->counters[i] += __atomic_load_n (&shard->counters[i], __ATOMIC_RELAXED);
+
+            for (u32 i = 0; i < STATS_PACKET_TYPES; i++) {
+                snapshot->received[i] += __atomic_load_n (&shard->received[i], __ATOMIC_RELAXED);
+                snapshot->sent[i] += __atomic_load_n (&shard->sent[i], __ATOMIC_RELAXED);
+            }
+
+            if (stats->histograms) {
+                const StatsHistograms *histograms = &stats->histograms[s];
+
+                for (u32 i = 0; i < STATS_PACKET_TYPES; i++) {
+                    for (u32 b = 0; b < STATS_HISTOGRAM_BUCKETS; b++) {
+                        snapshot->sizes[i][b] += __atomic_load_n (&histograms->sizes[i][b], __ATOMIC_RELAXED);
+                        snapshot->latency[i][b] += __atomic_load_n (&histograms->latency[i][b], __ATOMIC_RELAXED);
+                    }
+                }
+            }
+        }
+
+        snapshot->has_histograms = stats->histograms ? true : false;
+    }
+
+}
+
+// copies the received or sent packets of the snapshot
+void stats_snapshot_packets_per_type (const StatsSnapshot *snapshot, bool sent, PacketsPerType *packets_per_type) {
+
+    if (snapshot && packets_per_type) {
+        const u64 *packets = sent ? snapshot->sent : snapshot->received;
+
+        // there is no field for the client packets
+        packets_per_type->n_cerver_packets = packets[STATS_PACKET_CERVER];
+        packets_per_type->n_error_packets = packets[STATS_PACKET_ERROR];
+        packets_per_type->n_auth_packets = packets[STATS_PACKET_AUTH];
+        packets_per_type->n_request_packets = packets[STATS_PACKET_REQUEST];
+        packets_per_type->n_game_packets = packets[STATS_PACKET_GAME];
+        packets_per_type->n_app_packets = packets[STATS_PACKET_APP];
+        packets_per_type->n_app_error_packets = packets[STATS_PACKET_APP_ERROR];
+        packets_per_type->n_custom_packets = packets[STATS_PACKET_CUSTOM];
+        packets_per_type->n_test_packets = packets[STATS_PACKET_TEST];
+        packets_per_type->n_unknown_packets = packets[STATS_PACKET_UNKNOWN];
+        packets_per_type->n_bad_packets = packets[STATS_PACKET_BAD];
+    }
+
+}
+
+static const char *stats_counter_names[STATS_COUNTERS] = {
+    "receives_done", "bytes_received", "bytes_sent", "packets_received", "packets_sent", "receive_allocs",
+    "udp_acked", "udp_lost", "udp_retransmits",
+    "compressed_sent", "bytes_uncompressed_sent", "bytes_compressed_sent",
+    "compressed_received", "bytes_uncompressed_received", "bytes_compressed_received"
+};
+
+static const char *stats_packet_type_names[STATS_PACKET_TYPES] = {
+    "cerver", "client", "error", "auth", "request", "game", "app", "app_error", "custom", "test", "unknown", "bad"
+};
+
+// a string that grows as the json is written
+typedef struct StatsJson {
+
+    char *buffer;
+    size_t size;
+    size_t used;
+    bool failed;
+
+} StatsJson;
+
+static void stats_json_append (StatsJson *json, const char *format, ...) {
+
+    while (!json->failed) {
+        va_list args;
+        va_start (args, format);
+        int n = vsnprintf (json->buffer + json->used, json->size - json->used, format, args);
+        va_end (args);
+
+        if (n < 0) json->failed = true;
+
+        else if ((size_t) n < json->size - json->used) {
+            json->used += (size_t) n;
+            break;
+        }
+
+        else {
+            size_t new_size = json->size ? json->size * 2 : 4096;
+            while (new_size - json->used <= (size_t) n) new_size *= 2;
+
+            char *buffer = (char *) realloc (json->buffer, new_size);
+            if (buffer) {
+                json->buffer = buffer;
+                json->size = new_size;
+            }
+
+            else json->failed = true;
+        }
+    }
+
+}
+
+// writes the non empty buckets as "bucket": count, where bucket is the upper bound of the values it has
+static void stats_json_histogram (StatsJson *json, const u64 *buckets) {
+
+    stats_json_append (json, "{");
+
+    bool first = true;
+    for (u32 b = 0; b < STATS_HISTOGRAM_BUCKETS; b++) {
+        if (buckets[b]) {
+            if (b < STATS_HISTOGRAM_BUCKETS - 1)
+                stats_json_append (json, "%s\"%lu\":%lu", first ? "" : ",", (unsigned long) (1ul << b), (unsigned long) buckets[b]);
+            else
+                stats_json_append (json, "%s\"inf\":%lu", first ? "" : ",", (unsigned long) buckets[b]);
+
+            first = false;
+        }
+    }
+
+    stats_json_append (json, "}");
+
+}
+
+static void stats_json_snapshot (StatsJson *json, const StatsSnapshot *snapshot) {
+
+    stats_json_append (json, "{");
+
+    for (u32 i = 0; i < STATS_COUNTERS; i++)
+        stats_json_append (json, "\"%s\":%lu,", stats_counter_names[i], (unsigned long) snapshot->counters[i]);
+
+    const char *directions[2] = { "received_packets", "sent_packets" };
+    const u64 *packets[2] = { snapshot->received, snapshot->sent };
+    for (u32 d = 0; d < 2; d++) {
+        stats_json_append (json, "%s\"%s\":{", d ? "," : "", directions[d]);
+        for (u32 i = 0; i < STATS_PACKET_TYPES; i++) {
+            stats_json_append (json, "%s\"%s\":%lu", i ? "," : "",
+                stats_packet_type_names[i], (unsigned long) packets[d][i]);
+        }
+
+        stats_json_append (json, "}");
+    }
+
+    // only the types that have packets
+    if (snapshot->has_histograms) {
+        const char *names[2] = { "packet_sizes", "handler_latency_ns" };
+        for (u32 h = 0; h < 2; h++) {
+            stats_json_append (json, ",\"%s\":{", names[h]);
+
+            bool first = true;
+            for (u32 i = 0; i < STATS_PACKET_TYPES; i++) {
+                const u64 *buckets = h ? snapshot->latency[i] : snapshot->sizes[i];
+
+                bool empty = true;
+                for (u32 b = 0; b < STATS_HISTOGRAM_BUCKETS && empty; b++) empty = !buckets[b];
+
+                if (!empty) {
+                    stats_json_append (json, "%s\"%s\":", first ? "" : ",", stats_packet_type_names[i]);
+                    stats_json_histogram (json, buckets);
+                    first = false;
+                }
+            }
+
+            stats_json_append (json, "}");
+        }
+    }
+
+    stats_json_append (json, "}");
+
+}
+
+// returns a newly allocated json object with the snapshot counters (and histograms) that should be freed
+char *stats_snapshot_json (const StatsSnapshot *snapshot) {
+
+    StatsJson json = { 0 };
+
+    if (snapshot) stats_json_snapshot (&json, snapshot);
+
+    if (json.failed || !json.buffer) {
+        free (json.buffer);
+        json.buffer = NULL;
+    }
+
+    return json.buffer;
+
+}
+
+// takes a snapshot of the stats of the client
+void client_stats_snapshot (Client *client, StatsSnapshot *snapshot) {
+
+    if (snapshot) stats_snapshot ((client && client->stats) ? client->stats->counters : NULL, snapshot);
+
+}
+
+// takes a snapshot of the stats of the connection
+void connection_stats_snapshot (Connection *connection, StatsSnapshot *snapshot) {
+
+    if (snapshot) stats_snapshot ((connection && connection->stats) ? connection->stats->counters : NULL, snapshot);
+
+}
+
+// writes a string value, escaping what json needs
+static void stats_json_string (StatsJson *json, const char *str) {
+
+    stats_json_append (json, "\"");
+
+    for (const char *c = str; c && *c; c++) {
+        if ((*c == '"') || (*c == '\\')) stats_json_append (json, "\\%c", *c);
+        else if ((unsigned char) *c < 0x20) stats_json_append (json, "\\u%04x", (unsigned char) *c);
+        else stats_json_append (json, "%c", *c);
+    }
+
+    stats_json_append (json, "\"");
+
+}
+
+// returns a newly allocated json object with the stats of the client & of each of its connections,
+// for monitoring, it should be freed, NULL on error
+char *client_stats_json (Client *client) {
+
+    StatsJson json = { 0 };
+
+    if (client && client->stats) {
+        StatsSnapshot *snapshot = (StatsSnapshot *) malloc (sizeof (StatsSnapshot));
+        if (snapshot) {
+            stats_json_append (&json, "{\"name\":");
+            stats_json_string (&json, client->name ? client->name->str : NULL);
+
+            client_stats_snapshot (client, snapshot);
+            stats_json_append (&json, ",\"stats\":");
+            stats_json_snapshot (&json, snapshot);
+
+            stats_json_append (&json, ",\"connections\":[");
+            if (client->connections) {
+                bool first = true;
+                for (ListElement *le = dlist_start (client->connections); le; le = le->next) {
+                    Connection *connection = (Connection *) le->data;
+
+                    stats_json_append (&json, "%s{\"name\":", first ? "" : ",");
+                    stats_json_string (&json, connection->name ? connection->name->str : NULL);
+                    stats_json_append (&json, ",\"connected\":%s", connection->connected ? "true" : "false");
+
+                    if (connection->protocol == PROTOCOL_UDP) {
+                        stats_json_append (&json, ",\"rtt_ms\":%.3f,\"packet_loss\":%.3f",
+                            connection->stats->rtt, connection->stats->packet_loss);
+                    }
+
+                    // 18/10/2026 -- measured with the heartbeats
+                    else if (connection->heartbeat_interval) {
+                        stats_json_append (&json, ",\"rtt_ms\":%.3f", connection->stats->rtt);
+                    }
+
+                    connection_stats_snapshot (connection, snapshot);
+                    stats_json_append (&json, ",\"stats\":");
+                    stats_json_snapshot (&json, snapshot);
+                    stats_json_append (&json, "}");
+
+                    first = false;
+                }
+            }
+
+            stats_json_append (&json, "]}");
+
+            free (snapshot);
+        }
+
+        else json.failed = true;
+    }
+
+    if (json.failed || !json.buffer) {
+        free (json.buffer);
+        json.buffer = NULL;
+    }
+
+    return json.buffer;
+
+}
+
+#pragma endregion
@@ -0,0 +1,713 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/files.h"
+
+#include "cengine/client/client.h"
+#include "cengine/client/connection.h"
+#include "cengine/client/errors.h"
+#include "cengine/client/events.h"
+#include "cengine/client/packets.h"
+#include "cengine/client/transfer.h"
+
+#include "cengine/utils/sha-256.h"
+#include "cengine/utils/utils.h"
+#include "cengine/utils/log.h"
+
+#pragma region transfer
+
+static FileTransfer *file_transfer_new (void) {
+
+    FileTransfer *transfer = (FileTransfer *) malloc (sizeof (FileTransfer));
+    if (transfer) {
+        memset (transfer, 0, sizeof (FileTransfer));
+        transfer->fd = -1;
+        transfer->refs = 1;
+    }
+
+    return transfer;
+
+}
+
+static void file_transfer_delete (FileTransfer *transfer) {
+
+    if (transfer) {
+        if (transfer->fd >= 0) close (transfer->fd);
+
+        if (transfer->path) free (transfer->path);
+        if (transfer->chunk) free (transfer->chunk);
+
+        free (transfer);
+    }
+
+}
+
+// drops a reference, the transfer is deleted with the last one
+static void file_transfer_release (FileTransfer *transfer) {
+
+    if (transfer && !__atomic_sub_fetch (&transfer->refs, 1, __ATOMIC_ACQ_REL))
+        file_transfer_delete (transfer);
+
+}
+
+// reads size bytes of the file from offset
+// returns 0 on success, 1 on error
+static u8 file_transfer_read (int fd, char *buffer, size_t size, off_t offset) {
+
+    size_t done = 0;
+    while (done < size) {
+        ssize_t rc = pread (fd, buffer + done, size - done, offset + (off_t) done);
+        if (rc > 0) done += (size_t) rc;
+        else if ((rc < 0) && (errno == EINTR)) continue;
+        else break;
+    }
+
+    return done == size ? 0 : 1;
+
+}
+
+// writes the bytes to the file at offset
+// returns 0 on success, 1 on error
+static u8 file_transfer_write (int fd, const char *buffer, size_t size, off_t offset) {
+
+    size_t done = 0;
+    while (done < size) {
+        ssize_t rc = pwrite (fd, buffer + done, size - done, offset + (off_t) done);
+        if (rc > 0) done += (size_t) rc;
+        else if ((rc < 0) && (errno == EINTR)) continue;
+        else break;
+    }
+
+    return done == size ? 0 : 1;
+
+}
+
+// passes the transfer to the event action, it is only valid inside of it,
+// so the action should not be registered to run in a thread
+static void file_transfer_event (FileTransfer *transfer, ClientEventType event_type) {
+
+    client_event_set_response (transfer->client, event_type, transfer, NULL);
+    client_event_trigger (event_type, transfer->client, transfer->connection);
+    client_event_set_response (transfer->client, event_type, NULL, NULL);
+
+}
+
+// triggers the event of a transfer that has ended & drops the reference of its table,
+// it must have been removed from the table by the caller
+static void file_transfer_end (FileTransfer *transfer) {
+
+    if (transfer->status == FILE_TRANSFER_DONE) {
+        file_transfer_event (transfer, CLIENT_EVENT_FILE_DONE);
+    }
+
+    else {
+        char *status = c_string_create ("Failed to %s file %s!",
+            transfer->type == FILE_TRANSFER_GET ? "get" : "send", transfer->filename);
+        if (status) {
+            cengine_log_msg (stderr, LOG_ERROR, LOG_CLIENT, status);
+            (void) client_error_trigger (CLIENT_ERROR_FILE_TRANSFER, transfer->client, transfer->connection, status);
+            free (status);
+        }
+
+        file_transfer_event (transfer, CLIENT_EVENT_FILE_FAILED);
+    }
+
+    file_transfer_release (transfer);
+
+}
+
+#pragma endregion
+
+#pragma region table
+
+FileTransfers *file_transfers_new (void) {
+
+    FileTransfers *transfers = (FileTransfers *) malloc (sizeof (FileTransfers));
+    if (transfers) {
+        memset (transfers, 0, sizeof (FileTransfers));
+
+        transfers->next_id = 1;
+
+        transfers->chunk_size = FILE_TRANSFER_CHUNK_SIZE;
+        transfers->window = FILE_TRANSFER_WINDOW;
+        transfers->flags = 0;
+
+        transfers->mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+        if (transfers->mutex) pthread_mutex_init (transfers->mutex, NULL);
+
+        else {
+            free (transfers);
+            transfers = NULL;
+        }
+    }
+
+    return transfers;
+
+}
+
+// takes every transfer out of the table
+// returns a list of the transfers, linked with their next field
+static FileTransfer *file_transfers_take_all (FileTransfers *transfers) {
+
+    pthread_mutex_lock (transfers->mutex);
+
+    FileTransfer *list = transfers->transfers;
+    transfers->transfers = NULL;
+
+    pthread_mutex_unlock (transfers->mutex);
+
+    return list;
+
+}
+
+// the transfers that have not ended are closed without triggering any event
+void file_transfers_delete (void *transfers_ptr) {
+
+    if (transfers_ptr) {
+        FileTransfers *transfers = (FileTransfers *) transfers_ptr;
+
+        FileTransfer *list = file_transfers_take_all (transfers);
+        while (list) {
+            FileTransfer *next = list->next;
+            file_transfer_release (list);
+            list = next;
+        }
+
+        pthread_mutex_destroy (transfers->mutex);
+        free (transfers->mutex);
+
+        free (transfers);
+    }
+
+}
+
+// sets the chunk size & how many chunks can be sent before the cerver acks them in the transfers of the connection,
+// checksums adds the sha-256 of every chunk so the bad ones are sent again, it is only used in new transfers
+// chunk_size = 0 uses FILE_TRANSFER_CHUNK_SIZE, window = 0 uses FILE_TRANSFER_WINDOW
+void connection_set_file_transfers (Connection *connection, u32 chunk_size, u32 window, bool checksums) {
+
+    if (connection && connection->transfers) {
+        FileTransfers *transfers = connection->transfers;
+
+        pthread_mutex_lock (transfers->mutex);
+
+        transfers->chunk_size = chunk_size ? chunk_size : FILE_TRANSFER_CHUNK_SIZE;
+        if (transfers->chunk_size > FILE_TRANSFER_MAX_CHUNK_SIZE) transfers->chunk_size = FILE_TRANSFER_MAX_CHUNK_SIZE;
+
+        transfers->window = window ? window : FILE_TRANSFER_WINDOW;
+        transfers->flags = checksums ? FILE_TRANSFER_FLAG_CHECKSUMS : 0;
+
+        pthread_mutex_unlock (transfers->mutex);
+    }
+
+}
+
+// gives the transfer a new id, the table values & adds it to the table
+static void file_transfers_add (FileTransfers *transfers, FileTransfer *transfer) {
+
+    pthread_mutex_lock (transfers->mutex);
+
+    if (!transfers->next_id) transfers->next_id = 1;
+    transfer->transfer_id = transfers->next_id++;
+
+    transfer->chunk_size = transfers->chunk_size;
+    transfer->window = transfers->window;
+    transfer->flags = transfers->flags;
+
+    transfer->next = transfers->transfers;
+    transfers->transfers = transfer;
+
+    pthread_mutex_unlock (transfers->mutex);
+
+}
+
+// returns the transfer with the id, the table mutex must be locked by the caller
+static FileTransfer *file_transfers_get (FileTransfers *transfers, u32 transfer_id) {
+
+    FileTransfer *transfer = transfers->transfers;
+    while (transfer && (transfer->transfer_id != transfer_id)) transfer = transfer->next;
+
+    return transfer;
+
+}
+
+// removes the transfer from the table, the table mutex must be locked by the caller
+// returns true if it was there, so the caller now owns the reference of the table
+static bool file_transfers_remove (FileTransfers *transfers, FileTransfer *transfer) {
+
+    FileTransfer **link = &transfers->transfers;
+    while (*link) {
+        if (*link == transfer) {
+            *link = transfer->next;
+            transfer->next = NULL;
+            return true;
+        }
+
+        link = &(*link)->next;
+    }
+
+    return false;
+
+}
+
+// ends every transfer of the connection with FILE_TRANSFER_FAILED
+void connection_file_transfers_fail (Connection *connection) {
+
+    if (connection && connection->transfers) {
+        FileTransfer *list = file_transfers_take_all (connection->transfers);
+        while (list) {
+            FileTransfer *next = list->next;
+            list->next = NULL;
+
+            list->status = FILE_TRANSFER_FAILED;
+            file_transfer_end (list);
+
+            list = next;
+        }
+    }
+
+}
+
+#pragma endregion
+
+#pragma region send
+
+// sends a CLIENT_PACKET with the request type & the data
+// returns 0 on success, 1 on error
+static u8 file_transfer_send_packet (FileTransfer *transfer, u32 request_type, const void *data, size_t data_size) {
+
+    u8 retval = 1;
+
+    Packet *packet = packet_generate_request (CLIENT_PACKET, request_type, (void *) data, data_size);
+    if (packet) {
+        packet_set_network_values (packet, transfer->client, transfer->connection);
+        retval = packet_send (packet, 0, NULL, false);
+        packet_delete (packet);
+    }
+
+    return retval;
+
+}
+
+// returns 0 on success, 1 on error
+static u8 file_transfer_send_ack (FileTransfer *transfer, FileAckStatus status, u64 offset) {
+
+    SFileAck sack = { 0 };
+    sack.transfer_id = transfer->transfer_id;
+    sack.status = status;
+    sack.offset = offset;
+
+    return file_transfer_send_packet (transfer, CLIENT_FILE_ACK, &sack, sizeof (SFileAck));
+
+}
+
+// sends the next chunks until the window is full, the bytes of the file go from the file to the socket
+// the table mutex is only locked to take each chunk, so the acks of other transfers are not blocked by the sends,
+// and the caller must have set sending, so only one thread sends the chunks of the transfer
+// returns 0 on success, 1 on error
+static u8 file_transfer_send_chunks (FileTransfers *transfers, FileTransfer *transfer) {
+
+    u8 retval = 0;
+
+    pthread_mutex_lock (transfers->mutex);
+
+    u64 window_size = (u64) transfer->window * transfer->chunk_size;
+    while (!retval && (transfer->status == FILE_TRANSFER_ACTIVE)
+        && (transfer->sent_offset < transfer->file_size)
+        && ((transfer->sent_offset - transfer->offset) < window_size)) {
+        u64 remaining = transfer->file_size - transfer->sent_offset;
+        size_t size = remaining < transfer->chunk_size ? (size_t) remaining : transfer->chunk_size;
+
+        SFileChunk schunk = { 0 };
+        schunk.transfer_id = transfer->transfer_id;
+        schunk.size = (u32) size;
+        schunk.offset = transfer->sent_offset;
+
+        // a resend ack can move it back while this one is being sent
+        transfer->sent_offset += size;
+
+        pthread_mutex_unlock (transfers->mutex);
+
+        // the chunk is read to compute the checksum, so sendfile () finds it in the page cache
+        if (transfer->flags & FILE_TRANSFER_FLAG_CHECKSUMS) {
+            retval = file_transfer_read (transfer->fd, transfer->chunk, size, (off_t) schunk.offset);
+            if (!retval) sha_256_calc (schunk.checksum, transfer->chunk, size);
+        }
+
+        if (!retval) {
+            retval = 1;
+
+            Packet *packet = packet_generate_request (CLIENT_PACKET, CLIENT_FILE_CHUNK, &schunk, sizeof (SFileChunk));
+            if (packet) {
+                packet_set_network_values (packet, transfer->client, transfer->connection);
+                retval = packet_send_file (packet, transfer->fd, (off_t) schunk.offset, size, NULL);
+                packet_delete (packet);
+            }
+        }
+
+        pthread_mutex_lock (transfers->mutex);
+    }
+
+    transfer->sending = false;
+
+    pthread_mutex_unlock (transfers->mutex);
+
+    return retval;
+
+}
+
+// sends the CLIENT_FILE_GET or CLIENT_FILE_SEND packet of the transfer, that is already in the table
+// returns 0 on success, 1 on error
+static u8 file_transfer_start (FileTransfers *transfers, FileTransfer *transfer, u32 request_type) {
+
+    SFileHeader sheader = { 0 };
+    sheader.transfer_id = transfer->transfer_id;
+    sheader.flags = transfer->flags;
+    sheader.chunk_size = transfer->chunk_size;
+    sheader.window = transfer->window;
+    sheader.file_size = transfer->file_size;
+    sheader.offset = transfer->offset;
+    strncpy (sheader.filename, transfer->filename, FILE_TRANSFER_NAME_LENGTH - 1);
+
+    u8 retval = 1;
+    if (!(transfer->flags & FILE_TRANSFER_FLAG_CHECKSUMS) || (transfer->type == FILE_TRANSFER_GET) || transfer->chunk)
+        retval = file_transfer_send_packet (transfer, request_type, &sheader, sizeof (SFileHeader));
+
+    if (retval) {
+        pthread_mutex_lock (transfers->mutex);
+        bool removed = file_transfers_remove (transfers, transfer);
+        pthread_mutex_unlock (transfers->mutex);
+
+        // if the connection has already failed its transfers, it has ended this one
+        if (removed) file_transfer_release (transfer);
+    }
+
+    return retval;
+
+}
+
+// requests the file from the cerver, it is saved in path, and if path already has some of its bytes,
+// the transfer is resumed from there
+// returns 0 on success sending the request, 1 on error
+u8 file_transfer_get (Client *client, Connection *connection, const char *filename, const char *path) {
+
+    u8 retval = 1;
+
+    if (client && connection && connection->transfers && filename && path
+        && (strlen (filename) < FILE_TRANSFER_NAME_LENGTH)) {
+        FileTransfer *transfer = file_transfer_new ();
+        if (transfer) {
+            transfer->type = FILE_TRANSFER_GET;
+            transfer->status = FILE_TRANSFER_WAITING;
+            strncpy (transfer->filename, filename, FILE_TRANSFER_NAME_LENGTH - 1);
+            transfer->path = strdup (path);
+            transfer->client = client;
+            transfer->connection = connection;
+
+            struct stat filestatus;
+            transfer->fd = open (path, O_WRONLY | O_CREAT, 0644);
+            if ((transfer->fd >= 0) && !fstat (transfer->fd, &filestatus)) {
+                // what we already have of the file
+                transfer->start_offset = transfer->offset = (u64) filestatus.st_size;
+
+                file_transfers_add (connection->transfers, transfer);
+                retval = file_transfer_start (connection->transfers, transfer, CLIENT_FILE_GET);
+            }
+
+            else {
+                char *status = c_string_create ("Failed to open %s to get file %s!", path, filename);
+                if (status) {
+                    cengine_log_msg (stderr, LOG_ERROR, LOG_CLIENT, status);
+                    free (status);
+                }
+
+                file_transfer_delete (transfer);
+            }
+        }
+    }
+
+    return retval;
+
+}
+
+// sends the file in path to the cerver with filename, if the cerver already has some of its bytes,
+// it answers with where the transfer should be resumed from
+// returns 0 on success sending the request, 1 on error
+u8 file_transfer_send (Client *client, Connection *connection, const char *filename, const char *path) {
+
+    u8 retval = 1;
+
+    if (client && connection && connection->transfers && filename && path
+        && (strlen (filename) < FILE_TRANSFER_NAME_LENGTH)) {
+        FileTransfer *transfer = file_transfer_new ();
+        if (transfer) {
+            transfer->type = FILE_TRANSFER_SEND;
+            transfer->status = FILE_TRANSFER_WAITING;
+            strncpy (transfer->filename, filename, FILE_TRANSFER_NAME_LENGTH - 1);
+            transfer->path = strdup (path);
+            transfer->client = client;
+            transfer->connection = connection;
+
+            struct stat filestatus;
+            transfer->fd = file_open_as_fd (path, &filestatus);
+            if (transfer->fd >= 0) {
+                transfer->file_size = (u64) filestatus.st_size;
+
+                file_transfers_add (connection->transfers, transfer);
+
+                // the chunks are read here to compute their checksums
+                if (transfer->flags & FILE_TRANSFER_FLAG_CHECKSUMS)
+                    transfer->chunk = (char *) malloc (transfer->chunk_size);
+
+                retval = file_transfer_start (connection->transfers, transfer, CLIENT_FILE_SEND);
+            }
+
+            else {
+                char *status = c_string_create ("Failed to open file %s to send it!", path);
+                if (status) {
+                    cengine_log_msg (stderr, LOG_ERROR, LOG_CLIENT, status);
+                    free (status);
+                }
+
+                file_transfer_delete (transfer);
+            }
+        }
+    }
+
+    return retval;
+
+}
+
+#pragma endregion
+
+#pragma region handler
+
+// the cerver has accepted to send us the file
+// returns the transfer with a reference for the caller if it has ended
+static FileTransfer *file_transfer_handle_header (FileTransfers *transfers, const Packet *packet) {
+
+    FileTransfer *ended = NULL;
+
+    SFileHeader sheader;
+    memcpy (&sheader, packet->data, sizeof (SFileHeader));
+
+    pthread_mutex_lock (transfers->mutex);
+
+    FileTransfer *transfer = file_transfers_get (transfers, sheader.transfer_id);
+    if (transfer && (transfer->type == FILE_TRANSFER_GET) && (transfer->status == FILE_TRANSFER_WAITING)) {
+        // the cerver may not resume from where we asked, or may use smaller chunks
+        if ((sheader.offset <= transfer->offset) && (sheader.offset <= sheader.file_size)
+            && !ftruncate (transfer->fd, (off_t) sheader.offset)) {
+            transfer->status = FILE_TRANSFER_ACTIVE;
+            transfer->file_size = sheader.file_size;
+            transfer->start_offset = transfer->offset = sheader.offset;
+            if (sheader.chunk_size && (sheader.chunk_size < transfer->chunk_size))
+                transfer->chunk_size = sheader.chunk_size;
+
+            if (transfer->offset == transfer->file_size) transfer->status = FILE_TRANSFER_DONE;
+        }
+
+        else {
+            (void) file_transfer_send_ack (transfer, FILE_ACK_FAILED, transfer->offset);
+            transfer->status = FILE_TRANSFER_FAILED;
+        }
+
+        if (transfer->status != FILE_TRANSFER_ACTIVE) {
+            file_transfers_remove (transfers, transfer);
+            __atomic_add_fetch (&transfer->refs, 1, __ATOMIC_RELAXED);
+            ended = transfer;
+        }
+    }
+
+    pthread_mutex_unlock (transfers->mutex);
+
+    return ended;
+
+}
+
+// writes a chunk of a file that we are getting & acks it,
+// a chunk that is not the next one is dropped, it was sent before the cerver got our resend ack
+// returns the transfer with a reference for the caller, ended is set if it was removed from the table
+static FileTransfer *file_transfer_handle_chunk (FileTransfers *transfers, const Packet *packet,
+    ClientEventType *event_type, bool *ended) {
+
+    FileTransfer *transfer = NULL;
+
+    SFileChunk schunk;
+    memcpy (&schunk, packet->data, sizeof (SFileChunk));
+    const char *bytes = (const char *) packet->data + sizeof (SFileChunk);
+
+    if (schunk.size == (packet->data_size - sizeof (SFileChunk))) {
+        pthread_mutex_lock (transfers->mutex);
+
+        transfer = file_transfers_get (transfers, schunk.transfer_id);
+        if (transfer && (transfer->type == FILE_TRANSFER_GET) && (transfer->status == FILE_TRANSFER_ACTIVE)
+            && (schunk.offset == transfer->offset) && (schunk.size <= (transfer->file_size - transfer->offset))) {
+            bool good = true;
+            if (transfer->flags & FILE_TRANSFER_FLAG_CHECKSUMS) {
+                u8 checksum[32];
+                sha_256_calc (checksum, bytes, schunk.size);
+                good = !memcmp (checksum, schunk.checksum, sizeof (checksum));
+            }
+
+            if (good) {
+                if (!file_transfer_write (transfer->fd, bytes, schunk.size, (off_t) schunk.offset)) {
+                    transfer->offset += schunk.size;
+                    transfer->resending = false;
+
+                    if (transfer->offset == transfer->file_size) transfer->status = FILE_TRANSFER_DONE;
+                    *event_type = CLIENT_EVENT_FILE_PROGRESS;
+                }
+
+                else transfer->status = FILE_TRANSFER_FAILED;
+
+                (void) file_transfer_send_ack (transfer,
+                    transfer->status == FILE_TRANSFER_FAILED ? FILE_ACK_FAILED : FILE_ACK_OK, transfer->offset);
+            }
+
+            // the chunks after it are dropped until it arrives again
+            else if (!transfer->resending) {
+                transfer->resending = true;
+                (void) file_transfer_send_ack (transfer, FILE_ACK_RESEND, transfer->offset);
+            }
+
+            if (transfer->status != FILE_TRANSFER_ACTIVE) *ended = file_transfers_remove (transfers, transfer);
+            __atomic_add_fetch (&transfer->refs, 1, __ATOMIC_RELAXED);
+        }
+
+        else transfer = NULL;
+
+        pthread_mutex_unlock (transfers->mutex);
+    }
+
+    return transfer;
+
+}
+
+// the cerver has accepted the file we are sending, acked some of its chunks, or can not continue
+// returns the transfer with a reference for the caller, ended is set if it was removed from the table
+// and send if the caller has to send the next chunks
+static FileTransfer *file_transfer_handle_ack (FileTransfers *transfers, const Packet *packet,
+    ClientEventType *event_type, bool *ended, bool *send) {
+
+    SFileAck sack;
+    memcpy (&sack, packet->data, sizeof (SFileAck));
+
+    pthread_mutex_lock (transfers->mutex);
+
+    FileTransfer *transfer = file_transfers_get (transfers, sack.transfer_id);
+    if (transfer && (transfer->status != FILE_TRANSFER_DONE)) {
+        if (sack.status == FILE_ACK_FAILED) transfer->status = FILE_TRANSFER_FAILED;
+
+        else if (transfer->type == FILE_TRANSFER_SEND) {
+            // the offset is where the cerver wants the file from
+            if (transfer->status == FILE_TRANSFER_WAITING) {
+                if (sack.offset <= transfer->file_size) {
+                    transfer->status = FILE_TRANSFER_ACTIVE;
+                    transfer->start_offset = transfer->offset = transfer->sent_offset = sack.offset;
+                }
+
+                else transfer->status = FILE_TRANSFER_FAILED;
+            }
+
+            else if ((sack.offset >= transfer->offset) && (sack.offset <= transfer->sent_offset)) {
+                if (sack.offset > transfer->offset) *event_type = CLIENT_EVENT_FILE_PROGRESS;
+                transfer->offset = sack.offset;
+
+                // go back to the bad chunk
+                if (sack.status == FILE_ACK_RESEND) transfer->sent_offset = sack.offset;
+            }
+
+            if (transfer->status == FILE_TRANSFER_ACTIVE) {
+                if (transfer->offset == transfer->file_size) transfer->status = FILE_TRANSFER_DONE;
+
+                // the chunks are sent by the handler after the table has been unlocked
+                else if (!transfer->sending) {
+                    transfer->sending = true;
+                    *send = true;
+                }
+            }
+        }
+
+        if ((transfer->status == FILE_TRANSFER_DONE) || (transfer->status == FILE_TRANSFER_FAILED))
+            *ended = file_transfers_remove (transfers, transfer);
+
+        __atomic_add_fetch (&transfer->refs, 1, __ATOMIC_RELAXED);
+    }
+
+    else transfer = NULL;
+
+    pthread_mutex_unlock (transfers->mutex);
+
+    return transfer;
+
+}
+
+// handles the CLIENT_FILE_HEADER, CLIENT_FILE_CHUNK & CLIENT_FILE_ACK packets
+// the events are triggered after the table has been unlocked, so their actions can start other transfers
+void file_transfer_packet_handler (Packet *packet) {
+
+    if (packet && packet->header && packet->connection && packet->connection->transfers && packet->data) {
+        FileTransfers *transfers = packet->connection->transfers;
+
+        FileTransfer *transfer = NULL;
+        ClientEventType event_type = CLIENT_EVENT_NONE;
+        bool ended = false;
+        bool send = false;
+
+        switch (packet->header->request_type) {
+            case CLIENT_FILE_HEADER:
+                if (packet->data_size >= sizeof (SFileHeader)) {
+                    transfer = file_transfer_handle_header (transfers, packet);
+                    ended = (transfer != NULL);
+                }
+                break;
+
+            case CLIENT_FILE_CHUNK:
+                if (packet->data_size >= sizeof (SFileChunk))
+                    transfer = file_transfer_handle_chunk (transfers, packet, &event_type, &ended);
+                break;
+
+            case CLIENT_FILE_ACK:
+                if (packet->data_size >= sizeof (SFileAck))
+                    transfer = file_transfer_handle_ack (transfers, packet, &event_type, &ended, &send);
+                break;
+
+            default: break;
+        }
+
+        if (transfer) {
+            // the reference of this handler keeps the transfer alive even if
+            // connection_close () fails the transfers of the connection from another thread
+            if (send && file_transfer_send_chunks (transfers, transfer)) {
+                pthread_mutex_lock (transfers->mutex);
+                if (transfer->status == FILE_TRANSFER_ACTIVE) {
+                    transfer->status = FILE_TRANSFER_FAILED;
+                    ended = file_transfers_remove (transfers, transfer);
+                }
+                pthread_mutex_unlock (transfers->mutex);
+            }
+
+            if (event_type == CLIENT_EVENT_FILE_PROGRESS) file_transfer_event (transfer, CLIENT_EVENT_FILE_PROGRESS);
+
+            // only the one that removed it from the table ends it
+            if (ended) file_transfer_end (transfer);
+
+            file_transfer_release (transfer);
+        }
+    }
+
+}
+
+#pragma endregion
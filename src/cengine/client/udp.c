@@ -0,0 +1,390 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <time.h>
+
+#include <pthread.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/client/network.h"
+#include "cengine/client/client.h"
+#include "cengine/client/connection.h"
+#include "cengine/client/socket.h"
+#include "cengine/client/stats.h"
+#include "cengine/client/udp.h"
+
+#include "cengine/utils/utils.h"
+#include "cengine/utils/log.h"
+
+#pragma region state
+
+UdpState *udp_state_new (void) {
+
+    UdpState *udp = (UdpState *) malloc (sizeof (UdpState));
+    if (udp) {
+        memset (udp, 0, sizeof (UdpState));
+
+        for (u32 i = 0; i < UDP_SEQUENCE_BUFFER_SIZE; i++) {
+            udp->sent[i].sequence = UDP_SEQUENCE_NONE;
+            udp->received[i] = UDP_SEQUENCE_NONE;
+            udp->reliable_received[i] = UDP_SEQUENCE_NONE;
+        }
+    }
+
+    return udp;
+
+}
+
+void udp_state_delete (void *udp_state_ptr) {
+
+    if (udp_state_ptr) free (udp_state_ptr);
+
+}
+
+#pragma endregion
+
+#pragma region sequences
+
+// returns the CLOCK_MONOTONIC time in micro secs
+static inline u64 udp_time (void) {
+
+    struct timespec now = { 0 };
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    return (u64) now.tv_sec * 1000000 + (u64) now.tv_nsec / 1000;
+
+}
+
+// returns true if a is newer than b, taking into account that sequences wrap around
+static inline bool udp_sequence_greater (u16 a, u16 b) {
+
+    return ((a > b) && (a - b <= 32768)) || ((a < b) && (b - a > 32768));
+
+}
+
+static void udp_header_set_acks (UdpState *udp, UdpHeader *header) {
+
+    header->ack = 0;
+    header->ack_bits = 0;
+
+    if (udp->has_remote) {
+        header->flags |= UDP_FLAG_HAS_ACK;
+        header->ack = udp->remote_sequence;
+
+        for (u16 i = 0; i < UDP_ACK_BITS; i++) {
+            u16 sequence = (u16) (udp->remote_sequence - 1 - i);
+            if (udp->received[sequence % UDP_SEQUENCE_BUFFER_SIZE] == sequence)
+                header->ack_bits |= (1u << i);
+        }
+
+        udp->ack_pending = false;
+    }
+
+}
+
+static void udp_stats_resolve (ConnectionStats *stats, bool lost) {
+
+    stats_add (stats->counters, lost ? STATS_UDP_LOST : STATS_UDP_ACKED, 1);
+
+    stats->packet_loss += UDP_LOSS_SMOOTHING * ((lost ? 100.0f : 0.0f) - stats->packet_loss);
+
+}
+
+// takes the slot of the next sequence, and checks if the datagram that can no longer be acked got lost
+static u16 udp_sequence_next (UdpState *udp, ConnectionStats *stats, u64 now,
+    bool reliable, u16 reliable_id) {
+
+    u16 sequence = udp->local_sequence++;
+
+    UdpSentPacket *old = &udp->sent[(u16) (sequence - UDP_ACK_BITS - 1) % UDP_SEQUENCE_BUFFER_SIZE];
+    if ((old->sequence == (u16) (sequence - UDP_ACK_BITS - 1)) && !old->resolved) {
+        old->resolved = true;
+        udp_stats_resolve (stats, true);
+    }
+
+    UdpSentPacket *sent = &udp->sent[sequence % UDP_SEQUENCE_BUFFER_SIZE];
+    sent->sequence = sequence;
+    sent->sent_time = now;
+    sent->resolved = false;
+    sent->reliable = reliable;
+    sent->reliable_id = reliable_id;
+
+    return sequence;
+
+}
+
+static void udp_sequence_acked (UdpState *udp, ConnectionStats *stats, u64 now, u16 sequence) {
+
+    UdpSentPacket *sent = &udp->sent[sequence % UDP_SEQUENCE_BUFFER_SIZE];
+    if ((sent->sequence == sequence) && !sent->resolved) {
+        sent->resolved = true;
+        udp_stats_resolve (stats, false);
+
+        float rtt = (float) (now - sent->sent_time) / 1000.0f;
+        if (stats->rtt == 0.0f) stats->rtt = rtt;
+        else stats->rtt += UDP_RTT_SMOOTHING * (rtt - stats->rtt);
+
+        // any send of a reliable packet that gets acked is enough
+        if (sent->reliable) {
+            UdpReliablePacket *reliable = &udp->reliable[sent->reliable_id % UDP_RELIABLE_WINDOW];
+            if (reliable->used && (reliable->reliable_id == sent->reliable_id))
+                reliable->used = false;
+        }
+    }
+
+}
+
+#pragma endregion
+
+#pragma region send
+
+// sends the datagram, or adds it to the connection batch to be sent with sendmmsg ()
+// the write mutex must be locked by the caller
+static u8 udp_send_datagram (Connection *connection, UdpState *udp,
+    const char *datagram, size_t datagram_size, int flags, u64 now) {
+
+    u8 retval = 1;
+
+    if (socket_batch_enabled (connection->socket)) {
+        struct iovec iov = { (void *) datagram, datagram_size };
+        retval = socket_batch_add (connection->socket, &iov, 1, NULL);
+    }
+
+    else {
+        ssize_t sent = send (connection->socket->sock_fd, datagram, datagram_size, flags | MSG_NOSIGNAL);
+        if (sent == (ssize_t) datagram_size) retval = 0;
+
+        // nobody is listening yet in the other end, it is the same as a lost datagram
+        else if ((sent < 0) && (errno == ECONNREFUSED)) retval = 0;
+    }
+
+    if (!retval) udp->last_send_time = now;
+
+    return retval;
+
+}
+
+// sends the pieces as a single datagram after a new udp header
+// reliable datagrams are sent again until the other end acks them
+// returns 0 on success, 1 on error
+u8 udp_send (Connection *connection,
+    const void **pieces, const size_t *sizes, u32 n_pieces,
+    bool reliable, int flags, size_t *total_sent) {
+
+    u8 retval = 1;
+
+    if (connection && connection->udp && pieces && sizes) {
+        size_t datagram_size = sizeof (UdpHeader);
+        for (u32 i = 0; i < n_pieces; i++) datagram_size += sizes[i];
+
+        if (datagram_size <= UDP_MAX_DATAGRAM_SIZE) {
+            pthread_mutex_lock (connection->socket->write_mutex);
+
+            UdpState *udp = connection->udp;
+            UdpReliablePacket *slot = NULL;
+            if (reliable) {
+                slot = &udp->reliable[udp->next_reliable_id % UDP_RELIABLE_WINDOW];
+                if (slot->used) slot = NULL;
+            }
+
+            if (!reliable || slot) {
+                u64 now = udp_time ();
+
+                char datagram[UDP_MAX_DATAGRAM_SIZE];
+                UdpHeader header = { 0 };
+                header.flags = reliable ? UDP_FLAG_RELIABLE : 0;
+                header.reliable_id = reliable ? udp->next_reliable_id++ : 0;
+                header.sequence = udp_sequence_next (udp, connection->stats, now, reliable, header.reliable_id);
+                udp_header_set_acks (udp, &header);
+
+                char *end = datagram;
+                memcpy (end, &header, sizeof (UdpHeader));
+                end += sizeof (UdpHeader);
+                for (u32 i = 0; i < n_pieces; i++) {
+                    memcpy (end, pieces[i], sizes[i]);
+                    end += sizes[i];
+                }
+
+                if (slot) {
+                    slot->used = true;
+                    slot->reliable_id = header.reliable_id;
+                    slot->sent_time = now;
+                    slot->n_sends = 1;
+                    slot->size = datagram_size;
+                    memcpy (slot->datagram, datagram, datagram_size);
+                }
+
+                retval = udp_send_datagram (connection, udp, datagram, datagram_size, flags, now);
+
+                // a reliable packet will be sent again by udp_update ()
+                if (slot) retval = 0;
+
+                if (total_sent) *total_sent = retval ? 0 : datagram_size;
+            }
+
+            else {
+                cengine_log_msg (stderr, LOG_WARNING, LOG_CLIENT,
+                    "udp_send () - Too many reliable packets are waiting for an ack!");
+            }
+
+            pthread_mutex_unlock (connection->socket->write_mutex);
+        }
+
+        else {
+            char *s = c_string_create ("udp_send () - Datagram of %ld bytes is bigger than the max size %d!",
+                datagram_size, UDP_MAX_DATAGRAM_SIZE);
+            if (s) {
+                cengine_log_msg (stderr, LOG_ERROR, LOG_CLIENT, s);
+                free (s);
+            }
+        }
+    }
+
+    return retval;
+
+}
+
+#pragma endregion
+
+#pragma region receive
+
+// handles the udp header of a received datagram and updates the connection stats with its acks
+// returns true if the packet after the header has to be handled,
+// false if it was a duplicate, too old or it only had acks
+bool udp_receive (Connection *connection, const char *datagram, size_t datagram_size) {
+
+    bool retval = false;
+
+    if (connection && connection->udp && datagram && (datagram_size >= sizeof (UdpHeader))) {
+        UdpHeader header;
+        memcpy (&header, datagram, sizeof (UdpHeader));
+
+        pthread_mutex_lock (connection->socket->write_mutex);
+
+        UdpState *udp = connection->udp;
+
+        if (header.flags & UDP_FLAG_HAS_ACK) {
+            u64 now = udp_time ();
+
+            udp_sequence_acked (udp, connection->stats, now, header.ack);
+            for (u16 i = 0; i < UDP_ACK_BITS; i++) {
+                if (header.ack_bits & (1u << i))
+                    udp_sequence_acked (udp, connection->stats, now, (u16) (header.ack - 1 - i));
+            }
+        }
+
+        if (!(header.flags & UDP_FLAG_ACK_ONLY)) {
+            u32 idx = header.sequence % UDP_SEQUENCE_BUFFER_SIZE;
+
+            if (!udp->has_remote) {
+                udp->has_remote = true;
+                udp->remote_sequence = header.sequence;
+                udp->received[idx] = header.sequence;
+                retval = true;
+            }
+
+            else if (udp_sequence_greater (header.sequence, udp->remote_sequence)) {
+                // forget the sequences that were skipped, so their old values are not acked
+                for (u16 s = (u16) (udp->remote_sequence + 1); s != header.sequence; s++)
+                    udp->received[s % UDP_SEQUENCE_BUFFER_SIZE] = UDP_SEQUENCE_NONE;
+
+                udp->remote_sequence = header.sequence;
+                udp->received[idx] = header.sequence;
+                retval = true;
+            }
+
+            // out of order, only if it is still inside the buffer and is not a duplicate
+            else if (((u16) (udp->remote_sequence - header.sequence) < UDP_SEQUENCE_BUFFER_SIZE)
+                && (udp->received[idx] != header.sequence)) {
+                udp->received[idx] = header.sequence;
+                retval = true;
+            }
+
+            if (retval) {
+                udp->ack_pending = true;
+
+                // the ack of a reliable packet got lost and it was sent again
+                if (header.flags & UDP_FLAG_RELIABLE) {
+                    u32 *received = &udp->reliable_received[header.reliable_id % UDP_SEQUENCE_BUFFER_SIZE];
+                    if (*received == header.reliable_id) retval = false;
+                    else *received = header.reliable_id;
+                }
+            }
+        }
+
+        pthread_mutex_unlock (connection->socket->write_mutex);
+    }
+
+    return retval;
+
+}
+
+#pragma endregion
+
+#pragma region update
+
+// sends again the reliable datagrams that have not been acked in time,
+// sends the pending acks if nothing else has been sent to carry them, and the expired send batch
+// it is called by the connection update after every recv ()
+void udp_update (Connection *connection) {
+
+    if (connection && connection->udp) {
+        pthread_mutex_lock (connection->socket->write_mutex);
+
+        UdpState *udp = connection->udp;
+        u64 now = udp_time ();
+
+        u64 resend_time = (u64) (connection->stats->rtt * 2 * 1000);
+        if (resend_time < UDP_RESEND_MIN_TIME * 1000) resend_time = UDP_RESEND_MIN_TIME * 1000;
+
+        for (u32 i = 0; i < UDP_RELIABLE_WINDOW; i++) {
+            UdpReliablePacket *reliable = &udp->reliable[i];
+            if (reliable->used && ((now - reliable->sent_time) >= resend_time)) {
+                if (reliable->n_sends < UDP_RELIABLE_MAX_SENDS) {
+                    // it goes with a new sequence and the latest acks
+                    UdpHeader header;
+                    memcpy (&header, reliable->datagram, sizeof (UdpHeader));
+                    header.flags &= ~UDP_FLAG_HAS_ACK;
+                    header.sequence = udp_sequence_next (udp, connection->stats, now, true, reliable->reliable_id);
+                    udp_header_set_acks (udp, &header);
+                    memcpy (reliable->datagram, &header, sizeof (UdpHeader));
+
+                    (void) udp_send_datagram (connection, udp, reliable->datagram, reliable->size, 0, now);
+
+                    reliable->sent_time = now;
+                    reliable->n_sends += 1;
+
+                    stats_add (connection->stats->counters, STATS_UDP_RETRANSMITS, 1);
+                }
+
+                else {
+                    reliable->used = false;
+
+                    cengine_log_msg (stderr, LOG_WARNING, LOG_CLIENT,
+                        "udp_update () - Dropped a reliable packet that was never acked!");
+                }
+            }
+        }
+
+        if (udp->ack_pending && ((now - udp->last_send_time) >= UDP_ACK_TIMEOUT * 1000)) {
+            UdpHeader header = { 0 };
+            header.flags = UDP_FLAG_ACK_ONLY;
+            udp_header_set_acks (udp, &header);
+
+            (void) udp_send_datagram (connection, udp, (char *) &header, sizeof (UdpHeader), 0, now);
+        }
+
+        (void) socket_batch_flush_expired (connection->socket);
+
+        pthread_mutex_unlock (connection->socket->write_mutex);
+    }
+
+}
+
+#pragma endregion
@@ -0,0 +1,558 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cengine/collections/hashmap.h"
+
+#pragma region hash
+
+#define HASHMAP_SECRET_0				0xa0761d6478bd642fULL
+#define HASHMAP_SECRET_1				0xe7037ed1a0b428dbULL
+#define HASHMAP_SECRET_2				0x8ebc6af09c88c6e3ULL
+#define HASHMAP_SECRET_3				0x589965cc75374cc3ULL
+
+static inline uint64_t hashmap_mum (uint64_t a, uint64_t b) {
+
+	__uint128_t r = (__uint128_t) a * b;
+	return (uint64_t) r ^ (uint64_t) (r >> 64);
+
+}
+
+static inline uint64_t hashmap_read64 (const unsigned char *p) {
+
+	uint64_t v;
+	memcpy (&v, p, sizeof (uint64_t));
+	return v;
+
+}
+
+static inline uint64_t hashmap_read32 (const unsigned char *p) {
+
+	uint32_t v;
+	memcpy (&v, p, sizeof (uint32_t));
+	return v;
+
+}
+
+// hashes the key bytes, based on wyhash
+uint64_t hashmap_hash (const void *key, size_t key_size, uint64_t seed) {
+
+	const unsigned char *p = (const unsigned char *) key;
+	uint64_t a = 0, b = 0;
+
+	seed ^= hashmap_mum (seed ^ HASHMAP_SECRET_0, HASHMAP_SECRET_1);
+
+	if (key_size <= 16) {
+		if (key_size >= 4) {
+			size_t offset = (key_size >> 3) << 2;
+			a = (hashmap_read32 (p) << 32) | hashmap_read32 (p + offset);
+			b = (hashmap_read32 (p + key_size - 4) << 32) | hashmap_read32 (p + key_size - 4 - offset);
+		}
+
+		else if (key_size > 0) {
+			a = ((uint64_t) p[0] << 16) | ((uint64_t) p[key_size >> 1] << 8) | p[key_size - 1];
+		}
+	}
+
+	else {
+		size_t i = key_size;
+		if (i > 48) {
+			uint64_t seed1 = seed, seed2 = seed;
+			do {
+				seed = hashmap_mum (hashmap_read64 (p) ^ HASHMAP_SECRET_1, hashmap_read64 (p + 8) ^ seed);
+				seed1 = hashmap_mum (hashmap_read64 (p + 16) ^ HASHMAP_SECRET_2, hashmap_read64 (p + 24) ^ seed1);
+				seed2 = hashmap_mum (hashmap_read64 (p + 32) ^ HASHMAP_SECRET_3, hashmap_read64 (p + 40) ^ seed2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+
+			seed ^= seed1 ^ seed2;
+		}
+
+		while (i > 16) {
+			seed = hashmap_mum (hashmap_read64 (p) ^ HASHMAP_SECRET_1, hashmap_read64 (p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+
+		a = hashmap_read64 (p + i - 16);
+		b = hashmap_read64 (p + i - 8);
+	}
+
+	a ^= HASHMAP_SECRET_1;
+	b ^= seed;
+
+	__uint128_t r = (__uint128_t) a * b;
+	a = (uint64_t) r;
+	b = (uint64_t) (r >> 64);
+
+	return hashmap_mum (a ^ HASHMAP_SECRET_0 ^ key_size, b ^ HASHMAP_SECRET_1);
+
+}
+
+// spreads the bits of a custom hash that may only be good in its low bits
+static inline uint64_t hashmap_mix (uint64_t h) {
+
+	return hashmap_mum (h ^ HASHMAP_SECRET_0, HASHMAP_SECRET_1);
+
+}
+
+#pragma endregion
+
+#pragma region internal
+
+static inline uint64_t hashmap_key_hash (const HashMap *map, const void *key, size_t key_size) {
+
+	return map->hash ?
+		hashmap_mix (map->hash (key, key_size, SIZE_MAX)) :
+		hashmap_hash (key, key_size, map->seed);
+
+}
+
+static inline bool hashmap_key_is_inline (const HashMap *map, size_t key_size) {
+
+	return !map->key_create && key_size <= HASHMAP_INLINE_KEY_SIZE;
+
+}
+
+static inline const void *hashmap_entry_key (const HashMap *map, const HashMapEntry *entry) {
+
+	return hashmap_key_is_inline (map, entry->key_size) ? entry->key.bytes : entry->key.ptr;
+
+}
+
+static inline bool hashmap_entry_matches (const HashMap *map, const HashMapEntry *entry,
+	uint64_t hash, const void *key, size_t key_size) {
+
+	if (entry->hash != hash || !entry->key_size) return false;
+
+	if (map->key_compare) return !map->key_compare (key, hashmap_entry_key (map, entry));
+
+	return entry->key_size == key_size
+		&& !memcmp (hashmap_entry_key (map, entry), key, key_size);
+
+}
+
+static void hashmap_entry_key_delete (const HashMap *map, HashMapEntry *entry) {
+
+	if (!hashmap_key_is_inline (map, entry->key_size) && entry->key.ptr) {
+		if (map->key_delete) map->key_delete (entry->key.ptr);
+		else free (entry->key.ptr);
+	}
+
+}
+
+// returns 0 on success, 1 on error
+static int hashmap_table_init (HashMapTable *table, size_t capacity) {
+
+	table->entries = (HashMapEntry *) calloc (capacity, sizeof (HashMapEntry));
+	if (table->entries) {
+		table->capacity = capacity;
+		table->mask = capacity - 1;
+		table->count = 0;
+
+		return 0;
+	}
+
+	return 1;
+
+}
+
+static void hashmap_table_end (const HashMap *map, HashMapTable *table, bool delete_values) {
+
+	if (table->entries) {
+		for (size_t i = 0; i < table->capacity; i++) {
+			HashMapEntry *entry = &table->entries[i];
+			if (entry->dist && entry->key_size) {
+				hashmap_entry_key_delete (map, entry);
+				if (delete_values && map->delete_value && entry->value)
+					map->delete_value (entry->value);
+			}
+		}
+
+		free (table->entries);
+	}
+
+	memset (table, 0, sizeof (HashMapTable));
+
+}
+
+// robin hood search, we can stop as soon as we find an entry that is closer
+// to its ideal slot than we are to ours, because ours would have taken that slot
+static HashMapEntry *hashmap_table_find (const HashMap *map, const HashMapTable *table,
+	uint64_t hash, const void *key, size_t key_size) {
+
+	if (!table->capacity) return NULL;
+
+	size_t idx = hash & table->mask;
+	uint32_t dist = 1;
+	for (;;) {
+		HashMapEntry *entry = &table->entries[idx];
+		if (!entry->dist || entry->dist < dist) return NULL;
+
+		if (hashmap_entry_matches (map, entry, hash, key, key_size)) return entry;
+
+		dist += 1;
+		idx = (idx + 1) & table->mask;
+	}
+
+}
+
+// places the entry taking the slot of any entry that is closer to its ideal slot
+// the table must have at least one free slot
+static void hashmap_table_place (HashMapTable *table, const HashMapEntry *entry) {
+
+	HashMapEntry current = *entry;
+	current.dist = 1;
+
+	size_t idx = current.hash & table->mask;
+	for (;;) {
+		HashMapEntry *slot = &table->entries[idx];
+		if (!slot->dist) {
+			*slot = current;
+			table->count += 1;
+			break;
+		}
+
+		if (slot->dist < current.dist) {
+			HashMapEntry tmp = *slot;
+			*slot = current;
+			current = tmp;
+		}
+
+		current.dist += 1;
+		idx = (idx + 1) & table->mask;
+	}
+
+}
+
+// moves the next entries back one slot until one is in its ideal slot,
+// so no tombstones are needed
+static void hashmap_table_erase (HashMapTable *table, HashMapEntry *entry) {
+
+	size_t idx = (size_t) (entry - table->entries);
+	size_t next = (idx + 1) & table->mask;
+	while (table->entries[next].dist > 1) {
+		table->entries[idx] = table->entries[next];
+		table->entries[idx].dist -= 1;
+
+		idx = next;
+		next = (next + 1) & table->mask;
+	}
+
+	memset (&table->entries[idx], 0, sizeof (HashMapEntry));
+	table->count -= 1;
+
+}
+
+// moves some of the old table entries into the new one
+// moved entries keep their slot with key_size = 0, so the old table
+// never changes shape and can still be searched until it is freed
+static void hashmap_migrate (HashMap *map, size_t steps) {
+
+	while (map->old.entries && steps--) {
+		if (map->migrate_pos >= map->old.capacity) {
+			free (map->old.entries);
+			memset (&map->old, 0, sizeof (HashMapTable));
+			map->migrate_pos = 0;
+			break;
+		}
+
+		HashMapEntry *entry = &map->old.entries[map->migrate_pos];
+		if (entry->dist && entry->key_size) {
+			hashmap_table_place (&map->table, entry);
+			entry->key_size = 0;
+			map->old.count -= 1;
+		}
+
+		map->migrate_pos += 1;
+	}
+
+}
+
+// keep the load factor under 7/8
+static inline size_t hashmap_max_load (size_t capacity) {
+
+	return capacity - (capacity >> 3);
+
+}
+
+// starts moving the entries into a table twice as big
+// returns 0 on success, 1 on error
+static int hashmap_grow (HashMap *map) {
+
+	// finish any resize that is still going before starting a new one
+	hashmap_migrate (map, SIZE_MAX);
+
+	HashMapTable table = { 0 };
+	if (!hashmap_table_init (&table, map->table.capacity * 2)) {
+		map->old = map->table;
+		map->table = table;
+		map->migrate_pos = 0;
+
+		return 0;
+	}
+
+	return 1;
+
+}
+
+static HashMapEntry *hashmap_find (const HashMap *map,
+	uint64_t hash, const void *key, size_t key_size,
+	HashMapTable **table) {
+
+	HashMapEntry *entry = hashmap_table_find (map, &map->table, hash, key, key_size);
+	if (entry) {
+		if (table) *table = (HashMapTable *) &map->table;
+	}
+
+	else {
+		entry = hashmap_table_find (map, &map->old, hash, key, key_size);
+		if (entry && table) *table = (HashMapTable *) &map->old;
+	}
+
+	return entry;
+
+}
+
+static HashMap *hashmap_new (void) {
+
+	HashMap *map = (HashMap *) malloc (sizeof (HashMap));
+	if (map) {
+		memset (map, 0, sizeof (HashMap));
+
+		map->hash = NULL;
+
+		map->key_create = NULL;
+		map->key_delete = NULL;
+		map->key_compare = NULL;
+
+		map->delete_value = NULL;
+	}
+
+	return map;
+
+}
+
+#pragma endregion
+
+// creates a new hash map with space for at least capacity elements before resizing
+// delete_value - custom method to delete your values, NULL for no delete when the map gets destroyed
+HashMap *hashmap_create (size_t capacity, void (*delete_value)(void *value)) {
+
+	HashMap *map = hashmap_new ();
+	if (map) {
+		size_t table_capacity = HASHMAP_MIN_CAPACITY;
+		while (hashmap_max_load (table_capacity) < capacity) table_capacity <<= 1;
+
+		if (!hashmap_table_init (&map->table, table_capacity)) {
+			map->seed = HASHMAP_DEFAULT_SEED;
+			map->delete_value = delete_value;
+		}
+
+		else {
+			free (map);
+			map = NULL;
+		}
+	}
+
+	return map;
+
+}
+
+// destroys the map with all of its keys and values
+void hashmap_delete (void *map_ptr) {
+
+	if (map_ptr) {
+		HashMap *map = (HashMap *) map_ptr;
+
+		hashmap_table_end (map, &map->old, true);
+		hashmap_table_end (map, &map->table, true);
+
+		free (map_ptr);
+	}
+
+}
+
+// sets a custom method to hash the keys, it is called with SIZE_MAX as the table size
+// and its result is mixed again, so it does not need to be well distributed
+// must be set before inserting any elements
+void hashmap_set_hash (HashMap *map,
+	size_t (*hash)(const void *key, size_t key_size, size_t table_size)) {
+
+	if (map) map->hash = hash;
+
+}
+
+// sets a method to correctly create (allocate) a new key
+// keys created with this method are never stored inline
+// must be set before inserting any elements
+void hashmap_set_key_create (HashMap *map, void *(*key_create)(const void *)) {
+
+	if (map) map->key_create = key_create;
+
+}
+
+// sets a method to correctly delete (free) your previous allocated key
+// if not set, free will be used as default
+void hashmap_set_key_delete (HashMap *map, void (*key_delete)(void *)) {
+
+	if (map) map->key_delete = key_delete;
+
+}
+
+// sets a method to compare keys, it must return 0 if they are equal
+// keys with the same hash are the only ones compared
+// if not set, the keys bytes are compared
+void hashmap_set_key_comparator (HashMap *map,
+	int (*key_compare)(const void *one, const void *two)) {
+
+	if (map) map->key_compare = key_compare;
+
+}
+
+// returns the current number of elements inside the map
+size_t hashmap_size (const HashMap *map) {
+
+	return map ? map->count : 0;
+
+}
+
+// returns how many slots the current table has
+size_t hashmap_capacity (const HashMap *map) {
+
+	return map ? map->table.capacity : 0;
+
+}
+
+// returns true if there is a value associated with the key
+bool hashmap_contains_key (const HashMap *map, const void *key, size_t key_size) {
+
+	bool retval = false;
+
+	if (map && key && key_size) {
+		uint64_t hash = hashmap_key_hash (map, key, key_size);
+		retval = hashmap_find (map, hash, key, key_size, NULL) != NULL;
+	}
+
+	return retval;
+
+}
+
+// inserts a new value associated with its key, the key is copied
+// returns 0 on success, 1 on error or if the key is already inside the map
+int hashmap_insert (HashMap *map,
+	const void *key, size_t key_size,
+	void *value, size_t value_size) {
+
+	int retval = 1;
+
+	if (map && key && key_size && key_size <= UINT32_MAX) {
+		hashmap_migrate (map, HASHMAP_MIGRATE_STEP);
+
+		uint64_t hash = hashmap_key_hash (map, key, key_size);
+		if (!hashmap_find (map, hash, key, key_size, NULL)) {
+			if (map->count + 1 <= hashmap_max_load (map->table.capacity)
+				|| !hashmap_grow (map)) {
+				HashMapEntry entry = { 0 };
+				entry.hash = hash;
+				entry.key_size = (uint32_t) key_size;
+				entry.value = value;
+				entry.value_size = value_size;
+
+				if (hashmap_key_is_inline (map, key_size)) {
+					memcpy (entry.key.bytes, key, key_size);
+				}
+
+				else if (map->key_create) {
+					entry.key.ptr = map->key_create (key);
+				}
+
+				else {
+					entry.key.ptr = malloc (key_size);
+					if (entry.key.ptr) memcpy (entry.key.ptr, key, key_size);
+				}
+
+				if (hashmap_key_is_inline (map, key_size) || entry.key.ptr) {
+					hashmap_table_place (&map->table, &entry);
+					map->count += 1;
+
+					retval = 0;
+				}
+			}
+		}
+	}
+
+	return retval;
+
+}
+
+// returns a ptr to the value associated with the key
+// returns NULL if no value was found
+void *hashmap_get (const HashMap *map, const void *key, size_t key_size) {
+
+	void *retval = NULL;
+
+	if (map && key && key_size) {
+		uint64_t hash = hashmap_key_hash (map, key, key_size);
+		HashMapEntry *entry = hashmap_find (map, hash, key, key_size, NULL);
+		if (entry) retval = entry->value;
+	}
+
+	return retval;
+
+}
+
+// removes the key from the map and returns its value, the value is NOT deleted
+// returns NULL if no value was found
+void *hashmap_remove (HashMap *map, const void *key, size_t key_size) {
+
+	void *retval = NULL;
+
+	if (map && key && key_size) {
+		hashmap_migrate (map, HASHMAP_MIGRATE_STEP);
+
+		uint64_t hash = hashmap_key_hash (map, key, key_size);
+		HashMapTable *table = NULL;
+		HashMapEntry *entry = hashmap_find (map, hash, key, key_size, &table);
+		if (entry) {
+			retval = entry->value;
+			hashmap_entry_key_delete (map, entry);
+
+			if (table == &map->table) hashmap_table_erase (table, entry);
+
+			else {
+				// the old table keeps its shape until it is freed
+				entry->key_size = 0;
+				table->count -= 1;
+			}
+
+			map->count -= 1;
+		}
+	}
+
+	return retval;
+
+}
+
+// calls the method with every element inside the map, in no particular order
+// the map must not be modified inside the method
+void hashmap_foreach (const HashMap *map,
+	void (*method)(const void *key, size_t key_size, void *value, size_t value_size, void *args),
+	void *args) {
+
+	if (map && method) {
+		const HashMapTable *tables[2] = { &map->old, &map->table };
+		for (unsigned int t = 0; t < 2; t++) {
+			for (size_t i = 0; i < tables[t]->capacity; i++) {
+				const HashMapEntry *entry = &tables[t]->entries[i];
+				if (entry->dist && entry->key_size) {
+					method (hashmap_entry_key (map, entry), entry->key_size,
+						entry->value, entry->value_size, args);
+				}
+			}
+		}
+	}
+
+}
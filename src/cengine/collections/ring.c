@@ -0,0 +1,322 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "cengine/collections/ring.h"
+
+#pragma region internal
+
+#define ring_slot(ring, pos) ((ring)->slots + ((pos) & (ring)->mask) * (ring)->slot_size)
+#define ring_slot_sequence(slot) ((size_t *) (slot))
+#define ring_slot_data(slot) ((slot) + sizeof (size_t))
+
+static size_t ring_round_capacity (size_t capacity) {
+
+	size_t retval = 2;
+	while (retval < capacity) retval <<= 1;
+
+	return retval;
+
+}
+
+static Ring *ring_new (void) {
+
+	Ring *ring = (Ring *) malloc (sizeof (Ring));
+	if (ring) {
+		memset (ring, 0, sizeof (Ring));
+
+		ring->slots = NULL;
+		ring->destroy = NULL;
+
+		ring->overflow_mutex = NULL;
+		ring->overflow = NULL;
+	}
+
+	return ring;
+
+}
+
+// tries to copy the element into a free slot
+// returns 0 on success, 1 if the ring is full
+static int ring_try_push (Ring *ring, const void *element) {
+
+	size_t pos = __atomic_load_n (&ring->tail, __ATOMIC_RELAXED);
+	unsigned char *slot = NULL;
+
+	for (;;) {
+		slot = ring_slot (ring, pos);
+		size_t sequence = __atomic_load_n (ring_slot_sequence (slot), __ATOMIC_ACQUIRE);
+		intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+
+		if (diff == 0) {
+			// the slot is free, claim it
+			if (__atomic_compare_exchange_n (&ring->tail, &pos, pos + 1, true,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+		}
+
+		// the slot still holds an element from the previous lap
+		else if (diff < 0) return 1;
+
+		else pos = __atomic_load_n (&ring->tail, __ATOMIC_RELAXED);
+	}
+
+	memcpy (ring_slot_data (slot), element, ring->element_size);
+	__atomic_store_n (ring_slot_sequence (slot), pos + 1, __ATOMIC_RELEASE);
+
+	return 0;
+
+}
+
+// tries to copy the oldest element out of the ring
+// returns 0 on success, 1 if the ring is empty
+static int ring_try_pop (Ring *ring, void *element) {
+
+	size_t pos = __atomic_load_n (&ring->head, __ATOMIC_RELAXED);
+	unsigned char *slot = NULL;
+
+	for (;;) {
+		slot = ring_slot (ring, pos);
+		size_t sequence = __atomic_load_n (ring_slot_sequence (slot), __ATOMIC_ACQUIRE);
+		intptr_t diff = (intptr_t) sequence - (intptr_t) (pos + 1);
+
+		if (diff == 0) {
+			// the slot has been written, claim it
+			if (__atomic_compare_exchange_n (&ring->head, &pos, pos + 1, true,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+		}
+
+		// nothing has been written in here yet
+		else if (diff < 0) return 1;
+
+		else pos = __atomic_load_n (&ring->head, __ATOMIC_RELAXED);
+	}
+
+	memcpy (element, ring_slot_data (slot), ring->element_size);
+	// mark the slot as free for the next lap
+	__atomic_store_n (ring_slot_sequence (slot), pos + ring->mask + 1, __ATOMIC_RELEASE);
+
+	return 0;
+
+}
+
+// returns 0 on success, 1 on error
+static int ring_overflow_push (Ring *ring, const void *element) {
+
+	int retval = 1;
+
+	pthread_mutex_lock (ring->overflow_mutex);
+
+	if (ring->overflow_count >= ring->overflow_capacity) {
+		size_t new_capacity = ring->overflow_capacity ? ring->overflow_capacity * 2 : ring->capacity;
+		unsigned char *new_overflow = (unsigned char *) malloc (new_capacity * ring->element_size);
+		if (new_overflow) {
+			// unwrap the elements at the start of the new buffer
+			for (size_t i = 0; i < ring->overflow_count; i++) {
+				size_t idx = (ring->overflow_start + i) % ring->overflow_capacity;
+				memcpy (new_overflow + i * ring->element_size,
+					ring->overflow + idx * ring->element_size, ring->element_size);
+			}
+
+			free (ring->overflow);
+			ring->overflow = new_overflow;
+			ring->overflow_capacity = new_capacity;
+			ring->overflow_start = 0;
+		}
+	}
+
+	if (ring->overflow_count < ring->overflow_capacity) {
+		size_t idx = (ring->overflow_start + ring->overflow_count) % ring->overflow_capacity;
+		memcpy (ring->overflow + idx * ring->element_size, element, ring->element_size);
+		__atomic_add_fetch (&ring->overflow_count, 1, __ATOMIC_RELEASE);
+		retval = 0;
+	}
+
+	pthread_mutex_unlock (ring->overflow_mutex);
+
+	return retval;
+
+}
+
+// returns 0 on success, 1 if the overflow is empty
+static int ring_overflow_pop (Ring *ring, void *element) {
+
+	int retval = 1;
+
+	pthread_mutex_lock (ring->overflow_mutex);
+
+	if (ring->overflow_count > 0) {
+		memcpy (element, ring->overflow + ring->overflow_start * ring->element_size, ring->element_size);
+		ring->overflow_start = (ring->overflow_start + 1) % ring->overflow_capacity;
+		__atomic_sub_fetch (&ring->overflow_count, 1, __ATOMIC_RELEASE);
+		retval = 0;
+	}
+
+	pthread_mutex_unlock (ring->overflow_mutex);
+
+	return retval;
+
+}
+
+#pragma endregion
+
+// creates a new ring with space for at least capacity elements of element_size bytes
+// destroy is used to free any resources referenced by an element, it can be NULL
+Ring *ring_create (size_t capacity, size_t element_size,
+	RingPolicy policy, void (*destroy)(void *element)) {
+
+	Ring *ring = NULL;
+
+	if (capacity > 0 && element_size > 0) {
+		ring = ring_new ();
+		if (ring) {
+			ring->capacity = ring_round_capacity (capacity);
+			ring->mask = ring->capacity - 1;
+			ring->element_size = element_size;
+
+			// keep every slot aligned for its sequence number
+			ring->slot_size = sizeof (size_t) + element_size;
+			ring->slot_size = (ring->slot_size + sizeof (size_t) - 1) & ~(sizeof (size_t) - 1);
+
+			ring->policy = policy;
+			ring->destroy = destroy;
+
+			ring->slots = (unsigned char *) malloc (ring->capacity * ring->slot_size);
+			ring->overflow_mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+			if (ring->slots && ring->overflow_mutex) {
+				for (size_t i = 0; i < ring->capacity; i++)
+					*ring_slot_sequence (ring_slot (ring, i)) = i;
+
+				pthread_mutex_init (ring->overflow_mutex, NULL);
+			}
+
+			else {
+				if (ring->slots) free (ring->slots);
+				if (ring->overflow_mutex) free (ring->overflow_mutex);
+				free (ring);
+				ring = NULL;
+			}
+		}
+	}
+
+	return ring;
+
+}
+
+// destroys the remaining elements and deletes the ring
+void ring_delete (void *ring_ptr) {
+
+	if (ring_ptr) {
+		Ring *ring = (Ring *) ring_ptr;
+
+		if (ring->destroy) {
+			void *element = malloc (ring->element_size);
+			if (element) {
+				while (!ring_pop (ring, element)) ring->destroy (element);
+				free (element);
+			}
+		}
+
+		free (ring->slots);
+
+		if (ring->overflow) free (ring->overflow);
+
+		pthread_mutex_destroy (ring->overflow_mutex);
+		free (ring->overflow_mutex);
+
+		free (ring_ptr);
+	}
+
+}
+
+// returns how many elements can be stored without using the policy
+size_t ring_capacity (const Ring *ring) {
+
+	return ring ? ring->capacity : 0;
+
+}
+
+// returns how many elements are inside the ring, it may be old when used by many threads
+size_t ring_size (Ring *ring) {
+
+	size_t retval = 0;
+
+	if (ring) {
+		size_t head = __atomic_load_n (&ring->head, __ATOMIC_ACQUIRE);
+		size_t tail = __atomic_load_n (&ring->tail, __ATOMIC_ACQUIRE);
+
+		retval = (tail > head ? tail - head : 0)
+			+ __atomic_load_n (&ring->overflow_count, __ATOMIC_ACQUIRE);
+	}
+
+	return retval;
+
+}
+
+bool ring_is_empty (Ring *ring) {
+
+	return ring_size (ring) == 0;
+
+}
+
+// copies the element into the ring, if the ring is full the policy is used
+// RING_POLICY_BLOCK must not be used if the consumer thread also pushes
+// returns 0 on success, 1 on error
+int ring_push (Ring *ring, const void *element) {
+
+	int retval = 1;
+
+	if (ring && element) {
+		switch (ring->policy) {
+			case RING_POLICY_BLOCK: {
+				while (ring_try_push (ring, element)) sched_yield ();
+				retval = 0;
+			} break;
+
+			case RING_POLICY_DROP_OLDEST: {
+				unsigned char dropped[ring->element_size];
+				while (ring_try_push (ring, element)) {
+					if (!ring_try_pop (ring, dropped) && ring->destroy)
+						ring->destroy (dropped);
+				}
+
+				retval = 0;
+			} break;
+
+			case RING_POLICY_GROW: {
+				// keep the order, once we have overflowed, new elements go after the old ones
+				if (__atomic_load_n (&ring->overflow_count, __ATOMIC_ACQUIRE) > 0
+					|| ring_try_push (ring, element)) {
+					retval = ring_overflow_push (ring, element);
+				}
+
+				else retval = 0;
+			} break;
+
+			default: break;
+		}
+	}
+
+	return retval;
+
+}
+
+// copies the oldest element into element and removes it from the ring
+// returns 0 on success, 1 if the ring is empty
+int ring_pop (Ring *ring, void *element) {
+
+	int retval = 1;
+
+	if (ring && element) {
+		retval = ring_try_pop (ring, element);
+
+		if (retval && __atomic_load_n (&ring->overflow_count, __ATOMIC_ACQUIRE) > 0)
+			retval = ring_overflow_pop (ring, element);
+	}
+
+	return retval;
+
+}
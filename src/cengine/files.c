@@ -10,11 +10,15 @@
 #include <unistd.h>
 #include <fcntl.h>
 
+#include <SDL2/SDL.h>
+
 #include "cengine/types/types.h"
 #include "cengine/types/string.h"
 
 #include "cengine/collections/dlist.h"
 
+#include "cengine/archive.h"
+
 #include "cengine/utils/utils.h"
 #include "cengine/utils/log.h"
 #include "cengine/utils/json.h"
@@ -201,13 +205,23 @@ FILE *file_open_as_file (const char *filename, const char *modes, struct stat *f
 
 }
 
-// opens and reads a file into a buffer
+// opens and reads a file into a buffer, from a mounted archive if it is in one
 // sets file size to the amount of bytes read
 char *file_read (const char *filename, int *file_size) {
 
     char *file_contents = NULL;
 
-    if (filename) {
+    size_t archived_size = 0;
+    const void *archived = filename ? archives_get_data (filename, &archived_size) : NULL;
+    if (archived) {
+        file_contents = (char *) malloc (archived_size ? archived_size : 1);
+        if (file_contents) {
+            memcpy (file_contents, archived, archived_size);
+            *file_size = (int) archived_size;
+        }
+    }
+
+    else if (filename) {
         struct stat filestatus;
         FILE *fp = file_open_as_file (filename, "rt", &filestatus);
         if (fp) {
@@ -269,11 +283,31 @@ int file_open_as_fd (const char *filename, struct stat *filestatus) {
 
 }
 
+// opens a read only rwops of the file, from a mounted archive if it is in one
+// returns NULL on error
+SDL_RWops *file_open_rw (const char *filename) {
+
+    SDL_RWops *rw = NULL;
+
+    if (filename) {
+        rw = archives_open_rw (filename);
+        if (!rw) rw = SDL_RWFromFile (filename, "rb");
+    }
+
+    return rw;
+
+}
+
+// parses the json file, from a mounted archive if it is in one, without copying it
 json_value *file_json_parse (const char *filename) {
 
     json_value *value = NULL;
 
-    if (filename) {
+    size_t archived_size = 0;
+    const void *archived = filename ? archives_get_data (filename, &archived_size) : NULL;
+    if (archived) value = json_parse ((const json_char *) archived, archived_size);
+
+    else if (filename) {
         int file_size;
         char *file_contents = file_read (filename, &file_size);
         json_char *json = (json_char *) file_contents;
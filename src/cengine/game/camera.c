@@ -71,8 +71,8 @@ void camera_set_target (Camera *cam, Transform *target) {
 static void camera_init (Camera *cam, Renderer *renderer) {
 
     // position
-    cam->transform.position.x = renderer->window->window_size.width / 2;
-    cam->transform.position.y = renderer->window->window_size.height / 2;
+    cam->position.x = renderer->window->window_size.width / 2;
+    cam->position.y = renderer->window->window_size.height / 2;
 
     cam->windowWidth = renderer->window->window_size.width;
     cam->windowHeight = renderer->window->window_size.height;
@@ -179,16 +179,16 @@ void camera_update (Camera *cam) {
     #endif
 
     // camera movement
-    // u32 x = cam->transform.position.x;
-    // u32 y = cam->transform.position.y;
+    // u32 x = cam->position.x;
+    // u32 y = cam->position.y;
 
     // FIXME:
     // if (cam->isFollwing) {
-    //     if (abs (x - cam->target->position.x) > cam->margin.x)
-    //         x = lerp (x, cam->target->position.x, cam->smoothing.x * deltaTime);
+    //     if (abs (x - transform_get_position (cam->target).x) > cam->margin.x)
+    //         x = lerp (x, transform_get_position (cam->target).x, cam->smoothing.x * deltaTime);
 
-    //     if (abs (y - cam->target->position.y) > cam->margin.y)
-    //         y = lerp (y, cam->target->position.y, cam->smoothing.y * deltaTime);
+    //     if (abs (y - transform_get_position (cam->target).y) > cam->margin.y)
+    //         y = lerp (y, transform_get_position (cam->target).y, cam->smoothing.y * deltaTime);
     // }
 
     // bounds - used to calculate what gets rendered to the screen
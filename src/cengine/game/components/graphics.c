@@ -2,6 +2,7 @@
 #include <stdbool.h>
 
 #include "cengine/types/types.h"
+#include "cengine/assets.h"
 #include "cengine/sprites.h"
 #include "cengine/renderer.h"
 #include "cengine/game/components/graphics.h"
@@ -33,8 +34,8 @@ void graphics_destroy (Graphics *graphics) {
         }
 
         else {
-            if (graphics->sprite) sprite_destroy (graphics->sprite);
-            if (graphics->spriteSheet) sprite_sheet_destroy (graphics->spriteSheet);
+            if (graphics->sprite) assets_release (graphics->sprite);
+            if (graphics->spriteSheet) assets_release (graphics->spriteSheet);
         }
 
         free (graphics);
@@ -45,7 +46,7 @@ void graphics_destroy (Graphics *graphics) {
 void graphics_set_sprite (Graphics *graphics, Renderer *renderer, const char *filename) {
 
     if (graphics && filename) {
-        graphics->sprite = sprite_load (filename, renderer);
+        graphics->sprite = assets_get_sprite (filename, renderer);
         graphics->spriteSheet = NULL;
         graphics->multipleSprites = false;
     }
@@ -56,7 +57,7 @@ void graphics_set_sprite_sheet (Graphics *graphics, Renderer *renderer, const ch
 
     if (graphics && filename) {
         graphics->sprite = NULL;
-        graphics->spriteSheet = sprite_sheet_load (filename, renderer);
+        graphics->spriteSheet = assets_get_sprite_sheet (filename, renderer);
         graphics->multipleSprites = true;
     }
 
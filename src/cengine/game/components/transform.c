@@ -2,20 +2,50 @@
 
 #include "cengine/types/types.h"
 #include "cengine/types/vector2d.h"
+
+#include "cengine/game/go.h"
+#include "cengine/game/ecs.h"
 #include "cengine/game/components/transform.h"
 
-Transform *transform_new (u32 objectID) {
+Vector2D transform_get_position (const Transform *transform) {
+
+    Vector2D position = { 0, 0 };
 
-    Transform *new_transform = (Transform *) malloc (sizeof (Transform));
-    if (new_transform) {
-        new_transform->go_id = objectID;
-        new_transform->position.x = 0;
-        new_transform->position.y = 0;
-        // new_transform->layer = UNSET_LAYER;
+    if (transform) {
+        float *x = (float *) ecs_get (game_world, transform->entity, game_transform_comp, GAME_TRANSFORM_X);
+        float *y = (float *) ecs_get (game_world, transform->entity, game_transform_comp, GAME_TRANSFORM_Y);
+        if (x && y) {
+            position.x = *x;
+            position.y = *y;
+        }
     }
 
-    return new_transform;
+    return position;
+
+}
+
+void transform_set_position (Transform *transform, float x, float y) {
+
+    if (transform) {
+        float *pos_x = (float *) ecs_get (game_world, transform->entity, game_transform_comp, GAME_TRANSFORM_X);
+        float *pos_y = (float *) ecs_get (game_world, transform->entity, game_transform_comp, GAME_TRANSFORM_Y);
+        if (pos_x && pos_y) {
+            *pos_x = x;
+            *pos_y = y;
+        }
+    }
 
 }
 
-void transform_destroy (Transform *transform) { if (transform) free (transform); }
\ No newline at end of file
+void transform_translate (Transform *transform, float x, float y) {
+
+    if (transform) {
+        float *pos_x = (float *) ecs_get (game_world, transform->entity, game_transform_comp, GAME_TRANSFORM_X);
+        float *pos_y = (float *) ecs_get (game_world, transform->entity, game_transform_comp, GAME_TRANSFORM_Y);
+        if (pos_x && pos_y) {
+            *pos_x += x;
+            *pos_y += y;
+        }
+    }
+
+}
\ No newline at end of file
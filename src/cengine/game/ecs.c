@@ -0,0 +1,605 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/game/ecs.h"
+
+#define ECS_ALIVE_BIT               (1ULL << 63)
+
+#define ecs_component_bit(component)    (1ULL << (component))
+
+#pragma region pools
+
+static EcsPool *ecs_pool_new (void) {
+
+    EcsPool *pool = (EcsPool *) malloc (sizeof (EcsPool));
+    if (pool) {
+        memset (pool, 0, sizeof (EcsPool));
+
+        pool->entities = NULL;
+        pool->sparse = NULL;
+        pool->destroy = NULL;
+    }
+
+    return pool;
+
+}
+
+static void ecs_pool_delete (EcsPool *pool) {
+
+    if (pool) {
+        if (pool->destroy) {
+            for (u32 row = 0; row < pool->count; row++)
+                pool->destroy (pool->columns[0] + row * pool->column_sizes[0]);
+        }
+
+        for (u32 i = 0; i < pool->n_columns; i++)
+            if (pool->columns[i]) free (pool->columns[i]);
+
+        if (pool->entities) free (pool->entities);
+        if (pool->sparse) free (pool->sparse);
+
+        free (pool);
+    }
+
+}
+
+// makes sure the entity index can be used with the sparse array
+// returns 0 on success, 1 on error
+static u8 ecs_pool_sparse_reserve (EcsPool *pool, u32 index) {
+
+    if (index < pool->sparse_capacity) return 0;
+
+    u32 new_capacity = pool->sparse_capacity ? pool->sparse_capacity : ECS_INIT_CAPACITY;
+    while (new_capacity <= index) new_capacity *= 2;
+
+    u32 *new_sparse = (u32 *) realloc (pool->sparse, new_capacity * sizeof (u32));
+    if (!new_sparse) return 1;
+
+    memset (new_sparse + pool->sparse_capacity, 0xFF, (new_capacity - pool->sparse_capacity) * sizeof (u32));
+    pool->sparse = new_sparse;
+    pool->sparse_capacity = new_capacity;
+
+    return 0;
+
+}
+
+// makes sure there is space for one more row
+// returns 0 on success, 1 on error
+static u8 ecs_pool_rows_reserve (EcsPool *pool) {
+
+    if (pool->count < pool->capacity) return 0;
+
+    u32 new_capacity = pool->capacity ? pool->capacity * 2 : ECS_INIT_CAPACITY;
+
+    Entity *new_entities = (Entity *) realloc (pool->entities, new_capacity * sizeof (Entity));
+    if (!new_entities) return 1;
+    pool->entities = new_entities;
+
+    for (u32 i = 0; i < pool->n_columns; i++) {
+        u8 *new_column = (u8 *) realloc (pool->columns[i], new_capacity * pool->column_sizes[i]);
+        if (!new_column) return 1;
+        pool->columns[i] = new_column;
+    }
+
+    pool->capacity = new_capacity;
+
+    return 0;
+
+}
+
+static inline u32 ecs_pool_row (const EcsPool *pool, u32 index) {
+
+    return index < pool->sparse_capacity ? pool->sparse[index] : ECS_INVALID_ROW;
+
+}
+
+// moves the last row to the removed one, so the rows are always packed
+static void ecs_pool_remove_row (EcsPool *pool, u32 index, u32 row) {
+
+    if (pool->destroy) pool->destroy (pool->columns[0] + row * pool->column_sizes[0]);
+
+    u32 last = pool->count - 1;
+    if (row != last) {
+        for (u32 i = 0; i < pool->n_columns; i++) {
+            memcpy (pool->columns[i] + row * pool->column_sizes[i],
+                pool->columns[i] + last * pool->column_sizes[i],
+                pool->column_sizes[i]);
+        }
+
+        pool->entities[row] = pool->entities[last];
+        pool->sparse[ecs_entity_index (pool->entities[row])] = row;
+    }
+
+    pool->sparse[index] = ECS_INVALID_ROW;
+    pool->count -= 1;
+
+}
+
+#pragma endregion
+
+#pragma region world
+
+static EcsWorld *ecs_world_new (void) {
+
+    EcsWorld *world = (EcsWorld *) malloc (sizeof (EcsWorld));
+    if (world) {
+        memset (world, 0, sizeof (EcsWorld));
+
+        world->generations = NULL;
+        world->masks = NULL;
+        world->free_slots = NULL;
+
+        world->systems = NULL;
+        world->deferred = NULL;
+    }
+
+    return world;
+
+}
+
+EcsWorld *ecs_world_create (void) {
+
+    return ecs_world_new ();
+
+}
+
+// destroys every entity with its components
+void ecs_world_delete (void *world_ptr) {
+
+    if (world_ptr) {
+        EcsWorld *world = (EcsWorld *) world_ptr;
+
+        for (u32 i = 0; i < world->n_pools; i++)
+            ecs_pool_delete (world->pools[i]);
+
+        if (world->generations) free (world->generations);
+        if (world->masks) free (world->masks);
+        if (world->free_slots) free (world->free_slots);
+
+        if (world->systems) free (world->systems);
+        if (world->deferred) free (world->deferred);
+
+        free (world_ptr);
+    }
+
+}
+
+// returns how many entities are alive
+u32 ecs_world_entity_count (const EcsWorld *world) {
+
+    return world ? world->n_alive : 0;
+
+}
+
+static inline bool ecs_component_is_valid (const EcsWorld *world, EcsComponent component) {
+
+    return component < world->n_pools;
+
+}
+
+#pragma endregion
+
+#pragma region deferred
+
+// returns 0 on success, 1 on error
+static u8 ecs_world_defer (EcsWorld *world, Entity entity, EcsComponent component) {
+
+    if (world->n_deferred >= world->max_deferred) {
+        u32 new_max = world->max_deferred ? world->max_deferred * 2 : ECS_INIT_CAPACITY;
+        EcsDeferred *new_deferred = (EcsDeferred *) realloc (world->deferred, new_max * sizeof (EcsDeferred));
+        if (!new_deferred) return 1;
+        world->deferred = new_deferred;
+        world->max_deferred = new_max;
+    }
+
+    world->deferred[world->n_deferred].entity = entity;
+    world->deferred[world->n_deferred].component = component;
+    world->n_deferred += 1;
+
+    return 0;
+
+}
+
+static void ecs_entity_release (EcsWorld *world, u32 index);
+
+// removes the rows of the entities that were destroyed & of the components that were removed
+// while the queries were running, in the same order they were made
+static void ecs_world_apply_deferred (EcsWorld *world) {
+
+    for (u32 i = 0; i < world->n_deferred; i++) {
+        Entity entity = world->deferred[i].entity;
+        EcsComponent component = world->deferred[i].component;
+        u32 index = ecs_entity_index (entity);
+
+        if (component == ECS_INVALID_COMPONENT) ecs_entity_release (world, index);
+
+        // it could have been added again after it was removed
+        else if (!(world->masks[index] & ecs_component_bit (component))) {
+            EcsPool *pool = world->pools[component];
+            u32 row = ecs_pool_row (pool, index);
+            if (row != ECS_INVALID_ROW) ecs_pool_remove_row (pool, index, row);
+        }
+    }
+
+    world->n_deferred = 0;
+
+}
+
+#pragma endregion
+
+#pragma region entities
+
+// returns 0 on success, 1 on error
+static u8 ecs_world_slots_grow (EcsWorld *world) {
+
+    u32 new_max = world->max_slots ? world->max_slots * 2 : ECS_INIT_CAPACITY;
+
+    u32 *new_generations = (u32 *) realloc (world->generations, new_max * sizeof (u32));
+    if (!new_generations) return 1;
+    world->generations = new_generations;
+
+    u64 *new_masks = (u64 *) realloc (world->masks, new_max * sizeof (u64));
+    if (!new_masks) return 1;
+    world->masks = new_masks;
+
+    // every slot can be free at the same time
+    u32 *new_free_slots = (u32 *) realloc (world->free_slots, new_max * sizeof (u32));
+    if (!new_free_slots) return 1;
+    world->free_slots = new_free_slots;
+
+    world->max_slots = new_max;
+
+    return 0;
+
+}
+
+// creates a new entity, reusing a destroyed slot if there is one
+// returns ECS_NULL_ENTITY on error
+Entity ecs_entity_create (EcsWorld *world) {
+
+    Entity entity = ECS_NULL_ENTITY;
+
+    if (world) {
+        u32 index = 0;
+        if (world->n_free_slots) {
+            world->n_free_slots -= 1;
+            index = world->free_slots[world->n_free_slots];
+        }
+
+        else {
+            if (world->n_slots >= world->max_slots && ecs_world_slots_grow (world))
+                return entity;
+
+            index = world->n_slots;
+            world->n_slots += 1;
+
+            // generation 0 is never used, so ECS_NULL_ENTITY is never valid
+            world->generations[index] = 1;
+        }
+
+        world->masks[index] = ECS_ALIVE_BIT;
+        world->n_alive += 1;
+
+        entity = ecs_entity_make (index, world->generations[index]);
+    }
+
+    return entity;
+
+}
+
+// returns true if the entity has not been destroyed
+bool ecs_entity_is_alive (const EcsWorld *world, Entity entity) {
+
+    bool retval = false;
+
+    if (world) {
+        u32 index = ecs_entity_index (entity);
+        retval = index < world->n_slots
+            && world->generations[index] == ecs_entity_generation (entity)
+            && (world->masks[index] & ECS_ALIVE_BIT);
+    }
+
+    return retval;
+
+}
+
+// removes every row the slot still has and makes it ready to be used again
+static void ecs_entity_release (EcsWorld *world, u32 index) {
+
+    for (EcsComponent component = 0; component < world->n_pools; component++) {
+        EcsPool *pool = world->pools[component];
+        u32 row = ecs_pool_row (pool, index);
+        if (row != ECS_INVALID_ROW) ecs_pool_remove_row (pool, index, row);
+    }
+
+    world->generations[index] += 1;
+    if (!world->generations[index]) world->generations[index] = 1;
+
+    world->free_slots[world->n_free_slots] = index;
+    world->n_free_slots += 1;
+
+}
+
+// removes all of the entity components and frees its slot
+// inside a query, the entity stops being alive right away but its rows are removed when the query ends
+void ecs_entity_destroy (EcsWorld *world, Entity entity) {
+
+    if (ecs_entity_is_alive (world, entity)) {
+        u32 index = ecs_entity_index (entity);
+
+        world->masks[index] = 0;
+        world->n_alive -= 1;
+
+        if (!world->iterating || ecs_world_defer (world, entity, ECS_INVALID_COMPONENT))
+            ecs_entity_release (world, index);
+    }
+
+}
+
+#pragma endregion
+
+#pragma region components
+
+// registers a new component type made of n_columns columns with the specified sizes
+// destroy is called when the component is removed, it can be NULL
+// returns the new component, ECS_INVALID_COMPONENT on error
+EcsComponent ecs_component_register (EcsWorld *world,
+    const size_t *column_sizes, u32 n_columns, void (*destroy)(void *component)) {
+
+    EcsComponent retval = ECS_INVALID_COMPONENT;
+
+    if (world && column_sizes && n_columns > 0 && n_columns <= ECS_MAX_COLUMNS
+        && world->n_pools < ECS_MAX_COMPONENTS) {
+        for (u32 i = 0; i < n_columns; i++)
+            if (!column_sizes[i]) return retval;
+
+        EcsPool *pool = ecs_pool_new ();
+        if (pool) {
+            pool->n_columns = n_columns;
+            memcpy (pool->column_sizes, column_sizes, n_columns * sizeof (size_t));
+            pool->destroy = destroy;
+
+            retval = world->n_pools;
+            world->pools[world->n_pools] = pool;
+            world->n_pools += 1;
+        }
+    }
+
+    return retval;
+
+}
+
+// adds the component to the entity with all of its columns set to 0
+// returns 0 on success, 1 on error or if the entity already has it
+u8 ecs_add (EcsWorld *world, Entity entity, EcsComponent component) {
+
+    u8 retval = 1;
+
+    if (ecs_entity_is_alive (world, entity) && ecs_component_is_valid (world, component)) {
+        u32 index = ecs_entity_index (entity);
+        if (!(world->masks[index] & ecs_component_bit (component))) {
+            EcsPool *pool = world->pools[component];
+            u32 removed_row = ecs_pool_row (pool, index);
+            if (removed_row != ECS_INVALID_ROW) {
+                // it was removed inside a query that has not ended yet, so its row is used again
+                if (pool->destroy) pool->destroy (pool->columns[0] + removed_row * pool->column_sizes[0]);
+                for (u32 i = 0; i < pool->n_columns; i++)
+                    memset (pool->columns[i] + removed_row * pool->column_sizes[i], 0, pool->column_sizes[i]);
+
+                world->masks[index] |= ecs_component_bit (component);
+
+                retval = 0;
+            }
+
+            else if (!ecs_pool_sparse_reserve (pool, index) && !ecs_pool_rows_reserve (pool)) {
+                u32 row = pool->count;
+                for (u32 i = 0; i < pool->n_columns; i++)
+                    memset (pool->columns[i] + row * pool->column_sizes[i], 0, pool->column_sizes[i]);
+
+                pool->entities[row] = entity;
+                pool->sparse[index] = row;
+                pool->count += 1;
+
+                world->masks[index] |= ecs_component_bit (component);
+
+                retval = 0;
+            }
+        }
+    }
+
+    return retval;
+
+}
+
+// removes the component from the entity, the last row is moved to fill its place
+// inside a query, the entity stops having it right away but its row is removed when the query ends
+void ecs_remove (EcsWorld *world, Entity entity, EcsComponent component) {
+
+    if (ecs_has (world, entity, component)) {
+        u32 index = ecs_entity_index (entity);
+        EcsPool *pool = world->pools[component];
+
+        world->masks[index] &= ~ecs_component_bit (component);
+
+        if (!world->iterating || ecs_world_defer (world, entity, component))
+            ecs_pool_remove_row (pool, index, pool->sparse[index]);
+    }
+
+}
+
+bool ecs_has (const EcsWorld *world, Entity entity, EcsComponent component) {
+
+    return ecs_entity_is_alive (world, entity)
+        && ecs_component_is_valid (world, component)
+        && (world->masks[ecs_entity_index (entity)] & ecs_component_bit (component));
+
+}
+
+// returns a ptr to the entity value inside the component column, NULL if it does not have it
+// it is only valid until the next add or remove of the same component
+void *ecs_get (const EcsWorld *world, Entity entity, EcsComponent component, u32 column) {
+
+    void *retval = NULL;
+
+    if (ecs_has (world, entity, component)) {
+        EcsPool *pool = world->pools[component];
+        if (column < pool->n_columns) {
+            u32 row = ecs_pool_row (pool, ecs_entity_index (entity));
+            retval = pool->columns[column] + row * pool->column_sizes[column];
+        }
+    }
+
+    return retval;
+
+}
+
+// returns how many entities have the component
+u32 ecs_component_count (const EcsWorld *world, EcsComponent component) {
+
+    return (world && ecs_component_is_valid (world, component)) ?
+        world->pools[component]->count : 0;
+
+}
+
+// returns the dense array of a component column, it has ecs_component_count () values
+void *ecs_column (const EcsWorld *world, EcsComponent component, u32 column) {
+
+    void *retval = NULL;
+
+    if (world && ecs_component_is_valid (world, component)) {
+        if (column < world->pools[component]->n_columns)
+            retval = world->pools[component]->columns[column];
+    }
+
+    return retval;
+
+}
+
+// returns the entities that own each row of the component
+const Entity *ecs_component_entities (const EcsWorld *world, EcsComponent component) {
+
+    return (world && ecs_component_is_valid (world, component)) ?
+        world->pools[component]->entities : NULL;
+
+}
+
+#pragma endregion
+
+#pragma region queries
+
+// calls the method with batches of the entities that have all of the components
+// the pool with less entities is walked in order and the others are checked with a mask,
+// so the cost depends on the smallest component and not on the total entities
+// entities can be destroyed & components removed inside the method, they are applied when the query ends,
+// so methods that do it have to skip the entities that are no longer valid with ecs_iter_valid ()
+void ecs_query_each (EcsWorld *world,
+    const EcsComponent *components, u32 n_components,
+    void (*method)(EcsIter *it), void *args) {
+
+    if (world && components && n_components > 0
+        && n_components <= ECS_MAX_QUERY_COMPONENTS && method) {
+        u64 query_mask = 0;
+        EcsComponent driver = components[0];
+        for (u32 i = 0; i < n_components; i++) {
+            if (!ecs_component_is_valid (world, components[i])) return;
+
+            query_mask |= ecs_component_bit (components[i]);
+            if (world->pools[components[i]]->count < world->pools[driver]->count)
+                driver = components[i];
+        }
+
+        EcsIter it;
+        it.world = world;
+        memcpy (it.components, components, n_components * sizeof (EcsComponent));
+        it.n_components = n_components;
+        it.mask = query_mask;
+        it.count = 0;
+        it.args = args;
+
+        world->iterating += 1;
+
+        EcsPool *pool = world->pools[driver];
+        for (u32 row = 0; row < pool->count; row++) {
+            Entity entity = pool->entities[row];
+            u32 index = ecs_entity_index (entity);
+            if ((world->masks[index] & query_mask) != query_mask) continue;
+
+            it.entities[it.count] = entity;
+            for (u32 i = 0; i < n_components; i++) {
+                it.rows[i][it.count] = components[i] == driver ?
+                    row : world->pools[components[i]]->sparse[index];
+            }
+
+            it.count += 1;
+            if (it.count == ECS_ITER_BATCH) {
+                method (&it);
+                it.count = 0;
+            }
+        }
+
+        if (it.count) method (&it);
+
+        world->iterating -= 1;
+        if (!world->iterating) ecs_world_apply_deferred (world);
+    }
+
+}
+
+#pragma endregion
+
+#pragma region systems
+
+// registers a method that will be called with the entities that have all of the components
+// every time the systems run
+// returns 0 on success, 1 on error
+u8 ecs_system_register (EcsWorld *world,
+    const EcsComponent *components, u32 n_components,
+    void (*method)(EcsIter *it), void *args) {
+
+    u8 retval = 1;
+
+    if (world && components && n_components > 0
+        && n_components <= ECS_MAX_QUERY_COMPONENTS && method) {
+        if (world->n_systems >= world->max_systems) {
+            u32 new_max = world->max_systems ? world->max_systems * 2 : 8;
+            EcsSystem *new_systems = (EcsSystem *) realloc (world->systems, new_max * sizeof (EcsSystem));
+            if (new_systems) {
+                world->systems = new_systems;
+                world->max_systems = new_max;
+            }
+        }
+
+        if (world->n_systems < world->max_systems) {
+            EcsSystem *system = &world->systems[world->n_systems];
+            memcpy (system->components, components, n_components * sizeof (EcsComponent));
+            system->n_components = n_components;
+            system->method = method;
+            system->args = args;
+
+            world->n_systems += 1;
+
+            retval = 0;
+        }
+    }
+
+    return retval;
+
+}
+
+// runs every registered system in the order they were registered
+void ecs_world_run_systems (EcsWorld *world) {
+
+    if (world) {
+        for (u32 i = 0; i < world->n_systems; i++) {
+            EcsSystem *system = &world->systems[i];
+            ecs_query_each (world, system->components, system->n_components,
+                system->method, system->args);
+        }
+    }
+
+}
+
+#pragma endregion
@@ -8,6 +8,7 @@
 #include "cengine/animation.h"
 
 #include "cengine/game/go.h"
+#include "cengine/game/ecs.h"
 #include "cengine/game/components/graphics.h"
 #include "cengine/game/components/transform.h"
 #include "cengine/game/components/collider.h"
@@ -17,6 +18,15 @@ u32 max_gos = 0;
 u32 curr_max_objs = 0;
 u32 new_go_id = 0;
 
+// ids of destroyed game objects that can be used again
+static u32 *free_gos = NULL;
+static u32 n_free_gos = 0;
+
+EcsWorld *game_world = NULL;
+EcsComponent game_transform_comp = ECS_INVALID_COMPONENT;
+EcsComponent game_graphics_comp = ECS_INVALID_COMPONENT;
+EcsComponent game_animator_comp = ECS_INVALID_COMPONENT;
+
 static Layer *default_layer = NULL;
 
 static DoubleList *user_components;        // user defined components
@@ -26,8 +36,9 @@ static bool game_objects_realloc (void) {
     u32 new_max_gos = curr_max_objs * 2;
 
     gameObjects = (GameObject **) realloc (gameObjects, new_max_gos * sizeof (GameObject *));
+    free_gos = (u32 *) realloc (free_gos, new_max_gos * sizeof (u32));
 
-    if (gameObjects) {
+    if (gameObjects && free_gos) {
         max_gos = new_max_gos;
         return true;
     }
@@ -137,6 +148,10 @@ int game_object_remove_from_tag (GameObject *go, const char *tag_name) {
 
 void user_component_delete (void *ptr);
 
+static void game_graphics_destroy (void *graphics_ptr) { graphics_destroy (*(Graphics **) graphics_ptr); }
+
+static void game_animator_destroy (void *animator_ptr) { animator_destroy (*(Animator **) animator_ptr); }
+
 // init our game objects array
 u8 game_objects_init_all (void) {
 
@@ -145,12 +160,22 @@ u8 game_objects_init_all (void) {
     default_layer = layer_get_by_name (gos_layers, "default");
 
     gameObjects = (GameObject **) calloc (DEFAULT_MAX_GOS, sizeof (GameObject *));
-    if (gameObjects) {
+    free_gos = (u32 *) calloc (DEFAULT_MAX_GOS, sizeof (u32));
+    game_world = ecs_world_create ();
+    if (gameObjects && free_gos && game_world) {
         for (u32 i = 0; i < DEFAULT_MAX_GOS; i++) gameObjects[i] = NULL;
 
         max_gos = DEFAULT_MAX_GOS;
         curr_max_objs = 0;
         new_go_id = 0;
+        n_free_gos = 0;
+
+        const size_t transform_columns[2] = { sizeof (float), sizeof (float) };
+        game_transform_comp = ecs_component_register (game_world, transform_columns, 2, NULL);
+
+        const size_t ptr_column[1] = { sizeof (void *) };
+        game_graphics_comp = ecs_component_register (game_world, ptr_column, 1, game_graphics_destroy);
+        game_animator_comp = ecs_component_register (game_world, ptr_column, 1, game_animator_destroy);
 
         tags = dlist_init (game_object_tag_delete, NULL);   // init gos tags
 
@@ -166,9 +191,10 @@ u8 game_objects_init_all (void) {
 
 static i32 game_object_get_free_spot (void) {
 
-    for (u32 i = 0; i < curr_max_objs; i++)
-        if (gameObjects[i]->id == -1)
-            return i;
+    if (n_free_gos) {
+        n_free_gos -= 1;
+        return (i32) free_gos[n_free_gos];
+    }
 
     return -1;
 
@@ -178,6 +204,7 @@ static void game_object_init (GameObject *go, u32 id, const char *name, const ch
 
     if (go) {
         go->id = id;
+        go->entity = ecs_entity_create (game_world);
         go->name = name ? str_new (name) : NULL;
         if (tag) {
             if (!game_object_add_to_tag (go, tag))
@@ -190,7 +217,8 @@ static void game_object_init (GameObject *go, u32 id, const char *name, const ch
 
         go->children = NULL;
 
-        go->update = NULL;
+        go->transform.go_id = id;
+        go->transform.entity = go->entity;
 
         go->user_components = dlist_init (user_component_delete, NULL);
 
@@ -285,9 +313,16 @@ GameObject *game_object_get_by_id (u32 id) {
 // mark as inactive or reusable the game object
 void game_object_destroy (GameObject *go) {
 
-    if (go) {
+    if (go && go->id != -1) {
+        free_gos[n_free_gos] = go->id;
+        n_free_gos += 1;
+
         go->id = -1;
-        go->update = NULL;
+
+        // the graphics & the animator are deleted with the entity components
+        ecs_entity_destroy (game_world, go->entity);
+        go->entity = ECS_NULL_ENTITY;
+        for (u8 i = 0; i < COMP_COUNT; i++) go->components[i] = NULL;
 
         if (go->name) str_delete (go->name);
         if (go->tag) {
@@ -299,11 +334,6 @@ void game_object_destroy (GameObject *go) {
 
         layer_remove_element (default_layer, go);
 
-        // individually destroy each component
-        transform_destroy ((Transform *) go->components[TRANSFORM_COMP]);
-        graphics_destroy ((Graphics *) go->components[GRAPHICS_COMP]);
-        animator_destroy ((Animator *) go->components[ANIMATOR_COMP]);
-
         // destroy user defined components
         dlist_delete (go->user_components);
     }
@@ -312,23 +342,20 @@ void game_object_destroy (GameObject *go) {
 
 void game_object_destroy_ref (void *data) { game_object_destroy ((GameObject *) data); } 
 
+// its components are deleted with the game world
 static void game_object_delete (GameObject *go) {
 
     if (go) {
-        go->update = NULL;
+        // the destroyed ones have already released the rest
+        if (go->id != -1) {
+            // destroy user defined components
+            dlist_delete (go->user_components);
 
-        // individually destroy each component
-        transform_destroy ((Transform *) go->components[TRANSFORM_COMP]);
-        graphics_destroy ((Graphics *) go->components[GRAPHICS_COMP]);
-        animator_destroy ((Animator *) go->components[ANIMATOR_COMP]);
-
-        // destroy user defined components
-        dlist_delete (go->user_components);
-
-        layer_remove_element (go->layer, go);
+            layer_remove_element (go->layer, go);
 
-        str_delete (go->name);
-        str_delete (go->tag);
+            str_delete (go->name);
+            str_delete (go->tag);
+        }
 
         free (go);
     }
@@ -396,41 +423,73 @@ void game_object_destroy_all (void) {
             game_object_delete (gameObjects[i]);
 
     free (gameObjects);
+    gameObjects = NULL;
+
+    free (free_gos);
+    free_gos = NULL;
+    n_free_gos = 0;
+
+    ecs_world_delete (game_world);
+    game_world = NULL;
+    game_transform_comp = ECS_INVALID_COMPONENT;
+    game_graphics_comp = ECS_INVALID_COMPONENT;
+    game_animator_comp = ECS_INVALID_COMPONENT;
 
 }
 
-// update every game object
+// updates the game objects by running the game world systems,
+// the user components updates are systems of the components that they belong to
 void game_object_update_all (void) {
-     
-    for (u32 i = 0; i < curr_max_objs; i++) {
-        if (gameObjects[i]->id != -1) {
-            if (gameObjects[i]->update)
-                gameObjects[i]->update (gameObjects[i]);
-        }
-    }
+
+    ecs_world_run_systems (game_world);
 
 }
 
 /*** Components ***/
 
+// the graphics & the animator are stored by reference in their pools, so their pointers do not move
+// returns true if the entity now has the component with the ptr
+static bool game_object_add_ptr_component (GameObject *go, EcsComponent component, void *ptr) {
+
+    if (ptr && !ecs_add (game_world, go->entity, component)) {
+        *(void **) ecs_get (game_world, go->entity, component, 0) = ptr;
+        return true;
+    }
+
+    return false;
+
+}
+
+// returns the component that the game object already had if it is added again
 void *game_object_add_component (GameObject *go, GameComponent component) {
 
     void *retval = NULL;
 
     if (go) {
-        switch (component) {
-            case TRANSFORM_COMP: 
-                retval = go->components[component] = transform_new (go->id); 
-                break;
-            case GRAPHICS_COMP: 
-                retval = go->components[component] = graphics_new (go->id); 
-                break;
-            case ANIMATOR_COMP: 
-                retval = go->components[component] = animator_new (go->id); 
-                break;
-
-            default: break;
+        if (!go->components[component]) {
+            switch (component) {
+                case TRANSFORM_COMP: 
+                    if (!ecs_add (game_world, go->entity, game_transform_comp))
+                        go->components[component] = &go->transform;
+                    break;
+                case GRAPHICS_COMP: {
+                    Graphics *graphics = graphics_new (go->id);
+                    if (game_object_add_ptr_component (go, game_graphics_comp, graphics))
+                        go->components[component] = graphics;
+                    else graphics_destroy (graphics);
+                } break;
+                case ANIMATOR_COMP: {
+                    Animator *animator = animator_new (go->id);
+                    if (game_object_add_ptr_component (go, game_animator_comp, animator))
+                        go->components[component] = animator;
+                    else animator_destroy (animator);
+                } break;
+
+                default: break;
+            }
         }
+
+        retval = go->components[component];
     }
 
     return retval;
@@ -448,17 +507,19 @@ void game_object_remove_component (GameObject *go, GameComponent component) {
     if (go) {
         switch (component) {
             case TRANSFORM_COMP: 
-                transform_destroy ((Transform *) go->components[component]); 
+                ecs_remove (game_world, go->entity, game_transform_comp); 
                 break;
             case GRAPHICS_COMP: 
-                graphics_destroy ((Graphics *) go->components[component]);
+                ecs_remove (game_world, go->entity, game_graphics_comp);
                 break;
             case ANIMATOR_COMP: 
-                animator_destroy ((Animator *) go->components[component]);
+                ecs_remove (game_world, go->entity, game_animator_comp);
                 break;
 
             default: break;
         }
+
+        go->components[component] = NULL;
     }
 
 }
@@ -476,6 +537,7 @@ UserComponent *user_component_new (const char *name,
         user_comp->add = add;
         user_comp->remove = remove;
         user_comp->update = update;
+        user_comp->ecs_component = ECS_INVALID_COMPONENT;
     }
 
     return user_comp;
@@ -496,14 +558,38 @@ void user_component_delete (void *ptr) {
 
 }
 
+// updates every game object that has the user component
+// the update can destroy game objects or add & remove their components,
+// so the ones that are no longer valid are skipped and the column is read again every time
+static void user_component_system (EcsIter *it) {
+
+    UserComponent *user_comp = (UserComponent *) it->args;
+
+    for (u32 i = 0; i < it->count; i++) {
+        if (ecs_iter_valid (it, i)) {
+            GameObject **gos = (GameObject **) ecs_iter_column (it, 0, 0);
+            user_comp->update (gos[it->rows[0][i]]);
+        }
+    }
+
+}
+
 // registers a new user component, returns 0 on success, 1 on error
 int user_component_register (UserComponent *user_comp) {
 
     int retval = 1;
 
-    if (user_comp) {
-        retval = dlist_insert_after (user_components, 
-            dlist_end (user_components), user_comp) == true ? 0 : 1;
+    // the game world is created with the game objects
+    if (user_comp && game_world) {
+        const size_t go_column[1] = { sizeof (GameObject *) };
+        user_comp->ecs_component = ecs_component_register (game_world, go_column, 1, NULL);
+        if (user_comp->ecs_component != ECS_INVALID_COMPONENT) {
+            if (!user_comp->update || !ecs_system_register (game_world, 
+                &user_comp->ecs_component, 1, user_component_system, user_comp)) {
+                retval = dlist_insert_after (user_components, 
+                    dlist_end (user_components), user_comp);
+            }
+        }
     }
 
     return retval;
@@ -534,14 +620,15 @@ void *game_object_add_user_component (GameObject *go, const char *component_name
     if (go && component_name) {
         // get the component by name
         UserComponent *user_comp = user_component_get (user_components, component_name);
-        if (user_comp) {
+        if (user_comp && !ecs_add (game_world, go->entity, user_comp->ecs_component)) {
+            *(GameObject **) ecs_get (game_world, go->entity, user_comp->ecs_component, 0) = go;
+
             // add the component to the game object
             UserComponent *new_comp = user_component_new (user_comp->name->str, 
                 user_comp->add, user_comp->remove, user_comp->update);
+            new_comp->ecs_component = user_comp->ecs_component;
             retval = new_comp->component = new_comp->add (go->id);
 
-            go->update = new_comp->update;
-
             // add the new user component to the game object
             dlist_insert_after (go->user_components, dlist_end (go->user_components), new_comp);
         }
@@ -562,9 +649,11 @@ void game_object_user_component_remove (GameObject *go, const char *name) {
     if (go && name) {
         ListElement *le = NULL;
         UserComponent *user_comp = NULL;
-        for (le = dlist_start (user_components); le; le = le->next) {
+        for (le = dlist_start (go->user_components); le; le = le->next) {
             user_comp = (UserComponent *) le->data;
             if (!strcmp (name, user_comp->name->str)) {
+                ecs_remove (game_world, go->entity, user_comp->ecs_component);
+
                 dlist_remove_element (go->user_components, le);
                 user_component_delete (user_comp);
                 break;
@@ -0,0 +1,475 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include "cengine/types/types.h"
+#include "cengine/types/string.h"
+
+#include "cengine/collections/hashmap.h"
+
+#include "cengine/archive.h"
+#include "cengine/cengine.h"
+#include "cengine/files.h"
+#include "cengine/graphics.h"
+#include "cengine/loader.h"
+#include "cengine/renderer.h"
+#include "cengine/texcache.h"
+
+#include "cengine/threads/jobs.h"
+
+#include "cengine/utils/log.h"
+#include "cengine/utils/utils.h"
+
+typedef struct AssetLoad {
+
+    AssetLoadHandle handle;
+    AssetLoadStatus status;
+    AssetLoadPriority priority;
+
+    // set when it is cancelled while an io worker is decoding it
+    bool cancelled;
+
+    String *filename;
+    Renderer *renderer;
+    u32 format;                     // the io worker can not ask the renderer, it may be deleted
+
+    SDL_Surface *surface;
+
+    AssetLoadCallback callback;
+    void *args;
+
+    struct AssetLoad *next;
+
+} AssetLoad;
+
+typedef struct AssetLoadQueue {
+
+    AssetLoad *head;
+    AssetLoad *tail;
+
+} AssetLoadQueue;
+
+// every load is in the map & in only one of the queues, everything is protected by the loader mutex
+static pthread_mutex_t loader_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static HashMap *loads = NULL;                                   // handle -> load
+static AssetLoadHandle next_handle = 1;
+
+static AssetLoadQueue pending[ASSET_LOAD_PRIORITIES];           // waiting to be decoded
+static AssetLoadQueue decoded[ASSET_LOAD_PRIORITIES];           // waiting to be uploaded
+static AssetLoad *decoding = NULL;
+
+#pragma region Load
+
+static AssetLoad *asset_load_new (Renderer *renderer, const char *filename,
+    AssetLoadPriority priority, AssetLoadCallback callback, void *args) {
+
+    AssetLoad *load = (AssetLoad *) malloc (sizeof (AssetLoad));
+    if (load) {
+        memset (load, 0, sizeof (AssetLoad));
+
+        load->status = ASSET_LOAD_PENDING;
+        load->priority = priority;
+
+        load->filename = str_new (filename);
+        load->renderer = renderer;
+        load->format = texcache_get_format (renderer);
+
+        load->surface = NULL;
+
+        load->callback = callback;
+        load->args = args;
+
+        load->next = NULL;
+    }
+
+    return load;
+
+}
+
+static void asset_load_delete (void *load_ptr) {
+
+    if (load_ptr) {
+        AssetLoad *load = (AssetLoad *) load_ptr;
+
+        str_delete (load->filename);
+        if (load->surface) SDL_FreeSurface (load->surface);
+
+        free (load);
+    }
+
+}
+
+#pragma endregion
+
+#pragma region Queues
+
+static void asset_load_queue_push (AssetLoadQueue *queue, AssetLoad *load) {
+
+    load->next = NULL;
+
+    if (queue->tail) queue->tail->next = load;
+    else queue->head = load;
+
+    queue->tail = load;
+
+}
+
+// removes the load that is after prev, or the head if prev is NULL
+static void asset_load_queue_remove (AssetLoadQueue *queue, AssetLoad *prev, AssetLoad *load) {
+
+    if (prev) prev->next = load->next;
+    else queue->head = load->next;
+
+    if (queue->tail == load) queue->tail = prev;
+
+    load->next = NULL;
+
+}
+
+// removes the first load of the renderer from the queues, from the highest priority to the lowest
+// pass NULL as the renderer to get the first load of any renderer
+static AssetLoad *asset_load_queues_pop (AssetLoadQueue *queues, Renderer *renderer) {
+
+    for (int p = ASSET_LOAD_PRIORITIES - 1; p >= 0; p--) {
+        AssetLoad *prev = NULL;
+        for (AssetLoad *load = queues[p].head; load; prev = load, load = load->next) {
+            if (!renderer || (load->renderer == renderer)) {
+                asset_load_queue_remove (&queues[p], prev, load);
+                return load;
+            }
+        }
+    }
+
+    return NULL;
+
+}
+
+// removes the load from the queue where it is, if it is there
+static bool asset_load_queue_take (AssetLoadQueue *queue, AssetLoad *load) {
+
+    AssetLoad *prev = NULL;
+    for (AssetLoad *l = queue->head; l; prev = l, l = l->next) {
+        if (l == load) {
+            asset_load_queue_remove (queue, prev, load);
+            return true;
+        }
+    }
+
+    return false;
+
+}
+
+static void asset_load_decoding_remove (AssetLoad *load) {
+
+    AssetLoad **l = &decoding;
+    while (*l && (*l != load)) l = &(*l)->next;
+    if (*l) *l = load->next;
+
+    load->next = NULL;
+
+}
+
+#pragma endregion
+
+#pragma region Decode
+
+// reads the whole file & decodes it, so the render thread only needs to create the texture
+static SDL_Surface *asset_load_decode_file (const char *filename, u32 format) {
+
+    SDL_Surface *surface = NULL;
+
+    // files in a mounted archive are decoded straight from the mapped memory
+    SDL_RWops *rw = archives_open_rw (filename);
+    if (rw) surface = IMG_Load_RW (rw, 1);
+
+    // the decoded image is copied from its entry, it is decoded only if the entry is not valid
+    else if (texcache_is_enabled ()) surface = texcache_load_surface (filename, format, true);
+
+    else {
+        int file_size = 0;
+        char *file_contents = file_read (filename, &file_size);
+        if (file_contents) {
+            rw = SDL_RWFromConstMem (file_contents, file_size);
+            if (rw) surface = IMG_Load_RW (rw, 1);
+
+            free (file_contents);
+        }
+    }
+
+    // convert it now to the format of the renderer, instead of in the render thread
+    if (surface && (surface->format->format != format)) {
+        SDL_Surface *converted = SDL_ConvertSurfaceFormat (surface, format, 0);
+        if (converted) {
+            SDL_FreeSurface (surface);
+            surface = converted;
+        }
+    }
+
+    if (!surface) {
+        cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+            c_string_create ("Failed to load asset: %s!", filename));
+    }
+
+    return surface;
+
+}
+
+// runs in an io worker, every submitted job decodes the most important pending load,
+// that may not be the one that submitted it
+static void asset_load_decode (void *args) {
+
+    pthread_mutex_lock (&loader_mutex);
+
+    AssetLoad *load = asset_load_queues_pop (pending, NULL);
+    if (load) {
+        load->status = ASSET_LOAD_DECODING;
+        load->next = decoding;
+        decoding = load;
+    }
+
+    pthread_mutex_unlock (&loader_mutex);
+
+    if (load) {
+        SDL_Surface *surface = asset_load_decode_file (load->filename->str, load->format);
+
+        pthread_mutex_lock (&loader_mutex);
+
+        asset_load_decoding_remove (load);
+
+        bool cancelled = load->cancelled;
+        if (!cancelled) {
+            // a load that failed still goes to the render thread to call its callback
+            load->surface = surface;
+            load->status = ASSET_LOAD_UPLOADING;
+            asset_load_queue_push (&decoded[load->priority], load);
+        }
+
+        pthread_mutex_unlock (&loader_mutex);
+
+        if (cancelled) {
+            if (surface) SDL_FreeSurface (surface);
+            asset_load_delete (load);
+        }
+    }
+
+}
+
+#pragma endregion
+
+#pragma region Public
+
+AssetLoadHandle asset_load_texture (Renderer *renderer, const char *filename,
+    AssetLoadPriority priority, AssetLoadCallback callback, void *args) {
+
+    AssetLoadHandle handle = 0;
+
+    if (renderer && filename && callback && (priority < ASSET_LOAD_PRIORITIES)) {
+        AssetLoad *load = asset_load_new (renderer, filename, priority, callback, args);
+        if (load) {
+            pthread_mutex_lock (&loader_mutex);
+
+            if (!loads) loads = hashmap_create (0, NULL);
+
+            load->handle = next_handle;
+            next_handle += 1;
+            if (!next_handle) next_handle = 1;
+
+            if (loads && !hashmap_insert (loads, &load->handle, sizeof (AssetLoadHandle), load, sizeof (AssetLoad))) {
+                asset_load_queue_push (&pending[priority], load);
+                handle = load->handle;
+            }
+
+            pthread_mutex_unlock (&loader_mutex);
+
+            if (handle) {
+                if (job_submit (JOB_AFFINITY_IO, asset_load_decode, NULL, NULL)) {
+                    cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+                        c_string_create ("Failed to submit load of %s!", filename));
+                    asset_load_cancel (handle);
+                    handle = 0;
+                }
+            }
+
+            else asset_load_delete (load);
+        }
+    }
+
+    return handle;
+
+}
+
+AssetLoadStatus asset_load_status (AssetLoadHandle handle) {
+
+    AssetLoadStatus status = ASSET_LOAD_NONE;
+
+    pthread_mutex_lock (&loader_mutex);
+
+    if (loads) {
+        AssetLoad *load = (AssetLoad *) hashmap_get (loads, &handle, sizeof (AssetLoadHandle));
+        if (load) status = load->status;
+    }
+
+    pthread_mutex_unlock (&loader_mutex);
+
+    return status;
+
+}
+
+// removes the load from the map and from its queue, the loader mutex must be locked
+// returns the load if it can be deleted now, NULL if an io worker is still decoding it
+static AssetLoad *asset_load_cancel_internal (AssetLoad *load) {
+
+    hashmap_remove (loads, &load->handle, sizeof (AssetLoadHandle));
+
+    switch (load->status) {
+        case ASSET_LOAD_PENDING: asset_load_queue_take (&pending[load->priority], load); break;
+        case ASSET_LOAD_UPLOADING: asset_load_queue_take (&decoded[load->priority], load); break;
+
+        // the io worker deletes it when it ends
+        case ASSET_LOAD_DECODING:
+            load->cancelled = true;
+            load = NULL;
+            break;
+
+        default: break;
+    }
+
+    return load;
+
+}
+
+u8 asset_load_cancel (AssetLoadHandle handle) {
+
+    u8 retval = 1;
+
+    AssetLoad *load = NULL;
+
+    pthread_mutex_lock (&loader_mutex);
+
+    if (loads) {
+        load = (AssetLoad *) hashmap_get (loads, &handle, sizeof (AssetLoadHandle));
+        if (load) {
+            load = asset_load_cancel_internal (load);
+            retval = 0;
+        }
+    }
+
+    pthread_mutex_unlock (&loader_mutex);
+
+    asset_load_delete (load);
+
+    return retval;
+
+}
+
+void asset_load_cancel_all (Renderer *renderer) {
+
+    if (renderer) {
+        AssetLoad *cancelled = NULL;
+
+        pthread_mutex_lock (&loader_mutex);
+
+        if (loads) {
+            AssetLoad *load = NULL;
+            while ((load = asset_load_queues_pop (pending, renderer))) {
+                load->next = cancelled;
+                cancelled = load;
+            }
+
+            while ((load = asset_load_queues_pop (decoded, renderer))) {
+                load->next = cancelled;
+                cancelled = load;
+            }
+
+            for (load = cancelled; load; load = load->next)
+                hashmap_remove (loads, &load->handle, sizeof (AssetLoadHandle));
+
+            for (load = decoding; load; load = load->next) {
+                if (load->renderer == renderer && !load->cancelled) {
+                    hashmap_remove (loads, &load->handle, sizeof (AssetLoadHandle));
+                    load->cancelled = true;
+                }
+            }
+        }
+
+        pthread_mutex_unlock (&loader_mutex);
+
+        while (cancelled) {
+            AssetLoad *next = cancelled->next;
+            asset_load_delete (cancelled);
+            cancelled = next;
+        }
+    }
+
+}
+
+u32 asset_loader_upload (Renderer *renderer, u64 deadline) {
+
+    u32 count = 0;
+
+    if (renderer) {
+        bool done = false;
+        while (!done) {
+            pthread_mutex_lock (&loader_mutex);
+
+            AssetLoad *load = loads ? asset_load_queues_pop (decoded, renderer) : NULL;
+            if (load) hashmap_remove (loads, &load->handle, sizeof (AssetLoadHandle));
+
+            pthread_mutex_unlock (&loader_mutex);
+
+            if (load) {
+                SDL_Texture *texture = NULL;
+                ImageData *img_data = NULL;
+                if (load->surface) {
+                    texture = SDL_CreateTextureFromSurface (renderer->renderer, load->surface);
+                    if (texture) {
+                        img_data = image_data_new (load->surface->w, load->surface->h,
+                            str_new (load->filename->str));
+                    }
+                }
+
+                load->callback (load->handle, texture, img_data, load->args);
+
+                asset_load_delete (load);
+
+                count++;
+                done = frame_clock_now () >= deadline;
+            }
+
+            else done = true;
+        }
+    }
+
+    return count;
+
+}
+
+void asset_loader_end (void) {
+
+    pthread_mutex_lock (&loader_mutex);
+
+    AssetLoad *load = NULL;
+    while ((load = asset_load_queues_pop (pending, NULL))) asset_load_delete (load);
+    while ((load = asset_load_queues_pop (decoded, NULL))) asset_load_delete (load);
+
+    // the io workers have been joined, so nothing is being decoded anymore
+    while (decoding) {
+        load = decoding;
+        decoding = load->next;
+        asset_load_delete (load);
+    }
+
+    hashmap_delete (loads);
+    loads = NULL;
+
+    pthread_mutex_unlock (&loader_mutex);
+
+}
+
+#pragma endregion
@@ -12,8 +12,12 @@
 #include "cengine/types/string.h"
 
 #include "cengine/collections/dlist.h"
-#include "cengine/collections/queue.h"
+#include "cengine/collections/ring.h"
 
+#include "cengine/atlas.h"
+#include "cengine/cengine.h"
+#include "cengine/files.h"
+#include "cengine/loader.h"
 #include "cengine/renderer.h"
 #include "cengine/window.h"
 #include "cengine/textures.h"
@@ -31,31 +35,25 @@
 
 static u64 next_renderer_id = 0;
 
-SurfaceTexture *surface_texture_new (SDL_Surface *surface, SDL_Texture **texture, bool update) {
-
-    SurfaceTexture *st = (SurfaceTexture *) malloc (sizeof (SurfaceTexture));
-    if (st) {
-        st->surface = surface;
-        st->texture = texture;
-        st->update = update;
-    }
-
-    return st;
-
-}
-
-void surface_texture_delete (void *st_ptr) {
+// frees the surface of a surface texture that will not be loaded
+void surface_texture_clear (void *st_ptr) {
 
     if (st_ptr) {
         SurfaceTexture *st = (SurfaceTexture *) st_ptr;
         if (st->surface) SDL_FreeSurface (st->surface);
+        st->surface = NULL;
         st->texture = NULL;
-
-        free (st);
     }
 
 }
 
+// the destroy queue holds texture pointers, so we get a pointer to one
+static void renderer_destroy_queue_texture_delete (void *texture_ptr) {
+
+    if (texture_ptr) SDL_DestroyTexture (*(SDL_Texture **) texture_ptr);
+
+}
+
 #pragma region Renderer
 
 DoubleList *renderers = NULL;
@@ -79,6 +77,10 @@ static Renderer *renderer_new (void) {
 
         renderer->ui = NULL;
 
+        renderer->atlas = NULL;
+
+        renderer->batch = NULL;
+
         renderer->update = NULL;
         renderer->update_args = NULL;
     }
@@ -93,15 +95,28 @@ void renderer_delete (void *ptr) {
         Renderer *renderer = (Renderer *) ptr;
 
         str_delete (renderer->name);
-        if (renderer->renderer) SDL_DestroyRenderer (renderer->renderer);
 
+        // 18/10/2026 -- the ui layers may hold textures, so destroy them first
+        ui_delete (renderer->ui);
+        renderer->ui = NULL;
+
+        // pending textures are destroyed while we still have the SDL renderer
         if (renderer->load_textures_queue)
-            queue_delete (renderer->load_textures_queue);
+            ring_delete (renderer->load_textures_queue);
 
         if (renderer->destroy_textures_queue)
-            queue_delete (renderer->destroy_textures_queue);
+            ring_delete (renderer->destroy_textures_queue);
 
-        ui_delete (renderer->ui);
+        // no more textures can be created for it
+        asset_load_cancel_all (renderer);
+
+        // the atlas pages textures belong to the SDL renderer
+        atlas_delete (renderer->atlas);
+        renderer->atlas = NULL;
+
+        if (renderer->renderer) SDL_DestroyRenderer (renderer->renderer);
+
+        render_batch_delete (renderer->batch);
 
         free (renderer);
     }
@@ -154,14 +169,19 @@ Renderer *renderer_create_empty (const char *name, int display_idx) {
         renderer->name = name ? str_new (name) : NULL;
         // renderer->display_index = display_idx;
 
-        renderer->load_textures_queue = queue_create (surface_texture_delete);
+        renderer->load_textures_queue = ring_create (DEFAULT_TEXTURES_QUEUE_CAPACITY, sizeof (SurfaceTexture), 
+            DEFAULT_TEXTURES_QUEUE_POLICY, surface_texture_clear);
         renderer->bg_loading_factor = DEFAULT_BG_LOADING_FACTOR;
+        renderer->bg_loading_budget = DEFAULT_BG_LOADING_BUDGET;
 
-        renderer->destroy_textures_queue = queue_create (texture_destroy_wrapper);
+        renderer->destroy_textures_queue = ring_create (DEFAULT_TEXTURES_QUEUE_CAPACITY, sizeof (SDL_Texture *), 
+            DEFAULT_TEXTURES_QUEUE_POLICY, renderer_destroy_queue_texture_delete);
         renderer->bg_destroying_factor = DEFAULT_BG_DESTROYING_FACTOR;
 
         renderer->ui = ui_create ();
 
+        renderer->batch = render_batch_new ();
+
         dlist_insert_after (renderers, dlist_end (renderers), renderer);
     }
 
@@ -236,11 +256,17 @@ int renderer_window_attach (Renderer *renderer, Uint32 render_flags, int display
 
 }
 
-void renderer_load_queue_push (Renderer *renderer, SurfaceTexture *st) {
-
-    if (renderer) {
-        if (renderer->load_textures_queue) {
-            queue_push (renderer->load_textures_queue, st);
+// sends a surface to be loaded into the texture by the render thread
+// if update is true, the texture gets updated instead of created
+// the surface is freed by the renderer
+void renderer_load_queue_push (Renderer *renderer, 
+    SDL_Surface *surface, SDL_Texture **texture, bool update) {
+
+    if (renderer && surface && texture) {
+        SurfaceTexture st = { .surface = surface, .texture = texture, .update = update };
+        if (ring_push (renderer->load_textures_queue, &st)) {
+            cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to push surface to renderer's load queue!");
+            surface_texture_clear (&st);
         }
     }
 
@@ -248,12 +274,84 @@ void renderer_load_queue_push (Renderer *renderer, SurfaceTexture *st) {
 
 void renderer_destroy_queue_push (Renderer *renderer, SDL_Texture *texture) {
 
-    if (renderer) {
-        if (renderer->destroy_textures_queue) {
-            queue_push (renderer->destroy_textures_queue, texture);
+    if (renderer && texture) {
+        if (ring_push (renderer->destroy_textures_queue, &texture)) {
+            cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to push texture to renderer's destroy queue!");
+        }
+    }
+
+}
+
+// moves the elements of the old queue into a new one with the requested values
+// the new queue must have space for all of them, as its policy could drop them or block forever,
+// returns NULL on error and the old queue is kept as it was
+static Ring *renderer_queue_replace (Ring *old_queue, size_t capacity, RingPolicy policy, 
+    size_t element_size, void (*destroy)(void *element)) {
+
+    Ring *new_queue = ring_create (capacity, element_size, policy, destroy);
+    if (new_queue && old_queue) {
+        if (ring_size (old_queue) <= ring_capacity (new_queue)) {
+            unsigned char element[element_size];
+            while (!ring_pop (old_queue, element)) {
+                if (ring_push (new_queue, element)) {
+                    cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to move element to renderer's new queue!");
+                    if (destroy) destroy (element);
+                }
+            }
+
+            ring_delete (old_queue);
+        }
+
+        else {
+            cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Renderer's queue has more elements than the new capacity!");
+            ring_delete (new_queue);
+            new_queue = NULL;
+        }
+    }
+
+    return new_queue;
+
+}
+
+// sets the capacity and what to do when the textures load queue gets full,
+// call it right after creating the renderer, before other threads can load textures
+// returns 0 on success, 1 on error or if the queue already has more textures than the capacity
+int renderer_set_load_queue (Renderer *renderer, size_t capacity, RingPolicy policy) {
+
+    int retval = 1;
+
+    if (renderer && capacity) {
+        Ring *queue = renderer_queue_replace (renderer->load_textures_queue, capacity, policy,
+            sizeof (SurfaceTexture), surface_texture_clear);
+        if (queue) {
+            renderer->load_textures_queue = queue;
+            retval = 0;
         }
     }
 
+    return retval;
+
+}
+
+// sets the capacity and what to do when the textures destroy queue gets full,
+// textures can only be destroyed in the render thread, so RING_POLICY_DROP_OLDEST is not allowed
+// call it right after creating the renderer, before other threads can destroy textures
+// returns 0 on success, 1 on error or if the queue already has more textures than the capacity
+int renderer_set_destroy_queue (Renderer *renderer, size_t capacity, RingPolicy policy) {
+
+    int retval = 1;
+
+    if (renderer && capacity && (policy != RING_POLICY_DROP_OLDEST)) {
+        Ring *queue = renderer_queue_replace (renderer->destroy_textures_queue, capacity, policy,
+            sizeof (SDL_Texture *), renderer_destroy_queue_texture_delete);
+        if (queue) {
+            renderer->destroy_textures_queue = queue;
+            retval = 0;
+        }
+    }
+
+    return retval;
+
 }
 
 // sets how many textures the renderer can create in the background every loop
@@ -265,6 +363,14 @@ void renderer_set_background_texture_loading_factor (Renderer *renderer, u32 bg_
 
 }
 
+// sets the micro secs the renderer can spend every loop creating the textures that were loaded in the background,
+// after the ones of the loading factor, it keeps creating textures until the budget is used
+void renderer_set_background_texture_loading_budget (Renderer *renderer, u32 bg_loading_budget) {
+
+    if (renderer) renderer->bg_loading_budget = bg_loading_budget;
+
+}
+
 // sets how many textures the renderer can destroy in the background every loop
 void renderer_set_background_texture_destroying_factor (Renderer *renderer, u32 bg_destroying_factor) {
 
@@ -272,6 +378,22 @@ void renderer_set_background_texture_destroying_factor (Renderer *renderer, u32
 
 }
 
+// sets the atlas where sprite_load () and sprite_sheet_load () pack their images,
+// the renderer takes ownership of it and deletes it before destroying its SDL renderer
+// returns the previous atlas, that now belongs to the caller as its sprites may still be in use
+Atlas *renderer_set_atlas (Renderer *renderer, Atlas *atlas) {
+
+    Atlas *previous = NULL;
+
+    if (renderer) {
+        previous = renderer->atlas;
+        renderer->atlas = atlas;
+    }
+
+    return previous;
+
+}
+
 // sets an action to executed on every renderer update
 // you can use this if you want to perform action son ui elements, like checking for 
 // the current ui element under the mouse using the ui_element_hover in UI
@@ -288,6 +410,9 @@ void renderer_set_update (Renderer *renderer, Action update, void *update_args)
 void renderer_set_viewport (Renderer *renderer, u32 x, u32 y, u32 width, u32 height) {
 
     if (renderer) {
+        // commands recorded until now use the old viewport coordinates
+        renderer_batch_flush (renderer);
+
         memcpy (&renderer->previous_viewport, &renderer->current_viewport, sizeof (SDL_Rect));
 
         SDL_Rect viewport = { 
@@ -299,6 +424,18 @@ void renderer_set_viewport (Renderer *renderer, u32 x, u32 y, u32 width, u32 hei
 
         SDL_RenderSetViewport (renderer->renderer, &viewport);
 
+        // the clip rect is relative to the viewport, so keep it in place
+        if (renderer->clip) {
+            SDL_Rect clip = {
+                .x = renderer->clip_rect.x - viewport.x,
+                .y = renderer->clip_rect.y - viewport.y,
+                .w = renderer->clip_rect.w,
+                .h = renderer->clip_rect.h
+            };
+
+            SDL_RenderSetClipRect (renderer->renderer, &clip);
+        }
+
         // set the new viewport
         renderer->current_viewport.x = viewport.x;
         renderer->current_viewport.y = viewport.y;
@@ -337,6 +474,61 @@ void renderer_set_viewport_to_window_size (Renderer *renderer) {
 
 }
 
+// sets a clip rect in target coordinates that is kept across viewport changes
+// pass NULL to disable clipping
+void renderer_set_clip_rect (Renderer *renderer, const SDL_Rect *rect) {
+
+    if (renderer) {
+        renderer_batch_flush (renderer);
+
+        if (rect) {
+            memcpy (&renderer->clip_rect, rect, sizeof (SDL_Rect));
+            renderer->clip = true;
+
+            SDL_Rect clip = {
+                .x = rect->x - renderer->current_viewport.x,
+                .y = rect->y - renderer->current_viewport.y,
+                .w = rect->w,
+                .h = rect->h
+            };
+
+            SDL_RenderSetClipRect (renderer->renderer, &clip);
+        }
+
+        else {
+            renderer->clip = false;
+            SDL_RenderSetClipRect (renderer->renderer, NULL);
+        }
+    }
+
+}
+
+// returns the stats of the last rendered frame
+RenderFrameStats renderer_get_frame_stats (Renderer *renderer) {
+
+    RenderFrameStats stats = { 0 };
+    if (renderer) memcpy (&stats, &renderer->frame_stats, sizeof (RenderFrameStats));
+    return stats;
+
+}
+
+// returns the percentage (0 - 100) of the layers pixels that were redrawn in the last frame
+// non cached layers always count as fully redrawn
+float renderer_get_redrawn_percentage (Renderer *renderer) {
+
+    float retval = 0;
+
+    if (renderer) {
+        if (renderer->frame_stats.total_pixels > 0) {
+            retval = (float) ((double) renderer->frame_stats.redrawn_pixels * 100.0 
+                / (double) renderer->frame_stats.total_pixels);
+        }
+    }
+
+    return retval;
+
+}
+
 #pragma endregion
 
 #pragma region Layers
@@ -347,6 +539,8 @@ static Layer *layer_new (DoubleList *layers, const char *name, int pos, bool gos
 
     Layer *layer = (Layer *) malloc (sizeof (Layer));
     if (layer) {
+        memset (layer, 0, sizeof (Layer));
+
         if (name) layer->name = str_new (name);
         else layer->name = NULL;
 
@@ -387,6 +581,8 @@ static void layer_delete (void *ptr) {
         str_delete (layer->name);
         dlist_delete (layer->elements);
 
+        if (layer->cache) SDL_DestroyTexture (layer->cache);
+
         free (layer);
     }
 
@@ -521,6 +717,106 @@ int layer_remove_element_by_name (DoubleList *layers, const char *layer_name, vo
 
 }
 
+// enables or disables caching the layer into a render target texture
+// use it for layers with mostly static content, elements are only drawn again
+// when they are marked as dirty by their setters or using ui_element_set_dirty ()
+void layer_set_cached (Layer *layer, bool cached) {
+
+    if (layer) {
+        layer->cached = cached;
+        layer->dirty_all = true;
+        layer->n_dirty_rects = 0;
+
+        // the texture will be destroyed when the layer gets deleted
+        // or created again by layer_cache_prepare ()
+    }
+
+}
+
+// marks the whole layer to be drawn again in the next frame
+void layer_set_dirty (Layer *layer) {
+
+    if (layer) {
+        layer->dirty_all = true;
+        layer->n_dirty_rects = 0;
+    }
+
+}
+
+// marks a rect (in window coordinates) of the layer to be drawn again in the next frame
+void layer_add_dirty_rect (Layer *layer, const SDL_Rect *rect) {
+
+    if (layer && rect) {
+        if (layer->cached && !layer->dirty_all && rect->w > 0 && rect->h > 0) {
+            // merge it with a rect it touches to keep the list short
+            for (u32 i = 0; i < layer->n_dirty_rects; i++) {
+                if (SDL_HasIntersection (&layer->dirty_rects[i], rect)) {
+                    SDL_UnionRect (&layer->dirty_rects[i], rect, &layer->dirty_rects[i]);
+                    return;
+                }
+            }
+
+            if (layer->n_dirty_rects < LAYER_MAX_DIRTY_RECTS) {
+                memcpy (&layer->dirty_rects[layer->n_dirty_rects], rect, sizeof (SDL_Rect));
+                layer->n_dirty_rects += 1;
+            }
+
+            else {
+                // too many rects, just grow the last one
+                SDL_UnionRect (&layer->dirty_rects[LAYER_MAX_DIRTY_RECTS - 1], rect, 
+                    &layer->dirty_rects[LAYER_MAX_DIRTY_RECTS - 1]);
+            }
+        }
+    }
+
+}
+
+// makes sure the layer's cache texture exists and matches the renderer's size
+// returns 0 on success, 1 on error
+u8 layer_cache_prepare (Renderer *renderer, Layer *layer) {
+
+    u8 retval = 1;
+
+    if (renderer && layer && renderer->window) {
+        int width = (int) renderer->window->window_size.width;
+        int height = (int) renderer->window->window_size.height;
+
+        if (layer->cache && (layer->cache_width != width || layer->cache_height != height)) {
+            SDL_DestroyTexture (layer->cache);
+            layer->cache = NULL;
+        }
+
+        if (!layer->cache) {
+            layer->cache = SDL_CreateTexture (renderer->renderer, SDL_PIXELFORMAT_RGBA8888, 
+                SDL_TEXTUREACCESS_TARGET, width, height);
+            if (layer->cache) {
+                SDL_SetTextureBlendMode (layer->cache, SDL_BLENDMODE_BLEND);
+                layer->cache_width = width;
+                layer->cache_height = height;
+
+                layer->dirty_all = true;
+                layer->n_dirty_rects = 0;
+            }
+
+            #ifdef CENGINE_DEBUG
+            else {
+                char *status = c_string_create ("Failed to create cache texture for layer %s: %s",
+                    layer->name ? layer->name->str : "", SDL_GetError ());
+                if (status) {
+                    cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, status);
+                    free (status);
+                }
+            }
+            #endif
+        }
+
+        retval = layer->cache ? 0 : 1;
+    }
+
+    return retval;
+
+}
+
 // init the ui elements layers
 DoubleList *ui_layers_init (void) {
 
@@ -571,7 +867,7 @@ SDL_Surface *surface_create (int width, int height) {
 // loads an image into a new surface
 SDL_Surface *surface_load_image (const char *filename) {
 
-    return filename ? IMG_Load (filename) : NULL;
+    return filename ? IMG_Load_RW (file_open_rw (filename), 1) : NULL;
 
 }
 
@@ -582,11 +878,24 @@ void surface_delete (SDL_Surface *surface) { if (surface) SDL_FreeSurface (surfa
 
 #pragma region Basic
 
+// the basic draws go straight to SDL, so the quads that were recorded before them
+// are submitted first, otherwise the flush at the end of the frame would draw them on top
+static inline void render_basic_flush (Renderer *renderer) {
+
+    if (renderer->batch && renderer->batch->open) renderer_batch_flush (renderer);
+
+}
+
 // draws a pixel in currently set color
 // returns 0 on success, -1 on error
 int render_basic_pixel (Renderer *renderer, int x, int y) {
 
-    return renderer ? SDL_RenderDrawPoint (renderer->renderer, x, y) : -1;
+    if (renderer) {
+        render_basic_flush (renderer);
+        return SDL_RenderDrawPoint (renderer->renderer, x, y);
+    }
+
+    return -1;
 
 }
 
@@ -597,6 +906,8 @@ int render_basic_pixel_rgba (Renderer *renderer,
     u8 r, u8 g, u8 b, u8 a) {
 
     if (renderer) {
+        render_basic_flush (renderer);
+
         int result = 0;
         result |= SDL_SetRenderDrawBlendMode (renderer->renderer, (a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
         result |= SDL_SetRenderDrawColor (renderer->renderer, r, g, b, a);
@@ -629,6 +940,8 @@ void render_basic_dot (Renderer *renderer, int x, int y, SDL_Color color,
     float x_scale, float y_scale) {
 
     if (renderer) {
+        render_basic_flush (renderer);
+
         float original_scale_x = 0;
         float original_scale_y = 0;
 
@@ -649,6 +962,8 @@ void render_basic_dot_line_horizontal (Renderer *renderer, int start, int end, i
     float x_scale, float y_scale) {
 
     if (renderer) {
+        render_basic_flush (renderer);
+
         float original_scale_x = 0;
         float original_scale_y = 0;
 
@@ -671,6 +986,8 @@ void render_basic_dot_line_vertical (Renderer *renderer, int start, int end, int
     float x_scale, float y_scale) {
 
     if (renderer) {
+        render_basic_flush (renderer);
+
         float original_scale_x = 0;
         float original_scale_y = 0;
 
@@ -714,6 +1031,8 @@ int render_basic_box (Renderer *renderer, int x1, int y1, int x2, int y2, SDL_Co
         rect.w = x2 - x1 + 1;
         rect.h = y2 - y1 + 1;
 
+        render_basic_flush (renderer);
+
         result = 0;
         result |= SDL_SetRenderDrawBlendMode (renderer->renderer, (color.a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
         result |= SDL_SetRenderDrawColor (renderer->renderer, color.r, color.g, color.b, color.a);	
@@ -730,8 +1049,7 @@ int render_basic_box (Renderer *renderer, int x1, int y1, int x2, int y2, SDL_Co
 void render_basic_filled_rect (Renderer *renderer, SDL_Rect *rect, SDL_Color color) {
 
     if (renderer && rect) {
-        SDL_SetRenderDrawColor (renderer->renderer, color.r, color.g, color.b, color.a);        
-        SDL_RenderFillRect (renderer->renderer, rect);
+        renderer_batch_fill_rect (renderer, rect, color);
     }
 
 }
@@ -740,7 +1058,23 @@ void render_basic_filled_rect (Renderer *renderer, SDL_Rect *rect, SDL_Color col
 // scale works better with even numbers
 void render_basic_outline_rect (Renderer *renderer, SDL_Rect *rect, SDL_Color color, float scale_x, float scale_y) {
 
-    if (renderer && rect) {
+    if (renderer && rect && renderer->batch && renderer->batch->enabled && renderer->batch->open) {
+        // the outline is recorded as four thin quads, scale is used as the line width
+        int width_x = scale_x >= 1 ? (int) scale_x : 1;
+        int width_y = scale_y >= 1 ? (int) scale_y : 1;
+
+        SDL_Rect top = { .x = rect->x, .y = rect->y, .w = rect->w, .h = width_y };
+        SDL_Rect bottom = { .x = rect->x, .y = rect->y + rect->h - width_y, .w = rect->w, .h = width_y };
+        SDL_Rect left = { .x = rect->x, .y = rect->y, .w = width_x, .h = rect->h };
+        SDL_Rect right = { .x = rect->x + rect->w - width_x, .y = rect->y, .w = width_x, .h = rect->h };
+
+        renderer_batch_fill_rect (renderer, &top, color);
+        renderer_batch_fill_rect (renderer, &bottom, color);
+        renderer_batch_fill_rect (renderer, &left, color);
+        renderer_batch_fill_rect (renderer, &right, color);
+    }
+
+    else if (renderer && rect) {
         float original_scale_x = 0;
         float original_scale_y = 0;
 
@@ -767,6 +1101,8 @@ void render_basic_outline_rect (Renderer *renderer, SDL_Rect *rect, SDL_Color co
 void render_basic_line (Renderer *renderer, int x1, int x2, int y1, int y2, SDL_Color color, float scale_x, float scale_y) {
 
     if (renderer) {
+        render_basic_flush (renderer);
+
         float original_scale_x = 0;
         float original_scale_y = 0;
 
@@ -789,6 +1125,8 @@ int render_basic_horizontal_line (Renderer *renderer,
     SDL_Color color) {
 
     if (renderer) {
+        render_basic_flush (renderer);
+
         int result = 0;
         result |= SDL_SetRenderDrawBlendMode (renderer->renderer, (color.a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
         result |= SDL_SetRenderDrawColor (renderer->renderer, color.r, color.g, color.b, color.a);
@@ -807,6 +1145,8 @@ int render_basic_vertical_line (Renderer *renderer,
     SDL_Color color) {
 
     if (renderer) {
+        render_basic_flush (renderer);
+
         int result = 0;
         result |= SDL_SetRenderDrawBlendMode (renderer->renderer, (color.a == 255) ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
         result |= SDL_SetRenderDrawColor (renderer->renderer, color.r, color.g, color.b, color.a);
@@ -848,7 +1188,7 @@ void render_complex_transparent_rect (Renderer *renderer, SDL_Texture **texture,
 
             else {
                 // send image to renderer queue
-                renderer_load_queue_push (renderer, surface_texture_new (surface, texture, false));
+                renderer_load_queue_push (renderer, surface, texture, false);
             }
         }
     }
@@ -1396,22 +1736,421 @@ int render_complex_circle (Renderer *renderer,
 
 #pragma endregion
 
+#pragma region Batch
+
+RenderBatch *render_batch_new (void) {
+
+    RenderBatch *batch = (RenderBatch *) malloc (sizeof (RenderBatch));
+    if (batch) {
+        memset (batch, 0, sizeof (RenderBatch));
+
+        batch->enabled = true;
+        batch->lookback = DEFAULT_RENDER_BATCH_LOOKBACK;
+
+        batch->commands = (RenderCommand *) calloc (DEFAULT_RENDER_BATCH_SIZE, sizeof (RenderCommand));
+        batch->max_commands = batch->commands ? DEFAULT_RENDER_BATCH_SIZE : 0;
+
+        batch->groups = (RenderGroup *) calloc (DEFAULT_RENDER_BATCH_SIZE, sizeof (RenderGroup));
+        batch->max_groups = batch->groups ? DEFAULT_RENDER_BATCH_SIZE : 0;
+
+        batch->vertices = (SDL_Vertex *) calloc (DEFAULT_RENDER_BATCH_SIZE * 4, sizeof (SDL_Vertex));
+        batch->indices = (int *) calloc (DEFAULT_RENDER_BATCH_SIZE * 6, sizeof (int));
+        batch->max_quads = (batch->vertices && batch->indices) ? DEFAULT_RENDER_BATCH_SIZE : 0;
+    }
+
+    return batch;
+
+}
+
+void render_batch_delete (void *batch_ptr) {
+
+    if (batch_ptr) {
+        RenderBatch *batch = (RenderBatch *) batch_ptr;
+
+        if (batch->commands) free (batch->commands);
+        if (batch->groups) free (batch->groups);
+        if (batch->vertices) free (batch->vertices);
+        if (batch->indices) free (batch->indices);
+
+        free (batch);
+    }
+
+}
+
+// enables or disables draw call batching for the renderer, enabled by default
+// when disabled, every draw is submitted to SDL right away
+void renderer_set_batching (Renderer *renderer, bool enabled) {
+
+    if (renderer && renderer->batch) {
+        renderer_batch_flush (renderer);
+        renderer->batch->enabled = enabled;
+    }
+
+}
+
+// sets how many groups back a new command may be merged into,
+// higher values merge more but cost more time at flush
+void renderer_set_batch_lookback (Renderer *renderer, u32 lookback) {
+
+    if (renderer && renderer->batch) renderer->batch->lookback = lookback;
+
+}
+
+// sets the layer that will be used to sort the next recorded commands
+void renderer_batch_set_layer (Renderer *renderer, int layer) {
+
+    if (renderer && renderer->batch) renderer->batch->layer = layer;
+
+}
+
+static void render_batch_begin (RenderBatch *batch) {
+
+    if (batch) {
+        batch->n_commands = 0;
+        batch->n_groups = 0;
+        batch->layer = 0;
+        batch->open = true;
+    }
+
+}
+
+static void render_batch_end (Renderer *renderer) {
+
+    renderer_batch_flush (renderer);
+    if (renderer->batch) renderer->batch->open = false;
+
+}
+
+// returns 0 on success, 1 on error
+static u8 render_batch_grow_commands (RenderBatch *batch) {
+
+    u32 new_max = batch->max_commands ? batch->max_commands * 2 : DEFAULT_RENDER_BATCH_SIZE;
+    RenderCommand *commands = (RenderCommand *) realloc (batch->commands, new_max * sizeof (RenderCommand));
+    if (commands) {
+        batch->commands = commands;
+        batch->max_commands = new_max;
+        return 0;
+    }
+
+    return 1;
+
+}
+
+// returns 0 on success, 1 on error
+static u8 render_batch_grow_groups (RenderBatch *batch) {
+
+    u32 new_max = batch->max_groups ? batch->max_groups * 2 : DEFAULT_RENDER_BATCH_SIZE;
+    RenderGroup *groups = (RenderGroup *) realloc (batch->groups, new_max * sizeof (RenderGroup));
+    if (groups) {
+        batch->groups = groups;
+        batch->max_groups = new_max;
+        return 0;
+    }
+
+    return 1;
+
+}
+
+// makes sure we have space for n_quads vertices and indices
+// returns 0 on success, 1 on error
+static u8 render_batch_reserve_quads (RenderBatch *batch, u32 n_quads) {
+
+    if (n_quads <= batch->max_quads) return 0;
+
+    u32 new_max = batch->max_quads ? batch->max_quads : DEFAULT_RENDER_BATCH_SIZE;
+    while (new_max < n_quads) new_max *= 2;
+
+    SDL_Vertex *vertices = (SDL_Vertex *) realloc (batch->vertices, new_max * 4 * sizeof (SDL_Vertex));
+    if (vertices) batch->vertices = vertices;
+
+    int *indices = (int *) realloc (batch->indices, new_max * 6 * sizeof (int));
+    if (indices) batch->indices = indices;
+
+    if (vertices && indices) {
+        batch->max_quads = new_max;
+        return 0;
+    }
+
+    return 1;
+
+}
+
+// draws a single command right away, used when the batch is closed or disabled
+static void render_command_draw (Renderer *renderer, RenderCommand *command) {
+
+    if (command->texture) {
+        bool modulate = (command->colour.r != 255) || (command->colour.g != 255) 
+            || (command->colour.b != 255) || (command->colour.a != 255);
+
+        if (modulate) {
+            SDL_SetTextureColorMod (command->texture, command->colour.r, command->colour.g, command->colour.b);
+            SDL_SetTextureAlphaMod (command->texture, command->colour.a);
+        }
+
+        SDL_RenderCopyEx (renderer->renderer, command->texture,
+            command->full_src ? NULL : &command->src_rect, &command->dest_rect,
+            0, 0, command->flip);
+
+        if (modulate) {
+            SDL_SetTextureColorMod (command->texture, 255, 255, 255);
+            SDL_SetTextureAlphaMod (command->texture, 255);
+        }
+    }
+
+    else {
+        SDL_SetRenderDrawColor (renderer->renderer,
+            command->colour.r, command->colour.g, command->colour.b, command->colour.a);
+        SDL_RenderFillRect (renderer->renderer, &command->dest_rect);
+    }
+
+    renderer->render_batch_count += 1;
+
+}
+
+static void render_batch_record (Renderer *renderer, RenderCommand *command) {
+
+    RenderBatch *batch = renderer->batch;
+    if (batch && batch->enabled && batch->open) {
+        if (batch->n_commands >= batch->max_commands) {
+            if (render_batch_grow_commands (batch)) {
+                // we are out of memory, at least draw it
+                render_command_draw (renderer, command);
+                return;
+            }
+        }
+
+        command->layer = batch->layer;
+        command->idx = batch->n_commands;
+        memcpy (&batch->commands[batch->n_commands], command, sizeof (RenderCommand));
+        batch->n_commands += 1;
+    }
+
+    else render_command_draw (renderer, command);
+
+}
+
+// draws a texture (or a portion of it if src_rect is not NULL)
+// the command is recorded in the batch if it is open, else it is drawn right away
+void renderer_batch_texture (Renderer *renderer, SDL_Texture *texture,
+    const SDL_Rect *src_rect, const SDL_Rect *dest_rect, SDL_RendererFlip flip) {
+
+    SDL_Color white = { 255, 255, 255, 255 };
+    renderer_batch_texture_colour (renderer, texture, src_rect, dest_rect, flip, white);
+
+}
+
+// same as renderer_batch_texture () but the texture colour is modulated by colour
+void renderer_batch_texture_colour (Renderer *renderer, SDL_Texture *texture,
+    const SDL_Rect *src_rect, const SDL_Rect *dest_rect, SDL_RendererFlip flip, SDL_Color colour) {
+
+    if (renderer && texture && dest_rect) {
+        RenderCommand command = { 0 };
+        command.texture = texture;
+        if (src_rect) memcpy (&command.src_rect, src_rect, sizeof (SDL_Rect));
+        else command.full_src = true;
+        memcpy (&command.dest_rect, dest_rect, sizeof (SDL_Rect));
+        command.colour = colour;
+        command.flip = flip;
+
+        render_batch_record (renderer, &command);
+    }
+
+}
+
+// draws a filled rect using the batch if it is open, else it is drawn right away
+void renderer_batch_fill_rect (Renderer *renderer, const SDL_Rect *rect, SDL_Color colour) {
+
+    if (renderer && rect) {
+        RenderCommand command = { 0 };
+        command.texture = NULL;
+        memcpy (&command.dest_rect, rect, sizeof (SDL_Rect));
+        command.colour = colour;
+        command.flip = SDL_FLIP_NONE;
+
+        render_batch_record (renderer, &command);
+    }
+
+}
+
+// sorts by layer and then by submission order
+static int render_command_layer_comparator (const void *a, const void *b) {
+
+    const RenderCommand *command_a = (const RenderCommand *) a;
+    const RenderCommand *command_b = (const RenderCommand *) b;
+
+    if (command_a->layer != command_b->layer) return command_a->layer < command_b->layer ? -1 : 1;
+    if (command_a->idx != command_b->idx) return command_a->idx < command_b->idx ? -1 : 1;
+    return 0;
+
+}
+
+// sorts by the group (texture run) and then by submission order
+static int render_command_group_comparator (const void *a, const void *b) {
+
+    const RenderCommand *command_a = (const RenderCommand *) a;
+    const RenderCommand *command_b = (const RenderCommand *) b;
+
+    if (command_a->group != command_b->group) return command_a->group < command_b->group ? -1 : 1;
+    if (command_a->idx != command_b->idx) return command_a->idx < command_b->idx ? -1 : 1;
+    return 0;
+
+}
+
+// assigns every command to a group, a command can only be moved back into an older
+// group with the same texture if it does not overlap anything drawn in between,
+// so the final image is the same as drawing the commands one by one
+// returns 0 on success, 1 on error
+static u8 render_batch_group_commands (RenderBatch *batch) {
+
+    batch->n_groups = 0;
+
+    RenderCommand *command = NULL;
+    for (u32 i = 0; i < batch->n_commands; i++) {
+        command = &batch->commands[i];
+
+        bool merged = false;
+        u32 checked = 0;
+        for (u32 g = batch->n_groups; g > 0 && checked < batch->lookback; g--, checked++) {
+            RenderGroup *group = &batch->groups[g - 1];
+            if (group->texture == command->texture) {
+                command->group = g - 1;
+                group->n_commands += 1;
+                SDL_UnionRect (&group->bounds, &command->dest_rect, &group->bounds);
+                merged = true;
+                break;
+            }
+
+            // we can not move the command below something it overlaps
+            if (SDL_HasIntersection (&group->bounds, &command->dest_rect)) break;
+        }
+
+        if (!merged) {
+            if (batch->n_groups >= batch->max_groups) {
+                if (render_batch_grow_groups (batch)) return 1;
+            }
+
+            RenderGroup *group = &batch->groups[batch->n_groups];
+            group->texture = command->texture;
+            memcpy (&group->bounds, &command->dest_rect, sizeof (SDL_Rect));
+            group->n_commands = 1;
+
+            command->group = batch->n_groups;
+            batch->n_groups += 1;
+        }
+    }
+
+    return 0;
+
+}
+
+static void render_command_set_vertices (RenderCommand *command, SDL_Vertex *vertices,
+    float tex_w, float tex_h) {
+
+    float x0 = (float) command->dest_rect.x;
+    float y0 = (float) command->dest_rect.y;
+    float x1 = (float) (command->dest_rect.x + command->dest_rect.w);
+    float y1 = (float) (command->dest_rect.y + command->dest_rect.h);
+
+    float u0 = 0, v0 = 0, u1 = 1, v1 = 1;
+    if (command->texture && !command->full_src && tex_w > 0 && tex_h > 0) {
+        u0 = command->src_rect.x / tex_w;
+        v0 = command->src_rect.y / tex_h;
+        u1 = (command->src_rect.x + command->src_rect.w) / tex_w;
+        v1 = (command->src_rect.y + command->src_rect.h) / tex_h;
+    }
+
+    float tmp = 0;
+    if (command->flip & SDL_FLIP_HORIZONTAL) { tmp = u0; u0 = u1; u1 = tmp; }
+    if (command->flip & SDL_FLIP_VERTICAL) { tmp = v0; v0 = v1; v1 = tmp; }
+
+    vertices[0] = (SDL_Vertex) { { x0, y0 }, command->colour, { u0, v0 } };
+    vertices[1] = (SDL_Vertex) { { x1, y0 }, command->colour, { u1, v0 } };
+    vertices[2] = (SDL_Vertex) { { x1, y1 }, command->colour, { u1, v1 } };
+    vertices[3] = (SDL_Vertex) { { x0, y1 }, command->colour, { u0, v1 } };
+
+}
+
+// submits a run of commands that share the same texture
+static void render_batch_submit_group (Renderer *renderer, RenderCommand *commands, u32 n_commands) {
+
+    #if SDL_VERSION_ATLEAST(2, 0, 18)
+    RenderBatch *batch = renderer->batch;
+    if (!render_batch_reserve_quads (batch, n_commands)) {
+        SDL_Texture *texture = commands[0].texture;
+
+        int w = 0, h = 0;
+        if (texture) SDL_QueryTexture (texture, NULL, NULL, &w, &h);
+
+        for (u32 i = 0; i < n_commands; i++) {
+            render_command_set_vertices (&commands[i], &batch->vertices[i * 4], (float) w, (float) h);
+
+            int base = (int) i * 4;
+            int *idx = &batch->indices[i * 6];
+            idx[0] = base; idx[1] = base + 1; idx[2] = base + 2;
+            idx[3] = base; idx[4] = base + 2; idx[5] = base + 3;
+        }
+
+        SDL_RenderGeometry (renderer->renderer, texture,
+            batch->vertices, (int) n_commands * 4,
+            batch->indices, (int) n_commands * 6);
+
+        renderer->render_batch_count += 1;
+        return;
+    }
+    #endif
+
+    // no geometry support (or no memory), submit the commands one by one
+    for (u32 i = 0; i < n_commands; i++)
+        render_command_draw (renderer, &commands[i]);
+
+}
+
+// submits all the recorded commands to SDL,
+// call this before changing any renderer state like the viewport or the render target
+void renderer_batch_flush (Renderer *renderer) {
+
+    if (renderer && renderer->batch) {
+        RenderBatch *batch = renderer->batch;
+        if (batch->n_commands > 0) {
+            qsort (batch->commands, batch->n_commands, sizeof (RenderCommand), render_command_layer_comparator);
+
+            if (!render_batch_group_commands (batch)) {
+                qsort (batch->commands, batch->n_commands, sizeof (RenderCommand), render_command_group_comparator);
+
+                u32 start = 0;
+                for (u32 i = 1; i <= batch->n_commands; i++) {
+                    if (i == batch->n_commands || batch->commands[i].group != batch->commands[start].group) {
+                        render_batch_submit_group (renderer, &batch->commands[start], i - start);
+                        start = i;
+                    }
+                }
+            }
+
+            else {
+                // failed to group them, just draw them in order
+                for (u32 i = 0; i < batch->n_commands; i++)
+                    render_command_draw (renderer, &batch->commands[i]);
+            }
+
+            batch->n_commands = 0;
+            batch->n_groups = 0;
+        }
+    }
+
+}
+
+#pragma endregion
+
 #pragma region Render
 
 static void renderer_bg_destroy_textures (Renderer *renderer) {
 
     if (renderer) {
-        size_t current_count = queue_size (renderer->destroy_textures_queue);
-
-        size_t max_count = current_count > renderer->bg_destroying_factor ? 
-            renderer->bg_destroying_factor : current_count;
-            
+        SDL_Texture *texture = NULL;
         size_t count = 0;
-        while (count < max_count) {
-            SDL_Texture *texture = (SDL_Texture *) queue_pop (renderer->destroy_textures_queue);
-            if (texture) {
-                SDL_DestroyTexture (texture);
-            } 
+        while (count < renderer->bg_destroying_factor
+            && !ring_pop (renderer->destroy_textures_queue, &texture)) {
+            SDL_DestroyTexture (texture);
 
             count++;
         }
@@ -1419,39 +2158,53 @@ static void renderer_bg_destroy_textures (Renderer *renderer) {
 
 }
 
-static void renderer_bg_load_textures (Renderer *renderer) {
+// we don't know which elements use the new textures,
+// so cached layers need to be drawn again
+static void renderer_bg_textures_loaded (Renderer *renderer) {
+
+    if (renderer->ui) {
+        for (ListElement *le = dlist_start (renderer->ui->ui_elements_layers); le; le = le->next) {
+            Layer *layer = (Layer *) le->data;
+            if (layer->cached) layer_set_dirty (layer);
+        }
+    }
+
+}
+
+// 18/10/2026 -- creates at least bg_loading_factor textures, and then keeps going until the deadline
+// returns how many textures were created
+static size_t renderer_bg_load_textures (Renderer *renderer, u64 deadline) {
+
+    size_t count = 0;
 
     if (renderer) {
-        size_t current_count = queue_size (renderer->load_textures_queue);
+        SurfaceTexture surface_texture = { 0 };
+        SurfaceTexture *st = &surface_texture;
 
-        size_t max_count = current_count > renderer->bg_loading_factor ? 
-            renderer->bg_loading_factor : current_count;
+        while ((count < renderer->bg_loading_factor || frame_clock_now () < deadline)
+            && !ring_pop (renderer->load_textures_queue, st)) {
+            if (st->update) {
+                // TODO: 27/01/2020 -- 01:01 -- check if SDL_UpdateTexture () is thread safe, maybe that why we are not rendering correctly
 
-        size_t count = 0;
-        while (count < max_count) {
-            SurfaceTexture *st = (SurfaceTexture *) queue_pop (renderer->load_textures_queue);
-            if (st) {
-                if (st->update) {
-                    // TODO: 27/01/2020 -- 01:01 -- check if SDL_UpdateTexture () is thread safe, maybe that why we are not rendering correctly
-
-                    // 27/01/2020 -- 00:27 -- SDL_UpdateTexture () does not render to screen, we get only back texture
-                    // so changed to use create texture and for streaming image, we first destroy the texture
-
-                    SDL_LockTexture (*st->texture, NULL, &st->surface->pixels, &st->surface->pitch);
-                    SDL_UpdateTexture (*st->texture, NULL, st->surface->pixels, st->surface->pitch);
-                    // *st->texture = SDL_CreateTextureFromSurface (renderer->renderer, st->surface);
-                    SDL_UnlockTexture (*st->texture);
-                }
+                // 27/01/2020 -- 00:27 -- SDL_UpdateTexture () does not render to screen, we get only back texture
+                // so changed to use create texture and for streaming image, we first destroy the texture
+
+                SDL_LockTexture (*st->texture, NULL, &st->surface->pixels, &st->surface->pitch);
+                SDL_UpdateTexture (*st->texture, NULL, st->surface->pixels, st->surface->pitch);
+                // *st->texture = SDL_CreateTextureFromSurface (renderer->renderer, st->surface);
+                SDL_UnlockTexture (*st->texture);
+            }
 
-                else *st->texture = SDL_CreateTextureFromSurface (renderer->renderer, st->surface);
+            else *st->texture = SDL_CreateTextureFromSurface (renderer->renderer, st->surface);
 
-                surface_texture_delete (st);
-            } 
+            surface_texture_clear (st);
 
             count++;
         }
     }
 
+    return count;
+
 }
 
 // TODO: 08/02/2020 -- 22:30 - implement occlusion culling using the same intersection checks as the ui
@@ -1472,11 +2225,12 @@ static void renderer_render_game_objects (Renderer *renderer) {
     //         transform = (Transform *) game_object_get_component (go, TRANSFORM_COMP);
     //         graphics = (Graphics *) game_object_get_component (go, GRAPHICS_COMP);
     //         if (transform && graphics) {
+    //             Vector2D position = transform_get_position (transform);
     //             if (graphics->multipleSprites) {
     //                 texture_draw_frame (main_camera, 
     //                     renderer,
     //                     graphics->spriteSheet, 
-    //                     transform->position.x, transform->position.y, 
+    //                     position.x, position.y, 
     //                     graphics->x_sprite_offset, graphics->y_sprite_offset,
     //                     graphics->flip);
     //             }
@@ -1485,7 +2239,7 @@ static void renderer_render_game_objects (Renderer *renderer) {
     //                 texture_draw (main_camera, 
     //                     renderer,
     //                     graphics->sprite, 
-    //                     transform->position.x, transform->position.y, 
+    //                     position.x, position.y, 
     //                     graphics->flip);
     //             }
     //         }
@@ -1494,32 +2248,47 @@ static void renderer_render_game_objects (Renderer *renderer) {
 
 }
 
-void render (Renderer *renderer) {
+void render (Renderer *renderer, double alpha) {
 
     if (renderer) {
+        renderer->alpha = alpha;
+
         renderer->render_count = 0;
+        renderer->render_batch_count = 0;
+        memset (&renderer->frame_stats, 0, sizeof (RenderFrameStats));
 
         // destroy any texture in background queue
-        if (queue_size (renderer->destroy_textures_queue) > 0) {
+        if (!ring_is_empty (renderer->destroy_textures_queue)) {
             renderer_bg_destroy_textures (renderer);
         }
 
-        // load any texture in background queue
-        if (queue_size (renderer->load_textures_queue) > 0) {
-            renderer_bg_load_textures (renderer);
+        // load any texture in background queue, and then the ones of the asset loader, until the budget is used
+        u64 deadline = frame_clock_now () + (u64) renderer->bg_loading_budget * 1000;
+        size_t loaded = 0;
+        if (!ring_is_empty (renderer->load_textures_queue)) {
+            loaded += renderer_bg_load_textures (renderer, deadline);
         }
 
+        loaded += asset_loader_upload (renderer, deadline);
+
+        if (loaded) renderer_bg_textures_loaded (renderer);
+
         SDL_SetRenderDrawColor (renderer->renderer, 0, 0, 0, 255);
         SDL_RenderClear (renderer->renderer);
 
+        render_batch_begin (renderer->batch);
+
         renderer_render_game_objects (renderer);
 
         ui_render (renderer);
 
+        render_batch_end (renderer);
+
         SDL_RenderPresent (renderer->renderer);
 
         #ifdef CENGINE_DEBUG
-        // printf ("Renderer: %s render count: %d\n", renderer->name->str, renderer->render_count);
+        // printf ("Renderer: %s render count: %d - batches: %d\n", 
+        //     renderer->name->str, renderer->render_count, renderer->render_batch_count);
         #endif
     }
 
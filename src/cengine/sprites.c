@@ -3,7 +3,9 @@
 
 #include <SDL2/SDL.h>
 
+#include "cengine/atlas.h"
 #include "cengine/graphics.h"
+#include "cengine/renderer.h"
 #include "cengine/sprites.h"
 #include "cengine/textures.h"
 
@@ -16,6 +18,7 @@ Sprite *sprite_new (void) {
         memset (sprite, 0, sizeof (Sprite));
         sprite->texture = NULL;
         sprite->img_data = NULL;
+        sprite->atlas = NULL;
     }
 
     return sprite;
@@ -25,7 +28,8 @@ Sprite *sprite_new (void) {
 void sprite_destroy (Sprite *sprite) {
 
     if (sprite) {
-        if (sprite->texture) {
+        // atlas sprites do not own the page texture
+        if (sprite->texture && !sprite->atlas) {
             SDL_DestroyTexture (sprite->texture);
             // texture_destroy (renderer_get_by_name ("main"), sprite->texture);
         }
@@ -40,6 +44,8 @@ void sprite_destroy (Sprite *sprite) {
 Sprite *sprite_load (const char *filename, Renderer *renderer) {
 
     if (filename && renderer) {
+        if (renderer->atlas) return atlas_sprite_load (renderer->atlas, filename);
+
         Sprite *new_sprite = sprite_new ();
         if (new_sprite) {
             new_sprite->img_data = texture_load (renderer, filename, &new_sprite->texture);
@@ -63,6 +69,19 @@ Sprite *sprite_load (const char *filename, Renderer *renderer) {
 
 }
 
+SDL_Texture *sprite_get_texture (Sprite *sprite, Renderer *renderer) {
+
+    SDL_Texture *texture = NULL;
+
+    if (sprite) {
+        if (sprite->atlas) texture = atlas_get_page_texture (sprite->atlas, renderer, sprite->atlas_page);
+        else texture = sprite->texture;
+    }
+
+    return texture;
+
+}
+
 /*** Sprites Sheets ***/
 
 SpriteSheet *sprite_sheet_new (void) {
@@ -72,6 +91,7 @@ SpriteSheet *sprite_sheet_new (void) {
         memset (sp, 0, sizeof (SpriteSheet));
         sp->texture = NULL;
         sp->individual_sprites = NULL;
+        sp->atlas = NULL;
     }
 
     return sp;
@@ -93,7 +113,9 @@ void sprite_sheet_destroy (SpriteSheet *sprite_sheet) {
             free (sprite_sheet->individual_sprites);
         }
 
-        if (sprite_sheet->texture) SDL_DestroyTexture (sprite_sheet->texture);
+        if (sprite_sheet->texture && !sprite_sheet->atlas) SDL_DestroyTexture (sprite_sheet->texture);
+
+        image_data_delete (sprite_sheet->img_data);
 
         free (sprite_sheet);
     }
@@ -103,6 +125,8 @@ void sprite_sheet_destroy (SpriteSheet *sprite_sheet) {
 SpriteSheet *sprite_sheet_load (const char *filename, Renderer *renderer) {
 
     if (filename && renderer) {
+        if (renderer->atlas) return atlas_sprite_sheet_load (renderer->atlas, filename);
+
         SpriteSheet *new_sprite_sheet = sprite_sheet_new ();
         if (new_sprite_sheet) {
             new_sprite_sheet->img_data = texture_load (renderer, filename, &new_sprite_sheet->texture);
@@ -129,6 +153,29 @@ SpriteSheet *sprite_sheet_load (const char *filename, Renderer *renderer) {
 
 }
 
+SDL_Texture *sprite_sheet_get_texture (SpriteSheet *sprite_sheet, Renderer *renderer) {
+
+    SDL_Texture *texture = NULL;
+
+    if (sprite_sheet) {
+        if (sprite_sheet->atlas) texture = atlas_get_page_texture (sprite_sheet->atlas, renderer, sprite_sheet->atlas_page);
+        else texture = sprite_sheet->texture;
+    }
+
+    return texture;
+
+}
+
+void sprite_sheet_set_frame (SpriteSheet *sprite_sheet, u32 col, u32 row) {
+
+    if (sprite_sheet) {
+        // the region is empty if the sprite sheet has its own texture
+        sprite_sheet->src_rect.x = sprite_sheet->region.x + sprite_sheet->sprite_w * col;
+        sprite_sheet->src_rect.y = sprite_sheet->region.y + sprite_sheet->sprite_h * row;
+    }
+
+}
+
 void sprite_sheet_set_sprite_size (SpriteSheet *sprite_sheet, u32 w, u32 h) {
 
     if (sprite_sheet) {
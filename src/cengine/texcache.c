@@ -0,0 +1,537 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <errno.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include <unistd.h>
+#include <fcntl.h>
+
+#include <pthread.h>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include "cengine/types/types.h"
+#include "cengine/types/string.h"
+
+#include "cengine/collections/dlist.h"
+#include "cengine/collections/hashmap.h"
+
+#include "cengine/archive.h"
+#include "cengine/assets.h"
+#include "cengine/files.h"
+#include "cengine/renderer.h"
+#include "cengine/texcache.h"
+
+#include "cengine/utils/log.h"
+#include "cengine/utils/utils.h"
+
+typedef enum TexCacheEntryResult {
+
+    TEXCACHE_ENTRY_MISS             = 0,        // there is no entry
+    TEXCACHE_ENTRY_HIT              = 1,
+    TEXCACHE_ENTRY_INVALID          = 2,        // the entry is not valid for the current source
+    TEXCACHE_ENTRY_CHECK_HASH       = 3,        // the source mtime changed, its hash is needed
+
+} TexCacheEntryResult;
+
+// the entry file that is still mapped by a surface that was not copied
+typedef struct TexCacheMapping {
+
+    void *map;
+    size_t map_size;
+
+} TexCacheMapping;
+
+static pthread_mutex_t texcache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static String *texcache_dir = NULL;
+static TexCacheStats texcache_stats = { 0 };
+
+#pragma region Dir
+
+// sets the directory where the decoded images are stored, it is created if needed
+// the cache is disabled until it is set, NULL disables it again
+// returns 0 on success, 1 on error
+u8 texcache_set_dir (const char *dir) {
+
+    u8 errors = 0;
+
+    if (dir && mkdir (dir, 0755) && (errno != EEXIST)) {
+        cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE,
+            c_string_create ("Failed to create texture cache dir %s!", dir));
+        errors = 1;
+    }
+
+    if (!errors) {
+        pthread_mutex_lock (&texcache_mutex);
+
+        str_delete (texcache_dir);
+        texcache_dir = dir ? str_new (dir) : NULL;
+
+        pthread_mutex_unlock (&texcache_mutex);
+    }
+
+    return errors;
+
+}
+
+// returns true if a cache directory has been set
+bool texcache_is_enabled (void) {
+
+    pthread_mutex_lock (&texcache_mutex);
+    bool enabled = (texcache_dir != NULL);
+    pthread_mutex_unlock (&texcache_mutex);
+
+    return enabled;
+
+}
+
+// returns the name of the entry file of the normalized path,
+// the format is part of it so renderers with different formats do not replace each other entries
+// NULL if the cache is disabled
+static char *texcache_entry_filename (const char *path, u32 format) {
+
+    char *entry_filename = NULL;
+
+    u64 hash = hashmap_hash (path, strlen (path), TEXCACHE_HASH_SEED);
+
+    pthread_mutex_lock (&texcache_mutex);
+
+    if (texcache_dir) {
+        entry_filename = c_string_create ("%s/%016llx_%08x.tex",
+            texcache_dir->str, (unsigned long long) hash, format);
+    }
+
+    pthread_mutex_unlock (&texcache_mutex);
+
+    return entry_filename;
+
+}
+
+static void texcache_stats_add (u64 *stat) {
+
+    pthread_mutex_lock (&texcache_mutex);
+    *stat += 1;
+    pthread_mutex_unlock (&texcache_mutex);
+
+}
+
+#pragma endregion
+
+#pragma region Entry
+
+// checks that the header is inside the file & that it is the entry of the path in the format
+static bool texcache_entry_is_valid (const TexCacheHeader *header, size_t entry_size,
+    const char *path, u32 format) {
+
+    if (memcmp (header->magic, TEXCACHE_MAGIC, sizeof (header->magic))) return false;
+    if (header->version != TEXCACHE_VERSION) return false;
+
+    if (header->format != format) return false;
+    if (!header->width || !header->height) return false;
+    if ((header->width > INT_MAX) || (header->height > INT_MAX) || (header->pitch > INT_MAX)) return false;
+    if (header->pitch < (u64) header->width * SDL_BYTESPERPIXEL (format)) return false;
+
+    size_t path_length = strlen (path);
+    if (header->path_length != path_length) return false;
+    if (sizeof (TexCacheHeader) + path_length > entry_size) return false;
+    if (memcmp ((const char *) header + sizeof (TexCacheHeader), path, path_length)) return false;
+
+    if (header->data_size != (u64) header->pitch * header->height) return false;
+    if ((header->data_offset > entry_size) || (header->data_size > entry_size - header->data_offset)) return false;
+
+    return true;
+
+}
+
+// creates the surface with the pixels of the mapped entry, the mapping belongs to the surface
+static SDL_Surface *texcache_entry_surface (void *map, size_t map_size, bool copy) {
+
+    const TexCacheHeader *header = (const TexCacheHeader *) map;
+
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormatFrom (
+        (char *) map + header->data_offset,
+        (int) header->width, (int) header->height, SDL_BITSPERPIXEL (header->format),
+        (int) header->pitch, header->format
+    );
+
+    if (surface) {
+        if (copy) {
+            // the pixels are copied once from the page cache, instead of being decoded again
+            SDL_Surface *copied = SDL_CreateRGBSurfaceWithFormat (0,
+                (int) header->width, (int) header->height, SDL_BITSPERPIXEL (header->format), header->format);
+            if (copied) {
+                size_t row_size = (size_t) header->width * SDL_BYTESPERPIXEL (header->format);
+                for (u32 y = 0; y < header->height; y++) {
+                    memcpy ((char *) copied->pixels + (size_t) y * copied->pitch,
+                        (char *) surface->pixels + (size_t) y * surface->pitch, row_size);
+                }
+            }
+
+            SDL_FreeSurface (surface);
+            munmap (map, map_size);
+
+            surface = copied;
+        }
+
+        else {
+            TexCacheMapping *mapping = (TexCacheMapping *) malloc (sizeof (TexCacheMapping));
+            if (mapping) {
+                mapping->map = map;
+                mapping->map_size = map_size;
+                surface->userdata = mapping;
+            }
+
+            else {
+                SDL_FreeSurface (surface);
+                munmap (map, map_size);
+                surface = NULL;
+            }
+        }
+    }
+
+    else munmap (map, map_size);
+
+    return surface;
+
+}
+
+// maps the entry of the source and checks if it is still valid, without reading the source
+// if its mtime changed, source_hash is needed to check if its contents are the same,
+// and if they are, the entry gets the new mtime so the next load does not need the hash
+static TexCacheEntryResult texcache_entry_load (const char *entry_filename, const char *path,
+    const struct stat *source, u32 format, const u64 *source_hash,
+    bool copy, SDL_Surface **surface) {
+
+    TexCacheEntryResult result = TEXCACHE_ENTRY_MISS;
+
+    int fd = open (entry_filename, source_hash ? O_RDWR : O_RDONLY);
+    if (fd >= 0) {
+        result = TEXCACHE_ENTRY_INVALID;
+
+        struct stat entry_status;
+        if (!fstat (fd, &entry_status) && ((size_t) entry_status.st_size >= sizeof (TexCacheHeader))) {
+            void *map = mmap (NULL, entry_status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                const TexCacheHeader *header = (const TexCacheHeader *) map;
+                if (texcache_entry_is_valid (header, entry_status.st_size, path, format)) {
+                    if ((header->source_size == (u64) source->st_size)
+                        && (header->source_mtime_sec == (i64) source->st_mtim.tv_sec)
+                        && (header->source_mtime_nsec == (i64) source->st_mtim.tv_nsec)) {
+                        result = TEXCACHE_ENTRY_HIT;
+                    }
+
+                    else if (header->source_size == (u64) source->st_size) {
+                        if (!source_hash) result = TEXCACHE_ENTRY_CHECK_HASH;
+
+                        else if (header->source_hash == *source_hash) {
+                            TexCacheHeader updated = *header;
+                            updated.source_mtime_sec = source->st_mtim.tv_sec;
+                            updated.source_mtime_nsec = source->st_mtim.tv_nsec;
+                            (void) !pwrite (fd, &updated, sizeof (TexCacheHeader), 0);
+
+                            texcache_stats_add (&texcache_stats.rehashed);
+                            result = TEXCACHE_ENTRY_HIT;
+                        }
+                    }
+                }
+
+                if (result == TEXCACHE_ENTRY_HIT) {
+                    *surface = texcache_entry_surface (map, entry_status.st_size, copy);
+                    if (!*surface) result = TEXCACHE_ENTRY_INVALID;
+                }
+
+                else munmap (map, entry_status.st_size);
+            }
+        }
+
+        close (fd);
+    }
+
+    return result;
+
+}
+
+// writes all the bytes, retrying the writes that were cut short
+// returns 0 on success, 1 on error
+static u8 texcache_write (int fd, const void *buffer, size_t size) {
+
+    const char *p = (const char *) buffer;
+    while (size > 0) {
+        ssize_t written = write (fd, p, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return 1;
+        }
+
+        p += written;
+        size -= written;
+    }
+
+    return 0;
+
+}
+
+// writes the entry into a temporary file that then replaces the old entry,
+// so other threads or processes never map an entry that is half written
+// returns 0 on success, 1 on error
+static u8 texcache_entry_store (const char *entry_filename, const char *path,
+    const struct stat *source, u64 source_hash, SDL_Surface *surface) {
+
+    static const char zeros[TEXCACHE_ALIGNMENT] = { 0 };
+
+    u8 errors = 1;
+
+    TexCacheHeader header = { 0 };
+    memcpy (header.magic, TEXCACHE_MAGIC, sizeof (header.magic));
+    header.version = TEXCACHE_VERSION;
+
+    header.format = surface->format->format;
+    header.width = surface->w;
+    header.height = surface->h;
+    header.pitch = surface->pitch;
+
+    header.source_mtime_sec = source->st_mtim.tv_sec;
+    header.source_mtime_nsec = source->st_mtim.tv_nsec;
+    header.source_size = source->st_size;
+    header.source_hash = source_hash;
+
+    header.path_length = (u32) strlen (path);
+
+    u64 end = sizeof (TexCacheHeader) + header.path_length;
+    u64 padding = (TEXCACHE_ALIGNMENT - (end % TEXCACHE_ALIGNMENT)) % TEXCACHE_ALIGNMENT;
+    header.data_offset = end + padding;
+    header.data_size = (u64) surface->pitch * surface->h;
+
+    char *temp_filename = c_string_create ("%s.XXXXXX", entry_filename);
+    int fd = temp_filename ? mkstemp (temp_filename) : -1;
+    if (fd >= 0) {
+        if (SDL_MUSTLOCK (surface)) SDL_LockSurface (surface);
+
+        errors = texcache_write (fd, &header, sizeof (TexCacheHeader))
+            || texcache_write (fd, path, header.path_length)
+            || texcache_write (fd, zeros, padding)
+            || texcache_write (fd, surface->pixels, header.data_size);
+
+        if (SDL_MUSTLOCK (surface)) SDL_UnlockSurface (surface);
+
+        if (close (fd)) errors = 1;
+
+        if (!errors) errors = (rename (temp_filename, entry_filename) != 0);
+        if (errors) unlink (temp_filename);
+    }
+
+    if (errors) {
+        cengine_log_msg (stderr, LOG_WARNING, LOG_NO_TYPE,
+            c_string_create ("Failed to store %s in the texture cache!", path));
+    }
+
+    free (temp_filename);
+
+    return errors;
+
+}
+
+#pragma endregion
+
+#pragma region Load
+
+// reads the source from the disk
+static void *texcache_read_source (const char *filename, size_t size) {
+
+    void *contents = NULL;
+
+    FILE *file = fopen (filename, "rb");
+    if (file) {
+        contents = malloc (size ? size : 1);
+        if (contents && size && (fread (contents, size, 1, file) != 1)) {
+            free (contents);
+            contents = NULL;
+        }
+
+        fclose (file);
+    }
+
+    return contents;
+
+}
+
+// decodes the image and converts it to the format
+static SDL_Surface *texcache_decode (const void *contents, size_t size, u32 format) {
+
+    SDL_Surface *surface = NULL;
+
+    SDL_RWops *rw = (size <= INT_MAX) ? SDL_RWFromConstMem (contents, (int) size) : NULL;
+    if (rw) surface = IMG_Load_RW (rw, 1);
+
+    if (surface && (surface->format->format != format)) {
+        SDL_Surface *converted = SDL_ConvertSurfaceFormat (surface, format, 0);
+        SDL_FreeSurface (surface);
+        surface = converted;
+    }
+
+    return surface;
+
+}
+
+// returns the pixel format the renderer creates textures from without converting them,
+// ARGB8888 if the renderer is NULL
+u32 texcache_get_format (Renderer *renderer) {
+
+    u32 format = SDL_PIXELFORMAT_ARGB8888;
+
+    SDL_RendererInfo info;
+    if (renderer && renderer->renderer && !SDL_GetRendererInfo (renderer->renderer, &info)) {
+        // the formats are sorted from the one the renderer prefers
+        for (u32 i = 0; i < info.num_texture_formats; i++) {
+            u32 texture_format = info.texture_formats[i];
+            if (!SDL_ISPIXELFORMAT_FOURCC (texture_format) && !SDL_ISPIXELFORMAT_INDEXED (texture_format)
+                && SDL_ISPIXELFORMAT_ALPHA (texture_format)) {
+                format = texture_format;
+                break;
+            }
+        }
+    }
+
+    return format;
+
+}
+
+// reads the source when its entry was not a hit, to check its hash or to decode it & store a new entry
+static SDL_Surface *texcache_load_source (const char *filename, const char *path, const char *entry_filename,
+    const struct stat *source, u32 format, bool copy, TexCacheEntryResult result) {
+
+    SDL_Surface *surface = NULL;
+
+    void *contents = texcache_read_source (filename, source->st_size);
+    if (contents) {
+        u64 source_hash = hashmap_hash (contents, source->st_size, TEXCACHE_HASH_SEED);
+
+        if (result == TEXCACHE_ENTRY_CHECK_HASH)
+            result = texcache_entry_load (entry_filename, path, source, format, &source_hash, copy, &surface);
+
+        switch (result) {
+            case TEXCACHE_ENTRY_HIT: texcache_stats_add (&texcache_stats.hits); break;
+            case TEXCACHE_ENTRY_MISS: texcache_stats_add (&texcache_stats.misses); break;
+            default: texcache_stats_add (&texcache_stats.invalidated); break;
+        }
+
+        if (!surface) {
+            surface = texcache_decode (contents, source->st_size, format);
+            if (surface && !texcache_entry_store (entry_filename, path, source, source_hash, surface))
+                texcache_stats_add (&texcache_stats.stored);
+        }
+
+        free (contents);
+    }
+
+    return surface;
+
+}
+
+// returns the decoded image, from its cache entry if it is valid, or decoding it & storing a new entry
+SDL_Surface *texcache_load_surface (const char *filename, u32 format, bool copy) {
+
+    SDL_Surface *surface = NULL;
+
+    if (filename) {
+        char *path = NULL;
+        char *entry_filename = NULL;
+
+        // the files of the mounted archives are already in memory, so they are not cached
+        if (!archives_get_data (filename, NULL)) {
+            path = assets_path_normalize (filename);
+            if (path) entry_filename = texcache_entry_filename (path, format);
+        }
+
+        struct stat source;
+        if (entry_filename && !stat (filename, &source) && S_ISREG (source.st_mode)) {
+            // most loads are hits that do not need to read the source
+            TexCacheEntryResult result = texcache_entry_load (entry_filename, path, &source, format, NULL, copy, &surface);
+            if (result == TEXCACHE_ENTRY_HIT) texcache_stats_add (&texcache_stats.hits);
+            else surface = texcache_load_source (filename, path, entry_filename, &source, format, copy, result);
+        }
+
+        else surface = IMG_Load_RW (file_open_rw (filename), 1);
+
+        free (entry_filename);
+        free (path);
+    }
+
+    return surface;
+
+}
+
+// deletes a surface returned by texcache_load_surface () and unmaps its pixels
+void texcache_surface_delete (SDL_Surface *surface) {
+
+    if (surface) {
+        TexCacheMapping *mapping = (surface->flags & SDL_PREALLOC) ? (TexCacheMapping *) surface->userdata : NULL;
+
+        SDL_FreeSurface (surface);
+
+        if (mapping) {
+            munmap (mapping->map, mapping->map_size);
+            free (mapping);
+        }
+    }
+
+}
+
+#pragma endregion
+
+#pragma region Public
+
+// removes every entry of the cache directory
+void texcache_clear (void) {
+
+    pthread_mutex_lock (&texcache_mutex);
+    char *dir = texcache_dir ? strdup (texcache_dir->str) : NULL;
+    pthread_mutex_unlock (&texcache_mutex);
+
+    if (dir) {
+        DoubleList *files = files_get_from_dir (dir);
+        if (files) {
+            for (ListElement *le = dlist_start (files); le; le = le->next) {
+                String *file = (String *) le->data;
+                if (strstr (file->str, ".tex")) unlink (file->str);
+            }
+
+            dlist_delete (files);
+        }
+
+        free (dir);
+    }
+
+}
+
+TexCacheStats texcache_get_stats (void) {
+
+    pthread_mutex_lock (&texcache_mutex);
+    TexCacheStats stats = texcache_stats;
+    pthread_mutex_unlock (&texcache_mutex);
+
+    return stats;
+
+}
+
+// disables the cache, it is called by cengine_end ()
+void texcache_end (void) {
+
+    pthread_mutex_lock (&texcache_mutex);
+
+    str_delete (texcache_dir);
+    texcache_dir = NULL;
+
+    pthread_mutex_unlock (&texcache_mutex);
+
+}
+
+#pragma endregion
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <stdbool.h>
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_rwops.h>
@@ -8,9 +9,11 @@
 #include "cengine/types/types.h"
 #include "cengine/types/string.h"
 
+#include "cengine/files.h"
 #include "cengine/renderer.h"
 #include "cengine/graphics.h"
 #include "cengine/sprites.h"
+#include "cengine/texcache.h"
 #include "cengine/textures.h"
 
 #include "cengine/game/camera.h"
@@ -32,7 +35,7 @@ void texture_create_from_surface (Renderer *renderer, SDL_Texture **texture, SDL
 
         else {
             // send texture to renderer queue
-            renderer_load_queue_push (renderer, surface_texture_new (surface, texture, false));
+            renderer_load_queue_push (renderer, surface, texture, false);
         }
     }
 
@@ -68,21 +71,25 @@ ImageData *texture_load (Renderer *renderer, const char *filename, SDL_Texture *
     ImageData *image_data = NULL;
 
     if (filename && renderer && texture) {
-        SDL_Surface *temp_surface = IMG_Load (filename);
+        pthread_t thread_id = pthread_self ();
+        // printf ("Loading texture in thread: %ld\n", thread_id);
+        bool render_thread = (thread_id == renderer->thread_id);
+
+        // 18/10/2026 -- cached images are already in the renderer's format, so the texture
+        // is uploaded straight from the mapped entry in the render thread, other threads get a copy
+        SDL_Surface *temp_surface = texcache_load_surface (filename, texcache_get_format (renderer), !render_thread);
         if (temp_surface) {
             image_data = image_data_new (temp_surface->w, temp_surface->h, str_new (filename));
 
-            pthread_t thread_id = pthread_self ();
-            // printf ("Loading texture in thread: %ld\n", thread_id);
-            if (thread_id == renderer->thread_id) {
+            if (render_thread) {
                 // load texture as always
                 *texture = SDL_CreateTextureFromSurface (renderer->renderer, temp_surface);
-                SDL_FreeSurface (temp_surface);
+                texcache_surface_delete (temp_surface);
             }
 
             else {
                 // send texture to renderer queue
-                renderer_load_queue_push (renderer, surface_texture_new (temp_surface, texture, false));
+                renderer_load_queue_push (renderer, temp_surface, texture, false);
             }
         }
 
@@ -108,7 +115,7 @@ void texture_update (Renderer *renderer, SDL_Texture **texture, SDL_Surface *sur
 
         else {
             // send texture to renderer queue
-            renderer_load_queue_push (renderer, surface_texture_new (surface, texture, true));
+            renderer_load_queue_push (renderer, surface, texture, true);
         }
     }
 
@@ -153,8 +160,7 @@ void texture_draw (Camera *cam, Renderer *renderer, Sprite *sprite, i32 x, i32 y
 
         CamRect screenRect = camera_world_to_screen (cam, sprite->dest_rect);
 
-        SDL_RenderCopyEx (renderer->renderer, sprite->texture, &sprite->src_rect, &screenRect, 
-            0, 0, flip);    
+        renderer_batch_texture (renderer, sprite_get_texture (sprite, renderer), &sprite->src_rect, &screenRect, flip);
     }
 
 }
@@ -163,17 +169,16 @@ void texture_draw_frame (Camera *cam, Renderer *renderer, SpriteSheet *spriteShe
     i32 x, i32 y, u32 col, u32 row, SDL_RendererFlip flip) {
 
     if (cam && spriteSheet) {
-        spriteSheet->src_rect.x = spriteSheet->sprite_w * col;
-        spriteSheet->src_rect.y = spriteSheet->sprite_h * row;
+        sprite_sheet_set_frame (spriteSheet, col, row);
 
         spriteSheet->dest_rect.x = x;
         spriteSheet->dest_rect.y = y;
 
         CamRect screenRect = camera_world_to_screen (cam, spriteSheet->dest_rect);
 
-        SDL_RenderCopyEx (renderer->renderer, spriteSheet->texture, 
+        renderer_batch_texture (renderer, sprite_sheet_get_texture (spriteSheet, renderer), 
             &spriteSheet->src_rect, &screenRect,
-            0, 0, flip);
+            flip);
     }
 
 }
\ No newline at end of file
@@ -0,0 +1,619 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/collections/ring.h"
+
+#include "cengine/threads/thread.h"
+#include "cengine/threads/jobs.h"
+
+#include "cengine/utils/log.h"
+
+static JobSystem *jobs = NULL;
+static pthread_mutex_t jobs_init_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// the worker that is running in this thread, NULL if it is not a worker
+static __thread JobWorker *current_worker = NULL;
+
+#pragma region deque
+
+#define JOBS_DEQUE_MASK         (JOBS_DEQUE_CAPACITY - 1)
+
+// only the owner can push
+// returns false if the deque is full
+static bool job_deque_push (JobDeque *deque, Job *job) {
+
+    i64 bottom = __atomic_load_n (&deque->bottom, __ATOMIC_RELAXED);
+    i64 top = __atomic_load_n (&deque->top, __ATOMIC_ACQUIRE);
+    if (bottom - top >= JOBS_DEQUE_CAPACITY) return false;
+
+    __atomic_store_n (&deque->jobs[bottom & JOBS_DEQUE_MASK], job, __ATOMIC_RELAXED);
+    __atomic_store_n (&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+
+    return true;
+
+}
+
+// only the owner can take, it gets the newest job
+static Job *job_deque_take (JobDeque *deque) {
+
+    Job *job = NULL;
+
+    i64 bottom = __atomic_load_n (&deque->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n (&deque->bottom, bottom, __ATOMIC_SEQ_CST);
+    i64 top = __atomic_load_n (&deque->top, __ATOMIC_SEQ_CST);
+
+    if (top <= bottom) {
+        job = __atomic_load_n (&deque->jobs[bottom & JOBS_DEQUE_MASK], __ATOMIC_RELAXED);
+        if (top == bottom) {
+            // this is the last job, race the thieves for it
+            if (!__atomic_compare_exchange_n (&deque->top, &top, top + 1, false,
+                __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) job = NULL;
+
+            __atomic_store_n (&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    else __atomic_store_n (&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+
+    return job;
+
+}
+
+// any thread can steal, it gets the oldest job
+static Job *job_deque_steal (JobDeque *deque) {
+
+    Job *job = NULL;
+
+    i64 top = __atomic_load_n (&deque->top, __ATOMIC_SEQ_CST);
+    i64 bottom = __atomic_load_n (&deque->bottom, __ATOMIC_SEQ_CST);
+
+    if (top < bottom) {
+        job = __atomic_load_n (&deque->jobs[top & JOBS_DEQUE_MASK], __ATOMIC_RELAXED);
+        if (!__atomic_compare_exchange_n (&deque->top, &top, top + 1, false,
+            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) job = NULL;
+    }
+
+    return job;
+
+}
+
+#pragma endregion
+
+#pragma region counters
+
+JobCounter *job_counter_create (void) {
+
+    JobCounter *counter = (JobCounter *) malloc (sizeof (JobCounter));
+    if (counter) {
+        counter->value = 0;
+        counter->waiting = NULL;
+
+        counter->mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+        if (counter->mutex) pthread_mutex_init (counter->mutex, NULL);
+
+        else {
+            free (counter);
+            counter = NULL;
+        }
+    }
+
+    return counter;
+
+}
+
+void job_counter_delete (void *counter_ptr) {
+
+    if (counter_ptr) {
+        JobCounter *counter = (JobCounter *) counter_ptr;
+
+        // jobs that never got to run
+        while (counter->waiting) {
+            Job *next = counter->waiting->next;
+            free (counter->waiting);
+            counter->waiting = next;
+        }
+
+        pthread_mutex_destroy (counter->mutex);
+        free (counter->mutex);
+
+        free (counter_ptr);
+    }
+
+}
+
+i32 job_counter_value (JobCounter *counter) {
+
+    return counter ? __atomic_load_n (&counter->value, __ATOMIC_ACQUIRE) : 0;
+
+}
+
+static void job_push (Job *job);
+
+// the counter is changed with its mutex locked, so once a waiter can lock it
+// after the value got to 0, nobody else is using the counter
+static void job_counter_decrement (JobCounter *counter) {
+
+    Job *waiting = NULL;
+
+    pthread_mutex_lock (counter->mutex);
+    if (__atomic_sub_fetch (&counter->value, 1, __ATOMIC_ACQ_REL) == 0) {
+        waiting = counter->waiting;
+        counter->waiting = NULL;
+    }
+    pthread_mutex_unlock (counter->mutex);
+
+    // the dependency is done, release the jobs that were waiting for it
+    while (waiting) {
+        Job *next = waiting->next;
+        waiting->next = NULL;
+        job_push (waiting);
+        waiting = next;
+    }
+
+}
+
+#pragma endregion
+
+#pragma region jobs
+
+static Job *job_new (JobAffinity affinity, void (*work)(void *args), void *args, JobCounter *counter) {
+
+    Job *job = (Job *) malloc (sizeof (Job));
+    if (job) {
+        job->work = work;
+        job->args = args;
+        job->affinity = affinity;
+        job->counter = counter;
+        job->next = NULL;
+    }
+
+    return job;
+
+}
+
+static void job_run (Job *job) {
+
+    JobCounter *counter = job->counter;
+
+    job->work (job->args);
+    free (job);
+
+    if (counter) job_counter_decrement (counter);
+
+}
+
+static void jobs_wake (u32 *sleeping, pthread_cond_t *cond) {
+
+    if (__atomic_load_n (sleeping, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock (jobs->mutex);
+        pthread_cond_signal (cond);
+        pthread_mutex_unlock (jobs->mutex);
+    }
+
+}
+
+static void job_push (Job *job) {
+
+    int failed = 0;
+
+    switch (job->affinity) {
+        case JOB_AFFINITY_MAIN:
+            failed = ring_push (jobs->main_queue, &job);
+            break;
+
+        case JOB_AFFINITY_IO:
+            __atomic_add_fetch (&jobs->io_pending, 1, __ATOMIC_SEQ_CST);
+            failed = ring_push (jobs->io_queue, &job);
+            if (!failed) jobs_wake (&jobs->io_sleeping, jobs->io_cond);
+            else __atomic_sub_fetch (&jobs->io_pending, 1, __ATOMIC_SEQ_CST);
+            break;
+
+        default: {
+            // counted before it can be taken, so a worker never misses it before sleeping
+            __atomic_add_fetch (&jobs->pending, 1, __ATOMIC_SEQ_CST);
+
+            // jobs created by a worker are kept close to it, unless its deque is full
+            bool pushed = current_worker ? job_deque_push (&current_worker->deque, job) : false;
+            if (!pushed) failed = ring_push (jobs->queue, &job);
+
+            if (!failed) jobs_wake (&jobs->sleeping, jobs->work_cond);
+            else __atomic_sub_fetch (&jobs->pending, 1, __ATOMIC_SEQ_CST);
+        } break;
+    }
+
+    // the queues only fail if they can not grow, so the job is not lost
+    if (failed) {
+        cengine_log_msg (stderr, LOG_WARNING, LOG_NO_TYPE, "Failed to queue job, running it now!");
+        job_run (job);
+    }
+
+}
+
+static inline u32 job_worker_random (JobWorker *worker) {
+
+    // xorshift
+    u32 x = worker->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    worker->random = x;
+
+    return x;
+
+}
+
+// gets the next cpu job, from our own deque, then from the shared queue
+// and then from a random worker
+static Job *jobs_find (JobWorker *worker) {
+
+    Job *job = NULL;
+
+    if (worker) job = job_deque_take (&worker->deque);
+
+    if (!job) (void) ring_pop (jobs->queue, &job);
+
+    if (!job && jobs->n_workers) {
+        static __thread u32 seed = 0x9e3779b9;
+        for (u32 i = 0; i < JOBS_STEAL_TRIES && !job; i++) {
+            u32 r = 0;
+            if (worker) r = job_worker_random (worker);
+            else {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                r = seed;
+            }
+
+            JobWorker *victim = jobs->workers[r % jobs->n_workers];
+            if (victim != worker) job = job_deque_steal (&victim->deque);
+        }
+    }
+
+    if (job) __atomic_sub_fetch (&jobs->pending, 1, __ATOMIC_SEQ_CST);
+
+    return job;
+
+}
+
+static void *jobs_worker_thread (void *worker_ptr) {
+
+    JobWorker *worker = (JobWorker *) worker_ptr;
+    current_worker = worker;
+
+    thread_set_name ("job-worker");
+
+    while (__atomic_load_n (&jobs->running, __ATOMIC_ACQUIRE)) {
+        Job *job = jobs_find (worker);
+        if (job) {
+            job_run (job);
+            continue;
+        }
+
+        // sleep until there are new jobs
+        pthread_mutex_lock (jobs->mutex);
+        __atomic_add_fetch (&jobs->sleeping, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n (&jobs->running, __ATOMIC_ACQUIRE)
+            && !__atomic_load_n (&jobs->pending, __ATOMIC_SEQ_CST)) {
+            pthread_cond_wait (jobs->work_cond, jobs->mutex);
+        }
+        __atomic_sub_fetch (&jobs->sleeping, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock (jobs->mutex);
+    }
+
+    current_worker = NULL;
+
+    return NULL;
+
+}
+
+static void *jobs_io_thread (void *args) {
+
+    thread_set_name ("job-io");
+
+    while (__atomic_load_n (&jobs->running, __ATOMIC_ACQUIRE)) {
+        Job *job = NULL;
+        if (!ring_pop (jobs->io_queue, &job)) {
+            __atomic_sub_fetch (&jobs->io_pending, 1, __ATOMIC_SEQ_CST);
+            job_run (job);
+            continue;
+        }
+
+        pthread_mutex_lock (jobs->mutex);
+        __atomic_add_fetch (&jobs->io_sleeping, 1, __ATOMIC_SEQ_CST);
+        while (__atomic_load_n (&jobs->running, __ATOMIC_ACQUIRE)
+            && !__atomic_load_n (&jobs->io_pending, __ATOMIC_SEQ_CST)) {
+            pthread_cond_wait (jobs->io_cond, jobs->mutex);
+        }
+        __atomic_sub_fetch (&jobs->io_sleeping, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock (jobs->mutex);
+    }
+
+    return NULL;
+
+}
+
+static void jobs_queue_job_delete (void *job_ptr) {
+
+    free (*(Job **) job_ptr);
+
+}
+
+static void jobs_delete (JobSystem *system) {
+
+    for (u32 i = 0; i < system->n_workers; i++) {
+        JobWorker *worker = system->workers[i];
+
+        Job *job = NULL;
+        while ((job = job_deque_steal (&worker->deque))) free (job);
+
+        free (worker);
+    }
+
+    ring_delete (system->queue);
+    ring_delete (system->main_queue);
+    ring_delete (system->io_queue);
+
+    if (system->mutex) {
+        pthread_mutex_destroy (system->mutex);
+        free (system->mutex);
+    }
+
+    if (system->work_cond) {
+        pthread_cond_destroy (system->work_cond);
+        free (system->work_cond);
+    }
+
+    if (system->io_cond) {
+        pthread_cond_destroy (system->io_cond);
+        free (system->io_cond);
+    }
+
+    free (system);
+
+}
+
+static JobSystem *jobs_new (void) {
+
+    JobSystem *system = (JobSystem *) malloc (sizeof (JobSystem));
+    if (system) {
+        memset (system, 0, sizeof (JobSystem));
+
+        system->queue = ring_create (JOBS_QUEUE_CAPACITY, sizeof (Job *), RING_POLICY_GROW, jobs_queue_job_delete);
+        system->main_queue = ring_create (JOBS_QUEUE_CAPACITY, sizeof (Job *), RING_POLICY_GROW, jobs_queue_job_delete);
+        system->io_queue = ring_create (JOBS_QUEUE_CAPACITY, sizeof (Job *), RING_POLICY_GROW, jobs_queue_job_delete);
+
+        system->mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+        system->work_cond = (pthread_cond_t *) malloc (sizeof (pthread_cond_t));
+        system->io_cond = (pthread_cond_t *) malloc (sizeof (pthread_cond_t));
+
+        if (system->queue && system->main_queue && system->io_queue
+            && system->mutex && system->work_cond && system->io_cond) {
+            pthread_mutex_init (system->mutex, NULL);
+            pthread_cond_init (system->work_cond, NULL);
+            pthread_cond_init (system->io_cond, NULL);
+        }
+
+        else {
+            if (system->mutex) free (system->mutex);
+            if (system->work_cond) free (system->work_cond);
+            if (system->io_cond) free (system->io_cond);
+            system->mutex = NULL;
+            system->work_cond = NULL;
+            system->io_cond = NULL;
+
+            jobs_delete (system);
+            system = NULL;
+        }
+    }
+
+    return system;
+
+}
+
+// starts the workers, n_workers = 0 uses one less than the number of cpus
+// it is called by the first submit if it has not been called before
+// returns 0 on success, 1 on error
+u8 jobs_init (u32 n_workers) {
+
+    u8 retval = 1;
+
+    pthread_mutex_lock (&jobs_init_mutex);
+
+    if (!jobs) {
+        if (!n_workers) {
+            long n_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+            n_workers = n_cpus > 1 ? (u32) (n_cpus - 1) : 1;
+        }
+
+        if (n_workers > JOBS_MAX_WORKERS) n_workers = JOBS_MAX_WORKERS;
+
+        JobSystem *system = jobs_new ();
+        if (system) {
+            system->running = true;
+
+            // every worker needs to exist before any of them tries to steal
+            for (u32 i = 0; i < n_workers; i++) {
+                JobWorker *worker = (JobWorker *) malloc (sizeof (JobWorker));
+                if (!worker) break;
+
+                memset (worker, 0, sizeof (JobWorker));
+                worker->idx = i;
+                worker->random = 0x9e3779b9 ^ (i * 0x85ebca6b);
+                if (!worker->random) worker->random = 1;
+
+                system->workers[i] = worker;
+                system->n_workers += 1;
+            }
+
+            jobs = system;
+
+            for (u32 i = 0; i < system->n_workers; i++) {
+                if (pthread_create (&system->workers[i]->thread_id, NULL, jobs_worker_thread, system->workers[i])) {
+                    cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to create job worker thread!");
+                    system->workers[i]->thread_id = 0;
+                }
+            }
+
+            for (u32 i = 0; i < JOBS_IO_WORKERS; i++) {
+                if (pthread_create (&system->io_threads[system->n_io_threads], NULL, jobs_io_thread, NULL)) {
+                    cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, "Failed to create job io thread!");
+                    break;
+                }
+
+                system->n_io_threads += 1;
+            }
+
+            retval = 0;
+        }
+    }
+
+    else retval = 0;
+
+    pthread_mutex_unlock (&jobs_init_mutex);
+
+    return retval;
+
+}
+
+// stops and joins every worker, the jobs that have not started are dropped
+void jobs_end (void) {
+
+    pthread_mutex_lock (&jobs_init_mutex);
+
+    if (jobs) {
+        pthread_mutex_lock (jobs->mutex);
+        __atomic_store_n (&jobs->running, false, __ATOMIC_RELEASE);
+        pthread_cond_broadcast (jobs->work_cond);
+        pthread_cond_broadcast (jobs->io_cond);
+        pthread_mutex_unlock (jobs->mutex);
+
+        for (u32 i = 0; i < jobs->n_workers; i++)
+            if (jobs->workers[i]->thread_id) pthread_join (jobs->workers[i]->thread_id, NULL);
+
+        for (u32 i = 0; i < jobs->n_io_threads; i++)
+            pthread_join (jobs->io_threads[i], NULL);
+
+        jobs_delete (jobs);
+        jobs = NULL;
+    }
+
+    pthread_mutex_unlock (&jobs_init_mutex);
+
+}
+
+// returns true if the calling thread is one of the cpu workers
+bool jobs_is_worker (void) {
+
+    return current_worker != NULL;
+
+}
+
+// submits a job to run as soon as possible
+// if counter is not NULL, it is incremented now and decremented when the job ends
+// returns 0 on success, 1 on error
+u8 job_submit (JobAffinity affinity,
+    void (*work)(void *args), void *args, JobCounter *counter) {
+
+    u8 retval = 1;
+
+    if (work && !jobs_init (0)) {
+        Job *job = job_new (affinity, work, args, counter);
+        if (job) {
+            if (counter) __atomic_add_fetch (&counter->value, 1, __ATOMIC_ACQ_REL);
+
+            job_push (job);
+
+            retval = 0;
+        }
+    }
+
+    return retval;
+
+}
+
+// submits a job that will only run after the dependency counter gets to 0
+// returns 0 on success, 1 on error
+u8 job_submit_after (JobCounter *dependency, JobAffinity affinity,
+    void (*work)(void *args), void *args, JobCounter *counter) {
+
+    u8 retval = 1;
+
+    if (dependency && work && !jobs_init (0)) {
+        Job *job = job_new (affinity, work, args, counter);
+        if (job) {
+            if (counter) __atomic_add_fetch (&counter->value, 1, __ATOMIC_ACQ_REL);
+
+            bool wait = false;
+            pthread_mutex_lock (dependency->mutex);
+            if (__atomic_load_n (&dependency->value, __ATOMIC_ACQUIRE) > 0) {
+                job->next = dependency->waiting;
+                dependency->waiting = job;
+                wait = true;
+            }
+            pthread_mutex_unlock (dependency->mutex);
+
+            if (!wait) job_push (job);
+
+            retval = 0;
+        }
+    }
+
+    return retval;
+
+}
+
+static bool jobs_is_main_thread (void) {
+
+    return jobs->main_thread_set && pthread_equal (jobs->main_thread, pthread_self ());
+
+}
+
+// runs every job that was submitted with JOB_AFFINITY_MAIN
+// called by cengine in the main thread once every frame
+void jobs_run_main (void) {
+
+    if (jobs) {
+        jobs->main_thread = pthread_self ();
+        jobs->main_thread_set = true;
+
+        // jobs submitted by these ones will run in the next frame
+        size_t n_jobs = ring_size (jobs->main_queue);
+        Job *job = NULL;
+        for (size_t i = 0; i < n_jobs && !ring_pop (jobs->main_queue, &job); i++)
+            job_run (job);
+    }
+
+}
+
+// waits until the counter gets to 0, running other cpu jobs meanwhile
+// in the main thread it also runs the JOB_AFFINITY_MAIN jobs
+void job_counter_wait (JobCounter *counter) {
+
+    if (counter && jobs) {
+        while (__atomic_load_n (&counter->value, __ATOMIC_ACQUIRE) > 0) {
+            Job *job = NULL;
+            if (jobs_is_main_thread () && !ring_pop (jobs->main_queue, &job)) {
+                job_run (job);
+                continue;
+            }
+
+            job = jobs_find (current_worker);
+            if (job) job_run (job);
+            else sched_yield ();
+        }
+
+        // wait for the last job to be done with the counter
+        pthread_mutex_lock (counter->mutex);
+        pthread_mutex_unlock (counter->mutex);
+    }
+
+}
+
+#pragma endregion
@@ -9,6 +9,7 @@
 #include "cengine/types/string.h"
 #include "cengine/types/vector2d.h"
 
+#include "cengine/assets.h"
 #include "cengine/video.h"
 #include "cengine/graphics.h"
 #include "cengine/renderer.h"
@@ -72,7 +73,7 @@ void ui_button_delete (void *button_ptr) {
 
         if (button->sprites && button->ref_sprites) {
             for (unsigned int  i = 0; i < BUTTON_STATE_TOTAL; i++) {
-                if (!button->ref_sprites[i]) sprite_destroy (button->sprites[i]);
+                if (!button->ref_sprites[i]) assets_release (button->sprites[i]);
                 else button->sprites[i] = NULL;
             }
 
@@ -113,8 +114,13 @@ void ui_button_set_pos_offset (Button *button, int x_offset, int y_offset) {
 void ui_button_set_dimensions (Button *button, unsigned int width, unsigned int height) {
 
     if (button) {
+        ui_element_set_dirty (button->ui_element);
+
         button->ui_element->transform->rect.w = width;
         button->ui_element->transform->rect.h = height;
+
+        ui_element_set_dirty (button->ui_element);
+        ui_element_set_moved (button->ui_element);
     }
 
 }
@@ -123,11 +129,16 @@ void ui_button_set_dimensions (Button *button, unsigned int width, unsigned int
 void ui_button_set_scale (Button *button, int x_scale, int y_scale) {
 
     if (button) {
+        ui_element_set_dirty (button->ui_element);
+
         button->ui_element->transform->x_scale = x_scale;
         button->ui_element->transform->y_scale = y_scale;
 
         button->ui_element->transform->rect.w *= button->ui_element->transform->x_scale;
         button->ui_element->transform->rect.h *= button->ui_element->transform->y_scale;
+
+        ui_element_set_dirty (button->ui_element);
+        ui_element_set_moved (button->ui_element);
     }
 
 }
@@ -135,14 +146,20 @@ void ui_button_set_scale (Button *button, int x_scale, int y_scale) {
 // sets the button to be active depending on values
 void ui_button_set_active (Button *button, bool active) {
 
-    if (button) button->active = active;
+    if (button) {
+        button->active = active;
+        ui_element_set_dirty (button->ui_element);
+    }
 
 }
 
 // toggles the button to be active or not
 void ui_button_toggle_active (Button *button) {
 
-    if (button) button->active = !button->active;
+    if (button) {
+        button->active = !button->active;
+        ui_element_set_dirty (button->ui_element);
+    }
 
 }
 
@@ -164,6 +181,8 @@ void ui_button_set_text (Button *button, Renderer *renderer, const char *text,
 
             ui_text_component_draw (button->text, renderer);
         }
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -178,6 +197,8 @@ void ui_button_update_text (Button *button, Renderer *renderer, const char *text
             // ui_transform_component_set_pos (textbox->text->transform, 
             //     &textbox->transform->rect, textbox->text->transform->pos, true);
         }
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -188,6 +209,8 @@ void ui_button_set_text_pos (Button *button, UIPosition pos) {
     if (button) {
         if (button->text)
             ui_transform_component_set_pos (button->text->transform, NULL, &button->ui_element->transform->rect, pos, true);
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -200,6 +223,8 @@ void ui_button_set_text_pos_offset (Button *button, int x_offset, int y_offset)
             button->text->transform->x_offset = x_offset;
             button->text->transform->y_offset = y_offset;
         }
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -220,6 +245,8 @@ void ui_button_update_text_pos (Button *button) {
                 &button->ui_element->transform->rect, 
                 false);
         }
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -230,6 +257,8 @@ void ui_button_set_font (Button *button, Renderer *renderer, Font *font) {
     if (button) {
         button->text->font = font;
         ui_text_component_draw (button->text, renderer);
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -240,6 +269,8 @@ void ui_button_set_text_color (Button *button, Renderer *renderer, RGBA_Color co
     if (button) {
         button->text->text_color = color;
         ui_text_component_draw (button->text, renderer);
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -250,6 +281,8 @@ void ui_button_set_ouline_colour (Button *button, RGBA_Color colour) {
     if (button) {
         button->outline = true;
         button->outline_colour = colour;
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -260,6 +293,8 @@ void ui_button_set_ouline_scale (Button *button, float x_scale, float y_scale) {
     if (button) {
         button->outline_scale_x = x_scale;
         button->outline_scale_y = y_scale;
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -270,6 +305,8 @@ void ui_button_remove_outline (Button *button) {
     if (button) {
         memset (&button->outline_colour, 0, sizeof (RGBA_Color));
         button->outline = false;
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -286,6 +323,8 @@ void ui_button_set_bg_color (Button *button, Renderer *renderer, RGBA_Color colo
         }
 
         button->colour = true;
+
+        ui_element_set_dirty (button->ui_element);
     } 
 
 }
@@ -301,16 +340,18 @@ void ui_button_remove_background (Button *button) {
 
         memset (&button->bg_colour, 0, sizeof (RGBA_Color));
         button->colour = false;
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
 
 // sets an sprite for each button state
-// the sprite is loaded and deleted when the button gets deleted
+// the sprite is shared with the assets cache and released when the button gets deleted
 void ui_button_set_sprite (Button *button, Renderer *renderer, ButtonState state, const char *filename) {
 
     if (button && filename) {
-        Sprite *sprite = sprite_load (filename, renderer);
+        Sprite *sprite = assets_get_sprite (filename, renderer);
 
         if (sprite) {
             switch (state) {
@@ -334,6 +375,8 @@ void ui_button_set_sprite (Button *button, Renderer *renderer, ButtonState state
                 default: break;
             }
         }
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -362,6 +405,8 @@ void ui_button_ref_sprite (Button *button, ButtonState state, Sprite *sprite) {
 
             default: break;
         }
+
+        ui_element_set_dirty (button->ui_element);
     }
 
 }
@@ -428,6 +473,8 @@ Button *ui_button_create (i32 x, i32 y, u32 w, u32 h, UIPosition pos, Renderer *
 void ui_button_resize (Button *button, WindowSize window_original_size, WindowSize window_new_size) {
 
     if (button) {
+        ui_element_set_dirty (button->ui_element);
+
         if ((window_original_size.width == window_new_size.width) && window_original_size.height == window_new_size.height) {
             button->ui_element->transform->rect.w = button->original_w;
             button->ui_element->transform->rect.h = button->original_h;
@@ -439,6 +486,9 @@ void ui_button_resize (Button *button, WindowSize window_original_size, WindowSi
             button->ui_element->transform->rect.w = new_width;
             button->ui_element->transform->rect.h = new_height;
         }
+
+        ui_element_set_dirty (button->ui_element);
+        ui_element_set_moved (button->ui_element);
     }
 
 }
@@ -450,9 +500,9 @@ void ui_button_draw (Button *button, Renderer *renderer) {
         if (SDL_HasIntersection (&button->ui_element->transform->rect, &renderer->window->screen_rect)) {
             // draw the background
             if (button->bg_texture) {
-                SDL_RenderCopyEx (renderer->renderer, button->bg_texture, 
+                renderer_batch_texture (renderer, button->bg_texture, 
                     &button->bg_texture_rect, &button->ui_element->transform->rect, 
-                    0, 0, SDL_FLIP_NONE);
+                    SDL_FLIP_NONE);
             }
 
             else if (button->colour) 
@@ -462,20 +512,8 @@ void ui_button_draw (Button *button, Renderer *renderer) {
 
             if (button->active) {
                 if (renderer->window->mouse) {
-                    UITransform real_position;
-                    memset (&real_position, 0, sizeof (UITransform));
-
-                    // real_position.rect.x = button->ui_element->parent ? button->ui_element->parent->transform->rect.x + button->ui_element->transform->rect.x : button->ui_element->transform->rect.x;
-                    real_position.rect.x = button->ui_element->transform->rect.x + button->ui_element->abs_offset_x;
-                    // real_position.rect.y = button->ui_element->parent ? button->ui_element->parent->transform->rect.y + button->ui_element->transform->rect.y : button->ui_element->transform->rect.y;
-                    real_position.rect.y = button->ui_element->transform->rect.y + button->ui_element->abs_offset_x;
-                    if (button->ui_element->parent) parent_ui_element_get_position (button->ui_element->parent, &real_position.rect.x, &real_position.rect.y);
-
-                    // check if the mouse is in the button
-                    if (mousePos.x >= real_position.rect.x && mousePos.x <= (real_position.rect.x + button->ui_element->transform->rect.w) && 
-                        mousePos.y >= real_position.rect.y && mousePos.y <= (real_position.rect.y + button->ui_element->transform->rect.h)) {
-                        renderer->ui->ui_element_hover = button->ui_element;
-                            
+                    // 18/10/2026 -- the element under the mouse is resolved by ui_hit_test ()
+                    if (renderer->ui->ui_element_hover == button->ui_element) {
                         // check if the user pressed the left button over the mouse
                         if (input_get_mouse_button_state (MOUSE_LEFT)) {
                             button->pressed = true;
@@ -536,10 +574,10 @@ void ui_button_draw (Button *button, Renderer *renderer) {
                 selected_sprite->dest_rect.x = button->ui_element->transform->rect.x;
                 selected_sprite->dest_rect.y = button->ui_element->transform->rect.y;
 
-                SDL_RenderCopyEx (renderer->renderer, selected_sprite->texture, 
+                renderer_batch_texture (renderer, sprite_get_texture (selected_sprite, renderer), 
                     &selected_sprite->src_rect, 
                     &button->ui_element->transform->rect, 
-                    0, 0, (const SDL_RendererFlip) NO_FLIP);
+                    (SDL_RendererFlip) NO_FLIP);
             } 
 
             // draw button text
@@ -2,6 +2,8 @@
 #include <string.h>
 #include <stdbool.h>
 
+#include <pthread.h>
+
 #include <SDL2/SDL.h>
 
 #include "cengine/types/types.h"
@@ -25,7 +27,12 @@ Text *ui_text_component_new (void) {
         text->font_source = NULL;
         text->text = NULL;
         text->wrap_text = false;
-        text->texture = NULL;
+
+        text->quads = NULL;
+        text->n_quads = text->max_quads = 0;
+
+        text->mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+        pthread_mutex_init (text->mutex, NULL);
     }
 
     return text;
@@ -41,7 +48,12 @@ void ui_text_component_delete (void *text_ptr) {
         text->font = NULL;
         text->font_source = NULL;
         // str_delete (text->text);
-        if (text->texture) SDL_DestroyTexture (text->texture);
+        if (text->quads) free (text->quads);
+
+        if (text->mutex) {
+            pthread_mutex_destroy (text->mutex);
+            free (text->mutex);
+        }
 
         free (text);
     }
@@ -95,36 +107,138 @@ void ui_text_component_set_wrap (Text *text, u32 wrap_lenght) {
 
 }
 
-// creates / updates the text texture
-void ui_text_component_draw (Text *text, Renderer *renderer) {
+// returns 0 on success, 1 on error
+static u8 ui_text_component_quads_grow (Text *text) {
 
-    if (text) {
-        if (text->texture) {
-            // SDL_DestroyTexture (text->texture);
-            texture_destroy (renderer, text->texture);
-            text->texture = NULL;
+    u32 new_max = text->max_quads ? text->max_quads * 2 : TEXT_INIT_QUADS;
+    TextQuad *quads = (TextQuad *) realloc (text->quads, new_max * sizeof (TextQuad));
+    if (quads) {
+        text->quads = quads;
+        text->max_quads = new_max;
+        return 0;
+    }
+
+    return 1;
+
+}
+
+// moves the quads starting at first to a new line
+static void ui_text_component_quads_new_line (Text *text, u32 first, int x_offset, int line_height) {
+
+    for (u32 i = first; i < text->n_quads; i++) {
+        text->quads[i].dest_rect.x -= x_offset;
+        text->quads[i].dest_rect.y += line_height;
+    }
+
+}
+
+// places every glyph of the text, breaking lines at '\n' and,
+// if wrap is enabled, at the last space before the wrap length
+static void ui_text_component_layout (Text *text) {
+
+    FontSource *source = text->font_source;
+    int line_height = source->height;
+
+    int pen_x = 0, pen_y = 0;
+    u32 line_start = 0;             // first quad in the current line
+    i32 break_quad = -1;            // first quad after the last space in the current line
+
+    text->n_quads = 0;
+
+    for (const char *c = text->text->str; *c; c++) {
+        u32 code_point = get_code_point_from_UTF8 (&c, 1);
+
+        if (code_point == '\n') {
+            pen_x = 0;
+            pen_y += line_height;
+            line_start = text->n_quads;
+            break_quad = -1;
+            continue;
         }
 
-        if (text->text->len > 0) {
-            SDL_Surface *surface = NULL;
+        FontGlyph glyph = font_source_get_glyph (source, code_point);
+        if (!glyph.valid) continue;
+
+        if (text->wrap_text && pen_x > 0 && (u32) (pen_x + glyph.advance) > text->wrap_length) {
+            if (code_point == ' ') {
+                // break at this space and drop it
+                pen_x = 0;
+                pen_y += line_height;
+                line_start = text->n_quads;
+                break_quad = -1;
+                continue;
+            }
 
-            if (text->wrap_text) {
-                surface = TTF_RenderText_Blended_Wrapped (text->font_source->ttf_source,
-                    text->text->str, text->text_color, text->wrap_length);
+            if (break_quad > (i32) line_start && break_quad < (i32) text->n_quads) {
+                // move the current word to the next line
+                int x_offset = text->quads[break_quad].dest_rect.x;
+                ui_text_component_quads_new_line (text, (u32) break_quad, x_offset, line_height);
+                pen_x -= x_offset;
+                line_start = (u32) break_quad;
             }
 
             else {
-                surface = TTF_RenderText_Blended (text->font_source->ttf_source, 
-                    text->text->str, text->text_color);
+                // the word is longer than the line, so break it here
+                pen_x = 0;
+                line_start = text->n_quads;
             }
 
-            text->transform->rect.w = surface->w;
-            text->transform->rect.h = surface->h;
+            pen_y += line_height;
+            break_quad = -1;
+        }
+
+        if (code_point == ' ') {
+            pen_x += glyph.advance;
+            break_quad = (i32) text->n_quads;
+            continue;
+        }
 
-            // text->texture = SDL_CreateTextureFromSurface (renderer->renderer, surface);
-            texture_create_from_surface (renderer, &text->texture, surface);
-            // SDL_FreeSurface (surface);
+        if (text->n_quads >= text->max_quads) {
+            if (ui_text_component_quads_grow (text)) break;
         }
+
+        TextQuad *quad = &text->quads[text->n_quads];
+        quad->page = glyph.page;
+        quad->src_rect = glyph.rect;
+        quad->dest_rect.x = pen_x + glyph.offset_x;
+        quad->dest_rect.y = pen_y;
+        quad->dest_rect.w = glyph.rect.w;
+        quad->dest_rect.h = glyph.rect.h;
+        text->n_quads += 1;
+
+        pen_x += glyph.advance;
+    }
+
+    // update the text size
+    int width = 0;
+    for (u32 i = 0; i < text->n_quads; i++) {
+        if (text->quads[i].dest_rect.x + text->quads[i].dest_rect.w > width)
+            width = text->quads[i].dest_rect.x + text->quads[i].dest_rect.w;
+    }
+
+    text->transform->rect.w = width;
+    text->transform->rect.h = pen_y + line_height;
+
+}
+
+// lays out the text using the font source glyph atlas,
+// updates the transform size to fit the text
+void ui_text_component_draw (Text *text, Renderer *renderer) {
+
+    if (text) {
+        pthread_mutex_lock (text->mutex);
+
+        if (text->text && text->text->len > 0 && text->font_source) {
+            ui_text_component_layout (text);
+        }
+
+        else {
+            text->n_quads = 0;
+            text->transform->rect.w = 0;
+            text->transform->rect.h = 0;
+        }
+
+        pthread_mutex_unlock (text->mutex);
     }
 
 }
@@ -132,11 +246,31 @@ void ui_text_component_draw (Text *text, Renderer *renderer) {
 // renders the text component to the screen
 void ui_text_component_render (Text *text, Renderer *renderer) {
 
-    if (text) {
-        if (text->texture) {
-            SDL_RenderCopy (renderer->renderer, text->texture, 
-                NULL, &text->transform->rect);
+    if (text && renderer) {
+        pthread_mutex_lock (text->mutex);
+
+        if (text->n_quads && text->font_source) {
+            SDL_Texture *pages[FONT_ATLAS_MAX_PAGES] = { 0 };
+
+            SDL_Rect dest = { 0 };
+            TextQuad *quad = NULL;
+            for (u32 i = 0; i < text->n_quads; i++) {
+                quad = &text->quads[i];
+
+                if (!pages[quad->page]) 
+                    pages[quad->page] = font_source_get_page_texture (text->font_source, renderer, quad->page);
+
+                dest.x = text->transform->rect.x + quad->dest_rect.x;
+                dest.y = text->transform->rect.y + quad->dest_rect.y;
+                dest.w = quad->dest_rect.w;
+                dest.h = quad->dest_rect.h;
+
+                renderer_batch_texture_colour (renderer, pages[quad->page], 
+                    &quad->src_rect, &dest, SDL_FLIP_NONE, text->text_color);
+            }
         }
+
+        pthread_mutex_unlock (text->mutex);
     }
 
 }
\ No newline at end of file
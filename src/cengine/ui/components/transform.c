@@ -24,8 +24,13 @@ void ui_transform_component_delete_dummy (void *transform_ptr) {}
 void ui_transform_component_set_pos (UITransform *transform, Renderer *renderer, UIRect *ref_rect, UIPosition pos, bool offset) {
 
     if (transform) {
+        ui_element_set_dirty (transform->ui_element);
+
         transform->pos = pos;
         ui_position_update (renderer, transform, ref_rect, offset);
+
+        ui_element_set_dirty (transform->ui_element);
+        ui_element_set_moved (transform->ui_element);
     } 
 
 }
@@ -34,10 +39,15 @@ void ui_transform_component_set_values (UITransform *transform,
     int x, int y, int w, int h) {
 
     if (transform) {
+        ui_element_set_dirty (transform->ui_element);
+
         transform->rect.x = x;
         transform->rect.y = y;
         transform->rect.w = w;
         transform->rect.h = h;
+
+        ui_element_set_dirty (transform->ui_element);
+        ui_element_set_moved (transform->ui_element);
     }
 
 }
@@ -98,9 +98,9 @@ void ui_cursor_draw (Cursor *cursor, Renderer *renderer) {
         cursor->sprite->dest_rect.x = mousePos.x;
         cursor->sprite->dest_rect.y = mousePos.y;
 
-        SDL_RenderCopyEx (renderer->renderer, cursor->sprite->texture, 
+        renderer_batch_texture (renderer, sprite_get_texture (cursor->sprite, renderer), 
             &cursor->sprite->src_rect, &cursor->sprite->dest_rect, 
-            0, 0, (const SDL_RendererFlip) NO_FLIP);   
+            (SDL_RendererFlip) NO_FLIP);
     }
 
 }
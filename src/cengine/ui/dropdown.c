@@ -132,6 +132,15 @@ static void ui_dropdown_option_render (DropdownOption *option, Renderer *rendere
 
 #pragma region Dropdown
 
+// marks the dropdown and the area where its options are drawn as dirty
+void ui_dropdown_set_dirty (Dropdown *dropdown) {
+
+    ui_element_set_dirty (dropdown->ui_element);
+    if (dropdown->vertical_layout)
+        ui_element_set_dirty_rect (dropdown->ui_element, &dropdown->vertical_layout->transform->rect);
+
+}
+
 static Dropdown *ui_dropdown_new (void) {
 
     Dropdown *dropdown = (Dropdown *) malloc (sizeof (Dropdown));
@@ -240,6 +249,7 @@ void ui_dropdown_set_active (Dropdown *dropdown, bool active) {
     if (dropdown) {
         dropdown->active = active;
         if (!dropdown->active) dropdown->extended = false;
+        ui_dropdown_set_dirty (dropdown);
     } 
 
 }
@@ -250,6 +260,7 @@ void ui_dropdown_toggle_active (Dropdown *dropdown) {
     if (dropdown) {
         dropdown->active = !dropdown->active;
         if (!dropdown->active) dropdown->extended = false;
+        ui_dropdown_set_dirty (dropdown);
     } 
 
 }
@@ -260,6 +271,8 @@ void ui_dropdown_set_ouline_colour (Dropdown *dropdown, RGBA_Color colour) {
     if (dropdown) {
         dropdown->outline = true;
         dropdown->outline_colour = colour;
+
+        ui_dropdown_set_dirty (dropdown);
     }
 
 }
@@ -270,6 +283,8 @@ void ui_dropdown_set_outline_scale (Dropdown *dropdown, float x_scale, float y_s
     if (dropdown) {
         dropdown->outline_scale_x = x_scale;
         dropdown->outline_scale_y = y_scale;
+
+        ui_dropdown_set_dirty (dropdown);
     }
 
 }
@@ -280,6 +295,8 @@ void ui_dropdown_remove_outline (Dropdown *dropdown) {
     if (dropdown) {
         memset (&dropdown->outline_colour, 0, sizeof (RGBA_Color));
         dropdown->outline = false;
+
+        ui_dropdown_set_dirty (dropdown);
     }
 
 }
@@ -296,6 +313,8 @@ void ui_dropdown_set_bg_color (Dropdown *dropdown, Renderer *renderer, RGBA_Colo
         }
 
         dropdown->colour = true;
+
+        ui_dropdown_set_dirty (dropdown);
     } 
 
 }
@@ -311,6 +330,8 @@ void ui_dropdown_remove_background (Dropdown *dropdown) {
 
         memset (&dropdown->bg_colour, 0, sizeof (RGBA_Color));
         dropdown->colour = false;
+
+        ui_dropdown_set_dirty (dropdown);
     }
 
 }
@@ -333,6 +354,8 @@ void ui_dropdown_set_placeholder (Dropdown *dropdown, Renderer *renderer,
 
             ui_text_component_draw (dropdown->placeholder, renderer);
         }
+
+        ui_dropdown_set_dirty (dropdown);
     }
 
 }
@@ -343,6 +366,8 @@ void ui_dropdown_set_placeholder_pos (Dropdown *dropdown, UIPosition pos) {
     if (dropdown) {
         if (dropdown->placeholder) 
             ui_transform_component_set_pos (dropdown->placeholder->transform, NULL, &dropdown->ui_element->transform->rect, pos, true);
+
+        ui_dropdown_set_dirty (dropdown);
     }
 
 }
@@ -350,7 +375,10 @@ void ui_dropdown_set_placeholder_pos (Dropdown *dropdown, UIPosition pos) {
 // sets the dropdown's extened panel colour
 void ui_dropdown_extened_set_bg_colour (Dropdown *dropdown, Renderer *renderer, RGBA_Color colour) {
 
-    if (dropdown) ui_panel_set_bg_colour (dropdown->extended_panel, renderer, colour);
+    if (dropdown) {
+        ui_panel_set_bg_colour (dropdown->extended_panel, renderer, colour);
+        ui_dropdown_set_dirty (dropdown);
+    }
 
 }
 
@@ -369,6 +397,8 @@ void ui_dropdown_option_add (Dropdown *dropdown, DropdownOption *option) {
         //     op = (DropdownOption *) le->data;
         //     // ui_position_update (NULL, op->option->transform, &op->transform->rect, false);
         // }
+
+        ui_dropdown_set_dirty (dropdown);
     }
 
 }
@@ -398,6 +428,8 @@ void ui_dropdown_option_remove (Dropdown *dropdown, DropdownOption *option) {
     if (dropdown && option) {
         ui_layout_vertical_remove (dropdown->vertical_layout, option->button->ui_element);
         dlist_remove_element (dropdown->options, dlist_get_element (dropdown->options, option, NULL));
+
+        ui_dropdown_set_dirty (dropdown);
     }
 
 }
@@ -434,9 +466,9 @@ void ui_dropdown_render (Dropdown *dropdown, Renderer *renderer) {
         if (SDL_HasIntersection (&dropdown->ui_element->transform->rect, &renderer->window->screen_rect)) {
             // render the background
             if (dropdown->bg_texture) {
-                SDL_RenderCopyEx (renderer->renderer, dropdown->bg_texture, 
+                renderer_batch_texture (renderer, dropdown->bg_texture, 
                     &dropdown->bg_texture_rect, &dropdown->ui_element->transform->rect, 
-                    0, 0, SDL_FLIP_NONE);
+                    SDL_FLIP_NONE);
             }
 
             else if (dropdown->colour) 
@@ -444,8 +476,7 @@ void ui_dropdown_render (Dropdown *dropdown, Renderer *renderer) {
 
             // check if the mouse is in the dropdown
             if (dropdown->active) {
-                if (mousePos.x >= dropdown->ui_element->transform->rect.x && mousePos.x <= (dropdown->ui_element->transform->rect.x + dropdown->ui_element->transform->rect.w) && 
-                    mousePos.y >= dropdown->ui_element->transform->rect.y && mousePos.y <= (dropdown->ui_element->transform->rect.y + dropdown->ui_element->transform->rect.h)) {
+                if (renderer->ui->ui_element_hover == dropdown->ui_element) {
                     // the mouse is over use
                     render_basic_filled_rect (renderer, &dropdown->ui_element->transform->rect, RGBA_BLACK);
 
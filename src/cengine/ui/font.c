@@ -3,9 +3,12 @@
 #include <stdbool.h>
 #include <stdarg.h>
 
+#include <pthread.h>
+
 #include "cengine/types/types.h"
 #include "cengine/types/string.h"
 
+#include "cengine/files.h"
 #include "cengine/renderer.h"
 
 #include "cengine/ui/ui.h"
@@ -95,6 +98,42 @@ u32 get_code_point_from_UTF8 (const char **c, u8 advancePtr) {
 
 }
 
+// writes the utf8 bytes of a code point returned by get_code_point_from_UTF8 ()
+// returns the number of bytes written (without the NULL terminator)
+int font_code_point_to_UTF8 (u32 code_point, char *buffer) {
+
+    int len = 0;
+
+    if (buffer) {
+        if (code_point <= 0xFF) {
+            buffer[len++] = (char) code_point;
+        }
+
+        else if (code_point <= 0xFFFF) {
+            buffer[len++] = (char) (code_point >> 8);
+            buffer[len++] = (char) code_point;
+        }
+
+        else if (code_point <= 0xFFFFFF) {
+            buffer[len++] = (char) (code_point >> 16);
+            buffer[len++] = (char) (code_point >> 8);
+            buffer[len++] = (char) code_point;
+        }
+
+        else {
+            buffer[len++] = (char) (code_point >> 24);
+            buffer[len++] = (char) (code_point >> 16);
+            buffer[len++] = (char) (code_point >> 8);
+            buffer[len++] = (char) code_point;
+        }
+
+        buffer[len] = '\0';
+    }
+
+    return len;
+
+}
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-function"
 
@@ -139,6 +178,275 @@ static inline SDL_Surface *font_create_surface (u32 width, u32 height) {
 
 #pragma endregion
 
+/*** Atlas ***/
+
+#pragma region Atlas
+
+FontAtlas *font_atlas_new (void) {
+
+    FontAtlas *atlas = (FontAtlas *) malloc (sizeof (FontAtlas));
+    if (atlas) {
+        memset (atlas, 0, sizeof (FontAtlas));
+
+        atlas->glyphs = (FontGlyph *) calloc (FONT_ATLAS_INIT_GLYPHS, sizeof (FontGlyph));
+        atlas->glyphs_size = atlas->glyphs ? FONT_ATLAS_INIT_GLYPHS : 0;
+
+        atlas->mutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+        pthread_mutex_init (atlas->mutex, NULL);
+    }
+
+    return atlas;
+
+}
+
+void font_atlas_delete (void *atlas_ptr) {
+
+    if (atlas_ptr) {
+        FontAtlas *atlas = (FontAtlas *) atlas_ptr;
+
+        for (u8 i = 0; i < atlas->n_pages; i++) {
+            if (atlas->pages[i].surface) SDL_FreeSurface (atlas->pages[i].surface);
+            if (atlas->pages[i].texture) SDL_DestroyTexture (atlas->pages[i].texture);
+        }
+
+        if (atlas->glyphs) free (atlas->glyphs);
+
+        if (atlas->mutex) {
+            pthread_mutex_destroy (atlas->mutex);
+            free (atlas->mutex);
+        }
+
+        free (atlas);
+    }
+
+}
+
+static inline u32 font_atlas_hash (u32 code_point) {
+
+    // fibonacci hashing, the table size is always a power of two
+    return code_point * 2654435769u;
+
+}
+
+static FontGlyph *font_atlas_glyph_slot (FontGlyph *glyphs, u32 size, u32 code_point) {
+
+    u32 idx = font_atlas_hash (code_point) & (size - 1);
+    while (glyphs[idx].code_point && glyphs[idx].code_point != code_point)
+        idx = (idx + 1) & (size - 1);
+
+    return &glyphs[idx];
+
+}
+
+// returns 0 on success, 1 on error
+static u8 font_atlas_glyphs_grow (FontAtlas *atlas) {
+
+    u32 new_size = atlas->glyphs_size ? atlas->glyphs_size * 2 : FONT_ATLAS_INIT_GLYPHS;
+    FontGlyph *glyphs = (FontGlyph *) calloc (new_size, sizeof (FontGlyph));
+    if (glyphs) {
+        for (u32 i = 0; i < atlas->glyphs_size; i++) {
+            if (atlas->glyphs[i].code_point) {
+                memcpy (font_atlas_glyph_slot (glyphs, new_size, atlas->glyphs[i].code_point),
+                    &atlas->glyphs[i], sizeof (FontGlyph));
+            }
+        }
+
+        if (atlas->glyphs) free (atlas->glyphs);
+        atlas->glyphs = glyphs;
+        atlas->glyphs_size = new_size;
+
+        return 0;
+    }
+
+    return 1;
+
+}
+
+// finds a place for a w x h rect in the atlas pages, adding a new page if needed
+// returns 0 on success, 1 if the atlas is full
+static u8 font_atlas_pack (FontAtlas *atlas, int w, int h, u8 *page_idx, SDL_Rect *rect) {
+
+    w += FONT_ATLAS_GLYPH_PADDING;
+    h += FONT_ATLAS_GLYPH_PADDING;
+
+    if (w > FONT_ATLAS_PAGE_SIZE || h > FONT_ATLAS_PAGE_SIZE) return 1;
+
+    FontAtlasPage *page = atlas->n_pages ? &atlas->pages[atlas->n_pages - 1] : NULL;
+    if (page) {
+        // start a new shelf
+        if (page->pen_x + w > FONT_ATLAS_PAGE_SIZE) {
+            page->pen_x = 0;
+            page->pen_y += page->row_height;
+            page->row_height = 0;
+        }
+
+        // the page is full
+        if (page->pen_y + h > FONT_ATLAS_PAGE_SIZE) page = NULL;
+    }
+
+    if (!page) {
+        if (atlas->n_pages >= FONT_ATLAS_MAX_PAGES) return 1;
+
+        page = &atlas->pages[atlas->n_pages];
+        memset (page, 0, sizeof (FontAtlasPage));
+        page->surface = font_create_surface (FONT_ATLAS_PAGE_SIZE, FONT_ATLAS_PAGE_SIZE);
+        if (!page->surface) return 1;
+
+        atlas->n_pages += 1;
+    }
+
+    rect->x = page->pen_x;
+    rect->y = page->pen_y;
+    rect->w = w - FONT_ATLAS_GLYPH_PADDING;
+    rect->h = h - FONT_ATLAS_GLYPH_PADDING;
+    *page_idx = atlas->n_pages - 1;
+
+    page->pen_x += w;
+    if (h > page->row_height) page->row_height = h;
+
+    return 0;
+
+}
+
+// the code points of get_code_point_from_UTF8 () are the utf8 bytes, ttf metrics need the unicode value
+static u32 font_utf8_to_unicode (const char *buffer) {
+
+    const unsigned char *c = (const unsigned char *) buffer;
+
+    if (c[0] <= 0x7F) return c[0];
+    else if (c[0] < 0xE0) return ((c[0] & 0x1F) << 6) | (c[1] & 0x3F);
+    else if (c[0] < 0xF0) return ((c[0] & 0x0F) << 12) | ((c[1] & 0x3F) << 6) | (c[2] & 0x3F);
+    else return ((c[0] & 0x07) << 18) | ((c[1] & 0x3F) << 12) | ((c[2] & 0x3F) << 6) | (c[3] & 0x3F);
+
+}
+
+// rasterizes the glyph into the atlas, the atlas mutex must be locked
+// returns 0 on success, 1 if it could not be rendered or it did not fit in the atlas
+static u8 font_atlas_add_glyph (FontAtlas *atlas, TTF_Font *ttf, FontGlyph *glyph) {
+
+    u8 retval = 1;
+
+    char buffer[8] = { 0 };
+    font_code_point_to_UTF8 (glyph->code_point, buffer);
+
+    // glyphs are rendered in white and get their colour when drawn
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface *surface = TTF_RenderUTF8_Blended (ttf, buffer, white);
+    if (surface) {
+        // the surface is as wide as the glyph ink, that can be more or less than the advance,
+        // and it starts at minx if the glyph goes to the left of the pen
+        int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+        u32 unicode = font_utf8_to_unicode (buffer);
+        if (unicode <= 0xFFFF && !TTF_GlyphMetrics (ttf, (Uint16) unicode, &minx, &maxx, &miny, &maxy, &advance)) {
+            glyph->advance = advance;
+            glyph->offset_x = minx < 0 ? minx : 0;
+        }
+
+        else {
+            glyph->advance = surface->w;
+            glyph->offset_x = 0;
+        }
+
+        if (!font_atlas_pack (atlas, surface->w, surface->h, &glyph->page, &glyph->rect)) {
+            FontAtlasPage *page = &atlas->pages[glyph->page];
+
+            // copy the pixels as they are, including alpha
+            SDL_SetSurfaceBlendMode (surface, SDL_BLENDMODE_NONE);
+            SDL_Rect dest = glyph->rect;
+            SDL_BlitSurface (surface, NULL, page->surface, &dest);
+
+            if (page->dirty) SDL_UnionRect (&page->dirty_rect, &glyph->rect, &page->dirty_rect);
+            else {
+                page->dirty_rect = glyph->rect;
+                page->dirty = true;
+            }
+
+            glyph->valid = true;
+
+            retval = 0;
+        }
+
+        SDL_FreeSurface (surface);
+    }
+
+    return retval;
+
+}
+
+// gets the glyph for the code point, rasterizing it into the atlas if needed
+// returns a copy of the glyph, check glyph.valid
+FontGlyph font_source_get_glyph (FontSource *source, u32 code_point) {
+
+    FontGlyph retval = { 0 };
+
+    if (source && source->atlas && source->ttf_source && code_point) {
+        FontAtlas *atlas = source->atlas;
+
+        pthread_mutex_lock (atlas->mutex);
+
+        if (((atlas->n_glyphs + 1) * 4) > (atlas->glyphs_size * 3)) 
+            (void) font_atlas_glyphs_grow (atlas);
+
+        if (atlas->glyphs_size) {
+            FontGlyph *glyph = font_atlas_glyph_slot (atlas->glyphs, atlas->glyphs_size, code_point);
+            if (!glyph->code_point) {
+                glyph->code_point = code_point;
+                if (!font_atlas_add_glyph (atlas, source->ttf_source, glyph)) atlas->n_glyphs += 1;
+            }
+
+            memcpy (&retval, glyph, sizeof (FontGlyph));
+
+            // the slot was empty, so it can be freed again and the glyph will be retried the next time
+            if (!glyph->valid) memset (glyph, 0, sizeof (FontGlyph));
+        }
+
+        pthread_mutex_unlock (atlas->mutex);
+    }
+
+    return retval;
+
+}
+
+// gets the texture of an atlas page, uploading any new glyphs
+// must be called from the renderer's thread
+SDL_Texture *font_source_get_page_texture (FontSource *source, Renderer *renderer, u8 page_idx) {
+
+    SDL_Texture *texture = NULL;
+
+    if (source && source->atlas && renderer) {
+        FontAtlas *atlas = source->atlas;
+
+        pthread_mutex_lock (atlas->mutex);
+
+        if (page_idx < atlas->n_pages) {
+            FontAtlasPage *page = &atlas->pages[page_idx];
+            if (!page->texture) {
+                page->texture = SDL_CreateTextureFromSurface (renderer->renderer, page->surface);
+                if (page->texture) SDL_SetTextureBlendMode (page->texture, SDL_BLENDMODE_BLEND);
+                page->dirty = false;
+            }
+
+            else if (page->dirty) {
+                // only upload the part of the page that changed
+                u8 *pixels = (u8 *) page->surface->pixels 
+                    + page->dirty_rect.y * page->surface->pitch 
+                    + page->dirty_rect.x * 4;
+                SDL_UpdateTexture (page->texture, &page->dirty_rect, pixels, page->surface->pitch);
+                page->dirty = false;
+            }
+
+            texture = page->texture;
+        }
+
+        pthread_mutex_unlock (atlas->mutex);
+    }
+
+    return texture;
+
+}
+
+#pragma endregion
+
 /*** Font Source ***/
 
 static FontSource *font_source_new (void) {
@@ -159,6 +467,7 @@ static void font_source_delete (void *font_source_ptr) {
     if (font_source_ptr) {
         FontSource *source = (FontSource *) font_source_ptr;
         // if (source->owns_ttf_source) TTF_CloseFont (source->ttf_source);
+        font_atlas_delete (source->atlas);
         free (source);
     }
 
@@ -305,6 +614,8 @@ static void ui_font_source_load_from_ttf (FontSource *source, TTF_Font *ttf, Ren
 
     source->baseline = source->height - source->descent;
 
+    source->atlas = font_atlas_new ();
+
 }
 
 static FontSource *ui_font_load_source (Renderer *renderer, Font *font, SDL_RWops *file_rwops_ttf,
@@ -351,12 +662,13 @@ u8 ui_font_load (Font *font, Renderer *renderer, int style) {
     if (font) {
         // check first if font sizes had been set
         if (font->n_sizes > 0) {
-            SDL_RWops *rwops = SDL_RWFromFile (font->filename->str, "rb");
-            if (rwops) {
-                font->sources = (FontSource **) calloc (font->n_sizes, sizeof (FontSource *));
+            font->sources = (FontSource **) calloc (font->n_sizes, sizeof (FontSource *));
 
-                // load the font for each set size
-                for (unsigned int i = 0; i < font->n_sizes; i++) {
+            // load the font for each set size
+            // every size gets its own rwops, as each ttf reads from it & closes it
+            for (unsigned int i = 0; i < font->n_sizes; i++) {
+                SDL_RWops *rwops = file_open_rw (font->filename->str);
+                if (rwops) {
                     font->sources[i] = ui_font_load_source (renderer, font, rwops, 1, font->sizes[i], style);
                     if (!font->sources[i]) {
                         cengine_log_msg (stderr, LOG_WARNING, LOG_NO_TYPE,
@@ -365,13 +677,14 @@ u8 ui_font_load (Font *font, Renderer *renderer, int style) {
                         errors = 1;
                     }
                 }
+
+                else {
+                    cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, 
+                        c_string_create ("Failed to open font file: %s", font->filename->str));
+                    errors = 1;
+                    break;
+                } 
             }
-            
-            else {
-                cengine_log_msg (stderr, LOG_ERROR, LOG_NO_TYPE, 
-                    c_string_create ("Failed to open font file: %s", font->filename->str));
-                errors = 1;
-            } 
         }
 
         else {
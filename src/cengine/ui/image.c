@@ -10,6 +10,7 @@
 #include "cengine/types/types.h"
 #include "cengine/types/vector2d.h"
 
+#include "cengine/assets.h"
 #include "cengine/sprites.h"
 #include "cengine/renderer.h"
 #include "cengine/input.h"
@@ -70,9 +71,10 @@ void ui_image_delete (void *image_ptr) {
             image->sprite_sheet = NULL;
         }
 
+        // 18/10/2026 -- the sprites are shared using the assets cache
         else {
-            sprite_destroy (image->sprite);
-            sprite_sheet_destroy (image->sprite_sheet);
+            assets_release (image->sprite);
+            assets_release (image->sprite_sheet);
         }
 
         if (image->overlay_texture && !image->overlay_reference) 
@@ -108,6 +110,8 @@ void ui_image_set_texture (Image *image, SDL_Texture *texture) {
         }
 
         image->texture = texture;
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -137,6 +141,8 @@ void ui_image_set_texture_src_rect (Image *image,
             image->texture_src_rect->w = w;
             image->texture_src_rect->h = h;
         }
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -145,8 +151,13 @@ void ui_image_set_texture_src_rect (Image *image,
 void ui_image_set_dimensions (Image *image, unsigned int width, unsigned int height) {
 
     if (image) {
+        ui_element_set_dirty (image->ui_element);
+
         image->ui_element->transform->rect.w = width;
         image->ui_element->transform->rect.h = height;
+
+        ui_element_set_dirty (image->ui_element);
+        ui_element_set_moved (image->ui_element);
     }
 
 }
@@ -155,11 +166,16 @@ void ui_image_set_dimensions (Image *image, unsigned int width, unsigned int hei
 void ui_image_set_scale (Image *image, int x_scale, int y_scale) {
 
     if (image) {
+        ui_element_set_dirty (image->ui_element);
+
         image->ui_element->transform->x_scale = x_scale;
         image->ui_element->transform->y_scale = y_scale;
 
         image->ui_element->transform->rect.w *= image->ui_element->transform->x_scale;
         image->ui_element->transform->rect.h *= image->ui_element->transform->y_scale;
+
+        ui_element_set_dirty (image->ui_element);
+        ui_element_set_moved (image->ui_element);
     }
 
 }
@@ -171,14 +187,19 @@ u8 ui_image_set_sprite (Image *image, Renderer *renderer, const char *filename)
     u8 retval = 1;
 
     if (image && renderer && filename) {
-        if (!image->ref_sprite) sprite_destroy (image->sprite);
+        ui_element_set_dirty (image->ui_element);
+
+        if (!image->ref_sprite) assets_release (image->sprite);
 
-        image->sprite = sprite_load (filename, renderer);
+        image->sprite = assets_get_sprite (filename, renderer);
         if (image->sprite) {
             image->ui_element->transform->rect.w = image->sprite->w;
             image->ui_element->transform->rect.h = image->sprite->h;
             retval = 0;
         }
+
+        ui_element_set_dirty (image->ui_element);
+        ui_element_set_moved (image->ui_element);
     }
 
     return retval;
@@ -192,10 +213,12 @@ u8 ui_image_set_sprite_sheet (Image *image, Renderer *renderer, const char *file
     u8 retval = 1;
 
     if (image && renderer && filename) {
-        if (!image->ref_sprite) sprite_sheet_destroy (image->sprite_sheet);
+        if (!image->ref_sprite) assets_release (image->sprite_sheet);
 
-        image->sprite_sheet = sprite_sheet_load (filename, renderer);
+        image->sprite_sheet = assets_get_sprite_sheet (filename, renderer);
         if (image->sprite_sheet) retval = 0;
+
+        ui_element_set_dirty (image->ui_element);
     }
 
     return retval;
@@ -206,10 +229,12 @@ u8 ui_image_set_sprite_sheet (Image *image, Renderer *renderer, const char *file
 void ui_image_ref_sprite (Image *image, Sprite *sprite) {
 
     if (image && sprite) {
-        if (!image->ref_sprite) sprite_destroy (image->sprite);
+        if (!image->ref_sprite) assets_release (image->sprite);
 
         image->sprite = sprite;
         image->ref_sprite = true;
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -218,10 +243,12 @@ void ui_image_ref_sprite (Image *image, Sprite *sprite) {
 void ui_image_ref_sprite_sheet (Image *image, SpriteSheet *sprite_sheet) {
 
     if (image && sprite_sheet) {
-        if (!image->ref_sprite) sprite_sheet_destroy (image->sprite_sheet);
+        if (!image->ref_sprite) assets_release (image->sprite_sheet);
 
         image->sprite_sheet = sprite_sheet;
         image->ref_sprite = true;
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -232,6 +259,8 @@ void ui_image_set_sprite_sheet_offset (Image *image, u32 x_offset, u32 y_offset)
     if (image) {
         image->x_sprite_offset = x_offset;
         image->y_sprite_offset = y_offset;
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -242,6 +271,8 @@ void ui_image_set_ouline_colour (Image *image, RGBA_Color colour) {
     if (image) {
         image->outline = true;
         image->outline_colour = colour;
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -252,6 +283,8 @@ void ui_image_set_outline_scale (Image *image, float x_scale, float y_scale) {
     if (image) {
         image->outline_scale_x = x_scale;
         image->outline_scale_y = y_scale;
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -262,6 +295,8 @@ void ui_image_remove_outline (Image *image) {
     if (image) {
         memset (&image->outline_colour, 0, sizeof (RGBA_Color));
         image->outline = false;
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -270,7 +305,10 @@ void ui_image_remove_outline (Image *image) {
 // action listerner working
 void ui_image_set_active (Image *image, bool active) {
 
-    if (image) image->active = active;
+    if (image) {
+        image->active = active;
+        ui_element_set_dirty (image->ui_element);
+    }
 
 }
 
@@ -278,7 +316,10 @@ void ui_image_set_active (Image *image, bool active) {
 // action listerner working
 void ui_image_toggle_active (Image *image) {
 
-    if (image) image->active = !image->active;
+    if (image) {
+        image->active = !image->active;
+        ui_element_set_dirty (image->ui_element);
+    }
 
 }
 
@@ -322,6 +363,8 @@ void ui_image_set_overlay (Image *image, Renderer *renderer, RGBA_Color color) {
 
         render_complex_transparent_rect (renderer, &image->overlay_texture, &image->ui_element->transform->rect, color); 
         image->overlay_reference = false;   
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -340,6 +383,8 @@ void ui_image_set_overlay_ref (Image *image, SDL_Texture *overlay_ref) {
 
         image->overlay_texture = overlay_ref;
         image->overlay_reference = true;
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -356,6 +401,8 @@ void ui_image_remove_overlay (Image *image) {
             image->overlay_texture = NULL;
             image->overlay_reference = false;
         }
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -373,6 +420,8 @@ void ui_image_set_selected (Image *image, Renderer *renderer, RGBA_Color color)
 
         render_complex_transparent_rect (renderer, &image->selected_texture, &image->ui_element->transform->rect, color); 
         image->selected_reference = false;   
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -391,6 +440,8 @@ void ui_image_set_selected_ref (Image *image, SDL_Texture *selected_ref) {
 
         image->selected_texture = selected_ref;
         image->selected_reference = true;
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -407,6 +458,8 @@ void ui_image_remove_selected (Image *image) {
             image->selected_texture = NULL;
             image->selected_reference = false;
         }
+
+        ui_element_set_dirty (image->ui_element);
     }
 
 }
@@ -467,6 +520,7 @@ u8 ui_image_update_texture_from_mem (Image *image, Renderer *renderer, void *mem
                 if (image->texture) texture_destroy (renderer, image->texture);
 
                 texture_create_from_surface (renderer, &image->texture, surface);
+                ui_element_set_dirty (image->ui_element);
 
                 retval = 0;
             }
@@ -518,6 +572,7 @@ u8 ui_image_update_streaming_texture_mem (Image *image, Renderer *renderer, void
                 // SDL_DestroyTexture (image->texture);
                 // texture_create_from_surface (renderer, &image->texture, surface);
                 texture_update (renderer, &image->texture, surface);
+                ui_element_set_dirty (image->ui_element);
 
                 retval = 0;
             }
@@ -549,25 +604,24 @@ void ui_image_draw (Image *image, Renderer *renderer) {
     if (image && renderer) {
         if (SDL_HasIntersection (&image->ui_element->transform->rect, &renderer->window->screen_rect)) {
             if (image->texture) {
-                SDL_RenderCopyEx (renderer->renderer, image->texture, 
+                renderer_batch_texture (renderer, image->texture, 
                     image->texture_src_rect, &image->ui_element->transform->rect, 
-                    0, 0, (const SDL_RendererFlip) image->flip);
+                    (SDL_RendererFlip) image->flip);
             }
 
             else {
                 if (image->sprite) {
-                    SDL_RenderCopyEx (renderer->renderer, image->sprite->texture, 
+                    renderer_batch_texture (renderer, sprite_get_texture (image->sprite, renderer), 
                         &image->sprite->src_rect, &image->ui_element->transform->rect, 
-                        0, 0, (const SDL_RendererFlip) image->flip);
+                        (SDL_RendererFlip) image->flip);
                 }
                 
                 else if (image->sprite_sheet) {
-                    image->sprite_sheet->src_rect.x = image->sprite_sheet->sprite_w * image->x_sprite_offset;
-                    image->sprite_sheet->src_rect.y = image->sprite_sheet->sprite_h * image->y_sprite_offset;
+                    sprite_sheet_set_frame (image->sprite_sheet, image->x_sprite_offset, image->y_sprite_offset);
 
-                    SDL_RenderCopyEx (renderer->renderer, image->sprite_sheet->texture, 
+                    renderer_batch_texture (renderer, sprite_sheet_get_texture (image->sprite_sheet, renderer), 
                         &image->sprite_sheet->src_rect, &image->ui_element->transform->rect, 
-                        0, 0, (const SDL_RendererFlip) image->flip);
+                        (SDL_RendererFlip) image->flip);
                 }
             }
 
@@ -579,15 +633,12 @@ void ui_image_draw (Image *image, Renderer *renderer) {
             // check for action listener
             if (image->active) {
                 if (renderer->window->mouse) {
-                    // check if the mouse is in the image
-                    if (mousePos.x >= image->ui_element->transform->rect.x + image->ui_element->abs_offset_x && mousePos.x <= (image->ui_element->transform->rect.x + image->ui_element->transform->rect.w + image->ui_element->abs_offset_x) && 
-                        mousePos.y >= image->ui_element->transform->rect.y + image->ui_element->abs_offset_y && mousePos.y <= (image->ui_element->transform->rect.y + image->ui_element->transform->rect.h + image->ui_element->abs_offset_y)) {
-                        renderer->ui->ui_element_hover = image->ui_element;
-                            
+                    // 18/10/2026 -- the element under the mouse is resolved by ui_hit_test ()
+                    if (renderer->ui->ui_element_hover == image->ui_element) {
                         if (image->overlay_texture && !image->selected) {
-                            SDL_RenderCopyEx (renderer->renderer, image->overlay_texture, 
+                            renderer_batch_texture (renderer, image->overlay_texture, 
                                 NULL, &image->ui_element->transform->rect, 
-                                0, 0, (const SDL_RendererFlip) image->flip);
+                                (SDL_RendererFlip) image->flip);
                         }
 
                         // check if the user pressed the left button over the image
@@ -637,9 +688,9 @@ void ui_image_draw (Image *image, Renderer *renderer) {
             }
 
             if (image->selected && image->selected_texture) {
-                SDL_RenderCopyEx (renderer->renderer, image->selected_texture, 
+                renderer_batch_texture (renderer, image->selected_texture, 
                     NULL, &image->ui_element->transform->rect, 
-                    0, 0, (const SDL_RendererFlip) image->flip);
+                    (SDL_RendererFlip) image->flip);
             }
 
             renderer->render_count += 1;
@@ -64,14 +64,20 @@ void ui_input_field_delete (void *input_ptr) {
 // sets the input field to be active depending on values
 void ui_input_field_set_active (InputField *input, bool active) {
 
-    if (input) input->active = active;
+    if (input) {
+        input->active = active;
+        ui_element_set_dirty (input->ui_element);
+    }
 
 }
 
 // toggles the input field to be active or not
 void ui_input_field_toggle_active (InputField *input) {
 
-    if (input) input->active = !input->active;
+    if (input) {
+        input->active = !input->active;
+        ui_element_set_dirty (input->ui_element);
+    }
 
 }
 
@@ -110,6 +116,8 @@ void ui_input_field_placeholder_text_set (InputField *input, Renderer *renderer,
 
             ui_text_component_draw (input->placeholder, renderer);
         }
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -124,6 +132,8 @@ void ui_input_field_placeholder_text_update (InputField *input, Renderer *render
             ui_transform_component_set_pos (input->placeholder->transform, NULL, 
                 &input->ui_element->transform->rect, input->placeholder->transform->pos, true);
         }
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -134,6 +144,8 @@ void ui_input_field_placeholder_text_pos_set (InputField *input, UIPosition pos)
     if (input) {
         if (input->placeholder) 
             ui_transform_component_set_pos (input->placeholder->transform, NULL, &input->ui_element->transform->rect, pos, true);
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -146,6 +158,8 @@ void ui_input_field_placeholder_text_pos_offset_set (InputField *input, int x_of
             input->placeholder->transform->x_offset = x_offset;
             input->placeholder->transform->y_offset = y_offset;
         }
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -165,6 +179,8 @@ void ui_input_field_placeholder_text_pos_update (InputField *input) {
                 &input->ui_element->transform->rect, 
                 false);
         }
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -193,6 +209,8 @@ void ui_input_field_text_set (InputField *input, Renderer *renderer, const char
             input->password = text ? str_new (text) : str_new ("");
             ui_input_field_update (input, renderer);
         } 
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -207,6 +225,8 @@ void ui_input_field_text_update (InputField *input, Renderer *renderer, const ch
             ui_transform_component_set_pos (input->text->transform, NULL,
                 &input->ui_element->transform->rect, input->text->transform->pos, true);
         }
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -217,6 +237,8 @@ void ui_input_field_text_pos_set (InputField *input, UIPosition pos) {
     if (input) {
         if (input->text) 
             ui_transform_component_set_pos (input->text->transform, NULL, &input->ui_element->transform->rect, pos, true);
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -229,6 +251,8 @@ void ui_input_field_text_pos_offset_set (InputField *input, int x_offset, int y_
             input->text->transform->x_offset = x_offset;
             input->text->transform->y_offset = y_offset;
         }
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -248,6 +272,8 @@ void ui_input_field_text_pos_update (InputField *input) {
                 &input->ui_element->transform->rect, 
                 false);
         }
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -258,6 +284,8 @@ void ui_input_field_text_color_set (InputField *input, Renderer *renderer, RGBA_
     if (input) {
         input->text->text_color = color;
         ui_text_component_draw (input->text, renderer);
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -282,6 +310,8 @@ void ui_input_field_ouline_set_colour (InputField *input, RGBA_Color colour) {
     if (input) {
         input->outline = true;
         input->outline_colour = colour;
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -292,6 +322,8 @@ void ui_input_field_ouline_set_scale (InputField *input, float x_scale, float y_
     if (input) {
         input->outline_scale_x = x_scale;
         input->outline_scale_y = y_scale;
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -302,6 +334,8 @@ void ui_input_field_outline_remove (InputField *input) {
     if (input) {
         memset (&input->outline_colour, 0, sizeof (RGBA_Color));
         input->outline = false;
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -319,6 +353,8 @@ void ui_input_field_bg_color_set (InputField *input, Renderer *renderer, RGBA_Co
         }
 
         input->colour = true;
+
+        ui_element_set_dirty (input->ui_element);
     } 
 
 }
@@ -334,6 +370,8 @@ void ui_input_field_bg_remove (InputField *input) {
 
         memset (&input->bg_colour, 0, sizeof (RGBA_Color));
         input->colour = false;
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -344,6 +382,8 @@ void ui_input_field_selected_set (InputField *input, RGBA_Color selected_color)
     if (input) {
         input->draw_selected = true;
         input->selected_color = selected_color;
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
@@ -391,9 +431,9 @@ void ui_input_field_draw (InputField *input, Renderer *renderer) {
         if (SDL_HasIntersection (&input->ui_element->transform->rect, &renderer->window->screen_rect)) {
             // render the background
             if (input->bg_texture) {
-                SDL_RenderCopyEx (renderer->renderer, input->bg_texture, 
+                renderer_batch_texture (renderer, input->bg_texture, 
                     &input->bg_texture_rect, &input->ui_element->transform->rect, 
-                    0, 0, SDL_FLIP_NONE);
+                    SDL_FLIP_NONE);
             }
 
             else if (input->colour) 
@@ -401,8 +441,7 @@ void ui_input_field_draw (InputField *input, Renderer *renderer) {
 
             // check if the mouse is in the input
             if (input->active) {
-                if (mousePos.x >= input->ui_element->transform->rect.x && mousePos.x <= (input->ui_element->transform->rect.x + input->ui_element->transform->rect.w) && 
-                    mousePos.y >= input->ui_element->transform->rect.y && mousePos.y <= (input->ui_element->transform->rect.y + input->ui_element->transform->rect.h)) {
+                if (renderer->ui->ui_element_hover == input->ui_element) {
                     // check if the user pressed the left input over the mouse
                     if (input_get_mouse_button_state (MOUSE_LEFT)) {
                         input->pressed = true;
@@ -477,6 +516,8 @@ void ui_input_field_update (InputField *input, Renderer *renderer) {
         ui_text_component_draw (input->text, renderer);
         ui_transform_component_set_pos (input->text->transform, renderer,
             &input->ui_element->transform->rect, input->text->transform->pos, false);
+
+        ui_element_set_dirty (input->ui_element);
     }
 
 }
\ No newline at end of file
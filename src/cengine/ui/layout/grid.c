@@ -133,6 +133,8 @@ static void grid_element_update_ui_elements_pos (GridLayout *grid, GridElement *
                 ui_element->transform->rect.y = trans->rect.y;
 
                 ui_transform_component_delete (trans);
+
+                ui_element_set_moved (ui_element);
             }
 
             // printf ("AFTER: ui element: x %d - y %d\n", ui_element->transform->rect.x, ui_element->transform->rect.y);
@@ -518,6 +520,8 @@ static void ui_layout_grid_update_image_size (GridLayout *grid, GridElement *ele
         // printf ("new: %d x %d\n", element->trans->rect.w, element->trans->rect.h);
         element->ui_element->transform->rect.w = new_width;
         element->ui_element->transform->rect.h = new_height;
+
+        ui_element_set_moved (element->ui_element);
     }
 
 }
@@ -827,6 +831,8 @@ static void ui_layout_grid_scroll_up_actual (GridLayout *grid, int amount) {
                             default: break;
                         }
                     }
+
+                    ui_hit_test_invalidate (grid->renderer->ui);
                 }
             }
         }
@@ -870,6 +876,8 @@ static void ui_layout_grid_scroll_down_actual (GridLayout *grid, int amount) {
                         default: break;
                     }
                 }
+
+                ui_hit_test_invalidate (grid->renderer->ui);
             }
         }
     }
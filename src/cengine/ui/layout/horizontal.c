@@ -178,6 +178,8 @@ static void ui_layout_horizontal_update (HorizontalLayout *horizontal) {
                     default: break;
                 }
             }
+
+            ui_hit_test_invalidate (horizontal->renderer->ui);
         }
     }
 
@@ -283,6 +285,8 @@ static void ui_layout_horizontal_scroll_up (void *event_data) {
                                     default: break;
                                 }
                             }
+
+                            ui_hit_test_invalidate (horizontal->renderer->ui);
                         }
                     }
                 }
@@ -330,6 +334,8 @@ static void ui_layout_horizontal_scroll_down (void *event_data) {
                                 default: break;
                             }
                         }
+
+                        ui_hit_test_invalidate (horizontal->renderer->ui);
                     }
                 }
             }
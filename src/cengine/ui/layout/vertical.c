@@ -180,6 +180,8 @@ void ui_layout_vertical_update (VerticalLayout *vertical) {
                     default: break;
                 }
             }
+
+            ui_hit_test_invalidate (vertical->renderer->ui);
         }
     }
 
@@ -293,6 +295,8 @@ static void ui_layout_vertical_scroll_up (void *event_data) {
                                     default: break;
                                 }
                             }
+
+                            ui_hit_test_invalidate (vertical->renderer->ui);
                         }
                     }
                 }
@@ -347,6 +351,8 @@ static void ui_layout_vertical_scroll_down (void *event_data) {
                                 default: break;
                             }
                         }
+
+                        ui_hit_test_invalidate (vertical->renderer->ui);
                     }
                 }
             }
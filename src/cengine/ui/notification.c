@@ -430,6 +430,8 @@ void ui_notification_display (NotiCenter *noti_center, Notification *notificatio
 
         // add the notification to the notification center for display
         dlist_insert_after (noti_center->notifications, dlist_end (noti_center->notifications), notification);
+
+        ui_element_set_dirty (noti_center->ui_element);
     }
 
 }
@@ -562,8 +564,12 @@ NotiCenter *ui_noti_center_create (UI *ui, u8 max_display, UIPosition pos, Rende
 void ui_noti_center_set_position (NotiCenter *noti_center, UIPosition pos) {
 
     if (noti_center) {
+        ui_element_set_dirty (noti_center->ui_element);
+
         noti_center->ui_element->transform->pos = pos;
         ui_noti_center_update_pos (noti_center);
+
+        ui_element_set_dirty (noti_center->ui_element);
     }
 
 }
@@ -572,10 +578,14 @@ void ui_noti_center_set_position (NotiCenter *noti_center, UIPosition pos) {
 void ui_noti_center_set_dimensions (NotiCenter *noti_center, u32 width, u32 height) {
 
     if (noti_center) {
+        ui_element_set_dirty (noti_center->ui_element);
+
         noti_center->ui_element->transform->rect.w = width;
         noti_center->ui_element->transform->rect.h = height;
 
         ui_noti_center_update_pos (noti_center);
+
+        ui_element_set_dirty (noti_center->ui_element);
     }
 
 }
@@ -586,6 +596,8 @@ void ui_noti_center_set_ouline_colour (NotiCenter *noti_center, RGBA_Color colou
     if (noti_center) {
         noti_center->outline = true;
         noti_center->outline_colour = colour;
+
+        ui_element_set_dirty (noti_center->ui_element);
     }
 
 }
@@ -596,6 +608,8 @@ void ui_noti_center_set_ouline_scale (NotiCenter *noti_center, float x_scale, fl
     if (noti_center) {
         noti_center->outline_scale_x = x_scale;
         noti_center->outline_scale_y = y_scale;
+
+        ui_element_set_dirty (noti_center->ui_element);
     }
 
 }
@@ -606,6 +620,8 @@ void ui_noti_center_remove_outline (NotiCenter *noti_center) {
     if (noti_center) {
         memset (&noti_center->outline_colour, 0, sizeof (RGBA_Color));
         noti_center->outline = false;
+
+        ui_element_set_dirty (noti_center->ui_element);
     }
 
 }
@@ -623,6 +639,8 @@ void ui_noti_center_set_bg_color (NotiCenter *noti_center, Renderer *renderer, R
         }
 
         noti_center->colour = true;
+
+        ui_element_set_dirty (noti_center->ui_element);
     } 
 
 }
@@ -638,6 +656,8 @@ void ui_noti_center_remove_background (NotiCenter *noti_center) {
 
         memset (&noti_center->bg_colour, 0, sizeof (RGBA_Color));
         noti_center->colour = false;
+
+        ui_element_set_dirty (noti_center->ui_element);
     }
 
 }
@@ -648,9 +668,9 @@ void ui_noti_center_draw (NotiCenter *noti_center, Renderer *renderer) {
     if (noti_center && renderer) {
         // render the background
         if (noti_center->bg_texture) {
-            SDL_RenderCopyEx (renderer->renderer, noti_center->bg_texture, 
+            renderer_batch_texture (renderer, noti_center->bg_texture, 
                 &noti_center->bg_texture_rect, &noti_center->ui_element->transform->rect, 
-                0, 0, SDL_FLIP_NONE);
+                SDL_FLIP_NONE);
         }
 
         else if (noti_center->colour) 
@@ -445,6 +445,8 @@ void ui_panel_child_add (Panel *panel, UIElement *ui_element) {
         ui_element->abs_offset_y = panel->ui_element->transform->rect.y;
 
         ui_element->parent = panel->ui_element;
+
+        ui_hit_test_invalidate (panel->renderer->ui);
     }
 
 }
@@ -466,6 +468,8 @@ UIElement *ui_panel_child_remove (Panel *panel, UIElement *ui_element) {
         ui_add_element (panel->renderer->ui, ui_element);
 
         ui_element->parent = NULL;
+
+        ui_hit_test_invalidate (panel->renderer->ui);
     }
 
     return retval;
@@ -519,6 +523,8 @@ void ui_panel_resize (Panel *panel, WindowSize window_original_size, WindowSize
             panel->ui_element->transform->rect.w = new_width;
             panel->ui_element->transform->rect.h = new_height;
         }
+
+        ui_element_set_moved (panel->ui_element);
     }
 
 }
@@ -531,9 +537,9 @@ void ui_panel_draw (Panel *panel, Renderer *renderer) {
             // render the background
             if (panel->colour) {
                 if (panel->bg_texture) {
-                    SDL_RenderCopyEx (renderer->renderer, panel->bg_texture, 
+                    renderer_batch_texture (renderer, panel->bg_texture, 
                         &panel->bg_texture_rect, &panel->ui_element->transform->rect, 
-                        0, 0, SDL_FLIP_NONE);
+                        SDL_FLIP_NONE);
                 }
 
                 else {
@@ -546,7 +552,12 @@ void ui_panel_draw (Panel *panel, Renderer *renderer) {
                 // SDL_Rect viewport;
                 // SDL_RenderGetViewport (renderer->renderer, &viewport);
 
-                if (panel->layout) SDL_RenderSetViewport (renderer->renderer, &panel->ui_element->transform->rect);
+                if (panel->layout) {
+                    renderer_set_viewport (renderer, 
+                        panel->ui_element->transform->rect.x, panel->ui_element->transform->rect.y,
+                        panel->ui_element->transform->rect.w, panel->ui_element->transform->rect.h);
+                }
+
                 for (ListElement *le = dlist_start (panel->children); le; le = le->next)
                     ui_render_element (renderer, (UIElement *) le->data);
                 
@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <SDL2/SDL_rect.h>
+
+#include "cengine/types/types.h"
+
+#include "cengine/ui/ui.h"
+#include "cengine/ui/spatial.h"
+
+UISpatialGrid *ui_spatial_grid_new (int cell_size) {
+
+    UISpatialGrid *grid = (UISpatialGrid *) malloc (sizeof (UISpatialGrid));
+    if (grid) {
+        memset (grid, 0, sizeof (UISpatialGrid));
+
+        grid->cell_size = cell_size > 0 ? cell_size : UI_SPATIAL_CELL_SIZE;
+
+        grid->entries = (UISpatialEntry *) calloc (UI_SPATIAL_INIT_ENTRIES, sizeof (UISpatialEntry));
+        grid->cell_entries = (u32 *) calloc (UI_SPATIAL_INIT_ENTRIES, sizeof (u32));
+        if (grid->entries && grid->cell_entries) {
+            grid->max_entries = UI_SPATIAL_INIT_ENTRIES;
+            grid->max_cell_entries = UI_SPATIAL_INIT_ENTRIES;
+            grid->dirty = true;
+        }
+
+        else {
+            ui_spatial_grid_delete (grid);
+            grid = NULL;
+        }
+    }
+
+    return grid;
+
+}
+
+void ui_spatial_grid_delete (void *grid_ptr) {
+
+    if (grid_ptr) {
+        UISpatialGrid *grid = (UISpatialGrid *) grid_ptr;
+
+        if (grid->entries) free (grid->entries);
+        if (grid->cell_entries) free (grid->cell_entries);
+        if (grid->cell_start) free (grid->cell_start);
+
+        free (grid_ptr);
+    }
+
+}
+
+// marks the grid to be built again before the next query
+void ui_spatial_grid_invalidate (UISpatialGrid *grid) {
+
+    if (grid) grid->dirty = true;
+
+}
+
+// removes all the entries, call it before adding the elements again
+void ui_spatial_grid_clear (UISpatialGrid *grid) {
+
+    if (grid) {
+        grid->n_entries = 0;
+        grid->n_cell_entries = 0;
+    }
+
+}
+
+// adds an element with the screen rect it covers
+// elements must be added in draw order
+// returns 0 on success, 1 on error
+u8 ui_spatial_grid_add (UISpatialGrid *grid, UIElement *ui_element, const SDL_Rect *rect) {
+
+    u8 retval = 1;
+
+    if (grid && ui_element && rect) {
+        if (grid->n_entries >= grid->max_entries) {
+            u32 new_max = grid->max_entries * 2;
+            UISpatialEntry *new_entries = (UISpatialEntry *) realloc (grid->entries, new_max * sizeof (UISpatialEntry));
+            if (new_entries) {
+                grid->entries = new_entries;
+                grid->max_entries = new_max;
+            }
+        }
+
+        if (grid->n_entries < grid->max_entries) {
+            UISpatialEntry *entry = &grid->entries[grid->n_entries];
+            entry->ui_element = ui_element;
+            entry->rect = *rect;
+
+            grid->n_entries += 1;
+
+            retval = 0;
+        }
+    }
+
+    return retval;
+
+}
+
+// gets the range of cells that the rect overlaps, returns false if it is outside the grid
+static bool ui_spatial_grid_rect_cells (UISpatialGrid *grid, const SDL_Rect *rect,
+    int *col_start, int *row_start, int *col_end, int *row_end) {
+
+    if (rect->w <= 0 || rect->h <= 0) return false;
+    if (rect->x >= grid->width || rect->y >= grid->height) return false;
+    if (rect->x + rect->w <= 0 || rect->y + rect->h <= 0) return false;
+
+    *col_start = rect->x > 0 ? rect->x / grid->cell_size : 0;
+    *row_start = rect->y > 0 ? rect->y / grid->cell_size : 0;
+    *col_end = (rect->x + rect->w - 1) / grid->cell_size;
+    *row_end = (rect->y + rect->h - 1) / grid->cell_size;
+
+    if (*col_end >= grid->cols) *col_end = grid->cols - 1;
+    if (*row_end >= grid->rows) *row_end = grid->rows - 1;
+
+    return true;
+
+}
+
+// sorts the entries into the cells of a window with the specified size
+// returns 0 on success, 1 on error
+u8 ui_spatial_grid_build (UISpatialGrid *grid, int width, int height) {
+
+    u8 retval = 1;
+
+    if (grid && width > 0 && height > 0) {
+        grid->width = width;
+        grid->height = height;
+        grid->cols = (width + grid->cell_size - 1) / grid->cell_size;
+        grid->rows = (height + grid->cell_size - 1) / grid->cell_size;
+
+        u32 n_cells = (u32) (grid->cols * grid->rows);
+        if (n_cells + 1 > grid->max_cells) {
+            u32 *new_start = (u32 *) realloc (grid->cell_start, (n_cells + 1) * sizeof (u32));
+            if (!new_start) return retval;
+
+            grid->cell_start = new_start;
+            grid->max_cells = n_cells + 1;
+        }
+
+        memset (grid->cell_start, 0, (n_cells + 1) * sizeof (u32));
+
+        // count how many entries overlap each cell
+        int col_start = 0, row_start = 0, col_end = 0, row_end = 0;
+        u32 total = 0;
+        for (u32 i = 0; i < grid->n_entries; i++) {
+            if (ui_spatial_grid_rect_cells (grid, &grid->entries[i].rect, &col_start, &row_start, &col_end, &row_end)) {
+                for (int row = row_start; row <= row_end; row++) {
+                    for (int col = col_start; col <= col_end; col++) {
+                        grid->cell_start[row * grid->cols + col + 1] += 1;
+                        total += 1;
+                    }
+                }
+            }
+        }
+
+        if (total > grid->max_cell_entries) {
+            u32 *new_cell_entries = (u32 *) realloc (grid->cell_entries, total * sizeof (u32));
+            if (!new_cell_entries) return retval;
+
+            grid->cell_entries = new_cell_entries;
+            grid->max_cell_entries = total;
+        }
+
+        for (u32 i = 0; i < n_cells; i++) grid->cell_start[i + 1] += grid->cell_start[i];
+
+        // place the entries, using cell_start as the write position of each cell
+        for (u32 i = 0; i < grid->n_entries; i++) {
+            if (ui_spatial_grid_rect_cells (grid, &grid->entries[i].rect, &col_start, &row_start, &col_end, &row_end)) {
+                for (int row = row_start; row <= row_end; row++) {
+                    for (int col = col_start; col <= col_end; col++) {
+                        u32 cell = row * grid->cols + col;
+                        grid->cell_entries[grid->cell_start[cell]++] = i;
+                    }
+                }
+            }
+        }
+
+        // restore the cells start positions
+        for (u32 i = n_cells; i > 0; i--) grid->cell_start[i] = grid->cell_start[i - 1];
+        grid->cell_start[0] = 0;
+
+        grid->n_cell_entries = total;
+        grid->dirty = false;
+
+        retval = 0;
+    }
+
+    return retval;
+
+}
+
+// returns the top most element under the point that accepts the mouse, NULL if none
+UIElement *ui_spatial_grid_query (UISpatialGrid *grid, int x, int y) {
+
+    UIElement *retval = NULL;
+
+    if (grid && !grid->dirty) {
+        if (x >= 0 && y >= 0 && x < grid->width && y < grid->height) {
+            u32 cell = (y / grid->cell_size) * grid->cols + (x / grid->cell_size);
+            SDL_Point point = { .x = x, .y = y };
+
+            // entries are placed in draw order, so the last one that matches is on top
+            UISpatialEntry *entry = NULL;
+            for (u32 i = grid->cell_start[cell + 1]; i > grid->cell_start[cell]; i--) {
+                entry = &grid->entries[grid->cell_entries[i - 1]];
+                if (SDL_PointInRect (&point, &entry->rect) && ui_element_accepts_mouse (entry->ui_element)) {
+                    retval = entry->ui_element;
+                    break;
+                }
+            }
+        }
+    }
+
+    return retval;
+
+}
@@ -80,11 +80,21 @@ String *ui_textbox_get_text (TextBox *textbox) {
 
 }
 
+// marks the textbox and its text as dirty, the text can be bigger than the textbox
+static void ui_textbox_set_dirty (TextBox *textbox) {
+
+    ui_element_set_dirty (textbox->ui_element);
+    if (textbox->text) ui_element_set_dirty_rect (textbox->ui_element, &textbox->text->transform->rect);
+
+}
+
 // sets the textbox's text with options
 void ui_textbox_set_text (TextBox *textbox, Renderer *renderer, const char *text, 
     Font *font, u32 size, RGBA_Color color, bool adjust_to_text) {
 
     if (textbox) {
+        ui_textbox_set_dirty (textbox);
+
         if (textbox->text) ui_text_component_delete (textbox->text);
 
         textbox->text = text ? ui_text_component_new () : NULL;
@@ -104,6 +114,8 @@ void ui_textbox_set_text (TextBox *textbox, Renderer *renderer, const char *text
                 ui_position_update (renderer, textbox->ui_element->transform, NULL, true);
             }
         }
+
+        ui_textbox_set_dirty (textbox);
     }
 
 }
@@ -113,10 +125,14 @@ void ui_textbox_update_text (TextBox *textbox, Renderer *renderer, const char *t
 
     if (textbox) {
         if (textbox->text) {
+            ui_textbox_set_dirty (textbox);
+
             ui_text_component_update (textbox->text, text);
             ui_text_component_draw (textbox->text, renderer);
             // ui_transform_component_set_pos (textbox->text->transform, 
             //     &textbox->transform->rect, textbox->text->transform->pos, true);
+
+            ui_textbox_set_dirty (textbox);
         }
     }
 
@@ -126,6 +142,8 @@ void ui_textbox_update_text (TextBox *textbox, Renderer *renderer, const char *t
 void ui_textbox_set_text_pos (TextBox *textbox, UIPosition pos) {
 
     if (textbox) {
+        ui_textbox_set_dirty (textbox);
+
         if (textbox->text) {
             ui_transform_component_set_pos (textbox->text->transform, 
                 NULL, 
@@ -133,6 +151,8 @@ void ui_textbox_set_text_pos (TextBox *textbox, UIPosition pos) {
                 pos, 
                 true);
         }
+
+        ui_textbox_set_dirty (textbox);
     }
 
 }
@@ -145,6 +165,8 @@ void ui_textbox_set_text_pos_offset (TextBox *textbox, int x_offset, int y_offse
             textbox->text->transform->x_offset = x_offset;
             textbox->text->transform->y_offset = y_offset;
         }
+
+        ui_textbox_set_dirty (textbox);
     }
 
 }
@@ -173,8 +195,12 @@ void ui_textbox_update_text_pos (TextBox *textbox) {
 void ui_textbox_set_font (TextBox *textbox, Renderer *renderer, Font *font) {
 
     if (textbox) {
+        ui_textbox_set_dirty (textbox);
+
         textbox->text->font = font;
         ui_text_component_draw (textbox->text, renderer);
+
+        ui_textbox_set_dirty (textbox);
     }
 
 }
@@ -183,10 +209,14 @@ void ui_textbox_set_font (TextBox *textbox, Renderer *renderer, Font *font) {
 void ui_textbox_set_text_color (TextBox *textbox, Renderer *renderer, RGBA_Color color) {
 
     if (textbox) {
+        ui_textbox_set_dirty (textbox);
+
         if (textbox->text) {
             textbox->text->text_color = color;
             ui_text_component_draw (textbox->text, renderer);
         }
+
+        ui_textbox_set_dirty (textbox);
     }
 
 }
@@ -197,6 +227,8 @@ void ui_textbox_set_ouline_colour (TextBox *textbox, RGBA_Color colour) {
     if (textbox) {
         textbox->outline = true;
         textbox->outline_colour = colour;
+
+        ui_textbox_set_dirty (textbox);
     }
 
 }
@@ -207,6 +239,8 @@ void ui_textbox_set_ouline_scale (TextBox *textbox, float x_scale, float y_scale
     if (textbox) {
         textbox->outline_scale_x = x_scale;
         textbox->outline_scale_y = y_scale;
+
+        ui_textbox_set_dirty (textbox);
     }
 
 }
@@ -217,6 +251,8 @@ void ui_textbox_remove_outline (TextBox *textbox) {
     if (textbox) {
         memset (&textbox->outline_colour, 0, sizeof (RGBA_Color));
         textbox->outline = false;
+
+        ui_textbox_set_dirty (textbox);
     }
 
 }
@@ -233,6 +269,8 @@ void ui_textbox_set_bg_color (TextBox *textbox, Renderer *renderer, RGBA_Color c
         }
 
         textbox->colour = true;
+
+        ui_textbox_set_dirty (textbox);
     } 
 
 }
@@ -249,6 +287,8 @@ void ui_textbox_remove_background (TextBox *textbox, Renderer *renderer) {
 
         memset (&textbox->bg_colour, 0, sizeof (RGBA_Color));
         textbox->colour = false;
+
+        ui_textbox_set_dirty (textbox);
     }
 
 }
@@ -307,9 +347,9 @@ void ui_textbox_draw (TextBox *textbox, Renderer *renderer) {
         if (SDL_HasIntersection (&textbox->ui_element->transform->rect, &renderer->window->screen_rect)) {
             // render the background
             if (textbox->bg_texture) {
-                SDL_RenderCopyEx (renderer->renderer, textbox->bg_texture, 
+                renderer_batch_texture (renderer, textbox->bg_texture, 
                     &textbox->bg_texture_rect, &textbox->ui_element->transform->rect, 
-                    0, 0, SDL_FLIP_NONE);
+                    SDL_FLIP_NONE);
             }
 
             else if (textbox->colour) 
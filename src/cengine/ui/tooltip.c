@@ -297,9 +297,9 @@ void ui_tooltip_draw (Tooltip *tooltip, Renderer *renderer) {
             // render the background
             if (tooltip->colour) {
                 if (tooltip->bg_texture) {
-                    SDL_RenderCopyEx (renderer->renderer, tooltip->bg_texture, 
+                    renderer_batch_texture (renderer, tooltip->bg_texture, 
                         &tooltip->bg_texture_rect, &tooltip->ui_element->transform->rect, 
-                        0, 0, SDL_FLIP_NONE);
+                        SDL_FLIP_NONE);
                 }
 
                 else {
@@ -309,7 +309,12 @@ void ui_tooltip_draw (Tooltip *tooltip, Renderer *renderer) {
 
             // render the tooltip's children
             if (tooltip->children) {
-                if (tooltip->vertical) SDL_RenderSetViewport (renderer->renderer, &tooltip->ui_element->transform->rect);
+                if (tooltip->vertical) {
+                    renderer_set_viewport (renderer, 
+                        tooltip->ui_element->transform->rect.x, tooltip->ui_element->transform->rect.y,
+                        tooltip->ui_element->transform->rect.w, tooltip->ui_element->transform->rect.h);
+                }
+
                 for (ListElement *le = dlist_start (tooltip->children); le; le = le->next)
                     ui_render_element (renderer, (UIElement *) le->data);
                 
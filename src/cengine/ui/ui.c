@@ -8,6 +8,7 @@
 #include "cengine/collections/dlist.h"
 
 #include "cengine/cengine.h"
+#include "cengine/input.h"
 #include "cengine/renderer.h"
 #include "cengine/sprites.h"
 #include "cengine/textures.h"
@@ -24,6 +25,7 @@
 #include "cengine/ui/notification.h"
 #include "cengine/ui/dropdown.h"
 #include "cengine/ui/tooltip.h"
+#include "cengine/ui/spatial.h"
 #include "cengine/ui/components/transform.h"
 
 #include "cengine/utils/log.h"
@@ -81,6 +83,9 @@ UIElement *ui_element_create (UI *ui, UIElementType type) {
             new_element->type = type;
             new_element->element = NULL;
             new_element->transform = ui_transform_component_new ();
+            if (new_element->transform) new_element->transform->ui_element = new_element;
+
+            ui_hit_test_invalidate (ui);
         }
     }
 
@@ -117,6 +122,13 @@ void ui_element_delete (void *ui_element_ptr) {
     if (ui_element_ptr) {
         UIElement *ui_element = (UIElement *) ui_element_ptr;
 
+        if (ui_element->ui) {
+            if (ui_element->ui->ui_element_hover == ui_element) 
+                ui_element->ui->ui_element_hover = NULL;
+
+            ui_hit_test_invalidate (ui_element->ui);
+        }
+
         ui_element_delete_element (ui_element);
         ui_transform_component_delete (ui_element->transform);
         
@@ -132,6 +144,8 @@ void ui_element_destroy (void *ui_element_ptr) {
     if (ui_element_ptr) {
         UIElement *ui_element = (UIElement *) ui_element_ptr;
 
+        ui_element_set_dirty (ui_element);
+
         ui_remove_element (ui_element->ui, ui_element);
 
         ui_element_delete (ui_element_ptr);
@@ -166,6 +180,8 @@ int ui_element_set_layer (UI *ui, UIElement *ui_element, const char *layer_name)
     if (ui_element && layer_name) {
         Layer *layer = layer_get_by_name (ui->ui_elements_layers, layer_name);
         if (layer) {
+            ui_element_set_dirty (ui_element);
+
             if (ui_element->layer_id >= 0) {
                 Layer *curr_layer = layer_get_by_pos (ui->ui_elements_layers, ui_element->layer_id);
                 // printf ("curr layer: %s\n", curr_layer->name->str);
@@ -187,6 +203,9 @@ int ui_element_set_layer (UI *ui, UIElement *ui_element, const char *layer_name)
             }
 
             // retval = layer_add_element (layer, ui_element);
+
+            ui_element_set_dirty (ui_element);
+            ui_hit_test_invalidate (ui);
         }
     }
 
@@ -196,13 +215,23 @@ int ui_element_set_layer (UI *ui, UIElement *ui_element, const char *layer_name)
 
 void ui_element_toggle_active (UIElement *ui_element) {
 
-    if (ui_element) ui_element->active = !ui_element->active;
+    if (ui_element) {
+        ui_element->active = !ui_element->active;
+        ui_element_set_dirty (ui_element);
+        ui_hit_test_invalidate (ui_element->ui);
+    }
 
 }
 
 void ui_element_set_active (UIElement *ui_element, bool active) {
 
-    if (ui_element) ui_element->active = active;
+    if (ui_element) {
+        if (ui_element->active != active) {
+            ui_element->active = active;
+            ui_element_set_dirty (ui_element);
+            ui_hit_test_invalidate (ui_element->ui);
+        }
+    }
 
 }
 
@@ -222,6 +251,99 @@ void parent_ui_element_get_position (UIElement *parent, int *x, int *y) {
 
 }
 
+// adds the position of each of the element's parents,
+// the transform of a child is relative to the panel that draws it
+static void ui_element_add_parents_pos (UIElement *ui_element, int *x, int *y) {
+
+    for (UIElement *parent = ui_element->parent; parent; parent = parent->parent) {
+        *x += parent->transform->rect.x;
+        *y += parent->transform->rect.y;
+    }
+
+}
+
+// gets the rect that the element covers in window coordinates
+void ui_element_get_screen_rect (UIElement *ui_element, SDL_Rect *rect) {
+
+    if (ui_element && rect) {
+        rect->x = ui_element->transform->rect.x;
+        rect->y = ui_element->transform->rect.y;
+        rect->w = ui_element->transform->rect.w;
+        rect->h = ui_element->transform->rect.h;
+
+        ui_element_add_parents_pos (ui_element, &rect->x, &rect->y);
+    }
+
+}
+
+// marks the area the element covers right now to be drawn again,
+// only has effect if the element is in a cached layer
+// call it before and after changing how the element looks
+void ui_element_set_dirty (UIElement *ui_element) {
+
+    if (ui_element && ui_element->transform)
+        ui_element_set_dirty_rect (ui_element, &ui_element->transform->rect);
+
+}
+
+// marks a rect to be drawn again, the rect is in the same coordinates
+// as the element's transform, useful for components that grow outside the element
+// adds the rect to the dirty rects of the element's layer if it is cached
+static void ui_element_add_dirty_rect (UIElement *ui_element, const SDL_Rect *rect) {
+
+    // children are drawn by their parents, so we need the top layer
+    UIElement *root = ui_element;
+    while (root->parent) root = root->parent;
+
+    Layer *layer = layer_get_by_pos (ui_element->ui->ui_elements_layers, root->layer_id);
+    if (layer && layer->cached) {
+        SDL_Rect screen_rect = *rect;
+        ui_element_add_parents_pos (ui_element, &screen_rect.x, &screen_rect.y);
+
+        layer_add_dirty_rect (layer, &screen_rect);
+    }
+
+}
+
+void ui_element_set_dirty_rect (UIElement *ui_element, const SDL_Rect *rect) {
+
+    if (ui_element && ui_element->ui && rect) {
+        // the element may look different under the mouse now
+        ui_element->ui->hover_dirty = true;
+
+        ui_element_add_dirty_rect (ui_element, rect);
+    }
+
+}
+
+// call it after changing the element's transform rect directly
+// to update the rects used to check which element is under the mouse
+void ui_element_set_moved (UIElement *ui_element) {
+
+    if (ui_element) ui_hit_test_invalidate (ui_element->ui);
+
+}
+
+// returns true if the element handles the mouse (buttons, images with actions, inputs and dropdowns)
+bool ui_element_accepts_mouse (UIElement *ui_element) {
+
+    bool retval = false;
+
+    if (ui_element && ui_element->element) {
+        switch (ui_element->type) {
+            case UI_BUTTON: retval = ((Button *) ui_element->element)->active; break;
+            case UI_IMAGE: retval = ((Image *) ui_element->element)->active; break;
+            case UI_INPUT: retval = ((InputField *) ui_element->element)->active; break;
+            case UI_DROPDOWN: retval = ((Dropdown *) ui_element->element)->active; break;
+
+            default: break;
+        }
+    }
+
+    return retval;
+
+}
+
 #pragma endregion
 
 #pragma region ui
@@ -236,6 +358,12 @@ static UI *ui_new (void) {
         ui->ui_elements_layers = NULL;
 
         ui->ui_element_hover = NULL;
+
+        ui->hit_grid = NULL;
+        ui->hover_x = ui->hover_y = -1;
+        ui->hover_in_window = false;
+        ui->hover_mouse_down = false;
+        ui->hover_dirty = true;
     }
 
     return ui;
@@ -251,6 +379,8 @@ void ui_delete (void *ui_ptr) {
 
         dlist_delete (ui->ui_elements_layers);
 
+        ui_spatial_grid_delete (ui->hit_grid);
+
         free (ui_ptr);
     }
 
@@ -264,6 +394,8 @@ UI *ui_create (void) {
         ui->ui_elements = dlist_init (ui_element_destroy, ui_element_comparator);
 
         ui->ui_elements_layers = ui_layers_init ();
+
+        ui->hit_grid = ui_spatial_grid_new (UI_SPATIAL_CELL_SIZE);
     }
 
     return ui;
@@ -304,6 +436,108 @@ UIElement *ui_remove_element (UI *ui, UIElement *ui_element) {
 
 #pragma endregion
 
+#pragma region hit test
+
+// the rects used to check which element is under the mouse will be updated
+// before the next check, call it after moving many elements directly
+void ui_hit_test_invalidate (UI *ui) {
+
+    if (ui) ui_spatial_grid_invalidate (ui->hit_grid);
+
+}
+
+// adds the elements that can handle the mouse in the same order as they are drawn
+static void ui_hit_test_add_element (UISpatialGrid *grid, UIElement *ui_element) {
+
+    if (ui_element->active) {
+        SDL_Rect rect = { 0 };
+
+        switch (ui_element->type) {
+            case UI_BUTTON:
+            case UI_IMAGE:
+            case UI_INPUT:
+            case UI_DROPDOWN:
+                ui_element_get_screen_rect (ui_element, &rect);
+                ui_spatial_grid_add (grid, ui_element, &rect);
+                break;
+
+            case UI_PANEL: {
+                Panel *panel = (Panel *) ui_element->element;
+                if (panel) {
+                    for (ListElement *le = dlist_start (panel->children); le; le = le->next)
+                        ui_hit_test_add_element (grid, (UIElement *) le->data);
+                }
+            } break;
+
+            default: break;
+        }
+    }
+
+}
+
+static void ui_hit_test_build (UI *ui, Window *window) {
+
+    ui_spatial_grid_clear (ui->hit_grid);
+
+    Layer *layer = NULL;
+    for (ListElement *le = dlist_start (ui->ui_elements_layers); le; le = le->next) {
+        layer = (Layer *) le->data;
+        for (ListElement *le_sub = dlist_start (layer->elements); le_sub; le_sub = le_sub->next)
+            ui_hit_test_add_element (ui->hit_grid, (UIElement *) le_sub->data);
+    }
+
+    ui_spatial_grid_build (ui->hit_grid, window->window_size.width, window->window_size.height);
+
+}
+
+// updates the ui element that is below the mouse, only looks for it again
+// when the mouse or the elements have changed since the last check
+void ui_hit_test (UI *ui, Window *window) {
+
+    if (ui && ui->hit_grid && window) {
+        bool update = ui->hover_dirty;
+
+        if (ui->hit_grid->dirty
+            || ui->hit_grid->width != window->window_size.width
+            || ui->hit_grid->height != window->window_size.height) {
+            ui_hit_test_build (ui, window);
+            update = true;
+        }
+
+        int x = (int) mousePos.x;
+        int y = (int) mousePos.y;
+        if (x != ui->hover_x || y != ui->hover_y || window->mouse != ui->hover_in_window) {
+            ui->hover_x = x;
+            ui->hover_y = y;
+            ui->hover_in_window = window->mouse;
+            update = true;
+        }
+
+        if (update) {
+            UIElement *hover = window->mouse ? ui_spatial_grid_query (ui->hit_grid, x, y) : NULL;
+            if (hover != ui->ui_element_hover) {
+                // both elements need to be drawn with their new state
+                ui_element_set_dirty (ui->ui_element_hover);
+                ui_element_set_dirty (hover);
+
+                ui->ui_element_hover = hover;
+            }
+        }
+
+        // clicks are handled when the element gets drawn
+        bool mouse_down = input_get_mouse_button_state (MOUSE_LEFT);
+        if (mouse_down != ui->hover_mouse_down) {
+            ui->hover_mouse_down = mouse_down;
+            ui_element_set_dirty (ui->ui_element_hover);
+        }
+
+        ui->hover_dirty = false;
+    }
+
+}
+
+#pragma endregion
+
 #pragma region render
 
 // resize the ui elements to fit new window
@@ -361,16 +595,145 @@ void ui_render_element (Renderer *renderer, UIElement *ui_element) {
 
 }
 
+static void ui_render_layer (Renderer *renderer, Layer *layer) {
+
+    for (ListElement *le_sub = dlist_start (layer->elements); le_sub; le_sub = le_sub->next) {
+        ui_render_element (renderer, (UIElement *) le_sub->data);
+    }
+
+}
+
+// draws again the elements of a cached layer that are inside its dirty rects
+// returns the number of pixels that were redrawn
+static u64 ui_render_cached_layer_update (Renderer *renderer, Layer *layer) {
+
+    u64 redrawn = 0;
+
+    SDL_Rect full = { .x = 0, .y = 0, .w = layer->cache_width, .h = layer->cache_height };
+
+    u32 n_rects = layer->dirty_all ? 1 : layer->n_dirty_rects;
+    SDL_Rect *rects = layer->dirty_all ? &full : layer->dirty_rects;
+
+    // draw the layer into its own texture
+    renderer_batch_flush (renderer);
+    SDL_SetRenderTarget (renderer->renderer, layer->cache);
+
+    SDL_BlendMode blend_mode = SDL_BLENDMODE_NONE;
+    SDL_GetRenderDrawBlendMode (renderer->renderer, &blend_mode);
+
+    SDL_Rect dirty = { 0 };
+    SDL_Rect element_rect = { 0 };
+    for (u32 i = 0; i < n_rects; i++) {
+        if (!SDL_IntersectRect (&rects[i], &full, &dirty)) continue;
+
+        renderer_set_clip_rect (renderer, &dirty);
+
+        // clear the area, SDL_RenderClear () ignores the clip rect
+        SDL_SetRenderDrawBlendMode (renderer->renderer, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor (renderer->renderer, 0, 0, 0, 0);
+        SDL_RenderFillRect (renderer->renderer, &dirty);
+        SDL_SetRenderDrawBlendMode (renderer->renderer, blend_mode);
+
+        UIElement *ui_element = NULL;
+        for (ListElement *le = dlist_start (layer->elements); le; le = le->next) {
+            ui_element = (UIElement *) le->data;
+            ui_element_get_screen_rect (ui_element, &element_rect);
+            if (SDL_HasIntersection (&element_rect, &dirty))
+                ui_render_element (renderer, ui_element);
+        }
+
+        renderer_batch_flush (renderer);
+
+        redrawn += (u64) dirty.w * (u64) dirty.h;
+    }
+
+    renderer_set_clip_rect (renderer, NULL);
+    SDL_SetRenderTarget (renderer->renderer, NULL);
+
+    layer->dirty_all = false;
+    layer->n_dirty_rects = 0;
+
+    return redrawn;
+
+}
+
+// buttons, images, input fields & dropdowns handle the mouse while they are drawn
+// and the notification center removes the old notifications while it is drawn,
+// so they can not wait in a cached layer until a setter marks them as dirty
+static bool ui_element_is_live (const UIElement *ui_element) {
+
+    bool retval = false;
+
+    switch (ui_element->type) {
+        case UI_IMAGE: retval = ((Image *) ui_element->element)->active; break;
+        case UI_BUTTON: retval = ((Button *) ui_element->element)->active; break;
+        case UI_INPUT: retval = ((InputField *) ui_element->element)->active; break;
+        case UI_DROPDOWN: retval = ((Dropdown *) ui_element->element)->active; break;
+        case UI_NOTI_CENTER: {
+            NotiCenter *noti_center = (NotiCenter *) ui_element->element;
+            retval = noti_center->notifications->size || noti_center->active_notifications->size;
+        } break;
+
+        default: break;
+    }
+
+    return retval;
+
+}
+
+// the live elements inside cached layers are drawn again every frame,
+// without marking the element under the mouse to be checked again
+static void ui_render_set_live_dirty (UI *ui) {
+
+    UIElement *ui_element = NULL;
+    for (ListElement *le = dlist_start (ui->ui_elements); le; le = le->next) {
+        ui_element = (UIElement *) le->data;
+        if (ui_element->active && ui_element->element && ui_element->transform
+            && ui_element_is_live (ui_element)) {
+            ui_element_add_dirty_rect (ui_element, &ui_element->transform->rect);
+
+            // the options are drawn below the dropdown
+            if (ui_element->type == UI_DROPDOWN) {
+                Dropdown *dropdown = (Dropdown *) ui_element->element;
+                if (dropdown->vertical_layout)
+                    ui_element_add_dirty_rect (ui_element, &dropdown->vertical_layout->transform->rect);
+            }
+        }
+    }
+
+}
+
 // render all the ui elements to the screen
 void ui_render (Renderer *renderer) {
 
+    u64 window_pixels = (u64) renderer->window->window_size.width * (u64) renderer->window->window_size.height;
+
+    ui_render_set_live_dirty (renderer->ui);
+
     Layer *layer = NULL;
     for (ListElement *le = dlist_start (renderer->ui->ui_elements_layers); le; le = le->next) {
         layer = (Layer *) le->data;
 
-        for (ListElement *le_sub = dlist_start (layer->elements); le_sub; le_sub = le_sub->next) {
-            ui_render_element (renderer, (UIElement *) le_sub->data);
-        }   
+        renderer_batch_set_layer (renderer, layer->pos);
+
+        renderer->frame_stats.n_layers += 1;
+        renderer->frame_stats.total_pixels += window_pixels;
+
+        if (layer->cached && !layer_cache_prepare (renderer, layer)) {
+            renderer->frame_stats.n_cached_layers += 1;
+
+            if (layer->dirty_all || layer->n_dirty_rects) {
+                renderer->frame_stats.redrawn_pixels += ui_render_cached_layer_update (renderer, layer);
+                renderer->frame_stats.n_redrawn_layers += 1;
+            }
+
+            renderer_batch_texture (renderer, layer->cache, NULL, &renderer->window->screen_rect, SDL_FLIP_NONE);
+        }
+
+        else {
+            ui_render_layer (renderer, layer);
+            renderer->frame_stats.redrawn_pixels += window_pixels;
+        }
     }
 
     // render the cursor on top of everything
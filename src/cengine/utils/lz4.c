@@ -0,0 +1,278 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cengine/utils/lz4.h"
+
+#define LZ4_MIN_MATCH               4
+#define LZ4_LAST_LITERALS           5           // the last bytes are always literals
+#define LZ4_MF_LIMIT                12          // a match can not start in the last bytes
+#define LZ4_MAX_DISTANCE            65535
+
+#define LZ4_HASH_LOG                12
+#define LZ4_RUN_MASK                15
+
+static inline uint32_t lz4_read32 (const uint8_t *p) {
+
+    uint32_t value = 0;
+    memcpy (&value, p, sizeof (uint32_t));
+    return value;
+
+}
+
+static inline uint64_t lz4_read64 (const uint8_t *p) {
+
+    uint64_t value = 0;
+    memcpy (&value, p, sizeof (uint64_t));
+    return value;
+
+}
+
+// copies in blocks of 8 bytes, so it can write up to 7 bytes after dest + size
+static inline void lz4_wild_copy (uint8_t *dest, const uint8_t *src, size_t size) {
+
+    uint8_t *end = dest + size;
+    do {
+        memcpy (dest, src, 8);
+        dest += 8;
+        src += 8;
+    } while (dest < end);
+
+}
+
+// returns how many bytes are equal at the start of a & b, without reading b past limit
+static inline size_t lz4_count (const uint8_t *a, const uint8_t *b, const uint8_t *limit) {
+
+    const uint8_t *start = b;
+
+    while (b + 8 <= limit) {
+        uint64_t diff = lz4_read64 (a) ^ lz4_read64 (b);
+        if (diff) return (b - start) + (__builtin_ctzll (diff) >> 3);
+
+        a += 8;
+        b += 8;
+    }
+
+    while ((b < limit) && (*a == *b)) {
+        a++;
+        b++;
+    }
+
+    return b - start;
+
+}
+
+static inline uint32_t lz4_hash (uint32_t sequence) {
+
+    return (sequence * 2654435761U) >> (32 - LZ4_HASH_LOG);
+
+}
+
+// writes the part of a length that does not fit in the token
+static inline uint8_t *lz4_write_length (uint8_t *op, size_t length) {
+
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+
+    *op++ = (uint8_t) length;
+
+    return op;
+
+}
+
+// writes a sequence of literals followed by a match, or only the literals if match_length is 0
+// returns the new output position, NULL if it does not fit
+static uint8_t *lz4_write_sequence (uint8_t *op, const uint8_t *oend,
+    const uint8_t *literals, size_t literals_length, size_t offset, size_t match_length) {
+
+    size_t needed = 1 + literals_length + (literals_length / 255) + 1;
+    if (match_length) needed += 2 + (match_length / 255) + 1;
+
+    if (needed > (size_t) (oend - op)) return NULL;
+
+    uint8_t *token = op++;
+
+    if (literals_length >= LZ4_RUN_MASK) {
+        *token = LZ4_RUN_MASK << 4;
+        op = lz4_write_length (op, literals_length - LZ4_RUN_MASK);
+    }
+
+    else *token = (uint8_t) (literals_length << 4);
+
+    memcpy (op, literals, literals_length);
+    op += literals_length;
+
+    if (match_length) {
+        *op++ = (uint8_t) (offset & 0xFF);
+        *op++ = (uint8_t) (offset >> 8);
+
+        size_t length = match_length - LZ4_MIN_MATCH;
+        if (length >= LZ4_RUN_MASK) {
+            *token |= LZ4_RUN_MASK;
+            op = lz4_write_length (op, length - LZ4_RUN_MASK);
+        }
+
+        else *token |= (uint8_t) length;
+    }
+
+    return op;
+
+}
+
+// compresses the source into dest, that should have LZ4_COMPRESS_BOUND (source_size) bytes to always succeed
+// returns the size of the compressed data, 0 if it does not fit in dest_capacity
+size_t lz4_compress (const void *source, size_t source_size, void *dest, size_t dest_capacity) {
+
+    const uint8_t *src = (const uint8_t *) source;
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *iend = src + source_size;
+
+    uint8_t *op = (uint8_t *) dest;
+    const uint8_t *oend = op + dest_capacity;
+
+    if (source && dest && (source_size > LZ4_MF_LIMIT)) {
+        // positions of the last sequences that had each hash
+        uint32_t table[1 << LZ4_HASH_LOG];
+        memset (table, 0, sizeof (table));
+
+        const uint8_t *mflimit = iend - LZ4_MF_LIMIT;
+        const uint8_t *matchlimit = iend - LZ4_LAST_LITERALS;
+
+        ip++;
+        while (op && (ip <= mflimit)) {
+            uint32_t sequence = lz4_read32 (ip);
+            uint32_t h = lz4_hash (sequence);
+            const uint8_t *ref = src + table[h];
+            table[h] = (uint32_t) (ip - src);
+
+            if ((ref < ip) && ((size_t) (ip - ref) <= LZ4_MAX_DISTANCE) && (lz4_read32 (ref) == sequence)) {
+                while ((ip > anchor) && (ref > src) && (ip[-1] == ref[-1])) {
+                    ip--;
+                    ref--;
+                }
+
+                const uint8_t *match_end = ip + LZ4_MIN_MATCH;
+                match_end += lz4_count (ref + LZ4_MIN_MATCH, match_end, matchlimit);
+
+                op = lz4_write_sequence (op, oend, anchor, ip - anchor, ip - ref, match_end - ip);
+
+                ip = match_end;
+                anchor = ip;
+
+                // the end of a match is a good place for the next one to start
+                if (ip <= mflimit) table[lz4_hash (lz4_read32 (ip - 2))] = (uint32_t) (ip - 2 - src);
+            }
+
+            // skip faster through data that does not compress
+            else ip += 1 + ((ip - anchor) >> 6);
+        }
+    }
+
+    if (op && source && dest) op = lz4_write_sequence (op, oend, anchor, iend - anchor, 0, 0);
+
+    return op ? (size_t) (op - (uint8_t *) dest) : 0;
+
+}
+
+// reads the part of a length that did not fit in the token
+// returns 0 on success, 1 if the input ended
+static inline int lz4_read_length (const uint8_t **ip, const uint8_t *iend, size_t *length) {
+
+    uint8_t byte = 255;
+    while (byte == 255) {
+        if (*ip >= iend) return 1;
+
+        byte = *(*ip)++;
+        *length += byte;
+    }
+
+    return 0;
+
+}
+
+// decompresses the source into dest, it never reads or writes outside of the buffers, even with bad data
+// returns the size of the decompressed data, 0 if the data is not valid or it does not fit in dest_capacity
+size_t lz4_decompress (const void *source, size_t source_size, void *dest, size_t dest_capacity) {
+
+    size_t retval = 0;
+
+    if (source && dest && source_size) {
+        const uint8_t *ip = (const uint8_t *) source;
+        const uint8_t *iend = ip + source_size;
+
+        uint8_t *dst = (uint8_t *) dest;
+        uint8_t *op = dst;
+        const uint8_t *oend = dst + dest_capacity;
+
+        int errors = 0;
+        while (!errors && (ip < iend)) {
+            uint8_t token = *ip++;
+
+            size_t literals_length = token >> 4;
+            if (literals_length == LZ4_RUN_MASK) errors = lz4_read_length (&ip, iend, &literals_length);
+
+            if (errors || (literals_length > (size_t) (iend - ip)) || (literals_length > (size_t) (oend - op))) {
+                errors = 1;
+                break;
+            }
+
+            // most literals runs are short, so they are copied in blocks when there is space
+            if (((size_t) (oend - op) >= literals_length + 8) && ((size_t) (iend - ip) >= literals_length + 8))
+                lz4_wild_copy (op, ip, literals_length);
+
+            else memcpy (op, ip, literals_length);
+
+            op += literals_length;
+            ip += literals_length;
+
+            // the last sequence only has literals
+            if (ip == iend) break;
+
+            if ((iend - ip) < 2) {
+                errors = 1;
+                break;
+            }
+
+            size_t offset = ip[0] | (ip[1] << 8);
+            ip += 2;
+
+            if (!offset || (offset > (size_t) (op - dst))) {
+                errors = 1;
+                break;
+            }
+
+            size_t match_length = token & LZ4_RUN_MASK;
+            if (match_length == LZ4_RUN_MASK) errors = lz4_read_length (&ip, iend, &match_length);
+            match_length += LZ4_MIN_MATCH;
+
+            if (errors || (match_length > (size_t) (oend - op))) {
+                errors = 1;
+                break;
+            }
+
+            const uint8_t *match = op - offset;
+            if ((offset >= 8) && ((size_t) (oend - op) >= match_length + 8)) {
+                lz4_wild_copy (op, match, match_length);
+                op += match_length;
+            }
+
+            else if (offset >= match_length) {
+                memcpy (op, match, match_length);
+                op += match_length;
+            }
+
+            // the match overlaps the bytes that it writes, so it repeats them
+            else {
+                for (size_t i = 0; i < match_length; i++) *op++ = *match++;
+            }
+        }
+
+        if (!errors) retval = op - dst;
+    }
+
+    return retval;
+
+}